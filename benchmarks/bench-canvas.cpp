@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include <lcdgfx.h>
+
+// Canvas primitives on a canvas the size of the SSD1331, separate from the
+// display's so the results do not depend on what the firmware last drew
+
+static uint8_t canvasData[96 * 64];
+static NanoCanvas8 canvas(96, 64, canvasData);
+
+// A 16x16 one bit icon in the SSD1306 page layout drawBitmap1 expects
+static const uint8_t icon16[32] = {
+    0x00, 0xE0, 0x18, 0x04, 0x04, 0x02, 0x82, 0xC2, 0xC2, 0x82, 0x02, 0x04, 0x04, 0x18, 0xE0, 0x00,
+    0x00, 0x07, 0x18, 0x20, 0x20, 0x40, 0x41, 0x43, 0x43, 0x41, 0x40, 0x20, 0x20, 0x18, 0x07, 0x00,
+};
+
+// Square of side range(0), from a single cell to the full canvas height
+static void BM_CanvasFillRect(benchmark::State &state)
+{
+  const lcdint_t side = (lcdint_t)state.range(0);
+  canvas.setColor(RGB_COLOR8(255, 0, 0));
+  for (auto _ : state)
+  {
+    canvas.fillRect(0, 0, side - 1, side - 1);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * side * side);
+}
+BENCHMARK(BM_CanvasFillRect)->Arg(4)->Arg(16)->Arg(64);
+
+// The home screen's status line, range(0) selects STYLE_NORMAL or STYLE_BOLD
+static void BM_CanvasPrintFixed(benchmark::State &state)
+{
+  static const char text[] = "T:23 H:48% L:650";
+  const EFontStyle style = state.range(0) ? STYLE_BOLD : STYLE_NORMAL;
+  canvas.setFixedFont(ssd1306xled_font5x7);
+  canvas.setColor(RGB_COLOR8(255, 255, 255));
+  for (auto _ : state)
+  {
+    canvas.printFixed(2, 36, text, style);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)(sizeof(text) - 1));
+}
+BENCHMARK(BM_CanvasPrintFixed)->Arg(0)->Arg(1);
+
+static void BM_CanvasDrawBitmap1(benchmark::State &state)
+{
+  canvas.setColor(RGB_COLOR8(0, 255, 0));
+  for (auto _ : state)
+  {
+    canvas.drawBitmap1(40, 24, 16, 16, icon16);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * 16 * 16);
+}
+BENCHMARK(BM_CanvasDrawBitmap1);
+
+static void BM_CanvasClear(benchmark::State &state)
+{
+  for (auto _ : state)
+  {
+    canvas.clear();
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * (int64_t)sizeof(canvasData));
+}
+BENCHMARK(BM_CanvasClear);
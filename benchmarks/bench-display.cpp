@@ -0,0 +1,16 @@
+#include <benchmark/benchmark.h>
+
+#include "display.h"
+
+// Whole home screen: clear, draw the three panels and the status line, then
+// bring the panel up to date. Only pixels that changed go over SPI (into the
+// simulated panel on the host), so this is mostly the cost of drawing and diffing.
+static void BM_RenderHome(benchmark::State &state)
+{
+  for (auto _ : state)
+  {
+    renderHome();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RenderHome);
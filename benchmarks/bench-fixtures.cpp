@@ -0,0 +1,58 @@
+#include "bench-fixtures.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "compressor-status.h"
+#include "display.h"
+#include "json-arena.h"
+#include "sensors.h"
+#include "wifi.h"
+
+const char *const benchStatusUpdateJson =
+    "{\"messageType\":\"INFO\",\"infoType\":\"STATUS_UPDATE\",\"pressure\":32.4,\"temperature\":27.1,"
+    "\"compressorOn\":true,\"motorRunning\":false,\"airbrushInUse\":true,\"compressionTimerDuration\":30,"
+    "\"compressionTimeLeft\":17,\"motorTimerDuration\":5,\"motorTimeLeft\":0,\"releaseTimerDuration\":8,"
+    "\"releaseTimeLeft\":0}";
+
+const char *const benchPressureChangeJson = "{\"messageType\":\"INFO\",\"infoType\":\"PRESSURE_CHANGE\",\"pressure\":31.9}";
+
+const char *const benchCommandJson = "{\"messageType\":\"COMMAND\",\"commandType\":\"SET_COMPRESSION_TIMEOUT\",\"timeout\":30}";
+
+void benchSetUpFirmware()
+{
+  initJsonArena();
+  initDisplay();
+  startDisplay();
+
+  SensorReadings readings = {};
+  readings.boothTemp = 23.5f;
+  readings.boothHumidity = 48.0f;
+  readings.lightsTemp[0] = 41.0f;
+  readings.lightsTemp[1] = 43.5f;
+  readings.lightsTemp[2] = 39.0f;
+  sensorReadings.publish(readings);
+  boothLux.publish(650.0f);
+  networkStatus = WIFI_CONNECTED;
+
+  CompressorStatus status = {};
+  status.pressure = 32.4f;
+  status.temperature = 27.1f;
+  status.compressorOn = true;
+  status.airbrushInUse = true;
+  status.compressionTimerDuration = 30;
+  status.compressionTimeLeft = 17;
+  g_compressorStatus.publish(status);
+
+  // A busy neighbourhood: every slot taken, SSIDs of typical lengths
+  static const char *const ssids[MAX_SCAN_RESULTS] = {
+      "bench-sim", "workshop", "VM4821937", "BT-KQ7Z2X", "TP-Link_5G_3A1F",
+      "guest", "SKYQ8M2P", "Garage Extender", "NETGEAR47", "DIRECT-roku-881"};
+  for (int i = 0; i < MAX_SCAN_RESULTS; i++)
+  {
+    snprintf(topScanResults[i].ssid, sizeof(topScanResults[i].ssid), "%s", ssids[i]);
+    topScanResults[i].rssi = -42 - 5 * i;
+    topScanResults[i].auth_mode = 7;
+  }
+  scanResultCount = MAX_SCAN_RESULTS;
+}
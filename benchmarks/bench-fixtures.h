@@ -0,0 +1,16 @@
+#ifndef BENCH_FIXTURES_H
+#define BENCH_FIXTURES_H
+
+// State shared by the host and on-target benchmark runs. Each platform's main
+// prepares its own hardware (or simulator) and then calls benchSetUpFirmware().
+
+// Puts the firmware in a representative running state: display initialised,
+// sensors reading normal booth values and a full list of scan results
+void benchSetUpFirmware();
+
+// Payloads as they arrive from, and go to, the compressor Pico
+extern const char *const benchStatusUpdateJson;
+extern const char *const benchPressureChangeJson;
+extern const char *const benchCommandJson;
+
+#endif // BENCH_FIXTURES_H
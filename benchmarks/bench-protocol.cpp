@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+
+#include <string.h>
+
+#include "bench-fixtures.h"
+#include "control.h"
+
+// range(0) picks the payload: 0 a full STATUS_UPDATE, 1 a PRESSURE_CHANGE, 2 a command
+static const char *payload(int64_t index)
+{
+  switch (index)
+  {
+  case 0:
+    return benchStatusUpdateJson;
+  case 1:
+    return benchPressureChangeJson;
+  default:
+    return benchCommandJson;
+  }
+}
+
+static void BM_BufferToMessage(benchmark::State &state)
+{
+  const char *json = payload(state.range(0));
+  Message msg;
+  for (auto _ : state)
+  {
+    bool ok = bufferToMessage(json, msg);
+    benchmark::DoNotOptimize(ok);
+    benchmark::DoNotOptimize(msg);
+  }
+  state.SetBytesProcessed(state.iterations() * (int64_t)strlen(json));
+}
+BENCHMARK(BM_BufferToMessage)->Arg(0)->Arg(1)->Arg(2);
+
+// range(0): 0 a STATUS_UPDATE, 1 a SET_COMPRESSION_TIMEOUT command
+static void BM_MessageToJson(benchmark::State &state)
+{
+  Message msg;
+  memset(&msg, 0, sizeof(msg));
+  if (state.range(0) == 0)
+  {
+    bufferToMessage(benchStatusUpdateJson, msg);
+  }
+  else
+  {
+    msg.messageType = COMMAND;
+    msg.command.commandType = SET_COMPRESSION_TIMEOUT;
+    msg.command.timeout = 30;
+  }
+  char json[512];
+  int64_t bytes = 0;
+  for (auto _ : state)
+  {
+    size_t length = messageToJson(msg, json, sizeof(json));
+    bytes += (int64_t)length;
+    benchmark::DoNotOptimize(json);
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_MessageToJson)->Arg(0)->Arg(1);
@@ -0,0 +1,19 @@
+#include <benchmark/benchmark.h>
+
+#include <string.h>
+
+#include "httpserver.h"
+
+// The /scan response for a full result list, see benchSetUpFirmware()
+static void BM_GenerateScanResultsJson(benchmark::State &state)
+{
+  int64_t bytes = 0;
+  for (auto _ : state)
+  {
+    const char *json = generateScanResultsJson();
+    bytes += (int64_t)strlen(json);
+    benchmark::DoNotOptimize(json);
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_GenerateScanResultsJson);
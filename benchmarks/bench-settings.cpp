@@ -0,0 +1,46 @@
+#include <benchmark/benchmark.h>
+
+#include <string.h>
+
+#include "settings.h"
+
+// Settings round trips through flash. They run against the sector after the
+// settings, which nothing else uses, so the board keeps its stored settings.
+#define BENCH_SETTINGS_OFFSET (FLASH_TARGET_OFFSET + FLASH_SECTOR_SIZE)
+
+static Settings benchSettings()
+{
+  Settings settings;
+  memcpy(&settings, (const void *)&currentSettings, sizeof(settings));
+  strncpy(settings.ssid, "bench-sim", sizeof(settings.ssid));
+  strncpy(settings.password, "correct horse battery", sizeof(settings.password));
+  settings.authMode = 7;
+  settings.magic = SETTINGS_MAGIC;
+  return settings;
+}
+
+static void BM_SaveSettingsToFlash(benchmark::State &state)
+{
+  const Settings settings = benchSettings();
+  for (auto _ : state)
+  {
+    saveSettingsToSector(BENCH_SETTINGS_OFFSET, &settings);
+  }
+  state.SetBytesProcessed(state.iterations() * (int64_t)sizeof(Settings));
+}
+BENCHMARK(BM_SaveSettingsToFlash);
+
+static void BM_LoadSettingsFromFlash(benchmark::State &state)
+{
+  const Settings stored = benchSettings();
+  saveSettingsToSector(BENCH_SETTINGS_OFFSET, &stored);
+  Settings settings;
+  for (auto _ : state)
+  {
+    bool ok = loadSettingsFromSector(BENCH_SETTINGS_OFFSET, &settings);
+    benchmark::DoNotOptimize(ok);
+    benchmark::DoNotOptimize(settings);
+  }
+  state.SetBytesProcessed(state.iterations() * (int64_t)sizeof(Settings));
+}
+BENCHMARK(BM_LoadSettingsFromFlash);
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+
+#include <string.h>
+
+#include "bench-fixtures.h"
+#include "control.h"
+#include "transport.h"
+
+#include "lwip/pbuf.h"
+
+// Stand-in for a loopback connection: a burst of compressor messages laid out as
+// lwIP delivers a stream, in TCP_MSS segments with lines crossing their edges
+#define STREAM_MESSAGES 32
+#define STREAM_MAX (STREAM_MESSAGES * 320)
+
+static char stream[STREAM_MAX];
+static size_t streamLength = 0;
+static size_t newlines[STREAM_MESSAGES];
+static struct pbuf segments[STREAM_MAX / TCP_MSS + 1];
+
+static LineAssembler assembler;
+static char readBuffer[SOCKET_LINE_MAX];
+static int parsed = 0;
+
+static void parseLine(char *line, size_t length)
+{
+  Message msg;
+  if (bufferToMessage(line, msg))
+  {
+    parsed++;
+  }
+  benchmark::DoNotOptimize(msg);
+}
+
+static void buildStream()
+{
+  if (streamLength > 0)
+  {
+    return;
+  }
+  for (int i = 0; i < STREAM_MESSAGES; i++)
+  {
+    const char *json = i % 2 == 0 ? benchStatusUpdateJson : benchPressureChangeJson;
+    size_t length = strlen(json);
+    memcpy(stream + streamLength, json, length);
+    streamLength += length;
+    newlines[i] = streamLength;
+    stream[streamLength++] = '\n';
+  }
+
+  memset(segments, 0, sizeof(segments));
+  size_t offset = 0;
+  for (int i = 0; offset < streamLength; i++)
+  {
+    size_t length = streamLength - offset < TCP_MSS ? streamLength - offset : TCP_MSS;
+    segments[i].payload = stream + offset;
+    segments[i].len = (u16_t)length;
+    segments[i].tot_len = (u16_t)(streamLength - offset);
+    segments[i].ref = 1;
+    offset += length;
+    segments[i].next = offset < streamLength ? &segments[i + 1] : NULL;
+  }
+  assembler.onLine = parseLine;
+}
+
+// Lines parsed in place leave terminators where their newlines were
+static void restoreNewlines()
+{
+  for (int i = 0; i < STREAM_MESSAGES; i++)
+  {
+    stream[newlines[i]] = '\n';
+  }
+}
+
+// range(0): 0 the socket transport, copying each read out of the pbufs as
+// lwip_recv() does, 1 the raw transport, parsing lines where they lie
+static void BM_TransportReceive(benchmark::State &state)
+{
+  buildStream();
+  bool raw = state.range(0) == 1;
+  for (auto _ : state)
+  {
+    restoreNewlines();
+    lineAssemblerReset(&assembler);
+    if (raw)
+    {
+      rawTransportReceive(&assembler, segments);
+    }
+    else
+    {
+      for (size_t offset = 0; offset < streamLength;)
+      {
+        u16_t length = pbuf_copy_partial(segments, readBuffer, sizeof(readBuffer), (u16_t)offset);
+        lineAssemblerFeed(&assembler, readBuffer, length);
+        offset += length;
+      }
+    }
+  }
+  benchmark::DoNotOptimize(parsed);
+  state.SetItemsProcessed(state.iterations() * STREAM_MESSAGES);
+  state.SetBytesProcessed(state.iterations() * (int64_t)streamLength);
+}
+BENCHMARK(BM_TransportReceive)->Arg(0)->Arg(1);
@@ -0,0 +1,21 @@
+#include <benchmark/benchmark.h>
+
+#include "bench-fixtures.h"
+#include "sim.h"
+
+// Host runner: the firmware on the simulator's devices, without starting the
+// scheduler. Settings benchmarks write to an in-memory flash image.
+int main(int argc, char **argv)
+{
+  simFlashLoad(NULL);
+  benchSetUpFirmware();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+  {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
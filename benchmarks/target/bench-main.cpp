@@ -0,0 +1,23 @@
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+
+#include "benchmark/benchmark.h"
+#include "bench-fixtures.h"
+
+// On-target runner: the firmware's modules on the real display and flash, timed
+// before the FreeRTOS scheduler starts so SysTick is free for cycle counting
+int main()
+{
+  stdio_init_all();
+  sleep_ms(2000); // Time to attach a terminal
+  printf("Bench controller benchmarks\n");
+
+  benchSetUpFirmware();
+  benchmark::RunSpecifiedBenchmarks();
+
+  while (true)
+  {
+    sleep_ms(1000);
+  }
+}
@@ -0,0 +1,245 @@
+#include "benchmark/benchmark.h"
+
+#include <stdio.h>
+
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "pico/time.h"
+
+#define BENCHMARK_MAX_REGISTERED 32
+#define BENCHMARK_MIN_TIME_US 500000 // Per benchmark and argument, like --benchmark_min_time=0.5s
+#define BENCHMARK_MAX_ITERATIONS 1000000
+#define BENCHMARK_MAX_RESULTS 64
+#define SYSTICK_MASK 0x00FFFFFF
+
+#define SYSTICK_CSR_ENABLE 0x1
+#define SYSTICK_CSR_CLKSOURCE_CPU 0x4
+
+namespace benchmark
+{
+
+  static Benchmark registered[BENCHMARK_MAX_REGISTERED];
+  static int registeredCount = 0;
+
+  Benchmark *Benchmark::Arg(int64_t value)
+  {
+    if (argCount < BENCHMARK_MAX_ARGS)
+    {
+      args[argCount++] = value;
+    }
+    return this;
+  }
+
+  Benchmark *RegisterBenchmark(const char *name, Function function)
+  {
+    if (registeredCount >= BENCHMARK_MAX_REGISTERED)
+    {
+      printf("Benchmark: too many benchmarks, %s not registered\n", name);
+      return nullptr;
+    }
+    Benchmark *benchmark = &registered[registeredCount++];
+    benchmark->name = name;
+    benchmark->function = function;
+    return benchmark;
+  }
+
+  State::State(const int64_t *args, int argCount, int64_t maxIterations)
+      : args(args), argCount(argCount), maxIterations(maxIterations)
+  {
+  }
+
+  State::StateIterator State::begin()
+  {
+    return StateIterator(this);
+  }
+
+  // SysTick counts down from its reload value
+  void State::sample()
+  {
+    uint32_t now = systick_hw->cvr;
+    uint64_t nowUs = time_us_64();
+    cycles += (lastSysTick - now) & SYSTICK_MASK;
+    elapsedUs += nowUs - lastUs;
+    lastSysTick = now;
+    lastUs = nowUs;
+  }
+
+  void State::PauseTiming()
+  {
+    if (timing)
+    {
+      sample();
+      timing = false;
+    }
+  }
+
+  void State::ResumeTiming()
+  {
+    if (!timing)
+    {
+      lastSysTick = systick_hw->cvr;
+      lastUs = time_us_64();
+      timing = true;
+    }
+  }
+
+  bool State::keepRunning()
+  {
+    if (errorMessage != nullptr)
+    {
+      PauseTiming();
+      return false;
+    }
+    if (!started)
+    {
+      started = true;
+      ResumeTiming();
+    }
+    else
+    {
+      if (timing)
+      {
+        sample();
+      }
+      completedIterations++;
+    }
+    if (completedIterations < maxIterations)
+    {
+      return true;
+    }
+    PauseTiming();
+    return false;
+  }
+
+  typedef struct
+  {
+    const Benchmark *benchmark;
+    const int64_t *arg;
+    int64_t iterations;
+    uint64_t elapsedUs;
+    uint64_t cycles;
+    int64_t itemsProcessed;
+    int64_t bytesProcessed;
+    const char *errorMessage;
+  } Result;
+
+  static Result results[BENCHMARK_MAX_RESULTS];
+
+  static void runOnce(const Benchmark &benchmark, const int64_t *arg, int64_t iterations, State &state)
+  {
+    state = State(arg, arg ? 1 : 0, iterations);
+    benchmark.function(state);
+  }
+
+  // Same doubling as Google Benchmark: grow the iteration count until a run
+  // lasts at least BENCHMARK_MIN_TIME_US, then keep that run
+  static void runBenchmark(const Benchmark &benchmark, const int64_t *arg, Result *result)
+  {
+    State state(arg, arg ? 1 : 0, 1);
+    int64_t iterations = 1;
+    runOnce(benchmark, arg, iterations, state);
+    while (state.errorMessage == nullptr && state.elapsedUs < BENCHMARK_MIN_TIME_US && iterations < BENCHMARK_MAX_ITERATIONS)
+    {
+      int64_t next = state.elapsedUs > 0 ? iterations * BENCHMARK_MIN_TIME_US * 14 / ((int64_t)state.elapsedUs * 10) : iterations * 10;
+      if (next <= iterations)
+      {
+        next = iterations * 2;
+      }
+      if (next > iterations * 10)
+      {
+        next = iterations * 10;
+      }
+      iterations = next < BENCHMARK_MAX_ITERATIONS ? next : BENCHMARK_MAX_ITERATIONS;
+      runOnce(benchmark, arg, iterations, state);
+    }
+
+    result->benchmark = &benchmark;
+    result->arg = arg;
+    result->iterations = iterations;
+    result->elapsedUs = state.elapsedUs;
+    result->cycles = state.cycles;
+    result->itemsProcessed = state.itemsProcessed;
+    result->bytesProcessed = state.bytesProcessed;
+    result->errorMessage = state.errorMessage;
+  }
+
+  static void printResult(const Result &result, bool first)
+  {
+    double timeNs = (double)result.elapsedUs * 1000.0 / (double)result.iterations;
+    double seconds = (double)result.elapsedUs / 1e6;
+    char name[64];
+    if (result.arg)
+    {
+      snprintf(name, sizeof(name), "%s/%lld", result.benchmark->name, (long long)*result.arg);
+    }
+    else
+    {
+      snprintf(name, sizeof(name), "%s", result.benchmark->name);
+    }
+
+    printf("%s    {\n", first ? "" : ",\n");
+    printf("      \"name\": \"%s\",\n", name);
+    printf("      \"run_name\": \"%s\",\n", name);
+    printf("      \"run_type\": \"iteration\",\n");
+    if (result.errorMessage != nullptr)
+    {
+      // As Google Benchmark reports a SkipWithError() run
+      printf("      \"error_occurred\": true,\n");
+      printf("      \"error_message\": \"%s\",\n", result.errorMessage);
+    }
+    printf("      \"iterations\": %lld,\n", (long long)result.iterations);
+    printf("      \"real_time\": %.3f,\n", timeNs);
+    printf("      \"cpu_time\": %.3f,\n", timeNs);
+    printf("      \"time_unit\": \"ns\",\n");
+    if (result.bytesProcessed > 0 && seconds > 0.0)
+    {
+      printf("      \"bytes_per_second\": %.3f,\n", (double)result.bytesProcessed / seconds);
+    }
+    if (result.itemsProcessed > 0 && seconds > 0.0)
+    {
+      printf("      \"items_per_second\": %.3f,\n", (double)result.itemsProcessed / seconds);
+    }
+    printf("      \"cycles_per_iteration\": %.1f\n", (double)result.cycles / (double)result.iterations);
+    printf("    }");
+  }
+
+  void RunSpecifiedBenchmarks()
+  {
+    // Free running at the processor clock, no interrupt. FreeRTOS takes SysTick
+    // back when the scheduler starts, so this has to run before that.
+    systick_hw->csr = 0;
+    systick_hw->rvr = SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = SYSTICK_CSR_ENABLE | SYSTICK_CSR_CLKSOURCE_CPU;
+
+    int resultCount = 0;
+    for (int i = 0; i < registeredCount; i++)
+    {
+      const Benchmark &benchmark = registered[i];
+      int runs = benchmark.argCount > 0 ? benchmark.argCount : 1;
+      for (int a = 0; a < runs && resultCount < BENCHMARK_MAX_RESULTS; a++)
+      {
+        printf("Benchmark: running %s\n", benchmark.name);
+        runBenchmark(benchmark, benchmark.argCount > 0 ? &benchmark.args[a] : nullptr, &results[resultCount++]);
+      }
+    }
+
+    // Results go out in one block at the end, so firmware logging during the
+    // runs does not break up the JSON
+    printf("BENCH-JSON-BEGIN\n");
+    printf("{\n  \"context\": {\n");
+    printf("    \"executable\": \"bench-controller-benchmarks\",\n");
+    printf("    \"num_cpus\": 1,\n");
+    printf("    \"mhz_per_cpu\": %lu,\n", (unsigned long)(clock_get_hz(clk_sys) / 1000000));
+    printf("    \"cpu_scaling_enabled\": false,\n");
+    printf("    \"library_build_type\": \"release\"\n");
+    printf("  },\n  \"benchmarks\": [\n");
+    for (int i = 0; i < resultCount; i++)
+    {
+      printResult(results[i], i == 0);
+    }
+    printf("\n  ]\n}\n");
+    printf("BENCH-JSON-END\n");
+  }
+
+} // namespace benchmark
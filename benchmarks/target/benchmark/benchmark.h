@@ -0,0 +1,118 @@
+#ifndef BENCHMARK_BENCHMARK_H
+#define BENCHMARK_BENCHMARK_H
+
+// The subset of Google Benchmark's API the suite in benchmarks/ uses, for the
+// on-target image. Time is counted in processor cycles with SysTick, since the
+// Cortex-M0+ has no DWT cycle counter, and in microseconds with the timer.
+//
+// SysTick is 24 bits wide and wraps every 134 ms at 125 MHz, so it is sampled at
+// every iteration boundary. A single iteration, or stretch between PauseTiming()
+// and ResumeTiming(), longer than that is miscounted in cycles but not in time.
+
+#include <stdint.h>
+
+namespace benchmark
+{
+
+  class State
+  {
+  public:
+    State(const int64_t *args, int argCount, int64_t maxIterations);
+
+    class StateIterator
+    {
+    public:
+      explicit StateIterator(State *parent) : parent(parent) {}
+      int operator*() const { return 0; }
+      StateIterator &operator++() { return *this; }
+      bool operator!=(const StateIterator &) const { return parent->keepRunning(); }
+
+    private:
+      State *parent;
+    };
+
+    StateIterator begin();
+    StateIterator end() { return StateIterator(nullptr); }
+
+    void PauseTiming();
+    void ResumeTiming();
+
+    int64_t range(int index = 0) const { return index < argCount ? args[index] : 0; }
+    int64_t iterations() const { return completedIterations; }
+
+    // Call before the loop: the benchmark runs no iterations and is reported as failed
+    void SkipWithError(const char *message) { errorMessage = message; }
+
+    void SetItemsProcessed(int64_t items) { itemsProcessed = items; }
+    void SetBytesProcessed(int64_t bytes) { bytesProcessed = bytes; }
+
+    // Results, read by the runner once the benchmark function returns
+    uint64_t cycles = 0;
+    uint64_t elapsedUs = 0;
+    int64_t itemsProcessed = 0;
+    int64_t bytesProcessed = 0;
+    const char *errorMessage = nullptr;
+
+  private:
+    bool keepRunning();
+    void sample();
+
+    const int64_t *args;
+    int argCount;
+    int64_t maxIterations;
+    int64_t completedIterations = 0;
+    bool started = false;
+    bool timing = false;
+    uint32_t lastSysTick = 0;
+    uint64_t lastUs = 0;
+  };
+
+  typedef void (*Function)(State &);
+
+#define BENCHMARK_MAX_ARGS 8
+
+  class Benchmark
+  {
+  public:
+    Benchmark *Arg(int64_t value);
+
+    const char *name = nullptr;
+    Function function = nullptr;
+    int64_t args[BENCHMARK_MAX_ARGS];
+    int argCount = 0;
+  };
+
+  // Registration from BENCHMARK(), returns nullptr once the fixed table is full
+  Benchmark *RegisterBenchmark(const char *name, Function function);
+
+  // Runs every registered benchmark and prints the results as Google Benchmark
+  // JSON between BENCH-JSON-BEGIN and BENCH-JSON-END lines on stdout
+  void RunSpecifiedBenchmarks();
+
+  template <class T>
+  inline void DoNotOptimize(T &value)
+  {
+    asm volatile("" : "+m"(value) : : "memory");
+  }
+
+  template <class T>
+  inline void DoNotOptimize(const T &value)
+  {
+    asm volatile("" : : "m"(value) : "memory");
+  }
+
+  inline void ClobberMemory()
+  {
+    asm volatile("" : : : "memory");
+  }
+
+} // namespace benchmark
+
+#define BENCHMARK_CONCAT_(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_(a, b)
+
+#define BENCHMARK(fn)                                                                        \
+  static ::benchmark::Benchmark *BENCHMARK_CONCAT(benchmarkRegistration_, __LINE__) \
+      __attribute__((unused)) = ::benchmark::RegisterBenchmark(#fn, fn)
+
+#endif // BENCHMARK_BENCHMARK_H
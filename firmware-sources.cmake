@@ -0,0 +1,67 @@
+# Firmware sources other than main.cpp, shared by the Pico build, the host
+# simulator (sim/) and the benchmark images (benchmarks/)
+set(FIRMWARE_SOURCES
+    ${CMAKE_CURRENT_LIST_DIR}/src/wifi.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/transport.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/socket-transport.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/raw-transport.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/settings.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/dhcpserver.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/httpserver.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/control.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/sensors.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/sensor-scheduler.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/compressor-status.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/display.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/display-panel.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/interaction.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/input.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/encoder.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/extractor.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/fan-controller.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/ramp.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/lights.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/thermal.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/isr-handlers.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/bme280.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/max44009.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/auto-brightness.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/sht30.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/diagnostics.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/static-memory.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/json-arena.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/boot-timeline.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/discovery.cpp
+)
+
+option(BENCH_CONTROLLER_DISPLAY_16BPP "Drive the display in 16-bit colour through strip canvases" OFF)
+option(BENCH_CONTROLLER_STATIC_MEMORY "Count heap allocations and report any made after boot" OFF)
+option(BENCH_CONTROLLER_RAW_TRANSPORT "Serve the compressor link with lwIP's raw TCP API instead of sockets" OFF)
+
+# Published in the mDNS TXT record so peers can tell firmware builds apart.
+# Regenerated on every build so it follows HEAD without reconfiguring; targets
+# built from FIRMWARE_SOURCES depend on firmware-version and add
+# FIRMWARE_GENERATED_DIR to their include directories.
+set(FIRMWARE_GENERATED_DIR ${CMAKE_BINARY_DIR}/generated)
+if (NOT TARGET firmware-version)
+    add_custom_target(firmware-version
+        COMMAND ${CMAKE_COMMAND}
+            -DSOURCE_DIR=${CMAKE_CURRENT_LIST_DIR}
+            -DOUTPUT=${FIRMWARE_GENERATED_DIR}/firmware-version.h
+            -P ${CMAKE_CURRENT_LIST_DIR}/firmware-version.cmake
+        BYPRODUCTS ${FIRMWARE_GENERATED_DIR}/firmware-version.h
+        COMMENT "Checking the firmware version"
+        VERBATIM)
+endif()
+
+# Compile definitions that go with FIRMWARE_SOURCES
+set(FIRMWARE_DEFINITIONS)
+if (BENCH_CONTROLLER_DISPLAY_16BPP)
+    list(APPEND FIRMWARE_DEFINITIONS DISPLAY_16BPP=1)
+endif()
+if (BENCH_CONTROLLER_STATIC_MEMORY)
+    list(APPEND FIRMWARE_DEFINITIONS STATIC_MEMORY=1)
+endif()
+if (BENCH_CONTROLLER_RAW_TRANSPORT)
+    list(APPEND FIRMWARE_DEFINITIONS RAW_TRANSPORT=1)
+endif()
@@ -0,0 +1,21 @@
+# Writes OUTPUT, a header defining FIRMWARE_VERSION from `git describe` in
+# SOURCE_DIR. Run as a script on every build by the firmware-version target in
+# firmware-sources.cmake; the header is only rewritten when the version changes,
+# so an unchanged HEAD recompiles nothing.
+execute_process(
+    COMMAND git describe --always --dirty
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE FIRMWARE_VERSION
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET)
+if (NOT FIRMWARE_VERSION)
+    set(FIRMWARE_VERSION unknown)
+endif()
+
+set(FIRMWARE_VERSION_HEADER "// Generated by firmware-version.cmake\n#define FIRMWARE_VERSION \"${FIRMWARE_VERSION}\"\n")
+if (EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS_HEADER)
+endif()
+if (NOT "${PREVIOUS_HEADER}" STREQUAL "${FIRMWARE_VERSION_HEADER}")
+    file(WRITE ${OUTPUT} "${FIRMWARE_VERSION_HEADER}")
+endif()
@@ -70,21 +70,61 @@
 #define configMESSAGE_BUFFER_LENGTH_TYPE size_t
 
 /* Memory allocation related definitions. */
-#define configSUPPORT_STATIC_ALLOCATION 0
+/* Application tasks, queues and timers are static; the heap is left to lwIP and
+the CYW43 driver, which create their own objects at boot. Those are the tcpip
+thread (TCPIP_THREAD_STACKSIZE, 4 KB), the CYW43 async context task (4 KB), and
+the mailboxes and semaphores of lwIP's sys_arch and each netconn, about 12 KB in
+all by count. The heap stays at its old size until that has been measured on a
+board: run it with a client connected and the HTTP server in use, read
+minEverFreeHeap from /diagnostics.json (or the boot report's heap left after
+init), and shrink it to what was used plus a margin. */
+#define configSUPPORT_STATIC_ALLOCATION 1
 #define configSUPPORT_DYNAMIC_ALLOCATION 1
 #define configTOTAL_HEAP_SIZE (128 * 1024)
 #define configAPPLICATION_ALLOCATED_HEAP 0
 
+/* Static memory builds count every heap allocation, so diagnostics can show that
+steady-state operation makes none. The kernel calls this with the scheduler
+suspended. */
+#if defined(STATIC_MEMORY) && STATIC_MEMORY && !defined(__ASSEMBLER__)
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern volatile uint32_t heapAllocationCount;
+extern volatile uint32_t heapAllocationLastSize;
+#ifdef __cplusplus
+}
+#endif
+#define traceMALLOC(pvAddress, uiSize)      \
+    do                                      \
+    {                                       \
+        if ((pvAddress) != NULL)            \
+        {                                   \
+            heapAllocationCount++;          \
+            heapAllocationLastSize = (uiSize); \
+        }                                   \
+    } while (0)
+#endif
+
 /* Hook function related definitions. */
 #define configCHECK_FOR_STACK_OVERFLOW 2
 #define configUSE_MALLOC_FAILED_HOOK 1
 #define configUSE_DAEMON_TASK_STARTUP_HOOK 0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS 0
+#define configGENERATE_RUN_TIME_STATS 1
 #define configUSE_TRACE_FACILITY 1
 #define configUSE_STATS_FORMATTING_FUNCTIONS 0
 
+/* The RP2040 system timer already ticks at 1 MHz, so it doubles as the run time
+counter. The 32-bit value wraps every ~71 minutes; the diagnostics task only
+ever looks at deltas between samples, which stay correct across the wrap. */
+#if !defined(__ASSEMBLER__)
+#include "hardware/timer.h"
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() time_us_32()
+
 /* Co-routine related definitions. */
 #define configUSE_CO_ROUTINES 0
 #define configMAX_CO_ROUTINE_PRIORITIES 1
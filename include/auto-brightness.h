@@ -0,0 +1,33 @@
+#ifndef AUTO_BRIGHTNESS_H
+#define AUTO_BRIGHTNESS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define AUTO_BRIGHTNESS_HYSTERESIS 0.1f       // No correction while within ±10% of the setpoint
+#define AUTO_BRIGHTNESS_MAX_STEP 5            // Largest brightness change per settled reading, in %
+#define AUTO_BRIGHTNESS_DEFAULT_GAIN 800.0f   // Lux the bars add at the sensor at 100% duty, until learned
+#define AUTO_BRIGHTNESS_MIN_GAIN 50.0f
+#define AUTO_BRIGHTNESS_MAX_GAIN 20000.0f
+#define AUTO_BRIGHTNESS_LEARN_RATE 0.25f
+#define AUTO_BRIGHTNESS_MIN_LEARN_DUTY 0.05f  // Duty change needed before a step is used to learn the gain
+
+typedef struct
+{
+  float selfGain;       // Learned lux per unit of duty the bars contribute to the reading
+  float lastLux;
+  float lastDuty;
+  bool haveLast;
+} AutoBrightness;
+
+void autoBrightnessInit(AutoBrightness *controller);
+
+// Feeds a reading taken with the bars settled at `brightness` % and returns the
+// brightness to ask for (unchanged inside the hysteresis band). Only call it with
+// settled readings, one step per reading is what limits the rate.
+int autoBrightnessUpdate(AutoBrightness *controller, float measuredLux, int brightness, float setpointLux);
+
+// Reading with the bars' own contribution removed
+float autoBrightnessAmbient(const AutoBrightness *controller, float measuredLux, int brightness);
+
+#endif // AUTO_BRIGHTNESS_H
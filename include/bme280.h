@@ -4,41 +4,85 @@
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 
+#define BME280_CHIP_ID 0x60
+
+// Oversampling as written to the control registers: pressure is what the booth
+// is watched for, temperature and humidity only feed its compensation
+#define BME280_OSRS_T 1 // x1
+#define BME280_OSRS_P 3 // x4
+#define BME280_OSRS_H 1 // x1
+#define BME280_FILTER 2 // IIR coefficient 4, smooths the extractor's buffeting on-chip
+
+// Trimming parameters, read from the sensor once at init
+typedef struct
+{
+  uint16_t digT1;
+  int16_t digT2;
+  int16_t digT3;
+  uint16_t digP1;
+  int16_t digP2;
+  int16_t digP3;
+  int16_t digP4;
+  int16_t digP5;
+  int16_t digP6;
+  int16_t digP7;
+  int16_t digP8;
+  int16_t digP9;
+  uint8_t digH1;
+  int16_t digH2;
+  uint8_t digH3;
+  int16_t digH4;
+  int16_t digH5;
+  int8_t digH6;
+} Bme280Calibration;
+
+// ADC values out of one burst read of 0xF7-0xFE
+typedef struct
+{
+  int32_t pressure;
+  int32_t temperature;
+  int32_t humidity;
+} Bme280Raw;
+
+// One compensated measurement in the sensor's own fixed-point units
+typedef struct
+{
+  int32_t temperature; // 0.01 °C
+  uint32_t pressure;   // Pa
+  uint32_t humidity;   // %RH in Q22.10
+} Bme280Reading;
+
+void bme280Unpack(const uint8_t data[8], Bme280Raw *raw);
+
+// The datasheet's 32-bit integer compensation, all the Cortex-M0+ does natively
+void bme280Compensate(const Bme280Calibration *calibration, const Bme280Raw *raw, Bme280Reading *reading);
+
+// The datasheet's floating point compensation in single precision. Not used by
+// the firmware, kept as the reference the integer path is benchmarked against.
+void bme280CompensateFloat(const Bme280Calibration *calibration, const Bme280Raw *raw,
+                           float *temperature, float *pressure, float *humidity);
+
 class BME280
 {
 public:
   BME280(i2c_inst_t *i2cPort, uint8_t addr = 0x76);
-  void init();
-  bool readAll(float *temperature, float *humidity, float *pressure);
+  // Checks the chip ID, loads the trimming parameters and sets up oversampling
+  // and the IIR filter. Returns false if no BME280 answers.
+  bool init();
+  // Starts one forced-mode measurement, after which the sensor sleeps again.
+  // Returns the milliseconds until its results can be read, or -1 on a bus error.
+  int startMeasurement();
+  // Reads the last measurement in one burst and compensates it
+  bool readMeasurement(Bme280Reading *reading);
 
 private:
   i2c_inst_t *i2cPort;
   uint8_t address;
-  struct CalibrationData
-  {
-    uint16_t digT1;
-    int16_t digT2;
-    int16_t digT3;
-    uint16_t digP1;
-    int16_t digP2;
-    int16_t digP3;
-    int16_t digP4;
-    int16_t digP5;
-    int16_t digP6;
-    int16_t digP7;
-    int16_t digP8;
-    int16_t digP9;
-    uint8_t digH1;
-    int16_t digH2;
-    uint8_t digH3;
-    int16_t digH4;
-    int16_t digH5;
-    int8_t digH6;
-  } calibData;
+  Bme280Calibration calibData;
 
   int readBytes(uint8_t regAddr, uint8_t *buffer, uint8_t len);
   int writeByte(uint8_t regAddr, uint8_t value);
-  void loadCalibrationData();
+  bool loadCalibrationData();
 };
 
 #endif
@@ -0,0 +1,22 @@
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BOOT_TIMELINE_MAX_ENTRIES 20
+#define BOOT_TIMELINE_JSON_MAX 1536
+
+// Times one boot step on the calling core, from any task on either core. Returns
+// a handle for bootStepEnd(), or -1 once the table is full.
+int bootStepBegin(const char *name);
+void bootStepEnd(int step);
+
+// Records the moment something became ready, such as the first frame. Only the
+// first call for a name is kept, so a reconnect does not move network-ready.
+void bootMilestone(const char *name);
+
+// Serialises the timeline as JSON into `buffer`. Returns the number of bytes written.
+size_t bootTimelineToJson(char *buffer, size_t length);
+
+#endif // BOOT_TIMELINE_H
@@ -3,6 +3,8 @@
 
 #include <stdbool.h>
 
+#include "snapshot.h"
+
 // Structure to hold all compressor status information
 typedef struct {
     float pressure;
@@ -18,8 +20,7 @@ typedef struct {
     int releaseTimeLeft;          // in minutes
 } CompressorStatus;
 
-// Declare a global volatile instance.
-// Volatile indicates that its value can be updated unexpectedly (by an ISR or another task).
-extern volatile CompressorStatus g_compressorStatus;
+// Published whole by controlTask, read as a consistent copy from any task
+extern Snapshot<CompressorStatus> g_compressorStatus;
 
 #endif // COMPRESSOR_STATUS_H
@@ -39,6 +39,9 @@ const int FORGET_WIFI_BUTTON_GPIO = 4;
 const uint8_t SENSORS_I2C_SDA_GPIO = 14; // SDA pin for I²C communication
 const uint8_t SENSORS_I2C_SCL_GPIO = 15; // SCL pin for I²C communication
 const uint32_t SENSORS_I2C_FREQ = 100000;
+// MAX44009 INT, open drain and active low. It needs its own wire from the sensor
+// to this pin; on a bench without one set it to -1 and the light sensor is polled.
+const int MAX44009_INT_GPIO = 2;
 
 const int LIGHTS_A_TEMP_GPIO = 3;
 const int LIGHTS_B_TEMP_GPIO = 5;
@@ -48,6 +51,16 @@ const int LIGHTS_A_PWM_GPIO = 4;
 const int LIGHTS_B_PWM_GPIO = 6;
 const int LIGHTS_C_PWM_GPIO = 8;
 
+// Per bar dimming calibration, measured on the bench: the PWM level where the bar
+// first visibly lights, and a Q16 gain trim (65536 = 1.0) that matches bars from
+// different LED bins at full output
+const uint16_t LIGHTS_A_OFFSET = 0;
+const uint16_t LIGHTS_B_OFFSET = 0;
+const uint16_t LIGHTS_C_OFFSET = 0;
+const uint32_t LIGHTS_A_TRIM = 65536;
+const uint32_t LIGHTS_B_TRIM = 65536;
+const uint32_t LIGHTS_C_TRIM = 65536;
+
 const uint8_t BME280_I2C_ADDR = 0x76;   // Default I2C address for BME280
 const uint8_t MAX44009_I2C_ADDR = 0x4A; // Default I2C address for MAX44009
 const uint8_t SHT30_I2C_ADDR = 0x44;
@@ -55,8 +68,8 @@ const uint8_t SHT30_I2C_ADDR = 0x44;
 const float TEMP_HIGH = 25.0f;
 const float TEMP_LOW = 17.0f;
 
-const float HUMIDITY_HIGH = 60.0f;
-const float HUMIDITY_LOW = 40.0f;
+constexpr float HUMIDITY_HIGH = 60.0f; // constexpr for the palette in display-palette.h
+constexpr float HUMIDITY_LOW = 40.0f;
 
 const float LUX_LOW = 600.0f;
 const float LUX_MEDIUM = 1000.0f;
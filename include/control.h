@@ -1,7 +1,7 @@
 #ifndef CONTROL_H
 #define CONTROL_H
 
-#include <string>
+#include <stddef.h>
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "timers.h"
@@ -96,8 +96,9 @@ void sendSetReleaseTimeoutCommand(int minutes);
 // (This replaces the hardware control task used on the compressor Pico.)
 void controlTask(void *params);
 
-// Functions for converting messages to/from JSON
+// Functions for converting messages to/from JSON. messageToJson() writes a
+// terminated string into `buffer` and returns its length, 0 if it did not fit.
 bool bufferToMessage(const char *buffer, Message &msg);
-std::string messageToString(const Message &msg);
+size_t messageToJson(const Message &msg, char *buffer, size_t length);
 
 #endif // CONTROL_H
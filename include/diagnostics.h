@@ -0,0 +1,46 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "input.h"
+
+#define DIAGNOSTICS_MAX_TASKS 20 // Application, kernel, lwIP and CYW43 tasks, with room to spare
+#define DIAGNOSTICS_SAMPLE_MS 5000
+// The console only hears about tasks and the heap once they run this low, and
+// again each time they drop further. Everything else is on /diagnostics.json.
+#define DIAGNOSTICS_LOW_STACK_WORDS 48
+#define DIAGNOSTICS_LOW_HEAP_BYTES 8192
+
+typedef struct
+{
+  char name[configMAX_TASK_NAME_LEN];
+  UBaseType_t priority;
+  uint16_t cpuPermille;         // Share of CPU time over the last sample window (0-1000)
+  uint32_t stackHighWaterMark;  // Minimum free stack ever seen, in words
+} TaskDiagnostics;
+
+typedef struct
+{
+  TaskDiagnostics tasks[DIAGNOSTICS_MAX_TASKS];
+  int taskCount;
+  size_t freeHeap;
+  size_t minEverFreeHeap;
+  uint32_t uptimeSeconds;
+  InputStats input; // Button gesture latency, edge to action
+  uint32_t heapAllocations; // Since boot, counted by static memory builds only
+  uint32_t sampleCount;
+} SystemDiagnostics;
+
+void initDiagnostics();
+void diagnosticsTask(void *params);
+
+// Copies the latest sample into `out`. Returns false until the first sample has been taken.
+bool getDiagnostics(SystemDiagnostics *out);
+
+// Serialises the latest sample as JSON into `buffer`. Returns the number of bytes written.
+size_t diagnosticsToJson(char *buffer, size_t length);
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,46 @@
+#ifndef DISCOVERY_H
+#define DISCOVERY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Version of the JSON line protocol served on SOCKET_SERVER_PORT, published as
+// "proto" in the service's TXT record
+#define DISCOVERY_PROTOCOL_VERSION 1
+
+#define DISCOVERY_PEER_SERVICE "_compressor" // What compressor units advertise
+#define DISCOVERY_MAX_PEERS 4
+#define DISCOVERY_HOST_MAX 64
+#define DISCOVERY_ANNOUNCE_MIN_MS 5000 // Closest two announcements of a TXT change can be
+#define DISCOVERY_BROWSE_MS 120000     // How often the browser asks for compressors again
+#define DISCOVERY_PEERS_JSON_MAX 1280
+
+// A compressor unit seen on the network
+typedef struct
+{
+  char instance[DISCOVERY_HOST_MAX]; // Service instance name, e.g. "Compressor"
+  char host[DISCOVERY_HOST_MAX];     // Target of its SRV record, e.g. "compressor.local"
+  uint32_t ipAddress;                // Network byte order, 0 until its address record is seen
+  uint16_t port;
+  uint8_t protocolVersion; // 0 if its TXT record has not been seen or has no "proto"
+  uint32_t seenMs;         // sys_now() of the last record, the entry lasts `ttlMs` from there
+  uint32_t ttlMs;
+} DiscoveredPeer;
+
+// Advertise the controller on the station or access point interface, and on
+// the station also browse for compressors. Called from the Wi-Fi task.
+void initMdnsSta();
+void deinitMdnsSta();
+void initMdnsAp();
+void deinitMdnsAp();
+
+// Re-announces the service so peers pick up a changed TXT record. Requests made
+// within DISCOVERY_ANNOUNCE_MIN_MS of the last announcement are folded into one
+// sent when the interval is up. Safe to call from any task.
+void discoveryRequestAnnounce();
+
+// Serialises the compressors seen and not yet expired as JSON into `buffer`.
+// Returns the number of bytes written. Called on lwIP's thread.
+size_t discoveredPeersToJson(char *buffer, size_t length);
+
+#endif // DISCOVERY_H
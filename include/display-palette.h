@@ -0,0 +1,96 @@
+#ifndef DISPLAY_PALETTE_H
+#define DISPLAY_PALETTE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "constants.h"
+#include "display.h"
+
+// Colour scales for readings, generated at compile time in the display's own
+// format. Looking a colour up is one table index.
+
+typedef struct
+{
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+} PaletteRgb;
+
+typedef struct
+{
+  int index; // Entries between stops are interpolated linearly
+  PaletteRgb rgb;
+} PaletteStop;
+
+template <size_t N>
+struct Palette
+{
+  DisplayColor colors[N];
+
+  constexpr DisplayColor operator[](size_t index) const
+  {
+    return colors[index];
+  }
+};
+
+template <size_t N, size_t S>
+constexpr Palette<N> makePalette(const PaletteStop (&stops)[S])
+{
+  Palette<N> palette = {};
+  for (size_t i = 0; i < N; i++)
+  {
+    size_t s = 0;
+    while (s + 2 < S && (int)i > stops[s + 1].index)
+    {
+      s++;
+    }
+    const PaletteStop &from = stops[s];
+    const PaletteStop &to = stops[s + 1];
+    int span = to.index - from.index;
+    int t = (int)i < from.index ? 0 : ((int)i > to.index ? span : (int)i - from.index);
+    int r = span > 0 ? from.rgb.r + (to.rgb.r - from.rgb.r) * t / span : from.rgb.r;
+    int g = span > 0 ? from.rgb.g + (to.rgb.g - from.rgb.g) * t / span : from.rgb.g;
+    int b = span > 0 ? from.rgb.b + (to.rgb.b - from.rgb.b) * t / span : from.rgb.b;
+    palette.colors[i] = (DisplayColor)DISPLAY_COLOR(r, g, b);
+  }
+  return palette;
+}
+
+// Temperature against a reference, -5.0 to +5.0 degrees in tenths: blue when
+// cold, green on target, red when hot
+#define TEMPERATURE_PALETTE_RANGE 5.0f
+#define TEMPERATURE_PALETTE_SIZE 101
+constexpr PaletteStop temperatureStops[] = {
+    {0, {0, 0, 255}},
+    {TEMPERATURE_PALETTE_SIZE / 2, {0, 255, 0}},
+    {TEMPERATURE_PALETTE_SIZE - 1, {255, 0, 0}},
+};
+constexpr Palette<TEMPERATURE_PALETTE_SIZE> temperaturePalette = makePalette<TEMPERATURE_PALETTE_SIZE>(temperatureStops);
+
+// Relative humidity, 0 to 100%: yellow when dry, green inside the comfort band,
+// red when damp. The edges fade over 10% either side of the band.
+#define HUMIDITY_PALETTE_SIZE 101
+constexpr PaletteStop humidityStops[] = {
+    {(int)HUMIDITY_LOW - 10, {255, 255, 0}},
+    {(int)HUMIDITY_LOW, {0, 255, 0}},
+    {(int)HUMIDITY_HIGH, {0, 255, 0}},
+    {(int)HUMIDITY_HIGH + 10, {255, 0, 0}},
+};
+constexpr Palette<HUMIDITY_PALETTE_SIZE> humidityPalette = makePalette<HUMIDITY_PALETTE_SIZE>(humidityStops);
+
+// `difference` is the reading minus its reference
+static inline DisplayColor temperatureColor(float difference)
+{
+  int index = (int)((difference + TEMPERATURE_PALETTE_RANGE) * 10.0f + 0.5f);
+  index = index < 0 ? 0 : (index >= TEMPERATURE_PALETTE_SIZE ? TEMPERATURE_PALETTE_SIZE - 1 : index);
+  return temperaturePalette[index];
+}
+
+static inline DisplayColor humidityColor(float humidity)
+{
+  int index = (int)(humidity + 0.5f);
+  index = index < 0 ? 0 : (index >= HUMIDITY_PALETTE_SIZE ? HUMIDITY_PALETTE_SIZE - 1 : index);
+  return humidityPalette[index];
+}
+
+#endif // DISPLAY_PALETTE_H
@@ -0,0 +1,32 @@
+#ifndef DISPLAY_PANEL_H
+#define DISPLAY_PANEL_H
+
+#include <stdint.h>
+#include <lcdgfx.h>
+
+#define PANEL_WIDTH 96
+#define PANEL_HEIGHT 64
+#define PANEL_SHADOW_BYTES (PANEL_WIDTH * PANEL_HEIGHT) // Static copy of the panel's GDRAM, one byte a pixel
+
+typedef InterfaceSSD1331<PicoSpi> PanelInterface;
+
+// The SSD1331 as the display task draws on it. Solid rectangles, outlines,
+// clears and moves go to the controller's accelerated commands. Everything else
+// arrives as a canvas, and only the pixels that differ from what the panel
+// already shows are sent.
+void initDisplayPanel(PanelInterface *panel);
+
+// Something drew on the panel without going through these functions, so the
+// next panelDrawCanvas() sends every pixel
+void panelInvalidate();
+
+// Coordinates are inclusive and clipped to the panel, colours are RGB_COLOR8
+void panelFillRect(int x1, int y1, int x2, int y2, uint8_t color);
+void panelDrawRect(int x1, int y1, int x2, int y2, uint8_t color);
+void panelClear(int x1, int y1, int x2, int y2);
+void panelCopy(int x1, int y1, int x2, int y2, int newX, int newY);
+
+// Brings the panel up to date with a canvas the size of the screen
+void panelDrawCanvas(NanoCanvas8 &canvas);
+
+#endif // DISPLAY_PANEL_H
@@ -8,26 +8,40 @@
 #include "queue.h"
 #include "semphr.h"
 
-#define RED RGB_COLOR8(255, 0, 0)       // Max red, no green, no blue
-#define GREEN RGB_COLOR8(0, 255, 0)     // No red, max green, no blue
-#define BLUE RGB_COLOR8(0, 0, 255)      // No red, no green, max blue
-#define ORANGE RGB_COLOR8(255, 255, 0)  // Max red, some green, no blue
-#define PURPLE RGB_COLOR8(255, 0, 255)  // Max red, no green, no blue
-#define WHITE RGB_COLOR8(255, 255, 255) // Max red, max green, max blue
-#define GREY RGB_COLOR8(100, 100, 100)  // Max red, max green, max blue
-#define BLACK RGB_COLOR8(0, 0, 0)       // No red, no green, no blue
+// DISPLAY_16BPP (the BENCH_CONTROLLER_DISPLAY_16BPP build option) drives the
+// panel in RGB565 through strip canvases, otherwise it is RGB332
+#ifdef DISPLAY_16BPP
+#define DISPLAY_COLOR RGB_COLOR16
+typedef uint16_t DisplayColor;
+#else
+#define DISPLAY_COLOR RGB_COLOR8
+typedef uint8_t DisplayColor;
+#endif
+
+#define RED DISPLAY_COLOR(255, 0, 0)       // Max red, no green, no blue
+#define GREEN DISPLAY_COLOR(0, 255, 0)     // No red, max green, no blue
+#define BLUE DISPLAY_COLOR(0, 0, 255)      // No red, no green, max blue
+#define ORANGE DISPLAY_COLOR(255, 255, 0)  // Max red, some green, no blue
+#define PURPLE DISPLAY_COLOR(255, 0, 255)  // Max red, no green, no blue
+#define WHITE DISPLAY_COLOR(255, 255, 255) // Max red, max green, max blue
+#define GREY DISPLAY_COLOR(100, 100, 100)  // Max red, max green, max blue
+#define BLACK DISPLAY_COLOR(0, 0, 0)       // No red, no green, no blue
 
 void initDisplay();
-void displayUp();
-void displayDown();
+// Resets and configures the panel. Called by displayTask before its first frame.
+void startDisplay();
+void displayUp(int detents, int steps);
+void displayDown(int detents, int steps);
 void displayEnter();
 void displayBack();
+void displayHome();
 void displayCompressorSettingsMenu();
 void displayExtractorSettingsMenu();
 void displayLightsSettingsMenu();
 void alertCompressor(int flashes);
 void alertExtractor(int flashes);
 void alertLights(int flashes);
+void renderHome();
 
 void displayTask(void *params);
 
@@ -43,9 +57,11 @@ enum DisplayType
   SET_FAN_SPEED_DISPLAY,
   SET_MAX_LIGHTS,
   SET_LIGHT_COOLING,
+  SET_AUTO_BRIGHTNESS,
   COMPRESSOR_STATS,
   EXTRACTOR_STATS,
   LIGHTS_STATS,
+  DIAGNOSTICS_DISPLAY,
 };
 
 #endif // DISPLAY_H
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include "pico/stdlib.h"
+
+#define ENCODER_COUNTS_PER_DETENT 4 // One full quadrature cycle per click
+
+// Starts the PIO quadrature decoder on ENCODER_CLK_GPIO and ENCODER_DC_GPIO
+void initEncoder();
+// Steps counted since boot, positive clockwise. Wraps at 32 bits, so compare
+// readings by their difference.
+int32_t readEncoderCount();
+
+#endif // ENCODER_H
@@ -0,0 +1,65 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// ------- //
+// encoder //
+// ------- //
+
+#define encoder_wrap_target 15
+#define encoder_wrap 23
+#define encoder_pio_version 0
+
+static const uint16_t encoder_program_instructions[] = {
+    0x000f, //  0: jmp    15
+    0x000e, //  1: jmp    14
+    0x0015, //  2: jmp    21
+    0x000f, //  3: jmp    15
+    0x0015, //  4: jmp    21
+    0x000f, //  5: jmp    15
+    0x000f, //  6: jmp    15
+    0x000e, //  7: jmp    14
+    0x000e, //  8: jmp    14
+    0x000f, //  9: jmp    15
+    0x000f, // 10: jmp    15
+    0x0015, // 11: jmp    21
+    0x000f, // 12: jmp    15
+    0x0015, // 13: jmp    21
+    0x008f, // 14: jmp    y--, 15
+            //     .wrap_target
+    0xa0c2, // 15: mov    isr, y
+    0x8000, // 16: push   noblock
+    0x60c2, // 17: out    isr, 2
+    0x4002, // 18: in     pins, 2
+    0xa0e6, // 19: mov    osr, isr
+    0xa0a6, // 20: mov    pc, isr
+    0xa04a, // 21: mov    y, ~y
+    0x0097, // 22: jmp    y--, 23
+    0xa04a, // 23: mov    y, ~y
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program encoder_program = {
+    .instructions = encoder_program_instructions,
+    .length = 24,
+    .origin = 0,
+    .pio_version = encoder_pio_version,
+#if PICO_PIO_VERSION > 0
+    .used_gpio_ranges = 0x0
+#endif
+};
+
+static inline pio_sm_config encoder_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + encoder_wrap_target, offset + encoder_wrap);
+    return c;
+}
+#endif
+
@@ -13,13 +13,23 @@ void extractorTask(void *params);
 void startExtractor(void);
 void stopExtractor(void);
 void updateExtractorSpeed(void);
-void tachometerISR(uint gpio, uint32_t events);
+
+// Minimum speed (percent) requested by the light bars' thermal management, 0 to release
+void setExtractorCoolingDemand(int percent);
+
+// Sweeps the fan again to relearn its duty -> RPM table, e.g. after the fan or
+// its filter was changed. The sweep runs on the extractor task and takes ~40 s.
+void requestExtractorCalibration();
+
+// True while the fan is still spinning up or down towards its target
+bool extractorRamping();
 
 // External variable to hold the current fan speed
 extern volatile int currentFanSpeed;
 extern volatile int targetFanSpeed;
-extern volatile uint64_t extractorRPM;
-extern volatile uint64_t pulseCount;
+extern volatile uint32_t extractorCentiRPM; // Measured speed in hundredths of an RPM, updated at 10 Hz
 extern volatile bool extractorOn;
+extern volatile bool extractorStalled;
+extern volatile int extractorCoolingDemand;
 
 #endif // EXTRACTOR_H
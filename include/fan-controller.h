@@ -0,0 +1,57 @@
+#ifndef FAN_CONTROLLER_H
+#define FAN_CONTROLLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Duty points sampled by the start-up calibration sweep (0%, 10%, ... 100%)
+#define FAN_CALIBRATION_POINTS 11
+
+// Below this many RPM at full duty we assume there is no tachometer and stay open-loop
+#define FAN_MIN_CALIBRATED_RPM 300
+
+// Consecutive zero-RPM samples with the fan driven above FAN_STALL_MIN_DUTY before it is flagged stalled
+#define FAN_STALL_SAMPLES 10
+#define FAN_STALL_MIN_DUTY 20 // percent
+
+// Gains are Q16 fixed point, in PWM levels per RPM of error (and per second for the integral term)
+#define FAN_KP_Q16 (int32_t)(0.4 * 65536)
+#define FAN_KI_Q16 (int32_t)(0.8 * 65536)
+
+typedef struct
+{
+  uint32_t maxLevel;                            // PWM wrap value, i.e. 100% duty
+  uint32_t rpmAtDuty[FAN_CALIBRATION_POINTS];   // Feed-forward table learned at start-up
+  bool calibrated;
+  int32_t kp;                                   // Q16
+  int32_t ki;                                   // Q16
+  int32_t proportional;                         // PWM levels
+  int64_t integral;                             // PWM levels, Q16
+  uint8_t stallSamples;
+  bool stalled;
+} FanController;
+
+void fanControllerInit(FanController *controller, uint32_t maxLevel);
+
+// Records the RPM measured at calibration point `index` (duty = index * 10%).
+// Call fanControllerFinishCalibration once every point has been recorded.
+void fanControllerSetCalibrationPoint(FanController *controller, int index, uint32_t rpm);
+bool fanControllerFinishCalibration(FanController *controller);
+
+// RPM at 100% duty according to the calibration table
+uint32_t fanControllerMaxRpm(const FanController *controller);
+
+// Duty (in PWM levels) the calibration table predicts for `targetRpm`
+uint32_t fanControllerFeedForward(const FanController *controller, uint32_t targetRpm);
+
+// Runs one PI step against a fresh tachometer reading and returns the new PWM level.
+// `elapsedMs` is the time since the previous measurement.
+uint32_t fanControllerUpdate(FanController *controller, uint32_t targetRpm, uint32_t measuredRpm, uint32_t elapsedMs);
+
+// Current output for `targetRpm` without a new measurement (feed-forward plus the held PI correction)
+uint32_t fanControllerOutput(const FanController *controller, uint32_t targetRpm);
+
+// Clears the integrator and stall state, e.g. when the fan is switched off
+void fanControllerReset(FanController *controller);
+
+#endif // FAN_CONTROLLER_H
@@ -0,0 +1,89 @@
+#ifndef GAMMA_H
+#define GAMMA_H
+
+#include <stdint.h>
+
+// Perceptual lightness (CIE 1931 L*) to PWM duty. Lightness is 0-65535 for 0-100% L*,
+// duty comes out with GAMMA_FRACTION_BITS below the 16-bit PWM LSB so the bottom
+// of the range can be dithered rather than rounded.
+#define GAMMA_TABLE_BITS 8                          // 256 segments, linearly interpolated
+#define GAMMA_TABLE_SIZE ((1 << GAMMA_TABLE_BITS) + 1)
+#define GAMMA_FRACTION_BITS 4
+#define GAMMA_LIGHTNESS_MAX 65535
+#define GAMMA_DUTY_MAX (65535u << GAMMA_FRACTION_BITS)
+
+struct GammaTable
+{
+  uint32_t duty[GAMMA_TABLE_SIZE];
+};
+
+// Relative luminance for L* in 0-100, the CIE 1931 lightness curve inverted
+constexpr double cieLuminance(double lightness)
+{
+  if (lightness <= 8.0)
+  {
+    return lightness / 903.3;
+  }
+  double t = (lightness + 16.0) / 116.0;
+  return t * t * t;
+}
+
+constexpr GammaTable makeGammaTable()
+{
+  GammaTable table{};
+  for (int i = 0; i < GAMMA_TABLE_SIZE; i++)
+  {
+    double luminance = cieLuminance((100.0 * i) / (GAMMA_TABLE_SIZE - 1));
+    table.duty[i] = (uint32_t)(luminance * GAMMA_DUTY_MAX + 0.5);
+  }
+  return table;
+}
+
+// Built by the compiler, the firmware only ever does integer lookups into it
+inline constexpr GammaTable gammaTable = makeGammaTable();
+
+static_assert(gammaTable.duty[0] == 0, "Zero lightness must be fully off");
+static_assert(gammaTable.duty[GAMMA_TABLE_SIZE - 1] == GAMMA_DUTY_MAX, "Full lightness must be fully on");
+
+// Lightness (0-GAMMA_LIGHTNESS_MAX) to duty in 1/(2^GAMMA_FRACTION_BITS) PWM levels
+inline uint32_t gammaLightnessToDuty(uint32_t lightness)
+{
+  if (lightness >= GAMMA_LIGHTNESS_MAX)
+  {
+    return GAMMA_DUTY_MAX;
+  }
+  uint32_t index = lightness >> (16 - GAMMA_TABLE_BITS);
+  uint32_t fraction = lightness & ((1 << (16 - GAMMA_TABLE_BITS)) - 1);
+  uint32_t low = gammaTable.duty[index];
+  uint32_t high = gammaTable.duty[index + 1];
+  return low + (((high - low) * fraction) >> (16 - GAMMA_TABLE_BITS));
+}
+
+// Inverse of gammaLightnessToDuty, to the nearest table segment
+inline uint32_t gammaDutyToLightness(uint32_t duty)
+{
+  if (duty >= GAMMA_DUTY_MAX)
+  {
+    return GAMMA_LIGHTNESS_MAX;
+  }
+  // The table is monotonic, find the segment that brackets `duty`
+  int low = 0;
+  int high = GAMMA_TABLE_SIZE - 1;
+  while (high - low > 1)
+  {
+    int middle = (low + high) / 2;
+    if (gammaTable.duty[middle] <= duty)
+    {
+      low = middle;
+    }
+    else
+    {
+      high = middle;
+    }
+  }
+  uint32_t span = gammaTable.duty[high] - gammaTable.duty[low];
+  uint32_t fraction = span > 0 ? ((duty - gammaTable.duty[low]) << (16 - GAMMA_TABLE_BITS)) / span : 0;
+  return ((uint32_t)low << (16 - GAMMA_TABLE_BITS)) + fraction;
+}
+
+#endif // GAMMA_H
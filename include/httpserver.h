@@ -3,11 +3,11 @@
 #define HTTPSERVER_H
 
 #include "lwip/tcp.h"
-#include <string>
-#include <vector>
 
 // Function prototypes
+void initHttpServer();
 void startHttpServer();
 void stopHttpServer();
+const char *generateScanResultsJson();
 
 #endif // HTTPSERVER_H
\ No newline at end of file
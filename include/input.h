@@ -0,0 +1,62 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Buttons, in the order of INPUT_BUTTON_GPIOS
+enum InputButton
+{
+  ENTER_BUTTON,
+  COMPRESSOR_BUTTON,
+  EXTRACTOR_BUTTON,
+  INPUT_BUTTON_COUNT,
+};
+
+enum InputGesture
+{
+  SHORT_PRESS,  // Released before the long press time. On a button with double
+                // presses enabled, sent once the double press window has passed.
+  LONG_PRESS,   // Held for the long press time, sent while still held
+  DOUBLE_PRESS, // Second short press soon after a first one, sent instead of both SHORT_PRESSes
+  INPUT_GESTURE_COUNT,
+};
+
+typedef struct
+{
+  InputButton button;
+  InputGesture gesture;
+  uint32_t timeUs; // time_us_32() when the gesture was complete: its release edge, or when the
+                   // hold time or double press window ran out
+} InputEvent;
+
+typedef struct
+{
+  uint32_t lastLatencyUs; // From the gesture being complete (InputEvent::timeUs) to inputEventHandled()
+  uint32_t maxLatencyUs;
+  uint32_t events;
+  uint32_t droppedEdges; // Edges lost to a full ring
+} InputStats;
+
+// Configures the button pins and starts recording their edges
+void initInput();
+// Task notified when edges arrive, NULL to only record them
+void setInputConsumer(TaskHandle_t task);
+// Lets `button` send DOUBLE_PRESS. Its short presses are then held back until
+// the double press window has passed, so a double press never also runs the
+// short press action. Other buttons send every short press as it is released.
+void enableDoublePress(InputButton button);
+void handleButtonISR(uint gpio, uint32_t events);
+
+// Runs the button state machines over the recorded edges up to now. Returns
+// true with the next gesture in `event`, false once there are none left.
+bool nextInputEvent(InputEvent *event);
+// Milliseconds until a held button next needs looking at, or `limit` if sooner
+uint32_t inputWaitMs(uint32_t limit);
+
+// Records the gesture's latency once its action has run
+void inputEventHandled(const InputEvent *event);
+void getInputStats(InputStats *out);
+
+#endif // INPUT_H
@@ -3,25 +3,16 @@
 
 #include "constants.h"
 #include "FreeRTOS.h"
-#include "queue.h"
-#include "timers.h"
-
-#define LONG_PRESS_THRESHOLD 500 // 1 second threshold (in milliseconds)
 
 void initInteraction();
 void interactionTask(void *pvParameters);
-void handleEncoderISR(uint gpio, uint32_t events);
-void handleButtonISR(uint gpio, uint32_t events);
-
-extern QueueHandle_t interactionQueue;
 
 enum Interaction
 {
   NONE,
   ENTER,
   BACK,
-  UP,
-  DOWN,
+  ENTER_DOUBLE_PRESS,
   COMPRESSOR,
   COMPRESSOR_LONG_PRESS,
   EXTRACTOR,
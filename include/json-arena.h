@@ -0,0 +1,25 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <stddef.h>
+
+#define JSON_ARENA_SIZE 2048 // A STATUS_UPDATE tree, the largest message, peaks under 1200 bytes
+
+// Points cJSON's allocator at a fixed arena instead of the heap. Call once before
+// any task parses or builds JSON.
+void initJsonArena();
+
+// Each parse or build happens between these two calls. Begin waits for any other
+// task using the arena, then empties it, so a tree must not outlive its End.
+// cJSON_Delete() releases nothing; the next Begin reclaims everything at once.
+void jsonArenaBegin();
+void jsonArenaEnd();
+
+// jsonArenaBegin() for lwIP's thread, which must never wait: returns false at
+// once if another task holds the arena, and the caller gives up on its message
+bool jsonArenaTryBegin();
+
+// Most of the arena any one message has used
+size_t jsonArenaHighWater();
+
+#endif // JSON_ARENA_H
@@ -4,9 +4,15 @@
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
 
-#define PWM_LED_FREQUENCY 1000 // 1 kHz for LED control
-#define TRANSITION_STEP 5      // Brightness transition step
-#define TRANSITION_DELAY 10    // Delay in ms between steps
+#define LIGHTS_PWM_WRAP 65535  // PWM counter top, i.e. 100% duty. Undivided that is ~1.9 kHz, well clear of visible flicker
+#define LIGHTS_RAMP_MS 1500    // Fade time for a full 0 -> 100% change
+#define LIGHTS_DITHER_LEVEL 256 // Below this PWM level the sub-LSB fraction is dithered at the wrap rate
+#define LIGHTS_CHANNELS 3      // Bars A, B and C, each with its own PWM and DS18B20
+#define LIGHTS_DERATE_MIN 30   // Lowest output the derate curve holds a hot bar at, in %
+
+// Used when the stored derate curve is unusable, e.g. after a settings reset
+#define LIGHTS_DEFAULT_DERATE_START 45
+#define LIGHTS_DEFAULT_DERATE_END 65
 
 typedef struct
 {
@@ -20,7 +26,18 @@ typedef struct
 void initLights();
 void lightsTask(void *pvParameters);
 
+// Clamps to 0-100% and starts a fade towards it
+void setLightTargetBrightness(int brightness);
+
+// True while any bar is still fading towards its target
+bool lightsRamping();
+
 extern volatile int lightBrightness;
 extern volatile int lightTargetBrightness;
 
+// Per bar thermal state, index 0-2 for A-C
+extern volatile int lightsChannelBrightness[LIGHTS_CHANNELS];
+extern volatile int lightsChannelLimit[LIGHTS_CHANNELS];       // Thermal duty limit in %
+extern volatile float lightsChannelPredicted[LIGHTS_CHANNELS]; // Model temperature THERMAL_HORIZON_S ahead
+
 #endif // LIGHTS_H
@@ -55,6 +55,8 @@
 // mDNS settings (optional)
 #define LWIP_MDNS_RESPONDER 1
 #define LWIP_NUM_NETIF_CLIENT_DATA 2
+#define LWIP_MDNS_SEARCH 1               // Browse for compressor units, see discovery.cpp
+#define LWIP_NETIF_EXT_STATUS_CALLBACK 1 // Lets the responder re-announce as soon as the address changes
 
 // System settings
 #define MEMP_NUM_SYS_TIMEOUT 30
@@ -10,12 +10,27 @@ public:
   MAX44009(i2c_inst_t *i2cPort, uint8_t addr = 0x4A);
   void init();
   void configureIntegrationTime(uint16_t time_ms);
+  // Automatic gain and integration time. Continuous measures back to back,
+  // otherwise the sensor samples every 800 ms.
+  void configureAutoRange(bool continuous = false);
   float readLux();
 
+  // Threshold window: the INT flag is raised once the reading has been outside
+  // it for longer than timerMs (100 ms steps). Each edge is placed as near ±window
+  // around `lux` as the register steps allow without going past it, unless that
+  // would leave `lux` itself outside. The steps are up to 1/8 of the value, so an
+  // edge can land further out; returns the furthest edge's distance from `lux` as
+  // a fraction of it.
+  float setThresholdWindow(float lux, float window, uint16_t timerMs);
+  void enableInterrupt(bool enable);
+  // Reads and clears the interrupt status
+  bool interruptPending();
+
 private:
   i2c_inst_t *i2cPort;
   uint8_t address;
 
+  uint8_t encodeThreshold(uint32_t targetCounts, uint32_t readingCounts, bool upper);
   int readBytes(uint8_t regAddr, uint8_t *buffer, uint8_t len);
   int writeByte(uint8_t regAddr, uint8_t value);
 };
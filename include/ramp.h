@@ -0,0 +1,53 @@
+#ifndef RAMP_H
+#define RAMP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RAMP_MAX_CHANNELS 8
+#define RAMP_TICK_MS 10 // Step interval while any ramp is in flight
+
+typedef enum
+{
+  RAMP_LINEAR,      // Constant slew
+  RAMP_EXPONENTIAL, // Geometric: equal ratios per step, perceptually even for light output
+  RAMP_S_CURVE,     // Smoothstep: eases in and out, gentle on fan motors
+} RampProfile;
+
+// Called from the timer service task with the new level on every step
+typedef void (*RampStepCallback)(uint32_t level, void *context);
+
+typedef struct
+{
+  // Configuration
+  uint32_t fullScale;   // Level for 100%, normally the PWM wrap value
+  uint32_t fullScaleMs; // Duration of a 0 -> fullScale move, shorter moves scale down
+  RampProfile profile;
+  RampStepCallback onStep;
+  void *context;
+
+  // State, guarded by the ramp engine
+  uint32_t start;
+  uint32_t target;
+  uint32_t current;
+  uint32_t startTick;
+  uint32_t durationMs;
+  bool active;
+} Ramp;
+
+// Creates the shared step timer. Call once before any ramp is initialised.
+void initRamps();
+
+// Registers a ramp with the engine. `ramp` must outlive the program (static storage).
+bool rampInit(Ramp *ramp, uint32_t fullScale, RampProfile profile, uint32_t fullScaleMs, RampStepCallback onStep, void *context);
+void rampSetProfile(Ramp *ramp, RampProfile profile, uint32_t fullScaleMs);
+
+// Starts a move from the current level to `target`. Safe to call from any task,
+// but not from a timer callback: it may wait for room in the timer command queue.
+void rampSetTarget(Ramp *ramp, uint32_t target);
+
+uint32_t rampCurrent(const Ramp *ramp);
+uint32_t rampTarget(const Ramp *ramp);
+bool rampIsActive(const Ramp *ramp);
+
+#endif // RAMP_H
@@ -0,0 +1,58 @@
+#ifndef SENSOR_SCHEDULER_H
+#define SENSOR_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SENSOR_SCHEDULER_MAX_SOURCES 4
+
+typedef enum
+{
+  SENSOR_SAMPLED, // `value` holds a fresh reading, a non-zero `retryMs` brings the next one forward
+  SENSOR_FAILED,  // No answer, try again after the current period
+  SENSOR_PENDING, // Not ready yet, e.g. a conversion was started, come back after `retryMs`
+} SensorSampleResult;
+
+// Something the scheduler polls. The period drops straight to minPeriodMs when a
+// reading moves by `threshold` or more, or while `transient` says the readings
+// are about to move, and doubles towards maxPeriodMs while they hold still.
+typedef struct
+{
+  // Configuration
+  const char *name;
+  uint32_t minPeriodMs;
+  uint32_t maxPeriodMs;
+  float threshold; // In the units of `value`
+  SensorSampleResult (*sample)(float *value, uint32_t *retryMs);
+  bool (*transient)(); // Optional
+
+  // State, owned by the scheduler
+  uint32_t periodMs;
+  uint32_t dueMs;
+  float lastValue;
+  bool hasValue;
+} SensorSource;
+
+// One timeline of deadlines for every source, run from a single task
+typedef struct
+{
+  SensorSource *sources[SENSOR_SCHEDULER_MAX_SOURCES];
+  int count;
+} SensorScheduler;
+
+void sensorSchedulerInit(SensorScheduler *scheduler);
+
+// Adds a source, due at once and starting at its fastest period
+bool sensorSchedulerAdd(SensorScheduler *scheduler, SensorSource *source, uint32_t nowMs);
+
+// Samples every source that is due and returns the time until the next deadline
+uint32_t sensorSchedulerRun(SensorScheduler *scheduler, uint32_t nowMs);
+
+// Brings `source` forward to sample now, e.g. after its sensor raised an interrupt
+void sensorSchedulerWake(SensorSource *source, uint32_t nowMs);
+
+// Pulls in every source whose transient check now holds, so a ramp that just
+// started is followed from its first steps rather than after a long back-off
+void sensorSchedulerCheckTransients(SensorScheduler *scheduler, uint32_t nowMs);
+
+#endif // SENSOR_SCHEDULER_H
@@ -3,17 +3,26 @@
 
 #include "constants.h"
 #include "FreeRTOS.h"
+#include "snapshot.h"
 
 void initSensors(void);
-void tempSensorTask(void *params);
-void lightSensorTask(void *params);
+void sensorTask(void *params);
+void handleLightSensorISR(uint gpio, uint32_t events);
 
-// External variables (declarations only)
-extern volatile float lightsATemp;
-extern volatile float lightsBTemp;
-extern volatile float lightsCTemp;
-extern volatile float boothTemp;
-extern volatile float boothHumidity;
-extern volatile float boothLux;
+// Tells the sensor task a light or fan ramp has started, so the sensors it
+// affects are sampled at their fastest rate from the first steps
+void sensorsTransientStarted();
+
+// A reading that fails keeps the previous value, so 0 means no sample yet
+typedef struct
+{
+  float lightsTemp[3]; // Bars A, B and C
+  float boothTemp;
+  float boothHumidity;
+  float boothPressure; // hPa, absolute; stays 0 on boards without a BME280
+} SensorReadings;
+
+extern Snapshot<SensorReadings> sensorReadings; // Published by sensorTask
+extern Snapshot<float> boothLux;                // Published by sensorTask
 
 #endif // SENSORS_H
\ No newline at end of file
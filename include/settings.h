@@ -4,11 +4,29 @@
 #include <stdint.h>
 #include "FreeRTOS.h"
 #include "queue.h"
+#include "fan-controller.h"
 
 // Flash memory constants
 #define FLASH_TARGET_OFFSET 0x100000
 #define FLASH_SECTOR_SIZE (4 * 1024)
 #define SETTINGS_MAGIC 0x1234ABCD
+#define WIFI_CACHE_MAGIC 0x57494643
+#define LIGHT_COOLING_MAGIC 0x4C434F4C
+#define AUTO_BRIGHTNESS_MAGIC 0x4155544F
+#define FAN_CALIBRATION_MAGIC 0x46414E43
+
+// Where the last successful join landed, so the next one can skip the scan and
+// ask the DHCP server for the same address
+typedef struct
+{
+  char ssid[32]; // Network the rest belongs to
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+  uint32_t ipAddress;    // Network byte order
+  uint32_t leaseSeconds; // Lease length the server granted, 0 if unknown
+  uint32_t magic;        // WIFI_CACHE_MAGIC once filled in
+} WifiConnectCache;
 
 // Structure to store settings
 typedef struct
@@ -19,24 +37,74 @@ typedef struct
   int fanSpeed;
   int lightBrightness;
   uint32_t magic; // Magic number for validity check
+  // Groups added since the first layout go after the magic, each closed by a
+  // magic of its own, so settings written before a group existed still load
+  // and the group falls back to its defaults
+  int lightDerateStart;          // °C where the light bars start to derate
+  int lightDerateEnd;            // °C where they reach their minimum output
+  int lightCooling;              // Non-zero to run the extractor when the bars run hot
+  uint32_t lightCoolingMagic;    // LIGHT_COOLING_MAGIC once written
+  int autoBrightness;            // Non-zero to hold autoBrightnessLux at the work surface
+  int autoBrightnessLux;
+  uint32_t autoBrightnessMagic;  // AUTO_BRIGHTNESS_MAGIC once written
+  // Not defaulted on load, without its magic the extractor sweeps the fan again
+  uint32_t fanRpmAtDuty[FAN_CALIBRATION_POINTS]; // The extractor's duty -> RPM table
+  uint32_t fanCalibrationMagic;                  // FAN_CALIBRATION_MAGIC once swept
+  // Not defaulted on load, wifi.cpp checks its magic before using it
+  WifiConnectCache wifiCache;
 } Settings;
 
+#define SETTINGS_DEBOUNCE_MS 2000   // Quiet time after the last change before it is written
+#define SETTINGS_RAMP_POLL_MS 100    // How often a held back commit checks the ramps again
+#define SETTINGS_MAX_HOLD_MS 30000   // Longest ramps can hold a commit back before it goes anyway
+
+// Groups of fields the setters mark as changed, each written as one
+typedef enum
+{
+  SETTING_CREDENTIALS = 1 << 0, // ssid, password and authMode
+  SETTING_FAN_SPEED = 1 << 1,
+  SETTING_LIGHT_COOLING = 1 << 2, // lightCooling and the derate limits
+  SETTING_AUTO_BRIGHTNESS = 1 << 3, // autoBrightness and autoBrightnessLux
+  SETTING_WIFI_CACHE = 1 << 4,
+  SETTING_FAN_CALIBRATION = 1 << 5,
+} SettingsField;
+
 // Commands for the settings queue
 typedef enum
 {
-  SETTINGS_UPDATE, // Update the settings
-  SETTINGS_RESET,  // Reset settings to default
+  SETTINGS_CHANGED, // A setter marked a field, (re)start the debounce window
+  SETTINGS_RESET,   // Reset settings to default
 } SettingsCommandType;
 
-// Queue and global settings
+// Queue and global settings. Read currentSettings directly, change it through
+// the setters below so the change is written to flash.
 extern QueueHandle_t settingsQueue;
 extern volatile Settings currentSettings;
-static Settings localSettingsCopy;
 
 // Function declarations
 void initSettings();
+bool loadSettingsFromFlash(Settings *settings);
+bool saveSettingsToFlash(const Settings *settings);
+// The same against another sector, for the benchmarks, which must leave the
+// stored settings alone. `offset` is from the start of flash, sector aligned.
+bool loadSettingsFromSector(uint32_t offset, Settings *settings);
+bool saveSettingsToSector(uint32_t offset, const Settings *settings);
 void requestSettingsReset();
-void requestSettingsUpdate();
 void settingsTask(void *params);
 
+// Setters update currentSettings at once and leave writing to the settings task,
+// which merges a burst of changes into one flash commit after SETTINGS_DEBOUNCE_MS
+// without one, and never while a fan or light ramp is in flight. Setting a field
+// to the value it already has does nothing. Safe to call from any task.
+void settingsSetCredentials(const char *ssid, const char *password, int authMode);
+void settingsSetFanSpeed(int fanSpeed);
+void settingsSetLightCooling(bool lightCooling);
+void settingsSetAutoBrightness(bool autoBrightness, int autoBrightnessLux);
+void settingsSetWifiCache(const WifiConnectCache *cache);
+void settingsSetFanCalibration(const uint32_t rpmAtDuty[FAN_CALIBRATION_POINTS]);
+
+// SettingsField bits changed but not yet in flash, including a commit in
+// progress. Non-zero while the UI should show that settings are being saved.
+uint32_t settingsDirty();
+
 #endif // SETTINGS_H
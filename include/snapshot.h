@@ -0,0 +1,78 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "hardware/sync.h"
+
+// Seqlock around a plain struct. One task publishes whole values and any task,
+// on either core, reads a consistent copy without taking a lock. The sequence is
+// odd while a publish is copying; readers that see it move retry their copy.
+//
+// Only one task may publish to a given snapshot. Interrupts are masked on the
+// publishing core for the copy, so a reader on that core never spins on a
+// publisher it has preempted.
+template <typename T>
+class Snapshot
+{
+public:
+  Snapshot() : sequence(0), value() {}
+  explicit Snapshot(const T &initial) : sequence(0), value(initial) {}
+
+  void publish(const T &next)
+  {
+    uint32_t interrupts = save_and_disable_interrupts();
+    uint32_t start = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&sequence, start + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&value, &next, sizeof(T));
+    __atomic_store_n(&sequence, start + 2, __ATOMIC_RELEASE);
+    restore_interrupts(interrupts);
+  }
+
+  T read() const
+  {
+    T copy;
+    read(&copy);
+    return copy;
+  }
+
+  // Copies the value into `out` and returns its version
+  uint32_t read(T *out) const
+  {
+    uint32_t before;
+    uint32_t after;
+    do
+    {
+      before = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+      memcpy(out, &value, sizeof(T));
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      after = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+    } while ((before & 1) || before != after);
+    return before / 2;
+  }
+
+  // Copies the value only if it has been published since version `*seen`
+  bool readIfChanged(T *out, uint32_t *seen) const
+  {
+    if (version() == *seen)
+    {
+      return false;
+    }
+    *seen = read(out);
+    return true;
+  }
+
+  // Number of publishes so far, for subscribers to compare against
+  uint32_t version() const
+  {
+    return __atomic_load_n(&sequence, __ATOMIC_ACQUIRE) / 2;
+  }
+
+private:
+  uint32_t sequence;
+  T value;
+};
+
+#endif // SNAPSHOT_H
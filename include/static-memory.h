@@ -0,0 +1,65 @@
+#ifndef STATIC_MEMORY_H
+#define STATIC_MEMORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "timers.h"
+
+// Adds `bytes` to the static RAM tally for `subsystem`. Call during init, before
+// the scheduler starts; the tally is not locked.
+void staticMemoryAccount(const char *subsystem, size_t bytes);
+
+// Prints the tally, one line per subsystem, with the heap left after boot
+void printStaticMemoryReport();
+
+// Storage for a task that runs for the whole session. Tasks never delete
+// themselves, so the stack and TCB are never handed back to the kernel.
+template <uint32_t StackDepth>
+class StaticTask
+{
+public:
+  TaskHandle_t create(TaskFunction_t function, const char *name, UBaseType_t priority, const char *subsystem, void *params = NULL)
+  {
+    staticMemoryAccount(subsystem, sizeof(*this));
+    return xTaskCreateStatic(function, name, StackDepth, params, priority, stack, &task);
+  }
+
+private:
+  StackType_t stack[StackDepth];
+  StaticTask_t task;
+};
+
+// Storage for a queue of `Length` items of type `T`
+template <typename T, UBaseType_t Length>
+class StaticQueue
+{
+public:
+  QueueHandle_t create(const char *subsystem)
+  {
+    staticMemoryAccount(subsystem, sizeof(*this));
+    return xQueueCreateStatic(Length, sizeof(T), storage, &queue);
+  }
+
+private:
+  uint8_t storage[Length * sizeof(T)];
+  StaticQueue_t queue;
+};
+
+class StaticTimer
+{
+public:
+  TimerHandle_t create(const char *name, TickType_t period, bool autoReload, TimerCallbackFunction_t callback, const char *subsystem)
+  {
+    staticMemoryAccount(subsystem, sizeof(*this));
+    return xTimerCreateStatic(name, period, autoReload ? pdTRUE : pdFALSE, (void *)0, callback, &timer);
+  }
+
+private:
+  StaticTimer_t timer;
+};
+
+#endif // STATIC_MEMORY_H
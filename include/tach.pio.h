@@ -0,0 +1,50 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// ---- //
+// tach //
+// ---- //
+
+#define tach_wrap_target 2
+#define tach_wrap 8
+#define tach_pio_version 0
+
+static const uint16_t tach_program_instructions[] = {
+    0x20a0, //  0: wait   1 pin, 0
+    0x2020, //  1: wait   0 pin, 0
+            //     .wrap_target
+    0xa02b, //  2: mov    x, ~null
+    0x00c5, //  3: jmp    pin, 5
+    0x0043, //  4: jmp    x--, 3
+    0x0046, //  5: jmp    x--, 6
+    0x00c5, //  6: jmp    pin, 5
+    0xa0c9, //  7: mov    isr, ~x
+    0x8000, //  8: push   noblock
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program tach_program = {
+    .instructions = tach_program_instructions,
+    .length = 9,
+    .origin = -1,
+    .pio_version = tach_pio_version,
+#if PICO_PIO_VERSION > 0
+    .used_gpio_ranges = 0x0
+#endif
+};
+
+static inline pio_sm_config tach_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + tach_wrap_target, offset + tach_wrap);
+    return c;
+}
+#endif
+
@@ -0,0 +1,46 @@
+#ifndef THERMAL_H
+#define THERMAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define THERMAL_UPDATE_MS 1000        // Model step rate
+#define THERMAL_TAU_S 240.0f          // Heatsink time constant, sensor to steady state
+#define THERMAL_RISE_AT_FULL_C 35.0f  // Steady state rise over ambient at 100% duty
+#define THERMAL_OBSERVER_GAIN 0.2f    // How hard each reading pulls the model towards the sensor
+#define THERMAL_HORIZON_S 60.0f       // How far ahead the derate curve looks
+#define THERMAL_CUTOFF_MARGIN_C 10    // Above end of the curve by this much the bar is switched off
+#define THERMAL_ASSIST_LEAD_C 5       // Extractor assist starts this far below the start of the curve
+#define THERMAL_DEFAULT_AMBIENT_C 25.0f
+
+// Linear derate from 100% at startC down to minPercent at endC, off above endC + THERMAL_CUTOFF_MARGIN_C
+typedef struct
+{
+  int startC;
+  int endC;
+  uint8_t minPercent;
+} ThermalCurve;
+
+typedef struct
+{
+  ThermalCurve curve;
+  float estimatedC;   // First-order model estimate, corrected by the sensor
+  float predictedC;   // Estimate THERMAL_HORIZON_S ahead at the current duty
+  uint8_t limitPercent;
+  bool tripped;       // Over the cutoff, held off until back under endC
+  bool initialised;
+} ThermalChannel;
+
+void thermalInit(ThermalChannel *channel, const ThermalCurve *curve);
+
+// Duty limit (percent) the curve allows at `temperatureC`
+uint8_t thermalDerate(const ThermalCurve *curve, float temperatureC);
+
+// Advances the model by `elapsedMs` at `dutyPercent` and returns the new duty limit.
+// Pass `measurementValid` false while the sensor has not produced a reading.
+uint8_t thermalUpdate(ThermalChannel *channel, float measuredC, bool measurementValid, float ambientC, uint8_t dutyPercent, uint32_t elapsedMs);
+
+// Extractor speed (percent) this channel asks for to help it cool
+uint8_t thermalCoolingDemand(const ThermalChannel *channel);
+
+#endif // THERMAL_H
@@ -0,0 +1,57 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "wifi.h"
+
+struct pbuf;
+
+// Gathers newline-delimited lines from a byte stream. A line that arrives whole
+// in one read is handed over where it lies, its newline replaced by a terminator;
+// only lines split across reads are copied into `line`. A line longer than the
+// buffer is dropped whole rather than parsed in pieces.
+typedef struct
+{
+  char line[SOCKET_LINE_MAX];
+  size_t length;
+  bool overflowed;
+  void (*onLine)(char *line, size_t length);
+} LineAssembler;
+
+void lineAssemblerReset(LineAssembler *assembler);
+void lineAssemblerFeed(LineAssembler *assembler, char *data, size_t length);
+
+// The link to the compressor, one client at a time. Lines that arrive go to
+// transportReceivedLine() and messages queued on outgoingMessageQueue go out as
+// JSON lines. Both run on the server socket task.
+typedef struct
+{
+  const char *name;
+  // Accounts the transport's buffers. Called once from initWifi().
+  void (*init)();
+  // Listens on `port` and serves clients. Returns only if the transport fails.
+  void (*serve)(uint16_t port);
+} Transport;
+
+// BSD sockets: a copy out of lwIP on each read and back into it on each send
+extern const Transport socketTransport;
+
+// lwIP's raw TCP API: lines are framed in the received pbufs and copied once for
+// the server socket task, and sent from static buffers that lwIP references
+// until the client acknowledges them
+extern const Transport rawTransport;
+
+// Feeds each segment of a received pbuf chain to `assembler`
+void rawTransportReceive(LineAssembler *assembler, struct pbuf *chain);
+
+// Provided by wifi.cpp for the transports
+void transportListening();
+void transportClientConnected();
+void transportClientDisconnected();
+// Called on the server socket task, never on lwIP's thread: parsing may wait for
+// the JSON arena
+void transportReceivedLine(char *line, size_t length);
+
+#endif // TRANSPORT_H
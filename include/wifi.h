@@ -1,20 +1,22 @@
 #ifndef WIFI_H
 #define WIFI_H
 
-#include <string>
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "control.h"
 
 // Wi-Fi-related constants
 #define WIFI_MAX_RETRY 3
 #define WIFI_TIMEOUT_MS 15000
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 3000 // Directed join to the cached BSSID, before falling back to a scan
 
 #define MAX_SCAN_RESULTS 10
 #define SSID_MAX_LEN 32
 
 #define SOCKET_MAX_RETRY 3
 #define SOCKET_TIMEOUT_MS 5000
+#define SOCKET_LINE_MAX 512 // Longest JSON line in either direction, including the terminator
 
 typedef struct
 {
@@ -38,10 +40,11 @@ extern int scanResultCount;
 extern QueueHandle_t outgoingMessageQueue;
 
 extern volatile NetworkStatus networkStatus;
+extern volatile bool isAppModeActive; // The setup access point is up
 
 void initWifi();
 void disconnectAndForgetWifi();
-bool sendMessage(const std::string &message);
+bool sendMessage(const Message &message);
 void wifiTask(void *params);
 void ledTask(void *params);
 void serverSocketTask(void *params);
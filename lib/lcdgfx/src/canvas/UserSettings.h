@@ -43,6 +43,18 @@
  */
 #define CONFIG_SSD1306_UNICODE_ENABLE
 
+/**
+ * Bytes of RAM given to the glyph cache of NanoCanvasOps<8>::printFixed().
+ * Glyphs of the built-in 6x8 and 5x7 fonts are expanded once per style and
+ * then copied to the canvas a word at a time. An expanded glyph takes 136 bytes
+ * and the cache is a power of two of 4-way sets, so 2176 bytes hold 16 glyphs:
+ * enough for the digits and units a status screen draws.
+ * Define as 0 to draw every char through drawBitmap1() instead.
+ */
+#ifndef CONFIG_CANVAS8_GLYPH_CACHE_SIZE
+#define CONFIG_CANVAS8_GLYPH_CACHE_SIZE 2176
+#endif
+
 /**
  * @}
  */
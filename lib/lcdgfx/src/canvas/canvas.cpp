@@ -24,8 +24,13 @@
 
 #include "canvas.h"
 #include "canvas/internal/canvas_types_int.h"
+#include "canvas/fonts/fonts.h"
+#include "lcd_hal/io.h"
 #include <string.h>
 
+// Canvas code reads font data through its own inline pgm_read_byte(), not the HAL call
+#undef pgm_read_byte
+
 /////////////////////////////////////////////////////////////////////////////////
 //
 //                            COMMON GRAPHICS
@@ -764,6 +769,59 @@ template <> void NanoCanvasOps<4>::rotateCW(NanoCanvasOps<4> &out)
  * with resolution different from 2^N (160x128, 96x64, etc.)                   */
 #define YADDR8(y) (static_cast<uint32_t>(y) * m_w)
 
+#if defined(__GNUC__)
+/* Canvas memory is accessed as words by the kernels below, may_alias keeps that legal */
+typedef uint32_t __attribute__((__may_alias__)) canvas8_word_t;
+#endif
+
+/* Spans at least this long go to lcd_fillBytes(), which can use DMA */
+#define CANVAS8_BULK_FILL 256
+
+/* Fills len bytes from dst: single bytes up to a word boundary, whole words, then the tail */
+static inline void canvas8FillSpan(uint8_t *dst, uint8_t color, uint32_t len)
+{
+#if defined(__GNUC__)
+    while ( len && ((uintptr_t)dst & 3) )
+    {
+        *dst++ = color;
+        len--;
+    }
+    uint32_t word = color * 0x01010101u;
+    canvas8_word_t *words = (canvas8_word_t *)dst;
+    for ( ; len >= 16; len -= 16 )
+    {
+        words[0] = word;
+        words[1] = word;
+        words[2] = word;
+        words[3] = word;
+        words += 4;
+    }
+    for ( ; len >= 4; len -= 4 )
+    {
+        *words++ = word;
+    }
+    dst = (uint8_t *)words;
+    while ( len-- )
+    {
+        *dst++ = color;
+    }
+#else
+    memset(dst, color, len);
+#endif
+}
+
+static inline void canvas8Fill(uint8_t *dst, uint8_t color, uint32_t len)
+{
+    if ( len >= CANVAS8_BULK_FILL )
+    {
+        lcd_fillBytes(dst, color, len);
+    }
+    else
+    {
+        canvas8FillSpan(dst, color, len);
+    }
+}
+
 template <> void NanoCanvasOps<8>::putPixel(lcdint_t x, lcdint_t y)
 {
     x -= offset.x;
@@ -812,12 +870,7 @@ template <> void NanoCanvasOps<8>::drawHLine(lcdint_t x1, lcdint_t y1, lcdint_t
         return;
     x1 = __max(x1, 0);
     x2 = __min(x2, (lcdint_t)m_w - 1);
-    uint8_t *buf = m_buf + YADDR8(y1) + x1;
-    for ( lcdint_t x = 0; x <= x2 - x1; x++ )
-    {
-        *buf = m_color;
-        buf++;
-    }
+    canvas8FillSpan(m_buf + YADDR8(y1) + x1, (uint8_t)m_color, x2 - x1 + 1);
 }
 
 template <> void NanoCanvasOps<8>::fillRect(lcdint_t x1, lcdint_t y1, lcdint_t x2, lcdint_t y2)
@@ -843,14 +896,17 @@ template <> void NanoCanvasOps<8>::fillRect(lcdint_t x1, lcdint_t y1, lcdint_t x
     y1 = __max(y1, 0);
     y2 = __min(y2, (lcdint_t)m_h - 1);
     uint8_t *buf = m_buf + YADDR8(y1) + x1;
+    uint32_t width = x2 - x1 + 1;
+    if ( width == m_w )
+    {
+        /* Full rows are contiguous, fill them in one go */
+        canvas8Fill(buf, (uint8_t)m_color, width * (y2 - y1 + 1));
+        return;
+    }
     for ( lcdint_t y = y1; y <= y2; y++ )
     {
-        for ( lcdint_t x = x1; x <= x2; x++ )
-        {
-            *buf = m_color;
-            buf++;
-        }
-        buf += ((lcdint_t)(m_w) - (x2 - x1 + 1));
+        canvas8FillSpan(buf, (uint8_t)m_color, width);
+        buf += m_w;
     }
 }
 
@@ -962,9 +1018,274 @@ void NanoCanvasOps<8>::drawBitmap8(lcdint_t xpos, lcdint_t ypos, lcduint_t w, lc
     }
 }
 
+#if (CONFIG_CANVAS8_GLYPH_CACHE_SIZE > 0) && defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+/* Text fast path: glyphs of the fixed fonts below are expanded once per style into
+ * byte masks of the pixels they set and the pixels they write, then copied to the
+ * canvas with aligned 32-bit read-modify-writes. Colour is applied per word while
+ * copying, so one entry serves every colour. The result is byte for byte what
+ * printChar() and drawBitmap1() produce. */
+
+#define GLYPH_CACHE_MAX_COLUMNS 8 // glyph width plus the extra column of bold text
+#define GLYPH_CACHE_MAX_ROWS 8    // single page glyphs only
+#define GLYPH_CACHE_WAYS 4
+#define GLYPH_BOLD 0x01
+#define GLYPH_OPAQUE 0x02
+
+/** Fixed fonts known to the fast path, with their metrics resolved at compile time */
+typedef struct
+{
+    const uint8_t *font; ///< font data including its 4 byte header
+    uint8_t width;
+    uint8_t height;
+    uint8_t asciiOffset;
+} SCanvas8FastFont;
+
+static const SCanvas8FastFont s_canvas8FastFonts[] = {
+    {ssd1306xled_font6x8, 6, 8, 0x20},
+    {ssd1306xled_font5x7, 5, 7, 0x20},
+};
+
+/** One expanded glyph. Each row is two words, pixel 0 in the low byte of the first. */
+typedef struct
+{
+    const uint8_t *glyph; ///< glyph bitmap in the font, nullptr while the entry is unused
+    uint8_t flags;        ///< GLYPH_BOLD, GLYPH_OPAQUE
+    uint16_t lastUse;
+    uint32_t set[GLYPH_CACHE_MAX_ROWS][2];   ///< 0xFF for every pixel drawn in the text colour
+    uint32_t cover[GLYPH_CACHE_MAX_ROWS][2]; ///< 0xFF for every pixel the glyph writes
+} SGlyphCacheEntry;
+
+static constexpr uint16_t glyphCacheSets(uint32_t fit, uint16_t sets = 1)
+{
+    return (sets * 2u <= fit) ? glyphCacheSets(fit, sets * 2) : sets;
+}
+
+/* Largest power of two number of sets that fits the configured budget, at least one */
+#define GLYPH_CACHE_SETS glyphCacheSets(CONFIG_CANVAS8_GLYPH_CACHE_SIZE / (GLYPH_CACHE_WAYS * sizeof(SGlyphCacheEntry)))
+
+static SGlyphCacheEntry s_glyphCache[GLYPH_CACHE_SETS * GLYPH_CACHE_WAYS];
+static uint16_t s_glyphCacheClock = 0;
+
+static void glyphCacheExpand(SGlyphCacheEntry *entry, const uint8_t *glyph, uint8_t width, uint8_t height,
+                             uint8_t flags)
+{
+    /* Bold text is the glyph drawn twice, the second copy one pixel to the right and
+     * always transparent. Opaque text clears the glyph box to 0, not to m_bgColor. */
+    uint8_t columns = width + ((flags & GLYPH_BOLD) ? 1 : 0);
+    for ( uint8_t row = 0; row < GLYPH_CACHE_MAX_ROWS; row++ )
+    {
+        uint32_t set[2] = {0, 0};
+        uint32_t cover[2] = {0, 0};
+        for ( uint8_t col = 0; row < height && col < columns; col++ )
+        {
+            bool inGlyph = col < width;
+            bool bit = inGlyph && (pgm_read_byte(&glyph[col]) & (1 << row));
+            bool shifted = (flags & GLYPH_BOLD) && col > 0 && (pgm_read_byte(&glyph[col - 1]) & (1 << row));
+            uint8_t shift = (col & 3) * 8;
+            if ( bit || shifted )
+            {
+                set[col >> 2] |= (uint32_t)0xFF << shift;
+                cover[col >> 2] |= (uint32_t)0xFF << shift;
+            }
+            else if ( inGlyph && (flags & GLYPH_OPAQUE) )
+            {
+                cover[col >> 2] |= (uint32_t)0xFF << shift;
+            }
+        }
+        entry->set[row][0] = set[0];
+        entry->set[row][1] = set[1];
+        entry->cover[row][0] = cover[0];
+        entry->cover[row][1] = cover[1];
+    }
+    entry->glyph = glyph;
+    entry->flags = flags;
+}
+
+static const SGlyphCacheEntry *glyphCacheGet(const uint8_t *glyph, uint8_t width, uint8_t height, uint8_t flags)
+{
+    uint32_t hash = ((uint32_t)(uintptr_t)glyph * 4 + flags) * 0x9E3779B1u;
+    SGlyphCacheEntry *set = &s_glyphCache[((hash >> 24) & (GLYPH_CACHE_SETS - 1)) * GLYPH_CACHE_WAYS];
+    SGlyphCacheEntry *victim = &set[0];
+    uint16_t now = ++s_glyphCacheClock;
+    for ( uint8_t way = 0; way < GLYPH_CACHE_WAYS; way++ )
+    {
+        SGlyphCacheEntry *entry = &set[way];
+        if ( !entry->glyph )
+        {
+            // Ways fill in order and are never emptied, nothing further on can match
+            victim = entry;
+            break;
+        }
+        if ( entry->glyph == glyph && entry->flags == flags )
+        {
+            entry->lastUse = now;
+            return entry;
+        }
+        if ( (uint16_t)(now - entry->lastUse) > (uint16_t)(now - victim->lastUse) )
+        {
+            victim = entry;
+        }
+    }
+    glyphCacheExpand(victim, glyph, width, height, flags);
+    victim->lastUse = now;
+    return victim;
+}
+
+static inline void glyphBlitWord(canvas8_word_t *dst, uint32_t pixels, uint32_t cover)
+{
+    *dst = (*dst & ~cover) | pixels;
+}
+
+/* Clipped glyphs skip words without a pixel to write, which keeps them inside the buffer */
+static inline void glyphBlitClippedWord(canvas8_word_t *dst, uint32_t pixels, uint32_t cover)
+{
+    if ( cover )
+    {
+        *dst = (*dst & ~cover) | pixels;
+    }
+}
+
+/* x and y are in canvas coordinates, buf is word aligned and w a multiple of 4, so
+ * every row of the glyph starts at the same byte within a word. */
+static void glyphBlit(uint8_t *buf, lcdint_t w, lcdint_t h, lcdint_t x, lcdint_t y, const SGlyphCacheEntry *entry,
+                      uint8_t columns, uint8_t height, uint32_t color)
+{
+    if ( (x + columns <= 0) || (x >= w) || (y + height <= 0) || (y >= h) )
+    {
+        return;
+    }
+    lcdint_t rowStart = __max(0, -y);
+    lcdint_t rowEnd = __min((lcdint_t)height, h - y);
+    uint8_t shift = (x & 3) * 8;
+    uint8_t rshift = 32 - shift;
+    uint8_t words = ((x & 3) + columns + 3) >> 2;
+    canvas8_word_t *dst =
+        (canvas8_word_t *)((uintptr_t)buf + (intptr_t)(static_cast<int32_t>(y + rowStart) * w + (x & ~3)));
+    lcdint_t stride = w >> 2;
+
+    if ( (x >= 0) && (x + columns <= w) )
+    {
+        /* Every word spanned holds a pixel of the glyph, so all of them are in the buffer */
+        for ( lcdint_t row = rowStart; row < rowEnd; row++ )
+        {
+            uint32_t p[2] = {entry->set[row][0] & color, entry->set[row][1] & color};
+            const uint32_t *c = entry->cover[row];
+            if ( !shift )
+            {
+                glyphBlitWord(dst, p[0], c[0]);
+                if ( words > 1 )
+                    glyphBlitWord(dst + 1, p[1], c[1]);
+            }
+            else
+            {
+                glyphBlitWord(dst, p[0] << shift, c[0] << shift);
+                if ( words > 1 )
+                    glyphBlitWord(dst + 1, (p[1] << shift) | (p[0] >> rshift), (c[1] << shift) | (c[0] >> rshift));
+                if ( words > 2 )
+                    glyphBlitWord(dst + 2, p[1] >> rshift, c[1] >> rshift);
+            }
+            dst += stride;
+        }
+        return;
+    }
+
+    uint32_t clip[2] = {~0u, ~0u};
+    for ( lcdint_t col = 0; col < GLYPH_CACHE_MAX_COLUMNS; col++ )
+    {
+        if ( (x + col < 0) || (x + col >= w) )
+        {
+            clip[col >> 2] &= ~((uint32_t)0xFF << ((col & 3) * 8));
+        }
+    }
+    for ( lcdint_t row = rowStart; row < rowEnd; row++ )
+    {
+        uint32_t p0 = entry->set[row][0] & color & clip[0];
+        uint32_t p1 = entry->set[row][1] & color & clip[1];
+        uint32_t c0 = entry->cover[row][0] & clip[0];
+        uint32_t c1 = entry->cover[row][1] & clip[1];
+        if ( !shift )
+        {
+            glyphBlitClippedWord(dst, p0, c0);
+            glyphBlitClippedWord(dst + 1, p1, c1);
+        }
+        else
+        {
+            glyphBlitClippedWord(dst, p0 << shift, c0 << shift);
+            glyphBlitClippedWord(dst + 1, (p1 << shift) | (p0 >> rshift), (c1 << shift) | (c0 >> rshift));
+            glyphBlitClippedWord(dst + 2, p1 >> rshift, c1 >> rshift);
+        }
+        dst += stride;
+    }
+}
+
+template <> void NanoCanvasOps<8>::printFixed(lcdint_t xpos, lcdint_t y, const char *ch, EFontStyle style)
+{
+    m_fontStyle = style;
+    m_cursorX = xpos;
+    m_cursorY = y;
+
+    const SCanvas8FastFont *font = nullptr;
+    if ( m_font && m_font->getHeader().type == 0x00 && !(m_textMode & CANVAS_TEXT_WRAP_LOCAL) &&
+         !((uintptr_t)m_buf & 3) && !(m_w & 3) )
+    {
+        for ( const SCanvas8FastFont &known : s_canvas8FastFonts )
+        {
+            if ( m_font->getPrimaryTable() == known.font + 4 )
+            {
+                font = &known;
+            }
+        }
+    }
+    if ( !font )
+    {
+        while ( *ch )
+        {
+            write(*ch);
+            ch++;
+        }
+        return;
+    }
+
+    SCharInfo info;
+    m_font->getCharBitmap(font->asciiOffset, &info); // spacing can be changed at run time
+    uint8_t flags = (style == STYLE_BOLD ? GLYPH_BOLD : 0) | ((m_textMode & CANVAS_MODE_TRANSPARENT) ? 0 : GLYPH_OPAQUE);
+    uint8_t columns = font->width + (style == STYLE_BOLD ? 1 : 0);
+    uint32_t color = (uint8_t)m_color * 0x01010101u;
+    while ( *ch )
+    {
+        uint8_t c = *ch;
+        if ( c < font->asciiOffset || c >= 0x80 )
+        {
+            // Line breaks and UTF-8 sequences
+            write(c);
+        }
+        else
+        {
+            const uint8_t *glyph = font->font + 4 + (c - font->asciiOffset) * font->width;
+            const SGlyphCacheEntry *entry = glyphCacheGet(glyph, font->width, font->height, flags);
+            glyphBlit(m_buf, (lcdint_t)m_w, (lcdint_t)m_h, m_cursorX - offset.x, m_cursorY - offset.y, entry, columns,
+                      font->height, color);
+            m_cursorX += (lcdint_t)(font->width + info.spacing);
+        }
+        ch++;
+    }
+}
+
+#endif
+
+size_t canvas8GlyphCacheSize()
+{
+#if (CONFIG_CANVAS8_GLYPH_CACHE_SIZE > 0) && defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    return sizeof(s_glyphCache);
+#else
+    return 0;
+#endif
+}
+
 template <> void NanoCanvasOps<8u>::clear()
 {
-    memset(m_buf, 0, YADDR8(m_h));
+    canvas8Fill(m_buf, 0, YADDR8(m_h));
 }
 
 /* This method must be implemented always after clear() */
@@ -540,6 +540,12 @@ public:
     using NanoCanvasBase::NanoCanvasBase;
 };
 
+/**
+ * Returns the bytes of RAM taken by the NanoCanvas8 glyph cache, see
+ * CONFIG_CANVAS8_GLYPH_CACHE_SIZE. Zero when the cache is compiled out.
+ */
+size_t canvas8GlyphCacheSize();
+
 /////////////////////////////////////////////////////////////////////////////////
 //
 //                             16-BIT GRAPHICS
@@ -112,6 +112,30 @@
  */
 #define CONFIG_SSD1306_UNICODE_ENABLE
 
+/**
+ * Smallest fill, in bytes, that lcd_fillBytes() hands to a DMA channel on
+ * platforms that have one. Shorter fills use memset().
+ */
+#ifndef CONFIG_LCD_DMA_FILL_MIN
+#define CONFIG_LCD_DMA_FILL_MIN 1024
+#endif
+
+/**
+ * Time the SSD1331 takes to start an accelerated command (line, rectangle,
+ * copy or clear), in microseconds. Together with CONFIG_SSD1331_ACCEL_PIXELS_PER_US
+ * it sets how long the driver waits before it sends the controller anything else.
+ */
+#ifndef CONFIG_SSD1331_ACCEL_BASE_US
+#define CONFIG_SSD1331_ACCEL_BASE_US 20
+#endif
+
+/**
+ * Pixels the SSD1331 accelerator fills or copies per microsecond.
+ */
+#ifndef CONFIG_SSD1331_ACCEL_PIXELS_PER_US
+#define CONFIG_SSD1331_ACCEL_PIXELS_PER_US 16
+#endif
+
 /**
  * @}
  */
@@ -43,6 +43,7 @@
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifndef LCDINT_TYPES_DEFINED
@@ -162,6 +163,15 @@ void lcd_delayUs(unsigned long us);
  */
 uint8_t lcd_pgmReadByte(const void *ptr);
 
+/**
+ * Fills memory with a byte value, like memset(). Platforms with a DMA
+ * controller hand large, word aligned fills to it.
+ * @param dst memory to fill
+ * @param value byte to fill with
+ * @param len number of bytes to fill
+ */
+void lcd_fillBytes(void *dst, uint8_t value, size_t len);
+
 /**
  * Reads 16-bit from eeprom
  * @param ptr pointer to eeprom memory to read
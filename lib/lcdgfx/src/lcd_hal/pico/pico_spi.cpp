@@ -24,6 +24,7 @@
 
 #include "../io.h"
 #include "pico_spi.h"
+#include "hardware/dma.h"
 //////////////////////////////////////////////////////////////////////////////////
 //                        PI PICO SPI IMPLEMENTATION
 //////////////////////////////////////////////////////////////////////////////////
@@ -92,3 +93,39 @@ void PicoSpi::sendBuffer(const uint8_t *buffer, uint16_t size)
 {
     spi_write_blocking(PICO_SPI, buffer, size);
 }
+
+void PicoSpi::sendBufferAsync(const uint8_t *buffer, uint16_t size)
+{
+    if ( m_dmaChannel == -2 )
+    {
+        m_dmaChannel = dma_claim_unused_channel(false);
+    }
+    if ( m_dmaChannel < 0 )
+    {
+        spi_write_blocking(PICO_SPI, buffer, size);
+        return;
+    }
+    dma_channel_config config = dma_channel_get_default_config(m_dmaChannel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, spi_get_dreq(PICO_SPI, true));
+    dma_channel_configure(m_dmaChannel, &config, &spi_get_hw(PICO_SPI)->dr, buffer, size, true);
+}
+
+void PicoSpi::waitBuffer()
+{
+    if ( m_dmaChannel < 0 )
+        return;
+    dma_channel_wait_for_finish_blocking(m_dmaChannel);
+    // The last bytes are still shifting out when DMA finishes. Nothing reads the
+    // receive FIFO meanwhile, so empty it and clear the overrun it caused.
+    while ( spi_is_busy(PICO_SPI) )
+    {
+    }
+    while ( spi_is_readable(PICO_SPI) )
+    {
+        (void)spi_get_hw(PICO_SPI)->dr;
+    }
+    spi_get_hw(PICO_SPI)->icr = SPI_SSPICR_RORIC_BITS;
+}
@@ -91,10 +91,28 @@ public:
      */
     void sendBuffer(const uint8_t *buffer, uint16_t size);
 
+    /**
+     * @brief Starts sending bytes to SSD1306 device with DMA
+     *
+     * Starts sending bytes with DMA and returns without waiting for them.
+     * The buffer must stay untouched until waitBuffer() returns. Without
+     * a free DMA channel the bytes are sent straight away, like sendBuffer().
+     *
+     * @param buffer - bytes to send
+     * @param size - number of bytes to send
+     */
+    void sendBufferAsync(const uint8_t *buffer, uint16_t size);
+
+    /**
+     * Waits until the bytes passed to sendBufferAsync() have left the SPI bus
+     */
+    void waitBuffer();
+
 private:
     int8_t m_cs;
     int8_t m_dc;
     int8_t m_clk;
     int8_t m_mosi;
     uint32_t m_frequency;
+    int m_dmaChannel = -2; ///< not claimed yet, -1 when none was free
 };
@@ -23,6 +23,9 @@
 */
 
 #include "../io.h"
+#include "hardware/dma.h"
+
+#include <string.h>
 
 void lcd_gpioMode(int pin, int mode)
 {
@@ -58,7 +61,49 @@ void lcd_delay(unsigned long ms)
     sleep_ms(ms);
 }
 
+void lcd_delayUs(unsigned long us)
+{
+    busy_wait_us_32(us);
+}
+
+uint32_t lcd_millis(void)
+{
+    return to_ms_since_boot(get_absolute_time());
+}
+
+uint32_t lcd_micros(void)
+{
+    return time_us_32();
+}
+
 uint8_t lcd_pgmReadByte(const void *ptr)
 {
     return *(static_cast<const uint8_t *>(ptr));
 }
+
+static int s_fillChannel = -2; // not claimed yet, -1 when none was free
+
+void lcd_fillBytes(void *dst, uint8_t value, size_t len)
+{
+    if ( (len >= CONFIG_LCD_DMA_FILL_MIN) && !((uintptr_t)dst & 3) && !(len & 3) )
+    {
+        if ( s_fillChannel == -2 )
+        {
+            s_fillChannel = dma_claim_unused_channel(false);
+        }
+        if ( s_fillChannel >= 0 )
+        {
+            // The channel reads the pattern for every word, so it has to outlive the call
+            static uint32_t pattern;
+            pattern = value * 0x01010101u;
+            dma_channel_config config = dma_channel_get_default_config(s_fillChannel);
+            channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+            channel_config_set_read_increment(&config, false);
+            channel_config_set_write_increment(&config, true);
+            dma_channel_configure(s_fillChannel, &config, dst, &pattern, len / 4, true);
+            dma_channel_wait_for_finish_blocking(s_fillChannel);
+            return;
+        }
+    }
+    memset(dst, value, len);
+}
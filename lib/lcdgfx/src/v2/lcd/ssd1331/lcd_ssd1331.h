@@ -132,18 +132,65 @@ public:
      *
      * @note This API can be used only with ssd1331 RGB oled displays
      * @note after copy command is sent, it takes some time from oled
-     *       controller to complete operation. So, it is highly recommended
-     *       to wait for reasonable time before send other graphics operations
-     *       (for example, use 250us delay). This time is required for
-     *       oled display to become ready to accept new commands.
+     *       controller to complete operation. The next accelerated command
+     *       or startBlock() waits for it, see waitAccelerator().
      */
     void copyBlock(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom, uint8_t newLeft, uint8_t newTop);
 
+    /**
+     * Draws rectangle outline using hardware accelerator capabilities
+     *
+     * @param left left position of rectangle
+     * @param top top position of rectangle
+     * @param right right position of rectangle
+     * @param bottom bottom position of rectangle
+     * @param color color to draw outline with (refere RGB_COLOR16 macro)
+     */
+    void drawRect(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom, uint16_t color);
+
+    /**
+     * Fills rectangle using hardware accelerator capabilities
+     *
+     * @param left left position of rectangle
+     * @param top top position of rectangle
+     * @param right right position of rectangle
+     * @param bottom bottom position of rectangle
+     * @param color color to fill rectangle with (refere RGB_COLOR16 macro)
+     */
+    void fillRect(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom, uint16_t color);
+
+    /**
+     * Clears window in GDRAM to black using hardware accelerator capabilities
+     *
+     * @param left left position of window
+     * @param top top position of window
+     * @param right right position of window
+     * @param bottom bottom position of window
+     */
+    void clearWindow(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom);
+
+    /**
+     * Waits until the controller has finished the last accelerated command.
+     * The controller ignores GDRAM writes and new commands while it draws, so
+     * startBlock() and every accelerated command call this first. The time a
+     * command takes is estimated from the area it covers, see
+     * CONFIG_SSD1331_ACCEL_BASE_US and CONFIG_SSD1331_ACCEL_PIXELS_PER_US.
+     */
+    void waitAccelerator();
+
 private:
     const uint8_t m_bits;
     const int8_t m_dc = -1;                       ///< data/command pin for SPI, -1 for i2c
     NanoDisplayBase<InterfaceSSD1331<I>> &m_base; ///< basic lcd display support interface
     uint8_t m_rotation = 0x00;                    ///< Indicates display orientation: 0, 1, 2, 3. refer to setRotation
+    uint8_t m_fillMode = 0xFF;                    ///< last value sent with 0x26, 0xFF if not sent yet
+    bool m_accelBusy = false;                     ///< true while an accelerated command may still be running
+    uint32_t m_accelReadyUs = 0;                  ///< lcd_micros() value at which it will have finished
+
+    void sendRect(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom, uint16_t outline, uint16_t fill,
+                  uint8_t fillMode);
+    void sendColor(uint16_t color);
+    void startAccelerator(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom);
 };
 /**
  * Class implements basic functions for 8-bit mode of SSD1331-based displays
@@ -35,6 +35,7 @@
 template <class I> void InterfaceSSD1331<I>::startBlock(lcduint_t x, lcduint_t y, lcduint_t w)
 {
     uint8_t rx = w ? (x + w - 1) : (m_base.width() - 1);
+    waitAccelerator();
     this->start();
     setDataMode(0);
     this->send((m_rotation & 1) ? 0x75 : 0x15);
@@ -65,6 +66,7 @@ template <class I> void InterfaceSSD1331<I>::setDataMode(uint8_t mode)
 
 template <class I> void InterfaceSSD1331<I>::commandStart()
 {
+    waitAccelerator();
     this->start();
     if ( m_dc >= 0 )
         setDataMode(0);
@@ -105,6 +107,7 @@ template <class I> void InterfaceSSD1331<I>::setRotation(uint8_t rotation)
 template <class I>
 void InterfaceSSD1331<I>::drawLine(lcdint_t x1, lcdint_t y1, lcdint_t x2, lcdint_t y2, uint16_t color)
 {
+    waitAccelerator();
     this->start();
     setDataMode(0);
     this->send(0x21);
@@ -112,16 +115,16 @@ void InterfaceSSD1331<I>::drawLine(lcdint_t x1, lcdint_t y1, lcdint_t x2, lcdint
     this->send(y1);
     this->send(x2);
     this->send(y2);
-    this->send((color & 0xF800) >> 10);
-    this->send((color & 0x07E0) >> 5);
-    this->send((color & 0x001F) << 1);
+    sendColor(color);
     this->stop();
+    startAccelerator(x1, y1, x2, y2);
 }
 
 template <class I>
 void InterfaceSSD1331<I>::copyBlock(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom, uint8_t newLeft,
                                     uint8_t newTop)
 {
+    waitAccelerator();
     this->start();
     setDataMode(0);
     this->send(0x23);
@@ -132,6 +135,84 @@ void InterfaceSSD1331<I>::copyBlock(uint8_t left, uint8_t top, uint8_t right, ui
     this->send(newLeft);
     this->send(newTop);
     this->stop();
+    startAccelerator(left, top, right, bottom);
+}
+
+template <class I>
+void InterfaceSSD1331<I>::drawRect(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom, uint16_t color)
+{
+    sendRect(left, top, right, bottom, color, color, 0x00);
+}
+
+template <class I>
+void InterfaceSSD1331<I>::fillRect(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom, uint16_t color)
+{
+    sendRect(left, top, right, bottom, color, color, 0x01);
+}
+
+template <class I> void InterfaceSSD1331<I>::clearWindow(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom)
+{
+    waitAccelerator();
+    this->start();
+    setDataMode(0);
+    this->send(0x25);
+    this->send(left);
+    this->send(top);
+    this->send(right);
+    this->send(bottom);
+    this->stop();
+    startAccelerator(left, top, right, bottom);
+}
+
+template <class I> void InterfaceSSD1331<I>::waitAccelerator()
+{
+    if ( !m_accelBusy )
+        return;
+    int32_t remaining = (int32_t)(m_accelReadyUs - lcd_micros());
+    if ( remaining > 0 )
+    {
+        lcd_delayUs(remaining);
+    }
+    m_accelBusy = false;
+}
+
+template <class I>
+void InterfaceSSD1331<I>::sendRect(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom, uint16_t outline,
+                                   uint16_t fill, uint8_t fillMode)
+{
+    waitAccelerator();
+    this->start();
+    setDataMode(0);
+    if ( fillMode != m_fillMode )
+    {
+        this->send(0x26);
+        this->send(fillMode);
+        m_fillMode = fillMode;
+    }
+    this->send(0x22);
+    this->send(left);
+    this->send(top);
+    this->send(right);
+    this->send(bottom);
+    sendColor(outline);
+    sendColor(fill);
+    this->stop();
+    startAccelerator(left, top, right, bottom);
+}
+
+template <class I> void InterfaceSSD1331<I>::sendColor(uint16_t color)
+{
+    this->send((color & 0xF800) >> 10);
+    this->send((color & 0x07E0) >> 5);
+    this->send((color & 0x001F) << 1);
+}
+
+template <class I> void InterfaceSSD1331<I>::startAccelerator(uint8_t left, uint8_t top, uint8_t right, uint8_t bottom)
+{
+    uint32_t w = (left < right ? right - left : left - right) + 1;
+    uint32_t h = (top < bottom ? bottom - top : top - bottom) + 1;
+    m_accelReadyUs = lcd_micros() + CONFIG_SSD1331_ACCEL_BASE_US + w * h / CONFIG_SSD1331_ACCEL_PIXELS_PER_US;
+    m_accelBusy = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
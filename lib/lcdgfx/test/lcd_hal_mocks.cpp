@@ -0,0 +1,13 @@
+#include <cstring>
+
+#include "lcd_hal_mocks.h"
+#include "lcd_hal/io.h"
+
+int mockFillBytesCalls;
+size_t mockFillBytesLength;
+
+void lcd_fillBytes(void *dst, uint8_t value, size_t len) {
+	mockFillBytesCalls++;
+	mockFillBytesLength = len;
+	memset(dst, value, len);
+}
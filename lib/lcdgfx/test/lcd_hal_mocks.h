@@ -0,0 +1,9 @@
+#ifndef LCD_HAL_MOCKS_H
+#define LCD_HAL_MOCKS_H
+
+#include <cstddef>
+
+extern int mockFillBytesCalls;
+extern size_t mockFillBytesLength;
+
+#endif // LCD_HAL_MOCKS_H
@@ -0,0 +1,4 @@
+#ifndef MOCK_HARDWARE_SPI_H
+#define MOCK_HARDWARE_SPI_H
+
+#endif // MOCK_HARDWARE_SPI_H
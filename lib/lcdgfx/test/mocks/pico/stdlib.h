@@ -0,0 +1,6 @@
+#ifndef MOCK_PICO_STDLIB_H
+#define MOCK_PICO_STDLIB_H
+
+// Nothing from the pico-sdk is needed to draw on a canvas
+
+#endif // MOCK_PICO_STDLIB_H
@@ -0,0 +1,190 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "canvas/canvas.h"
+#include "canvas/fonts/fonts.h"
+#include "lcd_hal_mocks.h"
+
+// Golden images for the 8bpp canvas kernels. Each optimised primitive draws into
+// one buffer and a plain byte loop, as lcdgfx shipped it, draws the same thing
+// into another. The two buffers must match byte for byte.
+
+struct Size {
+	lcdint_t w;
+	lcdint_t h;
+};
+
+// 96x64 is the SSD1331. The others leave rows unaligned and shorter than a word.
+static const Size sizes[] = {{96, 64}, {37, 9}, {13, 7}, {3, 5}};
+
+struct Golden {
+	Golden(lcdint_t w, lcdint_t h, size_t misalign) :
+		w(w), h(h), storage(w * h + 8, 0xA5), reference(w * h, 0) {
+		buf = storage.data() + misalign;
+		canvas.begin(w, h, buf);
+	}
+
+	bool matches() const {
+		return memcmp(buf, reference.data(), reference.size()) == 0;
+	}
+
+	void referenceHLine(lcdint_t x1, lcdint_t y1, lcdint_t x2, uint8_t color) {
+		x1 -= canvas.offset.x;
+		y1 -= canvas.offset.y;
+		x2 -= canvas.offset.x;
+		if (x1 > x2) std::swap(x1, x2);
+		if (x2 < 0 || x1 >= w || y1 < 0 || y1 >= h) return;
+		x1 = std::max(x1, (lcdint_t)0);
+		x2 = std::min(x2, w - 1);
+		for (lcdint_t x = x1; x <= x2; x++) reference[y1 * w + x] = color;
+	}
+
+	void referenceFillRect(lcdint_t x1, lcdint_t y1, lcdint_t x2, lcdint_t y2, uint8_t color) {
+		if (y1 > y2) std::swap(y1, y2);
+		if (x1 > x2) std::swap(x1, x2);
+		x1 -= canvas.offset.x;
+		y1 -= canvas.offset.y;
+		x2 -= canvas.offset.x;
+		y2 -= canvas.offset.y;
+		if (x2 < 0 || x1 >= w || y2 < 0 || y1 >= h) return;
+		x1 = std::max(x1, (lcdint_t)0);
+		x2 = std::min(x2, w - 1);
+		y1 = std::max(y1, (lcdint_t)0);
+		y2 = std::min(y2, h - 1);
+		for (lcdint_t y = y1; y <= y2; y++) {
+			for (lcdint_t x = x1; x <= x2; x++) reference[y * w + x] = color;
+		}
+	}
+
+	lcdint_t w;
+	lcdint_t h;
+	std::vector<uint8_t> storage;
+	std::vector<uint8_t> reference;
+	uint8_t *buf;
+	NanoCanvasOps<8> canvas;
+};
+
+TEST_CASE("fillRect matches the byte loop") {
+	std::mt19937 rng(1);
+	for (const Size &size : sizes) {
+		for (size_t misalign = 0; misalign < 4; misalign++) {
+			Golden golden(size.w, size.h, misalign);
+			std::uniform_int_distribution<int> x(-size.w / 2 - 4, size.w + size.w / 2 + 4);
+			std::uniform_int_distribution<int> y(-size.h / 2 - 4, size.h + size.h / 2 + 4);
+			for (int i = 0; i < 2000; i++) {
+				uint8_t color = (uint8_t)rng();
+				lcdint_t ox = (lcdint_t)(rng() % 9) - 4;
+				lcdint_t oy = (lcdint_t)(rng() % 9) - 4;
+				lcdint_t x1 = x(rng), y1 = y(rng), x2 = x(rng), y2 = y(rng);
+				golden.canvas.setOffset(ox, oy);
+				golden.canvas.setColor(color);
+				golden.canvas.fillRect(x1, y1, x2, y2);
+				golden.referenceFillRect(x1, y1, x2, y2, color);
+				INFO(size.w << "x" << size.h << "+" << misalign << " rect " << x1 << "," << y1 << "-" << x2 << "," << y2);
+				REQUIRE(golden.matches());
+			}
+			// Nothing may be written outside the canvas
+			REQUIRE(golden.storage[misalign + size.w * size.h] == 0xA5);
+			if (misalign > 0) REQUIRE(golden.storage[misalign - 1] == 0xA5);
+		}
+	}
+}
+
+TEST_CASE("drawHLine matches the byte loop") {
+	std::mt19937 rng(2);
+	for (const Size &size : sizes) {
+		for (size_t misalign = 0; misalign < 4; misalign++) {
+			Golden golden(size.w, size.h, misalign);
+			std::uniform_int_distribution<int> x(-size.w / 2 - 4, size.w + size.w / 2 + 4);
+			std::uniform_int_distribution<int> y(-2, size.h + 1);
+			for (int i = 0; i < 2000; i++) {
+				uint8_t color = (uint8_t)rng();
+				lcdint_t ox = (lcdint_t)(rng() % 9) - 4;
+				lcdint_t x1 = x(rng), y1 = y(rng), x2 = x(rng);
+				golden.canvas.setOffset(ox, 0);
+				golden.canvas.setColor(color);
+				golden.canvas.drawHLine(x1, y1, x2);
+				golden.referenceHLine(x1, y1, x2, color);
+				INFO(size.w << "x" << size.h << "+" << misalign << " line " << x1 << "-" << x2 << " at " << y1);
+				REQUIRE(golden.matches());
+			}
+			REQUIRE(golden.storage[misalign + size.w * size.h] == 0xA5);
+			if (misalign > 0) REQUIRE(golden.storage[misalign - 1] == 0xA5);
+		}
+	}
+}
+
+TEST_CASE("clear zeroes the whole canvas") {
+	for (const Size &size : sizes) {
+		for (size_t misalign = 0; misalign < 4; misalign++) {
+			Golden golden(size.w, size.h, misalign);
+			golden.canvas.setColor(0xFF);
+			golden.canvas.fillRect(0, 0, size.w - 1, size.h - 1);
+			golden.canvas.clear();
+			REQUIRE(golden.matches());
+			REQUIRE(golden.storage[misalign + size.w * size.h] == 0xA5);
+		}
+	}
+}
+
+TEST_CASE("large fills go to the HAL, small ones stay inline") {
+	Golden display(96, 64, 0);
+	mockFillBytesCalls = 0;
+	display.canvas.clear();
+	REQUIRE(mockFillBytesCalls == 1);
+	REQUIRE(mockFillBytesLength == 96 * 64);
+
+	// Full width rows are one contiguous span
+	display.canvas.setColor(0x1C);
+	display.canvas.fillRect(0, 10, 95, 19);
+	REQUIRE(mockFillBytesCalls == 2);
+	REQUIRE(mockFillBytesLength == 96 * 10);
+
+	display.canvas.fillRect(1, 10, 95, 19);
+	display.canvas.drawHLine(0, 30, 95);
+	REQUIRE(mockFillBytesCalls == 2);
+
+	Golden small(13, 7, 0);
+	mockFillBytesCalls = 0;
+	small.canvas.clear();
+	REQUIRE(mockFillBytesCalls == 0);
+}
+
+// printFixed has its own 8bpp fast path. printFixedPgm still goes through
+// write() and drawBitmap1(), so it draws the reference image.
+TEST_CASE("printFixed matches the drawBitmap1 path") {
+	static const char *const texts[] = {
+		"Bench 23.5C 45%",
+		"Fan 1200rpm\nLights A B C",
+		"~!@#$%^&*()_+{}|:\"<>?`-=[];',./",
+		"AIRBRUSH\n\n  60 psi",
+	};
+	const uint8_t *fonts[] = {ssd1306xled_font6x8, ssd1306xled_font5x7};
+	std::mt19937 rng(3);
+	for (const Size &size : sizes) {
+		for (size_t misalign = 0; misalign < 4; misalign++) {
+			Golden fast(size.w, size.h, misalign);
+			Golden slow(size.w, size.h, misalign);
+			for (int i = 0; i < 400; i++) {
+				const char *text = texts[rng() % 4];
+				const uint8_t *font = fonts[rng() % 2];
+				uint8_t color = (uint8_t)rng();
+				uint8_t mode = (rng() & 1) ? CANVAS_MODE_TRANSPARENT : CANVAS_MODE_BASIC;
+				EFontStyle style = (rng() & 1) ? STYLE_BOLD : STYLE_NORMAL;
+				lcdint_t x = (lcdint_t)(rng() % (size.w + 20)) - 10;
+				lcdint_t y = (lcdint_t)(rng() % (size.h + 20)) - 10;
+				for (Golden *golden : {&fast, &slow}) {
+					golden->canvas.setFixedFont(font);
+					golden->canvas.setMode(mode);
+					golden->canvas.setColor(color);
+				}
+				fast.canvas.printFixed(x, y, text, style);
+				slow.canvas.printFixedPgm(x, y, text, style);
+				INFO(size.w << "x" << size.h << "+" << misalign << " \"" << text << "\" at " << x << "," << y);
+				REQUIRE(memcmp(fast.buf, slow.buf, fast.reference.size()) == 0);
+			}
+		}
+	}
+}
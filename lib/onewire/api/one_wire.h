@@ -61,10 +61,30 @@ static const int SearchROMCommand = 0xF0;
 static const int SkipROMCommand = 0xCC;
 static const int WriteScratchPadCommand = 0x4E;
 static const int ROMSize = 8;
+static const int MaxDevicesOnBus = 8;
 struct rom_address_t {
 	uint8_t rom[ROMSize];
 };
 
+/**
+ * Addresses found by a bus search, held in a fixed array so that searching
+ * never allocates. Devices beyond MaxDevicesOnBus are not listed.
+ */
+struct rom_address_list_t {
+	rom_address_t addresses[MaxDevicesOnBus];
+	int count;
+
+	void clear() { count = 0; }
+	int size() const { return count; }
+	bool full() const { return count >= MaxDevicesOnBus; }
+	void push_back(const rom_address_t &address) {
+		if (!full()) {
+			addresses[count++] = address;
+		}
+	}
+	rom_address_t &operator[](int index) { return addresses[index]; }
+};
+
 /**
  * OneWire with DS1820 Dallas 1-Wire Temperature Probe
  *
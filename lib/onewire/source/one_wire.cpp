@@ -3,7 +3,6 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <vector>
 
 #ifdef MOCK_PICO_PI
 
@@ -15,7 +14,7 @@
 
 #endif
 
-std::vector<rom_address_t> found_addresses;
+rom_address_list_t found_addresses;
 
 One_wire::One_wire(uint data_pin, uint power_pin, bool power_polarity)
 		: _data_pin(data_pin),
@@ -229,7 +228,8 @@ bool One_wire::search_rom_find_next() {
 				address.rom[byte_counter] = _search_ROM[byte_counter];
 			}
 			found_addresses.push_back(address);
-			_last_device = _last_discrepancy == 0;
+			// A full list ends the search as if this were the last device
+			_last_device = _last_discrepancy == 0 || found_addresses.full();
 			return true;
 		} else {
 			return false;
@@ -5,7 +5,7 @@
 
 #include "one_wire.h"
 
-extern std::vector<rom_address_t> found_addresses;
+extern rom_address_list_t found_addresses;
 
 One_wire one_wire(0); //NOLINT
 
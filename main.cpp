@@ -12,9 +12,38 @@
 #include "isr-handlers.h"
 #include "extractor.h"
 #include "lights.h"
+#include "diagnostics.h"
+#include "ramp.h"
+#include "json-arena.h"
+#include "static-memory.h"
+#include "boot-timeline.h"
 
 #define WATCHDOG_TIMEOUT_MS 5000 // Watchdog timeout in milliseconds
 
+#if defined(configNUMBER_OF_CORES) && configNUMBER_OF_CORES > 1
+#define PASSIVE_IDLE_TASKS (configNUMBER_OF_CORES - 1)
+#endif
+
+static StaticTask<256> displayTaskMemory;
+static StaticTask<4096> wifiTaskMemory;
+static StaticTask<256> settingsTaskMemory;
+static StaticTask<384> sensorTaskMemory;
+static StaticTask<256> extractorTaskMemory;
+static StaticTask<256> lightsTaskMemory;
+static StaticTask<256> interactionTaskMemory;
+static StaticTask<256> watchdogTaskMemory;
+static StaticTask<512> diagnosticsTaskMemory;
+
+// Kernel tasks, handed over through the hooks below
+static StaticTask_t idleTask;
+static StackType_t idleTaskStack[configMINIMAL_STACK_SIZE];
+static StaticTask_t timerTask;
+static StackType_t timerTaskStack[configTIMER_TASK_STACK_DEPTH];
+#ifdef PASSIVE_IDLE_TASKS
+static StaticTask_t passiveIdleTasks[PASSIVE_IDLE_TASKS];
+static StackType_t passiveIdleTaskStacks[PASSIVE_IDLE_TASKS][configMINIMAL_STACK_SIZE];
+#endif
+
 extern "C"
 {
     void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
@@ -24,25 +53,60 @@ extern "C"
             ; // Hang here for debugging.
     }
 
+    void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, configSTACK_DEPTH_TYPE *puxIdleTaskStackSize)
+    {
+        *ppxIdleTaskTCBBuffer = &idleTask;
+        *ppxIdleTaskStackBuffer = idleTaskStack;
+        *puxIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+    }
+
+#ifdef PASSIVE_IDLE_TASKS
+    void vApplicationGetPassiveIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, configSTACK_DEPTH_TYPE *puxIdleTaskStackSize, BaseType_t xPassiveIdleTaskIndex)
+    {
+        *ppxIdleTaskTCBBuffer = &passiveIdleTasks[xPassiveIdleTaskIndex];
+        *ppxIdleTaskStackBuffer = passiveIdleTaskStacks[xPassiveIdleTaskIndex];
+        *puxIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+    }
+#endif
+
+    void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, configSTACK_DEPTH_TYPE *puxTimerTaskStackSize)
+    {
+        *ppxTimerTaskTCBBuffer = &timerTask;
+        *ppxTimerTaskStackBuffer = timerTaskStack;
+        *puxTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+    }
+
     void vApplicationMallocFailedHook(void)
     {
-        printf("Malloc failed!\n");
+        // The watchdog task would keep the board alive with a dead subsystem, reset it instead
+        printf("Malloc failed! Rebooting.\n");
+        watchdog_reboot(0, 0, 0);
         while (1)
         {
-            vTaskDelay(pdMS_TO_TICKS(1000));
+            tight_loop_contents();
         }
     }
 
     void Default_Handler(void)
     {
-        uint32_t irq_num;
+        uint32_t irq_num = 0;
+#ifndef BENCH_SIMULATOR
         asm volatile("mrs %0, ipsr" : "=r"(irq_num));
+#endif
         printf("Unhandled IRQ: %ld\n", irq_num & 0x1FF); // Extract IRQ number
         while (1)
             ;
     }
 }
 
+// Runs one init step in main() and adds it to the boot timeline
+static void timedInit(const char *name, void (*init)())
+{
+    int step = bootStepBegin(name);
+    init();
+    bootStepEnd(step);
+}
+
 void watchdogKickTask(void *params)
 {
     while (1)
@@ -63,30 +127,43 @@ int main()
 
     // Initialize the watchdog with a timeout, this will reset the system if not regularly kicked
 
-    initDisplay();
-    initSettings();
+    staticMemoryAccount("kernel", sizeof(idleTask) + sizeof(idleTaskStack) + sizeof(timerTask) + sizeof(timerTaskStack));
+#ifdef PASSIVE_IDLE_TASKS
+    staticMemoryAccount("kernel", sizeof(passiveIdleTasks) + sizeof(passiveIdleTaskStacks));
+#endif
+    // Only quick, non-blocking setup happens here. The slow steps, panel bring-up,
+    // radio firmware load and sensor probing, run in their own tasks once the
+    // scheduler starts, so they overlap across both cores.
+    timedInit("json", initJsonArena);
+    timedInit("settings", initSettings);
+    timedInit("display-init", initDisplay);
     // initControl();
-    initWifi();
-    initSensors();
-    initInteraction();
-    initExtractor();
-    initLights();
+    timedInit("wifi-init", initWifi);
+    timedInit("sensors-init", initSensors);
+    timedInit("interaction", initInteraction);
+    timedInit("ramps", initRamps);
+    timedInit("extractor", initExtractor);
+    timedInit("lights", initLights);
+    timedInit("diagnostics", initDiagnostics);
 
     // requestSettingsReset();
     watchdog_enable(WATCHDOG_TIMEOUT_MS, 1);
 
-    xTaskCreate(displayTask, "DisplayTask", 256, NULL, tskIDLE_PRIORITY + 2, NULL);
-    xTaskCreate(wifiTask, "WiFiTask", 4096, NULL, tskIDLE_PRIORITY + 3, NULL);
-    xTaskCreate(settingsTask, "SettingsTask", 256, NULL, tskIDLE_PRIORITY + 1, NULL);
+    displayTaskMemory.create(displayTask, "DisplayTask", tskIDLE_PRIORITY + 2, "display");
+    wifiTaskMemory.create(wifiTask, "WiFiTask", tskIDLE_PRIORITY + 3, "wifi");
+    settingsTaskMemory.create(settingsTask, "SettingsTask", tskIDLE_PRIORITY + 1, "settings");
     // xTaskCreate(controlTask, "ControlTask", 256, NULL, tskIDLE_PRIORITY + 2, NULL);
-    xTaskCreate(lightSensorTask, "LightSensorsTask", 256, NULL, tskIDLE_PRIORITY + 2, NULL);
-    xTaskCreate(tempSensorTask, "TempSensorsTask", 256, NULL, tskIDLE_PRIORITY + 2, NULL);
-    xTaskCreate(extractorTask, "ExtractorTask", 256, NULL, tskIDLE_PRIORITY + 2, NULL);
-    xTaskCreate(lightsTask, "LightsTask", 256, NULL, tskIDLE_PRIORITY + 2, NULL);
+    sensorTaskMemory.create(sensorTask, "SensorTask", tskIDLE_PRIORITY + 2, "sensors");
+    extractorTaskMemory.create(extractorTask, "ExtractorTask", tskIDLE_PRIORITY + 2, "extractor");
+    lightsTaskMemory.create(lightsTask, "LightsTask", tskIDLE_PRIORITY + 2, "lights");
+
+    interactionTaskMemory.create(interactionTask, "InteractionTask", tskIDLE_PRIORITY + 3, "interaction");
+    watchdogTaskMemory.create(watchdogKickTask, "WatchdogTask", tskIDLE_PRIORITY + 3, "watchdog");
+    diagnosticsTaskMemory.create(diagnosticsTask, "DiagnosticsTask", tskIDLE_PRIORITY + 1, "diagnostics");
 
-    xTaskCreate(interactionTask, "InteractionTask", 256, NULL, tskIDLE_PRIORITY + 3, NULL);
-    xTaskCreate(watchdogKickTask, "WatchdogTask", 256, NULL, tskIDLE_PRIORITY + 3, NULL);
+    printStaticMemoryReport();
 
+    bootMilestone("scheduler");
     vTaskStartScheduler();
 
     // If the scheduler returns, this should never happen.
@@ -0,0 +1,118 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* FreeRTOS configuration for the host simulation build (POSIX port).
+ *
+ * Mirrors include/FreeRTOSConfig.h wherever the firmware can observe the
+ * difference: tick rate, priorities, timer task, run time stats and the
+ * INCLUDE_ set. The POSIX port runs one task at a time on a single core and
+ * gives every task a pthread stack, so stack checking is off and the heap is
+ * sized for the host. */
+
+#define configUSE_PREEMPTION 1
+#define configUSE_TICKLESS_IDLE 0
+#define configUSE_IDLE_HOOK 0
+#define configUSE_TICK_HOOK 0
+#define configTICK_RATE_HZ ((TickType_t)1000)
+#define configMAX_PRIORITIES 32
+#define configMINIMAL_STACK_SIZE (configSTACK_DEPTH_TYPE)1024
+#define configUSE_16_BIT_TICKS 0
+
+#define configIDLE_SHOULD_YIELD 1
+
+/* Synchronization Related */
+#define configUSE_MUTEXES 1
+#define configUSE_RECURSIVE_MUTEXES 1
+#define configUSE_APPLICATION_TASK_TAG 0
+#define configUSE_COUNTING_SEMAPHORES 1
+#define configQUEUE_REGISTRY_SIZE 8
+#define configUSE_QUEUE_SETS 1
+#define configUSE_TIME_SLICING 1
+#define configUSE_NEWLIB_REENTRANT 0
+#define configENABLE_BACKWARD_COMPATIBILITY 1
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
+
+/* System */
+#define configSTACK_DEPTH_TYPE uint32_t
+#define configMESSAGE_BUFFER_LENGTH_TYPE size_t
+
+/* Memory allocation related definitions. */
+#define configSUPPORT_STATIC_ALLOCATION 1
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#define configTOTAL_HEAP_SIZE (16 * 1024 * 1024)
+#define configAPPLICATION_ALLOCATED_HEAP 0
+
+/* Same heap allocation count as the target's static memory builds */
+#if defined(STATIC_MEMORY) && STATIC_MEMORY && !defined(__ASSEMBLER__)
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern volatile uint32_t heapAllocationCount;
+extern volatile uint32_t heapAllocationLastSize;
+#ifdef __cplusplus
+}
+#endif
+#define traceMALLOC(pvAddress, uiSize)      \
+    do                                      \
+    {                                       \
+        if ((pvAddress) != NULL)            \
+        {                                   \
+            heapAllocationCount++;          \
+            heapAllocationLastSize = (uiSize); \
+        }                                   \
+    } while (0)
+#endif
+
+/* Hook function related definitions. Tasks run on pthread stacks, which the
+kernel cannot watch, so overflow checking is left to the target build. */
+#define configCHECK_FOR_STACK_OVERFLOW 0
+#define configUSE_MALLOC_FAILED_HOOK 1
+#define configUSE_DAEMON_TASK_STARTUP_HOOK 0
+
+/* Run time and task stats gathering related definitions. Same 1 MHz counter as
+the target so the diagnostics task reports comparable percentages. */
+#define configGENERATE_RUN_TIME_STATS 1
+#define configUSE_TRACE_FACILITY 1
+#define configUSE_STATS_FORMATTING_FUNCTIONS 0
+
+#if !defined(__ASSEMBLER__)
+#include "hardware/timer.h"
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() time_us_32()
+
+/* Co-routine related definitions. */
+#define configUSE_CO_ROUTINES 0
+#define configMAX_CO_ROUTINE_PRIORITIES 1
+
+/* Software timer related definitions. */
+#define configUSE_TIMERS 1
+#define configTIMER_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+#define configTIMER_QUEUE_LENGTH 10
+#define configTIMER_TASK_STACK_DEPTH 1024
+
+#define configNUMBER_OF_CORES 1
+
+#include <assert.h>
+#define configASSERT(x) assert(x)
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+#define INCLUDE_vTaskPrioritySet 1
+#define INCLUDE_uxTaskPriorityGet 1
+#define INCLUDE_vTaskDelete 1
+#define INCLUDE_vTaskSuspend 1
+#define INCLUDE_vTaskDelayUntil 1
+#define INCLUDE_vTaskDelay 1
+#define INCLUDE_xTaskGetSchedulerState 1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
+#define INCLUDE_xTaskGetIdleTaskHandle 1
+#define INCLUDE_eTaskGetState 1
+#define INCLUDE_xTimerPendFunctionCall 1
+#define INCLUDE_xTaskAbortDelay 1
+#define INCLUDE_xTaskGetHandle 1
+#define INCLUDE_xTaskResumeFromISR 1
+#define INCLUDE_xQueueGetMutexHolder 1
+
+#endif /* FREERTOS_CONFIG_H */
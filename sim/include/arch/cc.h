@@ -0,0 +1,32 @@
+#ifndef SIM_LWIP_ARCH_CC_H
+#define SIM_LWIP_ARCH_CC_H
+
+// lwIP compiler/platform glue for the host simulation build, used together with
+// the FreeRTOS sys_arch from lwIP's contrib/ports/freertos
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+// The host C library already provides struct timeval, errno values and fd_set
+#define LWIP_TIMEVAL_PRIVATE 0
+#define LWIP_ERRNO_STDINCLUDE 1
+
+typedef int sys_prot_t;
+
+#define LWIP_RAND() ((u32_t)rand())
+
+#define LWIP_PLATFORM_DIAG(x) \
+  do                          \
+  {                           \
+    printf x;                 \
+  } while (0)
+
+#define LWIP_PLATFORM_ASSERT(x)                                                \
+  do                                                                           \
+  {                                                                            \
+    printf("lwIP assertion \"%s\" failed at %s:%d\n", x, __FILE__, __LINE__); \
+    abort();                                                                   \
+  } while (0)
+
+#endif // SIM_LWIP_ARCH_CC_H
@@ -0,0 +1,18 @@
+#ifndef SIM_CYW43_CONFIG_H
+#define SIM_CYW43_CONFIG_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  uint32_t cyw43_hal_ticks_ms(void);
+  uint32_t cyw43_hal_ticks_us(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_CYW43_CONFIG_H
@@ -0,0 +1,34 @@
+#ifndef SIM_HARDWARE_CLOCKS_H
+#define SIM_HARDWARE_CLOCKS_H
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SIM_SYS_CLOCK_HZ 125000000u
+
+  enum clock_index
+  {
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_usb,
+    clk_adc,
+    clk_rtc,
+    CLK_COUNT
+  };
+
+  uint32_t clock_get_hz(enum clock_index clk_index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_CLOCKS_H
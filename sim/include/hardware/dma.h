@@ -0,0 +1,51 @@
+#ifndef SIM_HARDWARE_DMA_H
+#define SIM_HARDWARE_DMA_H
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define NUM_DMA_CHANNELS 12
+#define DREQ_SPI0_TX 16
+#define DREQ_SPI1_TX 18
+#define DREQ_FORCE 0x3F
+
+  enum dma_channel_transfer_size
+  {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+  };
+
+  typedef struct
+  {
+    enum dma_channel_transfer_size size;
+    bool readIncrement;
+    bool writeIncrement;
+    uint dreq;
+  } dma_channel_config;
+
+  int dma_claim_unused_channel(bool required);
+  void dma_channel_unclaim(uint channel);
+
+  dma_channel_config dma_channel_get_default_config(uint channel);
+  void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+  void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+  void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+  void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+
+  // Memory to memory, or into the SPI stand-in when paced by its TX DREQ. A
+  // triggered transfer completes before the call returns.
+  void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                             const volatile void *read_addr, uint transfer_count, bool trigger);
+  void dma_channel_wait_for_finish_blocking(uint channel);
+  bool dma_channel_is_busy(uint channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_DMA_H
@@ -0,0 +1,31 @@
+#ifndef SIM_HARDWARE_FLASH_H
+#define SIM_HARDWARE_FLASH_H
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#ifndef FLASH_SECTOR_SIZE
+#define FLASH_SECTOR_SIZE (1u << 12)
+#endif
+#define FLASH_BLOCK_SIZE (1u << 16)
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+
+  // XIP reads of the simulated flash land in a host buffer that is backed by the
+  // file named in SIM_FLASH_FILE, so settings survive a simulator restart
+  uintptr_t sim_flash_xip_base(void);
+#define XIP_BASE (sim_flash_xip_base())
+
+  void flash_range_erase(uint32_t flash_offs, size_t count);
+  void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+  void flash_get_unique_id(uint8_t *id_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_FLASH_H
@@ -0,0 +1,37 @@
+#ifndef SIM_HARDWARE_I2C_H
+#define SIM_HARDWARE_I2C_H
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct i2c_inst
+  {
+    uint index;
+    uint baudrate;
+  } i2c_inst_t;
+
+  extern i2c_inst_t i2c0_inst;
+  extern i2c_inst_t i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+
+  uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+  void i2c_deinit(i2c_inst_t *i2c);
+  uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+
+  // Transfers go to the simulated device registered at `addr`, and fail with
+  // PICO_ERROR_GENERIC (an address NACK) when there is none
+  int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+  int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+  int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us);
+  int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop, uint timeout_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_I2C_H
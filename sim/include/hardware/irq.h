@@ -0,0 +1,44 @@
+#ifndef SIM_HARDWARE_IRQ_H
+#define SIM_HARDWARE_IRQ_H
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// RP2040 interrupt numbers
+#define TIMER_IRQ_0 0
+#define TIMER_IRQ_1 1
+#define TIMER_IRQ_2 2
+#define TIMER_IRQ_3 3
+#define PWM_IRQ_WRAP 4
+#define USBCTRL_IRQ 5
+#define XIP_IRQ 6
+#define PIO0_IRQ_0 7
+#define PIO0_IRQ_1 8
+#define PIO1_IRQ_0 9
+#define PIO1_IRQ_1 10
+#define DMA_IRQ_0 11
+#define DMA_IRQ_1 12
+#define IO_IRQ_BANK0 13
+#define NUM_IRQS 32
+
+#define PICO_DEFAULT_IRQ_PRIORITY 0x80
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+  typedef void (*irq_handler_t)(void);
+
+  void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+  void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+  void irq_remove_handler(uint num, irq_handler_t handler);
+  void irq_set_enabled(uint num, bool enabled);
+  bool irq_is_enabled(uint num);
+  void irq_set_priority(uint num, uint8_t hardware_priority);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_IRQ_H
@@ -0,0 +1,100 @@
+#ifndef SIM_HARDWARE_PIO_H
+#define SIM_HARDWARE_PIO_H
+
+#include "pico.h"
+#include "hardware/gpio.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define NUM_PIOS 2
+#define NUM_PIO_STATE_MACHINES 4
+#define PIO_INSTRUCTION_COUNT 32
+
+  // Programs are not executed. Each state machine keeps its configuration so the
+  // simulated devices can find it by pin, and a receive FIFO they push into.
+  typedef struct pio_hw pio_hw_t;
+  typedef pio_hw_t *PIO;
+
+  extern pio_hw_t *const sim_pio0;
+  extern pio_hw_t *const sim_pio1;
+#define pio0 (sim_pio0)
+#define pio1 (sim_pio1)
+
+  typedef struct pio_program
+  {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+    uint8_t pio_version;
+  } pio_program_t;
+
+  enum pio_fifo_join
+  {
+    PIO_FIFO_JOIN_NONE = 0,
+    PIO_FIFO_JOIN_TX = 1,
+    PIO_FIFO_JOIN_RX = 2,
+  };
+
+  typedef struct
+  {
+    float clkdiv;
+    uint wrapTarget;
+    uint wrap;
+    uint sidesetBits;
+    bool sidesetOptional;
+    bool sidesetPindirs;
+    int sidesetBase;
+    int inBase;
+    int outBase;
+    uint outCount;
+    int setBase;
+    uint setCount;
+    int jmpPin;
+    enum pio_fifo_join fifoJoin;
+  } pio_sm_config;
+
+  pio_sm_config pio_get_default_sm_config(void);
+  void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap);
+  void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs);
+  void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base);
+  void sm_config_set_in_pins(pio_sm_config *c, uint in_base);
+  void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count);
+  void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count);
+  void sm_config_set_jmp_pin(pio_sm_config *c, uint pin);
+  void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold);
+  void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold);
+  void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join);
+  void sm_config_set_clkdiv(pio_sm_config *c, float div);
+  void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac);
+
+  bool pio_can_add_program(PIO pio, const pio_program_t *program);
+  uint pio_add_program(PIO pio, const pio_program_t *program);
+  void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset);
+  int pio_claim_unused_sm(PIO pio, bool required);
+  void pio_sm_claim(PIO pio, uint sm);
+  void pio_sm_unclaim(PIO pio, uint sm);
+  void pio_gpio_init(PIO pio, uint pin);
+  int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+  int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+  void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+  void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+  void pio_sm_clear_fifos(PIO pio, uint sm);
+  void pio_sm_restart(PIO pio, uint sm);
+
+  bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+  bool pio_sm_is_rx_fifo_full(PIO pio, uint sm);
+  uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+  uint32_t pio_sm_get(PIO pio, uint sm);
+  uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+  void pio_sm_put(PIO pio, uint sm, uint32_t data);
+  void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+  bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_PIO_H
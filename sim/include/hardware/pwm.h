@@ -0,0 +1,66 @@
+#ifndef SIM_HARDWARE_PWM_H
+#define SIM_HARDWARE_PWM_H
+
+#include "pico.h"
+#include "hardware/irq.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define NUM_PWM_SLICES 8
+#define PWM_CHAN_A 0
+#define PWM_CHAN_B 1
+
+  enum pwm_clkdiv_mode
+  {
+    PWM_DIV_FREE_RUNNING = 0,
+    PWM_DIV_B_HIGH = 1,
+    PWM_DIV_B_RISING = 2,
+    PWM_DIV_B_FALLING = 3,
+  };
+
+  typedef struct
+  {
+    uint32_t csr;
+    uint32_t div; // 8.4 fixed point, as in the hardware register
+    uint32_t top;
+  } pwm_config;
+
+  static inline uint pwm_gpio_to_slice_num(uint gpio)
+  {
+    return (gpio >> 1u) & 7u;
+  }
+
+  static inline uint pwm_gpio_to_channel(uint gpio)
+  {
+    return gpio & 1u;
+  }
+
+  pwm_config pwm_get_default_config(void);
+  void pwm_config_set_clkdiv(pwm_config *c, float div);
+  void pwm_config_set_clkdiv_int(pwm_config *c, uint div);
+  void pwm_config_set_clkdiv_mode(pwm_config *c, enum pwm_clkdiv_mode mode);
+  void pwm_config_set_phase_correct(pwm_config *c, bool phase_correct);
+  void pwm_config_set_wrap(pwm_config *c, uint16_t wrap);
+
+  void pwm_init(uint slice_num, pwm_config *c, bool start);
+  void pwm_set_enabled(uint slice_num, bool enabled);
+  void pwm_set_wrap(uint slice_num, uint16_t wrap);
+  void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level);
+  void pwm_set_both_levels(uint slice_num, uint16_t level_a, uint16_t level_b);
+  void pwm_set_gpio_level(uint gpio, uint16_t level);
+  void pwm_set_clkdiv(uint slice_num, float divider);
+  uint16_t pwm_get_counter(uint slice_num);
+
+  void pwm_set_irq_enabled(uint slice_num, bool enabled);
+  void pwm_set_irq_mask_enabled(uint32_t slice_mask, bool enabled);
+  void pwm_clear_irq(uint slice_num);
+  uint32_t pwm_get_irq_status_mask(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_PWM_H
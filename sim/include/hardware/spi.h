@@ -0,0 +1,70 @@
+#ifndef SIM_HARDWARE_SPI_H
+#define SIM_HARDWARE_SPI_H
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct spi_inst
+  {
+    uint index;
+    uint baudrate;
+  } spi_inst_t;
+
+  // Register block, only for DMA addressing and the receive drain after it.
+  // Writes to dr from code are not decoded, DMA paced by the TX DREQ is.
+  typedef struct
+  {
+    volatile uint32_t dr;
+    volatile uint32_t icr;
+  } spi_hw_t;
+
+#define SPI_SSPICR_RORIC_BITS 0x00000001u
+
+  extern spi_inst_t spi0_inst;
+  extern spi_inst_t spi1_inst;
+#define spi0 (&spi0_inst)
+#define spi1 (&spi1_inst)
+
+  typedef enum
+  {
+    SPI_CPHA_0 = 0,
+    SPI_CPHA_1 = 1
+  } spi_cpha_t;
+
+  typedef enum
+  {
+    SPI_CPOL_0 = 0,
+    SPI_CPOL_1 = 1
+  } spi_cpol_t;
+
+  typedef enum
+  {
+    SPI_LSB_FIRST = 0,
+    SPI_MSB_FIRST = 1
+  } spi_order_t;
+
+  uint spi_init(spi_inst_t *spi, uint baudrate);
+  void spi_deinit(spi_inst_t *spi);
+  uint spi_set_baudrate(spi_inst_t *spi, uint baudrate);
+  void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+
+  // Bytes written while the display's chip select is low are decoded by the
+  // simulated SSD1331; the D/C GPIO selects command or pixel data as on the panel
+  int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+  int spi_write16_blocking(spi_inst_t *spi, const uint16_t *src, size_t len);
+  int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len);
+
+  spi_hw_t *spi_get_hw(spi_inst_t *spi);
+  uint spi_get_dreq(spi_inst_t *spi, bool is_tx);
+  bool spi_is_busy(const spi_inst_t *spi);     // Transfers finish on the spot, never busy
+  bool spi_is_readable(const spi_inst_t *spi); // Nothing is ever received
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_SPI_H
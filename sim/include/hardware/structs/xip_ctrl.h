@@ -0,0 +1,33 @@
+#ifndef SIM_HARDWARE_STRUCTS_XIP_CTRL_H
+#define SIM_HARDWARE_STRUCTS_XIP_CTRL_H
+
+#include "hardware/flash.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define XIP_STAT_FLUSH_READY_BITS 0x00000001u
+
+  // There is no cache in front of the simulated flash, so a flush is always complete
+  typedef struct
+  {
+    volatile uint32_t ctrl;
+    volatile uint32_t flush;
+    volatile uint32_t stat;
+    volatile uint32_t ctr_hit;
+    volatile uint32_t ctr_acc;
+    volatile uint32_t stream_addr;
+    volatile uint32_t stream_ctr;
+    volatile uint32_t stream_fifo;
+  } xip_ctrl_hw_t;
+
+  extern xip_ctrl_hw_t sim_xip_ctrl;
+#define xip_ctrl_hw (&sim_xip_ctrl)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_STRUCTS_XIP_CTRL_H
@@ -0,0 +1,39 @@
+#ifndef SIM_HARDWARE_SYNC_H
+#define SIM_HARDWARE_SYNC_H
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  static inline void __dmb(void)
+  {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  }
+
+  static inline void __dsb(void)
+  {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  }
+
+  static inline void __isb(void)
+  {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  }
+
+  static inline void __sev(void) {}
+  static inline void __wfe(void) {}
+  static inline void __wfi(void) {}
+
+  // Simulated interrupts are delivered by a FreeRTOS task, so masking them is a
+  // kernel critical section
+  uint32_t save_and_disable_interrupts(void);
+  void restore_interrupts(uint32_t status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_SYNC_H
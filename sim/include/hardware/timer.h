@@ -0,0 +1,23 @@
+#ifndef SIM_HARDWARE_TIMER_H
+#define SIM_HARDWARE_TIMER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // Microseconds since the simulator started, from the host monotonic clock
+  uint64_t time_us_64(void);
+  uint32_t time_us_32(void);
+
+  void busy_wait_us_32(uint32_t delay_us);
+  void busy_wait_us(uint64_t delay_us);
+  void busy_wait_ms(uint32_t delay_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_TIMER_H
@@ -0,0 +1,25 @@
+#ifndef SIM_HARDWARE_WATCHDOG_H
+#define SIM_HARDWARE_WATCHDOG_H
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // A missed kick ends the simulator with SIM_EXIT_WATCHDOG so hangs fail CI runs,
+  // an explicit reboot re-executes the simulator with the same flash file
+  void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+  void watchdog_disable(void);
+  void watchdog_update(void);
+  bool watchdog_caused_reboot(void);
+  bool watchdog_enable_caused_reboot(void);
+  void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms);
+  uint32_t watchdog_get_time_remaining_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_WATCHDOG_H
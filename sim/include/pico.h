@@ -0,0 +1,71 @@
+#ifndef SIM_PICO_H
+#define SIM_PICO_H
+
+// Host simulation stand-in for the pico-sdk base header: common types, error
+// codes and the attribute macros the firmware and libraries use.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef unsigned int uint;
+
+  enum pico_error_codes
+  {
+    PICO_OK = 0,
+    PICO_ERROR_NONE = 0,
+    PICO_ERROR_GENERIC = -1,
+    PICO_ERROR_TIMEOUT = -2,
+    PICO_ERROR_NO_DATA = -3,
+    PICO_ERROR_NOT_PERMITTED = -4,
+    PICO_ERROR_INVALID_ARG = -5,
+    PICO_ERROR_IO = -6,
+    PICO_ERROR_BADAUTH = -7,
+    PICO_ERROR_CONNECT_FAILED = -8,
+    PICO_ERROR_INSUFFICIENT_RESOURCES = -9,
+  };
+
+#ifndef MIN
+#define MIN(a, b) ((b) > (a) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+#define __not_in_flash(group)
+#define __not_in_flash_func(func_name) func_name
+#define __time_critical_func(func_name) func_name
+#define __no_inline_not_in_flash_func(func_name) func_name
+#define __in_flash(group)
+#define __scratch_x(group)
+#define __scratch_y(group)
+#define __uninitialized_ram(group) group
+#define __packed __attribute__((packed))
+#define __aligned(x) __attribute__((aligned(x)))
+#define __force_inline inline __attribute__((always_inline))
+
+#define PICO_NO_HARDWARE 0
+#define PICO_PIO_VERSION 0
+#define PICO_RP2040 1
+
+  void panic(const char *fmt, ...) __attribute__((noreturn));
+#define hard_assert(x) ((x) ? (void)0 : panic("hard_assert failed: %s", #x))
+#define invalid_params_if(x, test) ((test) ? panic("invalid params: %s", #test) : (void)0)
+
+  static inline uint get_core_num(void)
+  {
+    return 0;
+  }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_PICO_H
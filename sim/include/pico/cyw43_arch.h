@@ -0,0 +1,104 @@
+#ifndef SIM_PICO_CYW43_ARCH_H
+#define SIM_PICO_CYW43_ARCH_H
+
+#include "pico.h"
+#include "cyw43_config.h"
+#include "lwip/netif.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define CYW43_ITF_STA 0
+#define CYW43_ITF_AP 1
+
+#define CYW43_AUTH_OPEN (0)
+#define CYW43_AUTH_WPA_TKIP_PSK (0x00200002)
+#define CYW43_AUTH_WPA2_AES_PSK (0x00400004)
+#define CYW43_AUTH_WPA2_MIXED_PSK (0x00400006)
+#define CYW43_AUTH_WPA3_SAE_AES_PSK (0x01000004)
+#define CYW43_AUTH_WPA3_WPA2_AES_PSK (0x01400004)
+
+#define CYW43_LINK_DOWN (0)
+#define CYW43_LINK_JOIN (1)
+#define CYW43_LINK_NOIP (2)
+#define CYW43_LINK_UP (3)
+#define CYW43_LINK_FAIL (-1)
+#define CYW43_LINK_NONET (-2)
+#define CYW43_LINK_BADAUTH (-3)
+
+#define CYW43_WL_GPIO_LED_PIN 0
+
+#define CYW43_CHANNEL_NONE (0xffffffff)
+#define CYW43_IOCTL_GET_CHANNEL (0x3a)
+
+  // Only the parts of the driver state the firmware touches
+  typedef struct _cyw43_t
+  {
+    struct netif netif[2];
+    int itf_state;
+    bool scan_active;
+  } cyw43_t;
+
+  extern cyw43_t cyw43_state;
+
+  typedef struct _cyw43_ev_scan_result_t
+  {
+    uint8_t bssid[6];
+    uint16_t channel;
+    uint8_t auth_mode;
+    int16_t rssi;
+    uint8_t ssid_len;
+    uint8_t ssid[33]; // NUL terminated in the simulator
+  } cyw43_ev_scan_result_t;
+
+  typedef struct _cyw43_wifi_scan_options_t
+  {
+    uint32_t version;
+    uint16_t action;
+    uint16_t _;
+    uint32_t ssid_len;
+    uint8_t ssid[32];
+    uint8_t bssid[6];
+    int16_t channel_num;
+    uint16_t channel_list[1];
+  } cyw43_wifi_scan_options_t;
+
+  // The simulated radio always finds the networks listed in SIM_WIFI_SCAN and
+  // joins any of them. Joining or starting the AP attaches that interface's netif
+  // to the host TAP device named in SIM_TAP, or to a sink when it is unset.
+  int cyw43_arch_init(void);
+  void cyw43_arch_deinit(void);
+  void cyw43_arch_enable_sta_mode(void);
+  void cyw43_arch_disable_sta_mode(void);
+  void cyw43_arch_enable_ap_mode(const char *ssid, const char *password, uint32_t auth);
+  void cyw43_arch_disable_ap_mode(void);
+  int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *pw, uint32_t auth, uint32_t timeout);
+  int cyw43_arch_wifi_connect_blocking(const char *ssid, const char *pw, uint32_t auth);
+  void cyw43_arch_lwip_begin(void);
+  void cyw43_arch_lwip_end(void);
+  void cyw43_arch_gpio_put(uint wl_gpio, bool value);
+  bool cyw43_arch_gpio_get(uint wl_gpio);
+
+  int cyw43_wifi_scan(cyw43_t *self, cyw43_wifi_scan_options_t *opts, void *env,
+                      int (*result_cb)(void *, const cyw43_ev_scan_result_t *));
+  bool cyw43_wifi_scan_active(cyw43_t *self);
+  int cyw43_wifi_link_status(cyw43_t *self, int itf);
+  int cyw43_tcpip_link_status(cyw43_t *self, int itf);
+  int cyw43_wifi_leave(cyw43_t *self, int itf);
+  // A join names the network's BSSID and channel to skip the scan, as a join
+  // from the cache does. It finishes before returning and fails when either
+  // does not match the entry in SIM_WIFI_SCAN, like an access point that moved.
+  int cyw43_wifi_join(cyw43_t *self, size_t ssid_len, const uint8_t *ssid, size_t key_len, const uint8_t *key,
+                      uint32_t auth_type, const uint8_t *bssid, uint32_t channel);
+  int cyw43_wifi_get_bssid(cyw43_t *self, uint8_t bssid[6]);
+  // Only CYW43_IOCTL_GET_CHANNEL is answered
+  int cyw43_ioctl(cyw43_t *self, uint32_t cmd, size_t len, uint8_t *buf, uint32_t iface);
+  int cyw43_wifi_pm(cyw43_t *self, uint32_t pm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_PICO_CYW43_ARCH_H
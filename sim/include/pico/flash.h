@@ -0,0 +1,18 @@
+#ifndef SIM_PICO_FLASH_H
+#define SIM_PICO_FLASH_H
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // The simulated flash is plain memory, so nothing has to be paused around the call
+  int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_PICO_FLASH_H
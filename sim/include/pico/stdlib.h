@@ -0,0 +1,23 @@
+#ifndef SIM_PICO_STDLIB_H
+#define SIM_PICO_STDLIB_H
+
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  bool stdio_init_all(void);
+
+  static inline void tight_loop_contents(void) {}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_PICO_STDLIB_H
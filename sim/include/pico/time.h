@@ -0,0 +1,59 @@
+#ifndef SIM_PICO_TIME_H
+#define SIM_PICO_TIME_H
+
+#include "pico.h"
+#include "hardware/timer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef uint64_t absolute_time_t;
+
+  static inline absolute_time_t get_absolute_time(void)
+  {
+    return time_us_64();
+  }
+
+  static inline uint64_t to_us_since_boot(absolute_time_t t)
+  {
+    return t;
+  }
+
+  static inline uint32_t to_ms_since_boot(absolute_time_t t)
+  {
+    return (uint32_t)(t / 1000);
+  }
+
+  static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us)
+  {
+    return t + us;
+  }
+
+  static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms)
+  {
+    return t + (uint64_t)ms * 1000;
+  }
+
+  static inline absolute_time_t make_timeout_time_ms(uint32_t ms)
+  {
+    return delayed_by_ms(get_absolute_time(), ms);
+  }
+
+  static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to)
+  {
+    return (int64_t)(to - from);
+  }
+
+  // Block the calling task like the SDK does with configSUPPORT_PICO_TIME_INTEROP,
+  // and fall back to a host sleep before the scheduler is running
+  void sleep_us(uint64_t us);
+  void sleep_ms(uint32_t ms);
+  void sleep_until(absolute_time_t target);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_PICO_TIME_H
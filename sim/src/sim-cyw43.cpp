@@ -0,0 +1,256 @@
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/tcpip.h"
+
+#define SIM_JOIN_TIME_MS 500
+#define SIM_DIRECTED_JOIN_TIME_MS 150 // No scan before the association
+#define SIM_SCAN_TIME_MS 1500
+#define SIM_DEFAULT_IP "192.168.10.2"
+#define SIM_DEFAULT_NETMASK "255.255.255.0"
+#define SIM_DEFAULT_GATEWAY "192.168.10.1"
+#define SIM_DEFAULT_SCAN "bench-sim:7:-48,workshop:7:-71,guest:0:-80"
+
+cyw43_t cyw43_state;
+
+static SemaphoreHandle_t lwipMutex = NULL;
+static bool staEnabled = false;
+static uint32_t scanEndMs = 0;
+static uint8_t joinedBssid[6];
+static uint8_t joinedChannel = 0;
+
+static void tcpipReady(void *arg)
+{
+  xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+int cyw43_arch_init(void)
+{
+  lwipMutex = xSemaphoreCreateRecursiveMutex();
+  SemaphoreHandle_t ready = xSemaphoreCreateBinary();
+  tcpip_init(tcpipReady, ready);
+  xSemaphoreTake(ready, portMAX_DELAY);
+  vSemaphoreDelete(ready);
+  return PICO_OK;
+}
+
+void cyw43_arch_deinit(void)
+{
+  simNetifDown(CYW43_ITF_STA);
+  simNetifDown(CYW43_ITF_AP);
+}
+
+void cyw43_arch_enable_sta_mode(void)
+{
+  staEnabled = true;
+}
+
+void cyw43_arch_disable_sta_mode(void)
+{
+  staEnabled = false;
+  simNetifDown(CYW43_ITF_STA);
+}
+
+void cyw43_arch_enable_ap_mode(const char *ssid, const char *password, uint32_t auth)
+{
+  printf("Simulator: access point \"%s\" up\n", ssid);
+  simNetifUp(CYW43_ITF_AP, "192.168.4.1", "255.255.255.0", "192.168.4.1");
+}
+
+void cyw43_arch_disable_ap_mode(void)
+{
+  simNetifDown(CYW43_ITF_AP);
+}
+
+// Channel the scan places `ssid` on, counting entries in SIM_WIFI_SCAN the same
+// way cyw43_wifi_scan() does. Networks not in the list sit on channel 1.
+static uint8_t networkChannel(const char *ssid)
+{
+  const char *list = getenv("SIM_WIFI_SCAN");
+  char entries[512];
+  strncpy(entries, list != NULL ? list : SIM_DEFAULT_SCAN, sizeof(entries) - 1);
+  entries[sizeof(entries) - 1] = '\0';
+
+  uint8_t channel = 1;
+  char *save = NULL;
+  for (char *entry = strtok_r(entries, ",", &save); entry != NULL; entry = strtok_r(NULL, ",", &save))
+  {
+    char name[33] = {0};
+    if (sscanf(entry, "%32[^:]", name) < 1)
+    {
+      continue;
+    }
+    if (strcmp(name, ssid) == 0)
+    {
+      return channel;
+    }
+    channel = channel % 11 + 1;
+  }
+  return 1;
+}
+
+static void joinNetwork(const char *ssid, uint8_t channel)
+{
+  const char *ip = getenv("SIM_IP");
+  const char *netmask = getenv("SIM_NETMASK");
+  const char *gateway = getenv("SIM_GATEWAY");
+  simNetifUp(CYW43_ITF_STA, ip != NULL ? ip : SIM_DEFAULT_IP, netmask != NULL ? netmask : SIM_DEFAULT_NETMASK,
+             gateway != NULL ? gateway : SIM_DEFAULT_GATEWAY);
+  memset(joinedBssid, 0, sizeof(joinedBssid));
+  joinedBssid[0] = 0x02;
+  joinedBssid[5] = channel;
+  joinedChannel = channel;
+  printf("Simulator: joined \"%s\" on channel %u\n", ssid, channel);
+}
+
+// Any network joins after a short delay. The station takes the static address in
+// SIM_IP (SIM_NETMASK, SIM_GATEWAY) instead of running DHCP against the host.
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *pw, uint32_t auth, uint32_t timeout)
+{
+  if (!staEnabled || ssid == NULL || ssid[0] == '\0')
+  {
+    return PICO_ERROR_GENERIC;
+  }
+  vTaskDelay(pdMS_TO_TICKS(SIM_JOIN_TIME_MS));
+  joinNetwork(ssid, networkChannel(ssid));
+  return PICO_OK;
+}
+
+int cyw43_arch_wifi_connect_blocking(const char *ssid, const char *pw, uint32_t auth)
+{
+  return cyw43_arch_wifi_connect_timeout_ms(ssid, pw, auth, 0);
+}
+
+void cyw43_arch_lwip_begin(void)
+{
+  xSemaphoreTakeRecursive(lwipMutex, portMAX_DELAY);
+}
+
+void cyw43_arch_lwip_end(void)
+{
+  xSemaphoreGiveRecursive(lwipMutex);
+}
+
+void cyw43_arch_gpio_put(uint wl_gpio, bool value)
+{
+}
+
+bool cyw43_arch_gpio_get(uint wl_gpio)
+{
+  return false; // VBUS sense reads as running from battery
+}
+
+// SIM_WIFI_SCAN lists `ssid:auth:rssi` entries separated by commas, auth in the
+// firmware's numbering (7 = WPA2). Results are delivered before the call returns
+// and the scan then reports active for as long as a real one would take.
+int cyw43_wifi_scan(cyw43_t *self, cyw43_wifi_scan_options_t *opts, void *env,
+                    int (*result_cb)(void *, const cyw43_ev_scan_result_t *))
+{
+  const char *list = getenv("SIM_WIFI_SCAN");
+  char entries[512];
+  strncpy(entries, list != NULL ? list : SIM_DEFAULT_SCAN, sizeof(entries) - 1);
+  entries[sizeof(entries) - 1] = '\0';
+
+  self->scan_active = true;
+  scanEndMs = xTaskGetTickCount() * portTICK_PERIOD_MS + SIM_SCAN_TIME_MS;
+  uint8_t channel = 1;
+  char *save = NULL;
+  for (char *entry = strtok_r(entries, ",", &save); entry != NULL; entry = strtok_r(NULL, ",", &save))
+  {
+    cyw43_ev_scan_result_t result = {};
+    char ssid[33] = {0};
+    int auth = 7;
+    int rssi = -60;
+    if (sscanf(entry, "%32[^:]:%d:%d", ssid, &auth, &rssi) < 1)
+    {
+      continue;
+    }
+    memcpy(result.ssid, ssid, sizeof(ssid));
+    result.ssid_len = (uint8_t)strlen(ssid);
+    result.auth_mode = (uint8_t)auth;
+    result.rssi = (int16_t)rssi;
+    result.channel = channel;
+    result.bssid[0] = 0x02;
+    result.bssid[5] = channel;
+    channel = channel % 11 + 1;
+    result_cb(env, &result);
+  }
+  return 0;
+}
+
+bool cyw43_wifi_scan_active(cyw43_t *self)
+{
+  if (self->scan_active && (int32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS - scanEndMs) >= 0)
+  {
+    self->scan_active = false;
+  }
+  return self->scan_active;
+}
+
+int cyw43_wifi_link_status(cyw43_t *self, int itf)
+{
+  return simNetifIsUp(itf) ? CYW43_LINK_JOIN : CYW43_LINK_DOWN;
+}
+
+int cyw43_tcpip_link_status(cyw43_t *self, int itf)
+{
+  return simNetifIsUp(itf) ? CYW43_LINK_UP : CYW43_LINK_DOWN;
+}
+
+int cyw43_wifi_leave(cyw43_t *self, int itf)
+{
+  simNetifDown(itf);
+  return 0;
+}
+
+int cyw43_wifi_join(cyw43_t *self, size_t ssid_len, const uint8_t *ssid, size_t key_len, const uint8_t *key,
+                    uint32_t auth_type, const uint8_t *bssid, uint32_t channel)
+{
+  char name[33] = {0};
+  memcpy(name, ssid, ssid_len < 32 ? ssid_len : 32);
+  if (!staEnabled || name[0] == '\0')
+  {
+    return PICO_ERROR_GENERIC;
+  }
+  vTaskDelay(pdMS_TO_TICKS(SIM_DIRECTED_JOIN_TIME_MS));
+  uint8_t expected = networkChannel(name);
+  if (bssid == NULL || bssid[5] != expected || (channel != CYW43_CHANNEL_NONE && channel != expected))
+  {
+    return PICO_ERROR_GENERIC;
+  }
+  joinNetwork(name, expected);
+  return 0;
+}
+
+int cyw43_wifi_get_bssid(cyw43_t *self, uint8_t bssid[6])
+{
+  if (!simNetifIsUp(CYW43_ITF_STA))
+  {
+    return PICO_ERROR_GENERIC;
+  }
+  memcpy(bssid, joinedBssid, sizeof(joinedBssid));
+  return 0;
+}
+
+int cyw43_ioctl(cyw43_t *self, uint32_t cmd, size_t len, uint8_t *buf, uint32_t iface)
+{
+  if (cmd != CYW43_IOCTL_GET_CHANNEL || len < sizeof(uint32_t) || !simNetifIsUp(CYW43_ITF_STA))
+  {
+    return PICO_ERROR_GENERIC;
+  }
+  uint32_t channel = joinedChannel;
+  memcpy(buf, &channel, sizeof(channel));
+  return 0;
+}
+
+int cyw43_wifi_pm(cyw43_t *self, uint32_t pm)
+{
+  return 0;
+}
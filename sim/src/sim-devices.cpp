@@ -0,0 +1,35 @@
+#include "sim.h"
+
+#include "hardware/timer.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Stands in for interrupt context: it runs above every firmware task, so pin
+// edges, FIFO pushes and wrap interrupts preempt the firmware as they would on
+// the chip, only at the device tick instead of the instant they happen.
+static void simDevicesTask(void *params)
+{
+  TickType_t lastWake = xTaskGetTickCount();
+  uint32_t lastStepMs = time_us_32() / 1000;
+  while (true)
+  {
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SIM_DEVICE_TICK_MS));
+    uint64_t nowUs = time_us_64();
+    uint32_t nowMs = (uint32_t)(nowUs / 1000);
+
+    simScriptApplyGpio();
+    simI2cStep(nowMs);
+    simPlantStep(nowMs - lastStepMs);
+    simEncoderStep();
+    simPwmServiceWrapIrq();
+    simNetifPoll();
+    simSsd1331Step(nowMs);
+    simWatchdogCheck(nowUs);
+    lastStepMs = nowMs;
+  }
+}
+
+void startSimDevices()
+{
+  xTaskCreate(simDevicesTask, "SimDevices", 4096, NULL, configMAX_PRIORITIES - 1, NULL);
+}
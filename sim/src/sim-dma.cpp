@@ -0,0 +1,95 @@
+#include "sim.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hardware/dma.h"
+#include "hardware/spi.h"
+
+static bool claimed[NUM_DMA_CHANNELS];
+
+int dma_claim_unused_channel(bool required)
+{
+  for (int channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+  {
+    if (!claimed[channel])
+    {
+      claimed[channel] = true;
+      return channel;
+    }
+  }
+  if (required)
+  {
+    printf("SIM: no free DMA channel\n");
+  }
+  return -1;
+}
+
+void dma_channel_unclaim(uint channel)
+{
+  claimed[channel] = false;
+}
+
+// Same defaults as the pico-sdk: 32-bit transfers, reads increment, writes do not
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+  dma_channel_config config;
+  config.size = DMA_SIZE_32;
+  config.readIncrement = true;
+  config.writeIncrement = false;
+  config.dreq = DREQ_FORCE;
+  return config;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+  c->size = size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+  c->readIncrement = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+  c->writeIncrement = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+  c->dreq = dreq;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+  if (!trigger)
+  {
+    return;
+  }
+  size_t size = (size_t)1 << config->size;
+  uint8_t *write = (uint8_t *)write_addr;
+  const uint8_t *read = (const uint8_t *)read_addr;
+  if (config->dreq == DREQ_SPI0_TX || config->dreq == DREQ_SPI1_TX)
+  {
+    // Byte transfers into the data register, as the SPI drivers set them up
+    spi_write_blocking(config->dreq == DREQ_SPI0_TX ? spi0 : spi1, read, transfer_count);
+    return;
+  }
+  for (uint i = 0; i < transfer_count; i++)
+  {
+    memcpy(write, read, size);
+    write += config->writeIncrement ? size : 0;
+    read += config->readIncrement ? size : 0;
+  }
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel)
+{
+}
+
+bool dma_channel_is_busy(uint channel)
+{
+  return false;
+}
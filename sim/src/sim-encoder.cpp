@@ -0,0 +1,14 @@
+#include "sim.h"
+
+#include <math.h>
+
+#include "constants.h"
+#include "encoder.h"
+
+// The decoder state machine pushes its count on every pass through encoder.pio.
+// Once per tick is often enough for a reader that drains the FIFO first.
+void simEncoderStep()
+{
+  float detents = simScriptValue("encoder", 0.0f);
+  simPioPushByInPin(ENCODER_CLK_GPIO, (uint32_t)(int32_t)lroundf(detents * ENCODER_COUNTS_PER_DETENT));
+}
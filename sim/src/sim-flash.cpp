@@ -0,0 +1,121 @@
+#include "sim.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "settings.h" // Before hardware/flash.h, which keeps its FLASH_SECTOR_SIZE
+#include "hardware/flash.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "pico/flash.h"
+
+static uint8_t flash[PICO_FLASH_SIZE_BYTES];
+static const char *flashPath = NULL;
+
+xip_ctrl_hw_t sim_xip_ctrl = {0, 0, XIP_STAT_FLUSH_READY_BITS, 0, 0, 0, 0, 0};
+
+uintptr_t sim_flash_xip_base(void)
+{
+  return (uintptr_t)flash;
+}
+
+uint8_t *simFlashMemory()
+{
+  return flash;
+}
+
+// Starts from erased flash (all 0xFF) and overlays the backing file when it exists
+bool simFlashLoad(const char *path)
+{
+  memset(flash, 0xFF, sizeof(flash));
+  flashPath = path;
+  if (path == NULL)
+  {
+    return true;
+  }
+  FILE *file = fopen(path, "rb");
+  if (file == NULL)
+  {
+    printf("Simulator: %s does not exist yet, starting with erased flash\n", path);
+    return true;
+  }
+  size_t read = fread(flash, 1, sizeof(flash), file);
+  fclose(file);
+  printf("Simulator: loaded %u bytes of flash from %s\n", (unsigned)read, path);
+  return true;
+}
+
+static void saveFlash()
+{
+  if (flashPath == NULL)
+  {
+    return;
+  }
+  FILE *file = fopen(flashPath, "wb");
+  if (file == NULL)
+  {
+    printf("Simulator: cannot write %s\n", flashPath);
+    return;
+  }
+  fwrite(flash, 1, sizeof(flash), file);
+  fclose(file);
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+  if (flash_offs % FLASH_SECTOR_SIZE != 0 || count % FLASH_SECTOR_SIZE != 0 || flash_offs + count > sizeof(flash))
+  {
+    panic("flash_range_erase: 0x%x + 0x%x is not sector aligned", (unsigned)flash_offs, (unsigned)count);
+  }
+  memset(flash + flash_offs, 0xFF, count);
+  saveFlash();
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+  if (flash_offs % FLASH_PAGE_SIZE != 0 || count % FLASH_PAGE_SIZE != 0 || flash_offs + count > sizeof(flash))
+  {
+    panic("flash_range_program: 0x%x + 0x%x is not page aligned", (unsigned)flash_offs, (unsigned)count);
+  }
+  // Programming can only clear bits, like NOR flash
+  for (size_t i = 0; i < count; i++)
+  {
+    flash[flash_offs + i] &= data[i];
+  }
+  saveFlash();
+}
+
+void flash_get_unique_id(uint8_t *id_out)
+{
+  static const uint8_t id[8] = {0x53, 0x49, 0x4D, 0x00, 0x00, 0x00, 0x00, 0x01};
+  memcpy(id_out, id, sizeof(id));
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms)
+{
+  func(param);
+  return PICO_OK;
+}
+
+// Writes Wi-Fi credentials into the stored settings so the firmware joins the
+// simulated network at boot instead of starting its access point
+void simFlashSeedWifi(const char *ssid, const char *password)
+{
+  Settings settings;
+  memcpy(&settings, flash + FLASH_TARGET_OFFSET, sizeof(settings));
+  if (settings.magic != SETTINGS_MAGIC)
+  {
+    memcpy(&settings, (const void *)&currentSettings, sizeof(settings));
+    settings.authMode = 7; // WPA2 in the firmware's own numbering
+    settings.magic = SETTINGS_MAGIC;
+  }
+  memset(settings.ssid, 0, sizeof(settings.ssid));
+  memset(settings.password, 0, sizeof(settings.password));
+  strncpy(settings.ssid, ssid, sizeof(settings.ssid) - 1);
+  strncpy(settings.password, password != NULL ? password : "", sizeof(settings.password) - 1);
+
+  uint8_t sector[FLASH_SECTOR_SIZE];
+  memcpy(sector, flash + FLASH_TARGET_OFFSET, sizeof(sector));
+  memcpy(sector, &settings, sizeof(settings));
+  flash_range_erase(FLASH_TARGET_OFFSET, FLASH_SECTOR_SIZE);
+  flash_range_program(FLASH_TARGET_OFFSET, sector, FLASH_SECTOR_SIZE);
+}
@@ -0,0 +1,210 @@
+#include "sim.h"
+
+#include "hardware/gpio.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+typedef struct
+{
+  enum gpio_function function;
+  bool output;
+  bool outLevel;
+  bool pullUp;
+  bool pullDown;
+  bool driven;     // An external device is driving the pin
+  bool drivenLevel;
+  bool lastLevel;  // Input level at the last edge check
+  uint32_t irqMask;
+} SimGpio;
+
+static SimGpio pins[NUM_BANK0_GPIOS];
+static gpio_irq_callback_t irqCallback = NULL;
+
+static bool pinLevel(const SimGpio &pin)
+{
+  if (pin.output)
+  {
+    return pin.outLevel;
+  }
+  if (pin.driven)
+  {
+    return pin.drivenLevel;
+  }
+  // Floating inputs read as their pull, and low without one
+  return pin.pullUp;
+}
+
+// Raises edge interrupts for a level change. Runs on the devices task, which
+// stands in for interrupt context.
+static void checkEdge(uint gpio)
+{
+  SimGpio &pin = pins[gpio];
+  bool level = pinLevel(pin);
+  if (level == pin.lastLevel)
+  {
+    return;
+  }
+  pin.lastLevel = level;
+  uint32_t events = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+  if ((pin.irqMask & events) && irqCallback != NULL)
+  {
+    irqCallback(gpio, events);
+  }
+}
+
+void gpio_init(uint gpio)
+{
+  if (gpio < NUM_BANK0_GPIOS)
+  {
+    pins[gpio].function = GPIO_FUNC_SIO;
+    pins[gpio].output = false;
+    pins[gpio].outLevel = false;
+    pins[gpio].lastLevel = pinLevel(pins[gpio]);
+  }
+}
+
+void gpio_deinit(uint gpio)
+{
+  gpio_set_function(gpio, GPIO_FUNC_NULL);
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn)
+{
+  if (gpio < NUM_BANK0_GPIOS)
+  {
+    pins[gpio].function = fn;
+  }
+}
+
+enum gpio_function gpio_get_function(uint gpio)
+{
+  return gpio < NUM_BANK0_GPIOS ? pins[gpio].function : GPIO_FUNC_NULL;
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+  if (gpio < NUM_BANK0_GPIOS)
+  {
+    pins[gpio].output = out;
+    pins[gpio].lastLevel = pinLevel(pins[gpio]);
+  }
+}
+
+bool gpio_is_dir_out(uint gpio)
+{
+  return gpio < NUM_BANK0_GPIOS && pins[gpio].output;
+}
+
+void gpio_put(uint gpio, bool value)
+{
+  if (gpio < NUM_BANK0_GPIOS)
+  {
+    pins[gpio].outLevel = value;
+  }
+}
+
+bool gpio_get(uint gpio)
+{
+  return gpio < NUM_BANK0_GPIOS && pinLevel(pins[gpio]);
+}
+
+bool gpio_get_out_level(uint gpio)
+{
+  return gpio < NUM_BANK0_GPIOS && pins[gpio].outLevel;
+}
+
+uint32_t gpio_get_all(void)
+{
+  uint32_t levels = 0;
+  for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++)
+  {
+    levels |= (uint32_t)pinLevel(pins[gpio]) << gpio;
+  }
+  return levels;
+}
+
+void gpio_set_pulls(uint gpio, bool up, bool down)
+{
+  if (gpio < NUM_BANK0_GPIOS)
+  {
+    pins[gpio].pullUp = up;
+    pins[gpio].pullDown = down;
+    pins[gpio].lastLevel = pinLevel(pins[gpio]);
+  }
+}
+
+void gpio_pull_up(uint gpio)
+{
+  gpio_set_pulls(gpio, true, false);
+}
+
+void gpio_pull_down(uint gpio)
+{
+  gpio_set_pulls(gpio, false, true);
+}
+
+void gpio_disable_pulls(uint gpio)
+{
+  gpio_set_pulls(gpio, false, false);
+}
+
+void gpio_set_input_enabled(uint gpio, bool enabled)
+{
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled)
+{
+  if (gpio < NUM_BANK0_GPIOS)
+  {
+    taskENTER_CRITICAL();
+    if (enabled)
+    {
+      pins[gpio].irqMask |= event_mask;
+    }
+    else
+    {
+      pins[gpio].irqMask &= ~event_mask;
+    }
+    pins[gpio].lastLevel = pinLevel(pins[gpio]);
+    taskEXIT_CRITICAL();
+  }
+}
+
+void gpio_set_irq_callback(gpio_irq_callback_t callback)
+{
+  irqCallback = callback;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback)
+{
+  gpio_set_irq_enabled(gpio, event_mask, enabled);
+  gpio_set_irq_callback(callback);
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask)
+{
+}
+
+void simGpioDrive(uint gpio, bool level)
+{
+  if (gpio < NUM_BANK0_GPIOS)
+  {
+    pins[gpio].driven = true;
+    pins[gpio].drivenLevel = level;
+    checkEdge(gpio);
+  }
+}
+
+void simGpioRelease(uint gpio)
+{
+  if (gpio < NUM_BANK0_GPIOS)
+  {
+    pins[gpio].driven = false;
+    checkEdge(gpio);
+  }
+}
+
+bool simGpioOutputLevel(uint gpio)
+{
+  return gpio < NUM_BANK0_GPIOS && pins[gpio].output && pins[gpio].outLevel;
+}
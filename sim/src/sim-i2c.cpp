@@ -0,0 +1,111 @@
+#include "sim.h"
+
+#include "hardware/i2c.h"
+#include "hardware/timer.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define SIM_I2C_MAX_DEVICES 8
+
+i2c_inst_t i2c0_inst = {0, 0};
+i2c_inst_t i2c1_inst = {1, 0};
+
+typedef struct
+{
+  uint8_t address;
+  SimI2cDevice *device;
+} SimI2cSlot;
+
+static SimI2cSlot devices[SIM_I2C_MAX_DEVICES];
+static int deviceCount = 0;
+
+void simI2cAttach(uint8_t address, SimI2cDevice *device)
+{
+  if (deviceCount < SIM_I2C_MAX_DEVICES)
+  {
+    devices[deviceCount].address = address;
+    devices[deviceCount].device = device;
+    deviceCount++;
+  }
+}
+
+static SimI2cDevice *deviceAt(uint8_t address)
+{
+  for (int i = 0; i < deviceCount; i++)
+  {
+    if (devices[i].address == address)
+    {
+      return devices[i].device;
+    }
+  }
+  return NULL;
+}
+
+// Time on the wire at the configured clock: 9 bits per byte plus the address byte
+static void busDelay(const i2c_inst_t *i2c, size_t len)
+{
+  uint baudrate = i2c->baudrate > 0 ? i2c->baudrate : 100000;
+  busy_wait_us((uint64_t)(len + 1) * 9 * 1000000 / baudrate);
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+  i2c->baudrate = baudrate;
+  return baudrate;
+}
+
+void i2c_deinit(i2c_inst_t *i2c)
+{
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+  i2c->baudrate = baudrate;
+  return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+  SimI2cDevice *device = deviceAt(addr);
+  busDelay(i2c, device != NULL ? len : 0);
+  if (device == NULL)
+  {
+    return PICO_ERROR_GENERIC;
+  }
+  taskENTER_CRITICAL();
+  int result = device->write(src, len, nostop);
+  taskEXIT_CRITICAL();
+  return result < 0 ? PICO_ERROR_GENERIC : result;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+  SimI2cDevice *device = deviceAt(addr);
+  busDelay(i2c, device != NULL ? len : 0);
+  if (device == NULL)
+  {
+    return PICO_ERROR_GENERIC;
+  }
+  taskENTER_CRITICAL();
+  int result = device->read(dst, len, nostop);
+  taskEXIT_CRITICAL();
+  return result < 0 ? PICO_ERROR_GENERIC : result;
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us)
+{
+  return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop, uint timeout_us)
+{
+  return i2c_read_blocking(i2c, addr, dst, len, nostop);
+}
+
+void simI2cStep(uint32_t nowMs)
+{
+  for (int i = 0; i < deviceCount; i++)
+  {
+    devices[i].device->step(nowMs);
+  }
+}
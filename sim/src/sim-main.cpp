@@ -0,0 +1,95 @@
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The firmware's main(), renamed by the build (see sim/CMakeLists.txt)
+int firmwareMain();
+
+static void usage(const char *program)
+{
+  printf("Usage: %s [--script file.csv] [--flash flash.bin] [--tap tap0] [--ssid name --password secret]\n"
+         "Each option can also be given in the environment: SIM_SCRIPT, SIM_FLASH_FILE, SIM_TAP,\n"
+         "SIM_WIFI_SSID and SIM_WIFI_PASSWORD. See sim/README.md for the rest.\n",
+         program);
+}
+
+int main(int argc, char **argv)
+{
+  const char *script = getenv("SIM_SCRIPT");
+  const char *flashFile = getenv("SIM_FLASH_FILE");
+  const char *tap = getenv("SIM_TAP");
+  const char *ssid = getenv("SIM_WIFI_SSID");
+  const char *password = getenv("SIM_WIFI_PASSWORD");
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (strcmp(argv[i], "--help") == 0 || value == NULL)
+    {
+      usage(argv[0]);
+      return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+    }
+    if (strcmp(argv[i], "--script") == 0)
+    {
+      script = value;
+    }
+    else if (strcmp(argv[i], "--flash") == 0)
+    {
+      flashFile = value;
+    }
+    else if (strcmp(argv[i], "--tap") == 0)
+    {
+      tap = value;
+    }
+    else if (strcmp(argv[i], "--ssid") == 0)
+    {
+      ssid = value;
+    }
+    else if (strcmp(argv[i], "--password") == 0)
+    {
+      password = value;
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+    i++;
+  }
+
+  // A watchdog reboot re-executes without arguments, keep them for the next run
+  if (script != NULL)
+  {
+    setenv("SIM_SCRIPT", script, 1);
+  }
+  if (flashFile != NULL)
+  {
+    setenv("SIM_FLASH_FILE", flashFile, 1);
+  }
+  if (tap != NULL)
+  {
+    setenv("SIM_TAP", tap, 1);
+  }
+
+  if (script != NULL && !simScriptLoad(script))
+  {
+    return 1;
+  }
+  simFlashLoad(flashFile);
+  if (ssid != NULL)
+  {
+    simFlashSeedWifi(ssid, password);
+    unsetenv("SIM_WIFI_SSID"); // Seed once, later runs keep whatever the firmware stored
+  }
+  if (tap != NULL && !simTapOpen(tap))
+  {
+    return 1;
+  }
+
+  initSimSensors();
+  initSimPlant();
+  startSimDevices();
+  return firmwareMain();
+}
@@ -0,0 +1,156 @@
+#include "sim.h"
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/etharp.h"
+#include "lwip/igmp.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcpip.h"
+#include "netif/ethernet.h"
+
+#define SIM_ETHERNET_MTU 1500
+#define SIM_FRAME_CAPACITY 1536
+#define SIM_FRAMES_PER_POLL 16
+
+// Same OUI as the CYW43439, the last byte tells the interfaces apart
+static const uint8_t macPrefix[5] = {0x28, 0xCD, 0xC1, 0x00, 0x00};
+
+static volatile bool interfaceUp[2] = {false, false};
+
+static err_t linkOutput(struct netif *netif, struct pbuf *p)
+{
+  static uint8_t frame[SIM_FRAME_CAPACITY];
+  if (p->tot_len > sizeof(frame))
+  {
+    return ERR_BUF;
+  }
+  pbuf_copy_partial(p, frame, p->tot_len, 0);
+  simTapWrite(frame, p->tot_len); // Without a TAP device frames go nowhere, like an unassociated radio
+  return ERR_OK;
+}
+
+static err_t igmpMacFilter(struct netif *netif, const ip4_addr_t *group, enum netif_mac_filter_action action)
+{
+  return ERR_OK; // The TAP device delivers every multicast frame
+}
+
+static err_t netifInit(struct netif *netif)
+{
+  int itf = netif == &cyw43_state.netif[CYW43_ITF_AP] ? CYW43_ITF_AP : CYW43_ITF_STA;
+  netif->name[0] = 'w';
+  netif->name[1] = (char)('0' + itf);
+  netif->mtu = SIM_ETHERNET_MTU;
+  netif->hwaddr_len = ETH_HWADDR_LEN;
+  memcpy(netif->hwaddr, macPrefix, sizeof(macPrefix));
+  netif->hwaddr[5] = (uint8_t)(itf + 1);
+  netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET | NETIF_FLAG_IGMP;
+  netif->output = etharp_output;
+  netif->linkoutput = linkOutput;
+  netif_set_igmp_mac_filter(netif, igmpMacFilter);
+  return ERR_OK;
+}
+
+typedef struct
+{
+  int itf;
+  bool up;
+  ip4_addr_t ip;
+  ip4_addr_t netmask;
+  ip4_addr_t gateway;
+  SemaphoreHandle_t done;
+} NetifChange;
+
+// netif_add and friends are core functions, so they run on the tcpip thread
+static void applyChange(void *arg)
+{
+  NetifChange *change = (NetifChange *)arg;
+  struct netif *netif = &cyw43_state.netif[change->itf];
+  if (change->up && !interfaceUp[change->itf])
+  {
+    netif_add(netif, &change->ip, &change->netmask, &change->gateway, NULL, netifInit, tcpip_input);
+    if (change->itf == CYW43_ITF_STA)
+    {
+      netif_set_default(netif);
+    }
+    netif_set_up(netif);
+    netif_set_link_up(netif);
+    interfaceUp[change->itf] = true;
+  }
+  else if (!change->up && interfaceUp[change->itf])
+  {
+    interfaceUp[change->itf] = false;
+    netif_set_link_down(netif);
+    netif_set_down(netif);
+    netif_remove(netif);
+  }
+  xSemaphoreGive(change->done);
+}
+
+static void changeInterface(NetifChange *change)
+{
+  change->done = xSemaphoreCreateBinary();
+  if (tcpip_callback(applyChange, change) == ERR_OK)
+  {
+    xSemaphoreTake(change->done, portMAX_DELAY);
+  }
+  vSemaphoreDelete(change->done);
+}
+
+void simNetifUp(int itf, const char *ip, const char *netmask, const char *gateway)
+{
+  NetifChange change = {};
+  change.itf = itf;
+  change.up = true;
+  ip4addr_aton(ip, &change.ip);
+  ip4addr_aton(netmask, &change.netmask);
+  ip4addr_aton(gateway, &change.gateway);
+  changeInterface(&change);
+}
+
+void simNetifDown(int itf)
+{
+  NetifChange change = {};
+  change.itf = itf;
+  change.up = false;
+  changeInterface(&change);
+}
+
+bool simNetifIsUp(int itf)
+{
+  return interfaceUp[itf];
+}
+
+// Every interface that is up sees every frame, ARP and IP drop what is not theirs
+void simNetifPoll()
+{
+  static uint8_t frame[SIM_FRAME_CAPACITY];
+  for (int i = 0; i < SIM_FRAMES_PER_POLL; i++)
+  {
+    int len = simTapRead(frame, sizeof(frame));
+    if (len <= 0)
+    {
+      return;
+    }
+    for (int itf = 0; itf < 2; itf++)
+    {
+      if (!interfaceUp[itf])
+      {
+        continue;
+      }
+      struct pbuf *p = pbuf_alloc(PBUF_RAW, (u16_t)len, PBUF_POOL);
+      if (p == NULL)
+      {
+        continue; // Pool exhausted, the frame is lost as on the radio
+      }
+      pbuf_take(p, frame, (u16_t)len);
+      struct netif *netif = &cyw43_state.netif[itf];
+      if (netif->input(p, netif) != ERR_OK)
+      {
+        pbuf_free(p);
+      }
+    }
+  }
+}
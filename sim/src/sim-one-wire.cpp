@@ -0,0 +1,103 @@
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "one_wire.h"
+
+// Replaces lib/onewire/source/one_wire.cpp. Each bus carries one DS18B20 whose
+// reading comes from the light bar model for the bar wired to that data pin.
+
+#define SIM_DS18B20_CONVERSION_MS 750
+
+static rom_address_t foundAddresses[1];
+
+One_wire::One_wire(uint data_pin, uint power_pin, bool power_polarity)
+    : _data_pin(data_pin), _parasite_pin(power_pin), _power_mosfet(power_pin != not_controllable),
+      _power_polarity(power_polarity), _last_discrepancy(0), _last_device(false)
+{
+}
+
+One_wire::~One_wire()
+{
+}
+
+void One_wire::init()
+{
+  gpio_init(_data_pin);
+  _parasite_power = false;
+}
+
+int One_wire::find_and_count_devices_on_bus()
+{
+  single_device_read_rom(foundAddresses[0]);
+  return simLightBarTemperature(_data_pin) == invalid_conversion ? 0 : 1;
+}
+
+rom_address_t &One_wire::get_address(int index)
+{
+  return foundAddresses[0];
+}
+
+void One_wire::single_device_read_rom(rom_address_t &rom_address)
+{
+  memset(rom_address.rom, 0, sizeof(rom_address.rom));
+  rom_address.rom[0] = FAMILY_CODE_DS18B20;
+  rom_address.rom[1] = (uint8_t)_data_pin;
+}
+
+int One_wire::convert_temperature(rom_address_t &address, bool wait, bool all)
+{
+  if (wait)
+  {
+    sleep_ms(SIM_DS18B20_CONVERSION_MS);
+    return 0;
+  }
+  return SIM_DS18B20_CONVERSION_MS;
+}
+
+uint64_t One_wire::to_uint64(rom_address_t &address)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < ROMSize; i++)
+  {
+    value |= (uint64_t)address.rom[i] << ((ROMSize - 1 - i) * 8);
+  }
+  return value;
+}
+
+float One_wire::temperature(rom_address_t &address, bool convert_to_fahrenheit)
+{
+  float celsius = simLightBarTemperature(_data_pin);
+  if (celsius == invalid_conversion)
+  {
+    return invalid_conversion;
+  }
+  // The DS18B20 reports in 1/16 degree steps at its default 12 bit resolution
+  celsius = (float)(int)(celsius * 16.0f) / 16.0f;
+  return convert_to_fahrenheit ? celsius * 9.0f / 5.0f + 32.0f : celsius;
+}
+
+bool One_wire::set_resolution(rom_address_t &address, unsigned int resolution)
+{
+  return resolution >= 9 && resolution <= 12;
+}
+
+rom_address_t One_wire::address_from_hex(const char *hex_address)
+{
+  rom_address_t address{};
+  char byte[3] = {0, 0, 0};
+  for (int i = 0; i < ROMSize && hex_address[i * 2] != '\0' && hex_address[i * 2 + 1] != '\0'; i++)
+  {
+    byte[0] = hex_address[i * 2];
+    byte[1] = hex_address[i * 2 + 1];
+    address.rom[i] = (uint8_t)strtoul(byte, NULL, 16);
+  }
+  return address;
+}
+
+bool One_wire::reset_check_for_device() const
+{
+  return simLightBarTemperature(_data_pin) != invalid_conversion;
+}
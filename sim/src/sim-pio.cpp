@@ -0,0 +1,302 @@
+#include "sim.h"
+
+#include "pico/time.h"
+#include "hardware/pio.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define SIM_PIO_FIFO_DEPTH 8 // Joined depth, unjoined FIFOs hold half
+
+typedef struct
+{
+  bool claimed;
+  bool enabled;
+  pio_sm_config config;
+  uint32_t fifo[SIM_PIO_FIFO_DEPTH];
+  uint fifoHead;
+  uint fifoCount;
+} SimStateMachine;
+
+struct pio_hw
+{
+  uint usedInstructions;
+  SimStateMachine sm[NUM_PIO_STATE_MACHINES];
+};
+
+static pio_hw_t pioBlocks[NUM_PIOS];
+pio_hw_t *const sim_pio0 = &pioBlocks[0];
+pio_hw_t *const sim_pio1 = &pioBlocks[1];
+
+pio_sm_config pio_get_default_sm_config(void)
+{
+  pio_sm_config c;
+  c.clkdiv = 1.0f;
+  c.wrapTarget = 0;
+  c.wrap = PIO_INSTRUCTION_COUNT - 1;
+  c.sidesetBits = 0;
+  c.sidesetOptional = false;
+  c.sidesetPindirs = false;
+  c.sidesetBase = -1;
+  c.inBase = -1;
+  c.outBase = -1;
+  c.outCount = 0;
+  c.setBase = -1;
+  c.setCount = 0;
+  c.jmpPin = -1;
+  c.fifoJoin = PIO_FIFO_JOIN_NONE;
+  return c;
+}
+
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap)
+{
+  c->wrapTarget = wrap_target;
+  c->wrap = wrap;
+}
+
+void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs)
+{
+  c->sidesetBits = bit_count;
+  c->sidesetOptional = optional;
+  c->sidesetPindirs = pindirs;
+}
+
+void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base)
+{
+  c->sidesetBase = (int)sideset_base;
+}
+
+void sm_config_set_in_pins(pio_sm_config *c, uint in_base)
+{
+  c->inBase = (int)in_base;
+}
+
+void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count)
+{
+  c->outBase = (int)out_base;
+  c->outCount = out_count;
+}
+
+void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count)
+{
+  c->setBase = (int)set_base;
+  c->setCount = set_count;
+}
+
+void sm_config_set_jmp_pin(pio_sm_config *c, uint pin)
+{
+  c->jmpPin = (int)pin;
+}
+
+void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold)
+{
+}
+
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold)
+{
+}
+
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join)
+{
+  c->fifoJoin = join;
+}
+
+void sm_config_set_clkdiv(pio_sm_config *c, float div)
+{
+  c->clkdiv = div;
+}
+
+void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac)
+{
+  c->clkdiv = (float)div_int + (float)div_frac / 256.0f;
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program)
+{
+  return pio->usedInstructions + program->length <= PIO_INSTRUCTION_COUNT;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program)
+{
+  if (!pio_can_add_program(pio, program))
+  {
+    panic("No program space");
+  }
+  uint offset = pio->usedInstructions;
+  pio->usedInstructions += program->length;
+  return offset;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset)
+{
+}
+
+int pio_claim_unused_sm(PIO pio, bool required)
+{
+  for (int sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++)
+  {
+    if (!pio->sm[sm].claimed)
+    {
+      pio->sm[sm].claimed = true;
+      return sm;
+    }
+  }
+  if (required)
+  {
+    panic("No PIO state machines are available");
+  }
+  return -1;
+}
+
+void pio_sm_claim(PIO pio, uint sm)
+{
+  pio->sm[sm].claimed = true;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm)
+{
+  pio->sm[sm].claimed = false;
+}
+
+void pio_gpio_init(PIO pio, uint pin)
+{
+  gpio_set_function(pin, pio == pio0 ? GPIO_FUNC_PIO0 : GPIO_FUNC_PIO1);
+}
+
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out)
+{
+  return PICO_OK;
+}
+
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config)
+{
+  SimStateMachine &machine = pio->sm[sm];
+  machine.enabled = false;
+  machine.config = *config;
+  machine.fifoHead = 0;
+  machine.fifoCount = 0;
+  return PICO_OK;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+  pio->sm[sm].enabled = enabled;
+}
+
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div)
+{
+  pio->sm[sm].config.clkdiv = div;
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm)
+{
+  taskENTER_CRITICAL();
+  pio->sm[sm].fifoCount = 0;
+  taskEXIT_CRITICAL();
+}
+
+void pio_sm_restart(PIO pio, uint sm)
+{
+}
+
+static uint fifoDepth(const SimStateMachine &machine)
+{
+  return machine.config.fifoJoin == PIO_FIFO_JOIN_RX ? SIM_PIO_FIFO_DEPTH : SIM_PIO_FIFO_DEPTH / 2;
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm)
+{
+  return pio->sm[sm].fifoCount == 0;
+}
+
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm)
+{
+  return pio->sm[sm].fifoCount >= fifoDepth(pio->sm[sm]);
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm)
+{
+  return pio->sm[sm].fifoCount;
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm)
+{
+  SimStateMachine &machine = pio->sm[sm];
+  uint32_t value = 0;
+  taskENTER_CRITICAL();
+  if (machine.fifoCount > 0)
+  {
+    value = machine.fifo[machine.fifoHead];
+    machine.fifoHead = (machine.fifoHead + 1) % SIM_PIO_FIFO_DEPTH;
+    machine.fifoCount--;
+  }
+  taskEXIT_CRITICAL();
+  return value;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm)
+{
+  while (pio_sm_is_rx_fifo_empty(pio, sm))
+  {
+    sleep_ms(1);
+  }
+  return pio_sm_get(pio, sm);
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data)
+{
+  // Transmit data has no consumer in the simulator
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm)
+{
+  return false;
+}
+
+static void pushByPin(uint gpio, bool jmpPin, uint32_t value)
+{
+  taskENTER_CRITICAL();
+  for (int block = 0; block < NUM_PIOS; block++)
+  {
+    for (int sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++)
+    {
+      SimStateMachine &machine = pioBlocks[block].sm[sm];
+      int pin = jmpPin ? machine.config.jmpPin : machine.config.inBase;
+      if (machine.enabled && pin == (int)gpio && machine.fifoCount < fifoDepth(machine))
+      {
+        machine.fifo[(machine.fifoHead + machine.fifoCount) % SIM_PIO_FIFO_DEPTH] = value;
+        machine.fifoCount++;
+      }
+    }
+  }
+  taskEXIT_CRITICAL();
+}
+
+void simPioPushByJmpPin(uint gpio, uint32_t value)
+{
+  pushByPin(gpio, true, value);
+}
+
+void simPioPushByInPin(uint gpio, uint32_t value)
+{
+  pushByPin(gpio, false, value);
+}
+
+float simPioClockDivByJmpPin(uint gpio)
+{
+  for (int block = 0; block < NUM_PIOS; block++)
+  {
+    for (int sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++)
+    {
+      const SimStateMachine &machine = pioBlocks[block].sm[sm];
+      if (machine.enabled && machine.config.jmpPin == (int)gpio)
+      {
+        return machine.config.clkdiv;
+      }
+    }
+  }
+  return 1.0f;
+}
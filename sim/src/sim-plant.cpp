@@ -0,0 +1,102 @@
+#include "sim.h"
+
+#include <math.h>
+
+#include "constants.h"
+#include "hardware/clocks.h"
+
+#define SIM_FAN_MAX_RPM 2400.0f
+#define SIM_FAN_DEAD_BAND 0.10f  // Duty below which the motor does not turn
+#define SIM_FAN_TAU_MS 1200.0f   // Spin-up and coast-down time constant
+#define SIM_FAN_PULSES_PER_REV 2 // Standard PC fan tachometer
+#define SIM_FAN_MIN_RPM 30.0f    // Below this the tach output stops toggling
+#define SIM_TACH_LOOP_OVERHEAD 4 // Cycles per period spent outside the counting loops, see src/tach.pio
+
+#define SIM_LIGHT_TAU_MS 240000.0f   // Heatsink time constant
+#define SIM_LIGHT_RISE_AT_FULL 35.0f // Steady state rise over ambient at 100% duty
+#define SIM_AMBIENT_TEMP 22.0f
+
+typedef struct
+{
+  uint pwmGpio;
+  uint sensorGpio;
+  const char *overrideChannel; // Script channel that replaces the model when present
+  float temperature;
+} SimLightBar;
+
+static float fanRpm = 0.0f;
+static float tachPhase = 0.0f; // Fraction of the current tach period already elapsed
+static SimLightBar lightBars[3] = {
+    {LIGHTS_A_PWM_GPIO, LIGHTS_A_TEMP_GPIO, "lights_a_temp", SIM_AMBIENT_TEMP},
+    {LIGHTS_B_PWM_GPIO, LIGHTS_B_TEMP_GPIO, "lights_b_temp", SIM_AMBIENT_TEMP},
+    {LIGHTS_C_PWM_GPIO, LIGHTS_C_TEMP_GPIO, "lights_c_temp", SIM_AMBIENT_TEMP},
+};
+
+void initSimPlant()
+{
+  float ambient = simScriptValue("booth_temp", SIM_AMBIENT_TEMP);
+  for (SimLightBar &bar : lightBars)
+  {
+    bar.temperature = ambient;
+  }
+}
+
+// First order fan: the speed settles towards a target set by duty above the dead
+// band. `fan_max_rpm` rescales the fan and `fan_stall` holds the rotor still.
+static void stepFan(uint32_t elapsedMs)
+{
+  float duty = simPwmDuty(EXTRACTOR_PWM_GPIO);
+  float maxRpm = simScriptValue("fan_max_rpm", SIM_FAN_MAX_RPM);
+  float targetRpm = duty <= SIM_FAN_DEAD_BAND ? 0.0f : maxRpm * (duty - SIM_FAN_DEAD_BAND) / (1.0f - SIM_FAN_DEAD_BAND);
+  if (simScriptValue("fan_stall", 0.0f) != 0.0f)
+  {
+    targetRpm = 0.0f;
+    fanRpm = 0.0f;
+  }
+  fanRpm += (targetRpm - fanRpm) * (1.0f - expf(-(float)elapsedMs / SIM_FAN_TAU_MS));
+
+  if (fanRpm < SIM_FAN_MIN_RPM)
+  {
+    tachPhase = 0.0f;
+    return;
+  }
+
+  // Emit one tach period per completed pulse, measured the way tach.pio counts it
+  float periodS = 60.0f / (fanRpm * SIM_FAN_PULSES_PER_REV);
+  tachPhase += ((float)elapsedMs / 1000.0f) / periodS;
+  float cycles = periodS * (float)clock_get_hz(clk_sys) / simPioClockDivByJmpPin(EXTRACTOR_TACH_GPIO);
+  while (tachPhase >= 1.0f)
+  {
+    tachPhase -= 1.0f;
+    simPioPushByJmpPin(EXTRACTOR_TACH_GPIO, (uint32_t)((cycles - SIM_TACH_LOOP_OVERHEAD) / 2.0f));
+  }
+}
+
+static void stepLightBars(uint32_t elapsedMs)
+{
+  float ambient = simScriptValue("booth_temp", SIM_AMBIENT_TEMP);
+  float alpha = 1.0f - expf(-(float)elapsedMs / SIM_LIGHT_TAU_MS);
+  for (SimLightBar &bar : lightBars)
+  {
+    float target = ambient + SIM_LIGHT_RISE_AT_FULL * simPwmDuty(bar.pwmGpio);
+    bar.temperature += (target - bar.temperature) * alpha;
+  }
+}
+
+void simPlantStep(uint32_t elapsedMs)
+{
+  stepFan(elapsedMs);
+  stepLightBars(elapsedMs);
+}
+
+float simLightBarTemperature(uint dataGpio)
+{
+  for (const SimLightBar &bar : lightBars)
+  {
+    if (bar.sensorGpio == dataGpio)
+    {
+      return simScriptValue(bar.overrideChannel, bar.temperature);
+    }
+  }
+  return -1000.0f;
+}
@@ -0,0 +1,175 @@
+#include "sim.h"
+
+#include "hardware/pwm.h"
+#include "hardware/irq.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+typedef struct
+{
+  bool enabled;
+  uint32_t top;
+  uint32_t level[2];
+  uint32_t div; // 8.4 fixed point
+} SimPwmSlice;
+
+static SimPwmSlice slices[NUM_PWM_SLICES];
+static volatile uint32_t irqEnabledMask = 0;
+static volatile uint32_t irqStatusMask = 0;
+
+pwm_config pwm_get_default_config(void)
+{
+  pwm_config config;
+  config.csr = 0;
+  config.div = 1 << 4;
+  config.top = 0xffff;
+  return config;
+}
+
+void pwm_config_set_clkdiv(pwm_config *c, float div)
+{
+  c->div = (uint32_t)(div * 16.0f);
+}
+
+void pwm_config_set_clkdiv_int(pwm_config *c, uint div)
+{
+  c->div = div << 4;
+}
+
+void pwm_config_set_clkdiv_mode(pwm_config *c, enum pwm_clkdiv_mode mode)
+{
+}
+
+void pwm_config_set_phase_correct(pwm_config *c, bool phase_correct)
+{
+}
+
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap)
+{
+  c->top = wrap;
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start)
+{
+  if (slice_num < NUM_PWM_SLICES)
+  {
+    slices[slice_num].top = c->top;
+    slices[slice_num].div = c->div;
+    slices[slice_num].level[0] = 0;
+    slices[slice_num].level[1] = 0;
+    slices[slice_num].enabled = start;
+  }
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled)
+{
+  if (slice_num < NUM_PWM_SLICES)
+  {
+    slices[slice_num].enabled = enabled;
+  }
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap)
+{
+  if (slice_num < NUM_PWM_SLICES)
+  {
+    slices[slice_num].top = wrap;
+  }
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level)
+{
+  if (slice_num < NUM_PWM_SLICES && chan < 2)
+  {
+    slices[slice_num].level[chan] = level;
+  }
+}
+
+void pwm_set_both_levels(uint slice_num, uint16_t level_a, uint16_t level_b)
+{
+  pwm_set_chan_level(slice_num, PWM_CHAN_A, level_a);
+  pwm_set_chan_level(slice_num, PWM_CHAN_B, level_b);
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level)
+{
+  pwm_set_chan_level(pwm_gpio_to_slice_num(gpio), pwm_gpio_to_channel(gpio), level);
+}
+
+void pwm_set_clkdiv(uint slice_num, float divider)
+{
+  if (slice_num < NUM_PWM_SLICES)
+  {
+    slices[slice_num].div = (uint32_t)(divider * 16.0f);
+  }
+}
+
+uint16_t pwm_get_counter(uint slice_num)
+{
+  return 0;
+}
+
+void pwm_set_irq_enabled(uint slice_num, bool enabled)
+{
+  pwm_set_irq_mask_enabled(1u << slice_num, enabled);
+}
+
+void pwm_set_irq_mask_enabled(uint32_t slice_mask, bool enabled)
+{
+  taskENTER_CRITICAL();
+  if (enabled)
+  {
+    irqEnabledMask |= slice_mask;
+  }
+  else
+  {
+    irqEnabledMask &= ~slice_mask;
+  }
+  taskEXIT_CRITICAL();
+}
+
+void pwm_clear_irq(uint slice_num)
+{
+  taskENTER_CRITICAL();
+  irqStatusMask &= ~(1u << slice_num);
+  taskEXIT_CRITICAL();
+}
+
+uint32_t pwm_get_irq_status_mask(void)
+{
+  return irqStatusMask & irqEnabledMask;
+}
+
+float simPwmDuty(uint gpio)
+{
+  const SimPwmSlice &slice = slices[pwm_gpio_to_slice_num(gpio)];
+  if (!slice.enabled)
+  {
+    return 0.0f;
+  }
+  // Level top + 1 is 100%, as on the hardware
+  uint32_t level = slice.level[pwm_gpio_to_channel(gpio)];
+  return level > slice.top ? 1.0f : (float)level / (float)(slice.top + 1);
+}
+
+void simPwmServiceWrapIrq()
+{
+  // The hardware wraps at kHz rates, far above the device tick. One wrap per tick
+  // keeps handlers such as the light dither exercised at a rate the host can carry.
+  uint32_t wrapped = 0;
+  for (uint i = 0; i < NUM_PWM_SLICES; i++)
+  {
+    if (slices[i].enabled)
+    {
+      wrapped |= 1u << i;
+    }
+  }
+  taskENTER_CRITICAL();
+  irqStatusMask |= wrapped;
+  bool pending = (irqStatusMask & irqEnabledMask) != 0;
+  taskEXIT_CRITICAL();
+  if (pending)
+  {
+    simIrqDispatch(PWM_IRQ_WRAP);
+  }
+}
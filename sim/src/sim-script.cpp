@@ -0,0 +1,111 @@
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "pico/time.h"
+
+typedef struct
+{
+  float timeS;
+  float value;
+} ScriptPoint;
+
+static std::map<std::string, std::vector<ScriptPoint>> channels;
+
+bool simScriptLoad(const char *path)
+{
+  FILE *file = fopen(path, "r");
+  if (file == NULL)
+  {
+    printf("Simulator: cannot open script %s\n", path);
+    return false;
+  }
+
+  char line[256];
+  int lineNumber = 0;
+  while (fgets(line, sizeof(line), file) != NULL)
+  {
+    lineNumber++;
+    char *start = line + strspn(line, " \t");
+    if (*start == '#' || *start == '\n' || *start == '\0')
+    {
+      continue;
+    }
+    float timeS = 0.0f;
+    char channel[64];
+    float value = 0.0f;
+    if (sscanf(start, "%f , %63[^, ] , %f", &timeS, channel, &value) != 3)
+    {
+      printf("Simulator: %s:%d is not `time_s,channel,value`, skipped\n", path, lineNumber);
+      continue;
+    }
+    std::vector<ScriptPoint> &points = channels[channel];
+    // Keep each channel sorted so a script may list its channels in any order
+    auto at = points.end();
+    while (at != points.begin() && (at - 1)->timeS > timeS)
+    {
+      --at;
+    }
+    points.insert(at, ScriptPoint{timeS, value});
+  }
+  fclose(file);
+  printf("Simulator: loaded %d script channels from %s\n", (int)channels.size(), path);
+  return true;
+}
+
+bool simScriptHas(const char *channel)
+{
+  return channels.find(channel) != channels.end();
+}
+
+static float sample(const std::vector<ScriptPoint> &points, float nowS, bool interpolate)
+{
+  if (nowS <= points.front().timeS)
+  {
+    return points.front().value;
+  }
+  for (size_t i = 1; i < points.size(); i++)
+  {
+    if (nowS < points[i].timeS)
+    {
+      const ScriptPoint &a = points[i - 1];
+      const ScriptPoint &b = points[i];
+      if (!interpolate || b.timeS <= a.timeS)
+      {
+        return a.value;
+      }
+      return a.value + (b.value - a.value) * (nowS - a.timeS) / (b.timeS - a.timeS);
+    }
+  }
+  return points.back().value;
+}
+
+float simScriptValue(const char *channel, float fallback)
+{
+  auto found = channels.find(channel);
+  if (found == channels.end() || found->second.empty())
+  {
+    return fallback;
+  }
+  return sample(found->second, (float)time_us_64() / 1e6f, true);
+}
+
+void simScriptApplyGpio()
+{
+  float nowS = (float)time_us_64() / 1e6f;
+  for (const auto &channel : channels)
+  {
+    if (channel.first.compare(0, 4, "gpio") != 0 || channel.second.empty())
+    {
+      continue;
+    }
+    uint gpio = (uint)atoi(channel.first.c_str() + 4);
+    simGpioDrive(gpio, sample(channel.second, nowS, false) != 0.0f);
+  }
+}
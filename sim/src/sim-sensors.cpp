@@ -0,0 +1,262 @@
+#include "sim.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "constants.h"
+
+#define SIM_DEFAULT_LUX 800.0f
+#define SIM_DEFAULT_BOOTH_TEMP 22.0f
+#define SIM_DEFAULT_BOOTH_HUMIDITY 45.0f
+
+// MAX44009 ambient light sensor. Register map and interrupt behaviour follow the
+// datasheet: the threshold timer counts in 100 ms steps, the INT pin is pulled
+// low while the status bit is set and reading the status register clears it.
+class SimMax44009 : public SimI2cDevice
+{
+public:
+  int write(const uint8_t *src, size_t len, bool nostop) override
+  {
+    if (len == 0)
+    {
+      return 0;
+    }
+    pointer = src[0] & 0x07;
+    for (size_t i = 1; i < len; i++)
+    {
+      writeRegister(pointer, src[i]);
+      pointer = (pointer + 1) & 0x07;
+    }
+    return (int)len;
+  }
+
+  int read(uint8_t *dst, size_t len, bool nostop) override
+  {
+    for (size_t i = 0; i < len; i++)
+    {
+      dst[i] = readRegister(pointer);
+      pointer = (pointer + 1) & 0x07;
+    }
+    return (int)len;
+  }
+
+  void step(uint32_t nowMs) override
+  {
+    if (nowMs - lastConversionMs >= conversionMs())
+    {
+      lastConversionMs = nowMs;
+      float lux = simScriptValue("lux", SIM_DEFAULT_LUX);
+      encodeLux(lux);
+      updateThreshold(lux, nowMs);
+    }
+    updateInterruptPin();
+  }
+
+private:
+  uint8_t pointer = 0;
+  uint8_t status = 0;
+  uint8_t interruptEnable = 0;
+  uint8_t config = 0x03;
+  uint8_t luxHigh = 0;
+  uint8_t luxLow = 0;
+  uint8_t upperThreshold = 0xFF;
+  uint8_t lowerThreshold = 0x00;
+  uint8_t thresholdTimer = 0xFF;
+  uint32_t lastConversionMs = 0;
+  uint32_t outsideSinceMs = 0;
+  bool outside = false;
+
+  uint32_t conversionMs() const
+  {
+    // Continuous mode converts once per integration time, otherwise every 800 ms
+    static const uint32_t integrationMs[8] = {800, 400, 200, 100, 50, 25, 12, 6};
+    if (!(config & 0x80))
+    {
+      return 800;
+    }
+    return (config & 0x40) ? integrationMs[config & 0x07] : 100;
+  }
+
+  uint8_t readRegister(uint8_t reg)
+  {
+    switch (reg)
+    {
+    case 0x00:
+    {
+      uint8_t value = status;
+      status = 0;
+      updateInterruptPin();
+      return value;
+    }
+    case 0x01:
+      return interruptEnable;
+    case 0x02:
+      return config;
+    case 0x03:
+      return luxHigh;
+    case 0x04:
+      return luxLow;
+    case 0x05:
+      return upperThreshold;
+    case 0x06:
+      return lowerThreshold;
+    default:
+      return thresholdTimer;
+    }
+  }
+
+  void writeRegister(uint8_t reg, uint8_t value)
+  {
+    switch (reg)
+    {
+    case 0x01:
+      interruptEnable = value & 0x01;
+      break;
+    case 0x02:
+      config = value;
+      break;
+    case 0x05:
+      upperThreshold = value;
+      break;
+    case 0x06:
+      lowerThreshold = value;
+      break;
+    case 0x07:
+      thresholdTimer = value;
+      break;
+    default:
+      break; // Status and lux registers are read only
+    }
+  }
+
+  void encodeLux(float lux)
+  {
+    uint32_t counts = lux > 0.0f ? (uint32_t)(lux / 0.045f) : 0;
+    uint8_t exponent = 0;
+    while (counts > 0xFF && exponent < 14)
+    {
+      counts >>= 1;
+      exponent++;
+    }
+    if (counts > 0xFF)
+    {
+      counts = 0xFF;
+    }
+    luxHigh = (uint8_t)((exponent << 4) | (counts >> 4));
+    luxLow = (uint8_t)(counts & 0x0F);
+  }
+
+  static float thresholdLux(uint8_t value, uint8_t lowBits)
+  {
+    uint32_t mantissa = ((value & 0x0F) << 4) | lowBits;
+    return (float)(mantissa << (value >> 4)) * 0.045f;
+  }
+
+  void updateThreshold(float lux, uint32_t nowMs)
+  {
+    bool isOutside = lux > thresholdLux(upperThreshold, 0x0F) || lux < thresholdLux(lowerThreshold, 0x00);
+    if (!isOutside)
+    {
+      outside = false;
+      return;
+    }
+    if (!outside)
+    {
+      outside = true;
+      outsideSinceMs = nowMs;
+    }
+    if (nowMs - outsideSinceMs >= (uint32_t)thresholdTimer * 100)
+    {
+      status = 0x01;
+    }
+  }
+
+  void updateInterruptPin()
+  {
+    if ((status & 0x01) && interruptEnable)
+    {
+      simGpioDrive(MAX44009_INT_GPIO, false);
+    }
+    else
+    {
+      simGpioRelease(MAX44009_INT_GPIO); // Open drain, the pull-up takes it high
+    }
+  }
+};
+
+// SHT30 humidity and temperature sensor, single shot commands only. A read
+// before a measurement has been started is NACKed like on the real part.
+class SimSht30 : public SimI2cDevice
+{
+public:
+  int write(const uint8_t *src, size_t len, bool nostop) override
+  {
+    if (len < 2)
+    {
+      return -1;
+    }
+    uint16_t command = (uint16_t)((src[0] << 8) | src[1]);
+    if ((command & 0xFF00) == 0x2C00 || (command & 0xFF00) == 0x2400)
+    {
+      measure();
+    }
+    return (int)len;
+  }
+
+  int read(uint8_t *dst, size_t len, bool nostop) override
+  {
+    if (!measurementReady)
+    {
+      return -1;
+    }
+    memcpy(dst, measurement, len < sizeof(measurement) ? len : sizeof(measurement));
+    measurementReady = false;
+    return (int)len;
+  }
+
+  void step(uint32_t nowMs) override
+  {
+  }
+
+private:
+  uint8_t measurement[6];
+  bool measurementReady = false;
+
+  static uint8_t crc8(const uint8_t *data, int len)
+  {
+    uint8_t crc = 0xFF;
+    for (int i = 0; i < len; i++)
+    {
+      crc ^= data[i];
+      for (int bit = 0; bit < 8; bit++)
+      {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+      }
+    }
+    return crc;
+  }
+
+  void measure()
+  {
+    float temperature = simScriptValue("booth_temp", SIM_DEFAULT_BOOTH_TEMP);
+    float humidity = simScriptValue("booth_humidity", SIM_DEFAULT_BOOTH_HUMIDITY);
+    uint16_t rawTemperature = (uint16_t)(fminf(fmaxf((temperature + 45.0f) / 175.0f, 0.0f), 1.0f) * 65535.0f);
+    uint16_t rawHumidity = (uint16_t)(fminf(fmaxf(humidity / 100.0f, 0.0f), 1.0f) * 65535.0f);
+    measurement[0] = rawTemperature >> 8;
+    measurement[1] = rawTemperature & 0xFF;
+    measurement[2] = crc8(measurement, 2);
+    measurement[3] = rawHumidity >> 8;
+    measurement[4] = rawHumidity & 0xFF;
+    measurement[5] = crc8(measurement + 3, 2);
+    measurementReady = true;
+  }
+};
+
+static SimMax44009 max44009;
+static SimSht30 sht30;
+
+void initSimSensors()
+{
+  simI2cAttach(MAX44009_I2C_ADDR, &max44009);
+  simI2cAttach(SHT30_I2C_ADDR, &sht30);
+}
@@ -0,0 +1,487 @@
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "constants.h"
+#include "hardware/gpio.h"
+#include "hardware/spi.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define SIM_SSD1331_WIDTH 96
+#define SIM_SSD1331_HEIGHT 64
+#define SIM_SSD1331_MAX_ARGS 10
+#define SIM_FRAME_DEFAULT_INTERVAL_MS 100
+
+spi_inst_t spi0_inst = {0, 0};
+spi_inst_t spi1_inst = {1, 0};
+static spi_hw_t spiHw[2];
+
+// Panel state, only touched from the task doing the SPI transfer
+static uint16_t frame[SIM_SSD1331_HEIGHT][SIM_SSD1331_WIDTH]; // RGB565
+static uint8_t columnStart = 0;
+static uint8_t columnEnd = SIM_SSD1331_WIDTH - 1;
+static uint8_t rowStart = 0;
+static uint8_t rowEnd = SIM_SSD1331_HEIGHT - 1;
+static uint8_t column = 0;
+static uint8_t row = 0;
+static uint8_t remap = 0x32;
+static bool fillEnabled = false;
+static bool displayOn = false;
+static uint8_t command = 0;
+static uint8_t args[SIM_SSD1331_MAX_ARGS];
+static int argCount = 0;
+static int argsExpected = 0;
+static int pendingHighByte = -1; // First byte of a 16bpp pixel
+static volatile bool dirty = false;
+
+static uint32_t framesWritten = 0;
+static uint32_t lastFrameMs = 0;
+
+static bool is16Bit()
+{
+  return (remap & 0x40) != 0;
+}
+
+static int commandArgCount(uint8_t cmd)
+{
+  switch (cmd)
+  {
+  case 0x15: // Column address
+  case 0x75: // Row address
+    return 2;
+  case 0x21: // Draw line
+    return 7;
+  case 0x22: // Draw rectangle
+    return 10;
+  case 0x23: // Copy
+    return 6;
+  case 0x24: // Dim window
+  case 0x25: // Clear window
+    return 4;
+  case 0x27: // Continuous scrolling setup
+    return 5;
+  case 0x2E: // Deactivate scrolling
+  case 0x2F: // Activate scrolling
+  case 0xA4: // Normal display
+  case 0xA5: // Entire display on
+  case 0xA6: // Entire display off
+  case 0xA7: // Inverse display
+  case 0xAC: // Dim mode on
+  case 0xAE: // Display off
+  case 0xAF: // Display on
+  case 0xE3: // NOP
+    return 0;
+  case 0xAB: // Dim mode setting
+    return 5;
+  default:
+    return 1;
+  }
+}
+
+// Colour components in the command stream are R and B in 6 bit units like G
+static uint16_t commandColour(uint8_t r, uint8_t g, uint8_t b)
+{
+  return (uint16_t)(((r >> 1) & 0x1F) << 11 | (g & 0x3F) << 5 | ((b >> 1) & 0x1F));
+}
+
+static void putPixel(int x, int y, uint16_t colour)
+{
+  if (x >= 0 && x < SIM_SSD1331_WIDTH && y >= 0 && y < SIM_SSD1331_HEIGHT)
+  {
+    frame[y][x] = colour;
+  }
+}
+
+static void drawLine(int x0, int y0, int x1, int y1, uint16_t colour)
+{
+  int dx = abs(x1 - x0);
+  int dy = -abs(y1 - y0);
+  int sx = x0 < x1 ? 1 : -1;
+  int sy = y0 < y1 ? 1 : -1;
+  int err = dx + dy;
+  while (true)
+  {
+    putPixel(x0, y0, colour);
+    if (x0 == x1 && y0 == y1)
+    {
+      break;
+    }
+    int e2 = 2 * err;
+    if (e2 >= dy)
+    {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx)
+    {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+static void fillWindow(int x0, int y0, int x1, int y1, uint16_t colour)
+{
+  for (int y = y0; y <= y1; y++)
+  {
+    for (int x = x0; x <= x1; x++)
+    {
+      putPixel(x, y, colour);
+    }
+  }
+}
+
+static void executeCommand()
+{
+  switch (command)
+  {
+  case 0x15:
+    columnStart = args[0] % SIM_SSD1331_WIDTH;
+    columnEnd = args[1] % SIM_SSD1331_WIDTH;
+    column = columnStart;
+    break;
+  case 0x75:
+    rowStart = args[0] % SIM_SSD1331_HEIGHT;
+    rowEnd = args[1] % SIM_SSD1331_HEIGHT;
+    row = rowStart;
+    break;
+  case 0xA0:
+    remap = args[0];
+    break;
+  case 0x26:
+    fillEnabled = (args[0] & 0x01) != 0;
+    break;
+  case 0xAE:
+    displayOn = false;
+    break;
+  case 0xAF:
+    displayOn = true;
+    break;
+  case 0x21:
+    drawLine(args[0], args[1], args[2], args[3], commandColour(args[4], args[5], args[6]));
+    break;
+  case 0x22:
+  {
+    if (fillEnabled)
+    {
+      fillWindow(args[0], args[1], args[2], args[3], commandColour(args[7], args[8], args[9]));
+    }
+    uint16_t outline = commandColour(args[4], args[5], args[6]);
+    drawLine(args[0], args[1], args[2], args[1], outline);
+    drawLine(args[2], args[1], args[2], args[3], outline);
+    drawLine(args[2], args[3], args[0], args[3], outline);
+    drawLine(args[0], args[3], args[0], args[1], outline);
+    break;
+  }
+  case 0x23:
+  {
+    static uint16_t copy[SIM_SSD1331_HEIGHT][SIM_SSD1331_WIDTH];
+    memcpy(copy, frame, sizeof(frame));
+    for (int y = args[1]; y <= args[3] && y < SIM_SSD1331_HEIGHT; y++)
+    {
+      for (int x = args[0]; x <= args[2] && x < SIM_SSD1331_WIDTH; x++)
+      {
+        putPixel(args[4] + x - args[0], args[5] + y - args[1], copy[y][x]);
+      }
+    }
+    break;
+  }
+  case 0x25:
+    fillWindow(args[0], args[1], args[2], args[3], 0);
+    break;
+  default:
+    break; // Timing, contrast and power commands do not change the picture
+  }
+  dirty = true;
+}
+
+// Horizontal address increment inside the window set by 0x15 and 0x75. The
+// rotation bits of the remap register are not modelled: lcdgfx only uses them
+// to undo the panel's own mirroring, so the frame comes out the right way round.
+static void writePixel(uint16_t colour)
+{
+  putPixel(column, row, colour);
+  bool vertical = (remap & 0x01) != 0;
+  if (vertical)
+  {
+    if (row++ >= rowEnd)
+    {
+      row = rowStart;
+      column = column >= columnEnd ? columnStart : column + 1;
+    }
+  }
+  else if (column++ >= columnEnd)
+  {
+    column = columnStart;
+    row = row >= rowEnd ? rowStart : row + 1;
+  }
+  dirty = true;
+}
+
+void simSsd1331Write(bool data, const uint8_t *src, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    uint8_t byte = src[i];
+    if (data)
+    {
+      if (!is16Bit())
+      {
+        // RGB332 expanded to RGB565 by repeating the high bits
+        uint8_t r = byte >> 5;
+        uint8_t g = (byte >> 2) & 0x07;
+        uint8_t b = byte & 0x03;
+        writePixel((uint16_t)(((r << 2) | (r >> 1)) << 11 | ((g << 3) | g) << 5 | ((b << 3) | (b << 1) | (b >> 1))));
+      }
+      else if (pendingHighByte < 0)
+      {
+        pendingHighByte = byte;
+      }
+      else
+      {
+        writePixel((uint16_t)(pendingHighByte << 8 | byte));
+        pendingHighByte = -1;
+      }
+      continue;
+    }
+
+    pendingHighByte = -1;
+    if (argsExpected > 0)
+    {
+      args[argCount++] = byte;
+      if (--argsExpected == 0)
+      {
+        executeCommand();
+      }
+      continue;
+    }
+    command = byte;
+    argCount = 0;
+    argsExpected = commandArgCount(byte);
+    if (argsExpected == 0)
+    {
+      executeCommand();
+    }
+  }
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+  static uint32_t table[256];
+  if (table[1] == 0)
+  {
+    for (uint32_t n = 0; n < 256; n++)
+    {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++)
+      {
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      table[n] = c;
+    }
+  }
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++)
+  {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+static void putBigEndian(uint8_t *dst, uint32_t value)
+{
+  dst[0] = value >> 24;
+  dst[1] = value >> 16;
+  dst[2] = value >> 8;
+  dst[3] = value;
+}
+
+static void writeChunk(FILE *file, const char *type, const uint8_t *data, uint32_t len)
+{
+  uint8_t header[8];
+  putBigEndian(header, len);
+  memcpy(header + 4, type, 4);
+  uint32_t crc = crc32(crc32(0, header + 4, 4), data, len);
+  uint8_t trailer[4];
+  putBigEndian(trailer, crc);
+  fwrite(header, 1, sizeof(header), file);
+  fwrite(data, 1, len, file);
+  fwrite(trailer, 1, sizeof(trailer), file);
+}
+
+// PNG with a single stored (uncompressed) deflate block, so no zlib is needed
+static void writePng(FILE *file, const uint8_t *rgb)
+{
+  static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  fwrite(signature, 1, sizeof(signature), file);
+
+  uint8_t ihdr[13] = {0};
+  putBigEndian(ihdr, SIM_SSD1331_WIDTH);
+  putBigEndian(ihdr + 4, SIM_SSD1331_HEIGHT);
+  ihdr[8] = 8; // Bit depth
+  ihdr[9] = 2; // Truecolour
+  writeChunk(file, "IHDR", ihdr, sizeof(ihdr));
+
+  const uint32_t stride = SIM_SSD1331_WIDTH * 3 + 1;
+  const uint32_t rawLen = stride * SIM_SSD1331_HEIGHT;
+  static uint8_t idat[2 + 5 + SIM_SSD1331_HEIGHT * (SIM_SSD1331_WIDTH * 3 + 1) + 4];
+  uint8_t *raw = idat + 7;
+  for (int y = 0; y < SIM_SSD1331_HEIGHT; y++)
+  {
+    raw[y * stride] = 0; // Filter type none
+    memcpy(raw + y * stride + 1, rgb + y * SIM_SSD1331_WIDTH * 3, SIM_SSD1331_WIDTH * 3);
+  }
+  idat[0] = 0x78;
+  idat[1] = 0x01;
+  idat[2] = 0x01; // Final stored block
+  idat[3] = rawLen & 0xFF;
+  idat[4] = rawLen >> 8;
+  idat[5] = ~rawLen & 0xFF;
+  idat[6] = (~rawLen >> 8) & 0xFF;
+  uint32_t a = 1;
+  uint32_t b = 0;
+  for (uint32_t i = 0; i < rawLen; i++)
+  {
+    a = (a + raw[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+  putBigEndian(raw + rawLen, (b << 16) | a);
+  writeChunk(file, "IDAT", idat, sizeof(idat));
+  writeChunk(file, "IEND", NULL, 0);
+}
+
+static void writeFrame(const char *directory, bool png)
+{
+  static uint8_t rgb[SIM_SSD1331_HEIGHT * SIM_SSD1331_WIDTH * 3];
+  taskENTER_CRITICAL();
+  for (int y = 0; y < SIM_SSD1331_HEIGHT; y++)
+  {
+    for (int x = 0; x < SIM_SSD1331_WIDTH; x++)
+    {
+      uint16_t colour = displayOn ? frame[y][x] : 0;
+      uint8_t *pixel = rgb + (y * SIM_SSD1331_WIDTH + x) * 3;
+      pixel[0] = (uint8_t)(((colour >> 11) & 0x1F) * 255 / 31);
+      pixel[1] = (uint8_t)(((colour >> 5) & 0x3F) * 255 / 63);
+      pixel[2] = (uint8_t)((colour & 0x1F) * 255 / 31);
+    }
+  }
+  dirty = false;
+  taskEXIT_CRITICAL();
+
+  char path[512];
+  snprintf(path, sizeof(path), "%s/frame-%06u.%s", directory, (unsigned)framesWritten, png ? "png" : "ppm");
+  FILE *file = fopen(path, "wb");
+  if (file == NULL)
+  {
+    printf("Simulator: cannot write %s\n", path);
+    return;
+  }
+  if (png)
+  {
+    writePng(file, rgb);
+  }
+  else
+  {
+    fprintf(file, "P6\n%d %d\n255\n", SIM_SSD1331_WIDTH, SIM_SSD1331_HEIGHT);
+    fwrite(rgb, 1, sizeof(rgb), file);
+  }
+  fclose(file);
+}
+
+// Frames are written to SIM_FRAME_DIR when the picture changed, at most once per
+// SIM_FRAME_INTERVAL_MS. SIM_FRAME_FORMAT=ppm selects PPM instead of PNG.
+void simSsd1331Step(uint32_t nowMs)
+{
+  static const char *directory = getenv("SIM_FRAME_DIR");
+  static const char *format = getenv("SIM_FRAME_FORMAT");
+  static const char *interval = getenv("SIM_FRAME_INTERVAL_MS");
+  static uint32_t intervalMs = interval != NULL ? (uint32_t)atoi(interval) : SIM_FRAME_DEFAULT_INTERVAL_MS;
+
+  if (!dirty || nowMs - lastFrameMs < intervalMs)
+  {
+    return;
+  }
+  lastFrameMs = nowMs;
+  if (directory != NULL)
+  {
+    writeFrame(directory, format == NULL || strcmp(format, "ppm") != 0);
+  }
+  else
+  {
+    dirty = false;
+  }
+  framesWritten++;
+}
+
+uint32_t simSsd1331FrameCount()
+{
+  return framesWritten;
+}
+
+uint spi_init(spi_inst_t *spi, uint baudrate)
+{
+  spi->baudrate = baudrate;
+  return baudrate;
+}
+
+void spi_deinit(spi_inst_t *spi)
+{
+}
+
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate)
+{
+  spi->baudrate = baudrate;
+  return baudrate;
+}
+
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order)
+{
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len)
+{
+  if (spi == DISPLAY_SPI_PORT && !simGpioOutputLevel(DISPLAY_SPI_CS_GPIO))
+  {
+    simSsd1331Write(simGpioOutputLevel(DISPLAY_SPI_DC_GPIO), src, len);
+  }
+  return (int)len;
+}
+
+int spi_write16_blocking(spi_inst_t *spi, const uint16_t *src, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    uint8_t bytes[2] = {(uint8_t)(src[i] >> 8), (uint8_t)src[i]};
+    spi_write_blocking(spi, bytes, sizeof(bytes));
+  }
+  return (int)len;
+}
+
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len)
+{
+  memset(dst, 0, len); // The SSD1331 has no read path over SPI
+  return (int)len;
+}
+
+spi_hw_t *spi_get_hw(spi_inst_t *spi)
+{
+  return &spiHw[spi->index];
+}
+
+uint spi_get_dreq(spi_inst_t *spi, bool is_tx)
+{
+  return 16 + spi->index * 2 + (is_tx ? 0 : 1);
+}
+
+bool spi_is_busy(const spi_inst_t *spi)
+{
+  return false;
+}
+
+bool spi_is_readable(const spi_inst_t *spi)
+{
+  return false;
+}
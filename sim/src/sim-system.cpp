@@ -0,0 +1,258 @@
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+#include "cyw43_config.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+static uint64_t hostMonotonicUs()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+}
+
+static const uint64_t bootUs = hostMonotonicUs();
+
+uint64_t time_us_64(void)
+{
+  return hostMonotonicUs() - bootUs;
+}
+
+uint32_t time_us_32(void)
+{
+  return (uint32_t)time_us_64();
+}
+
+void busy_wait_us(uint64_t delay_us)
+{
+  uint64_t end = time_us_64() + delay_us;
+  while (time_us_64() < end)
+    ;
+}
+
+void busy_wait_us_32(uint32_t delay_us)
+{
+  busy_wait_us(delay_us);
+}
+
+void busy_wait_ms(uint32_t delay_ms)
+{
+  busy_wait_us((uint64_t)delay_ms * 1000);
+}
+
+static bool schedulerRunning()
+{
+  return xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+void sleep_us(uint64_t us)
+{
+  if (us >= 1000 && schedulerRunning())
+  {
+    vTaskDelay(pdMS_TO_TICKS((us + 999) / 1000));
+  }
+  else if (schedulerRunning())
+  {
+    busy_wait_us(us);
+  }
+  else
+  {
+    usleep((useconds_t)us);
+  }
+}
+
+void sleep_ms(uint32_t ms)
+{
+  sleep_us((uint64_t)ms * 1000);
+}
+
+void sleep_until(absolute_time_t target)
+{
+  int64_t remaining = absolute_time_diff_us(get_absolute_time(), target);
+  if (remaining > 0)
+  {
+    sleep_us((uint64_t)remaining);
+  }
+}
+
+bool stdio_init_all(void)
+{
+  // Line buffered so logs interleave sensibly with the tools talking to the simulator
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  return true;
+}
+
+void panic(const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  fprintf(stderr, "*** PANIC ***\n");
+  vfprintf(stderr, fmt, args);
+  fprintf(stderr, "\n");
+  va_end(args);
+  abort();
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index)
+{
+  switch (clk_index)
+  {
+  case clk_ref:
+    return 12000000;
+  case clk_usb:
+  case clk_adc:
+    return 48000000;
+  case clk_rtc:
+    return 46875;
+  default:
+    return SIM_SYS_CLOCK_HZ;
+  }
+}
+
+uint32_t cyw43_hal_ticks_ms(void)
+{
+  return (uint32_t)(time_us_64() / 1000);
+}
+
+uint32_t cyw43_hal_ticks_us(void)
+{
+  return time_us_32();
+}
+
+// Interrupts
+
+static irq_handler_t irqHandlers[NUM_IRQS];
+static bool irqEnabled[NUM_IRQS];
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+  if (num < NUM_IRQS)
+  {
+    irqHandlers[num] = handler;
+  }
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority)
+{
+  // Nothing in the firmware shares a vector yet, one handler per interrupt is enough
+  irq_set_exclusive_handler(num, handler);
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler)
+{
+  if (num < NUM_IRQS && irqHandlers[num] == handler)
+  {
+    irqHandlers[num] = NULL;
+  }
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+  if (num < NUM_IRQS)
+  {
+    irqEnabled[num] = enabled;
+  }
+}
+
+bool irq_is_enabled(uint num)
+{
+  return num < NUM_IRQS && irqEnabled[num];
+}
+
+void irq_set_priority(uint num, uint8_t hardware_priority)
+{
+}
+
+bool simIrqDispatch(uint num)
+{
+  if (num >= NUM_IRQS || !irqEnabled[num] || irqHandlers[num] == NULL)
+  {
+    return false;
+  }
+  irqHandlers[num]();
+  return true;
+}
+
+uint32_t save_and_disable_interrupts(void)
+{
+  taskENTER_CRITICAL();
+  return 0;
+}
+
+void restore_interrupts(uint32_t status)
+{
+  taskEXIT_CRITICAL();
+}
+
+// Watchdog
+
+static volatile uint32_t watchdogTimeoutMs = 0;
+static volatile uint64_t watchdogLastKickUs = 0;
+static bool watchdogRebooted = getenv("SIM_WATCHDOG_REBOOT") != NULL;
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug)
+{
+  watchdogLastKickUs = time_us_64();
+  watchdogTimeoutMs = delay_ms;
+}
+
+void watchdog_disable(void)
+{
+  watchdogTimeoutMs = 0;
+}
+
+void watchdog_update(void)
+{
+  watchdogLastKickUs = time_us_64();
+}
+
+bool watchdog_caused_reboot(void)
+{
+  return watchdogRebooted;
+}
+
+bool watchdog_enable_caused_reboot(void)
+{
+  return watchdogRebooted;
+}
+
+uint32_t watchdog_get_time_remaining_ms(void)
+{
+  if (watchdogTimeoutMs == 0)
+  {
+    return 0;
+  }
+  uint64_t elapsedMs = (time_us_64() - watchdogLastKickUs) / 1000;
+  return elapsedMs >= watchdogTimeoutMs ? 0 : watchdogTimeoutMs - (uint32_t)elapsedMs;
+}
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms)
+{
+  printf("Simulator: watchdog reboot requested, restarting.\n");
+  fflush(stdout);
+  // Flash is file backed, so re-executing ourselves is a faithful reboot
+  setenv("SIM_WATCHDOG_REBOOT", "1", 1);
+  char *const argv[] = {(char *)"bench-controller-sim", NULL};
+  execv("/proc/self/exe", argv);
+  exit(SIM_EXIT_WATCHDOG);
+}
+
+void simWatchdogCheck(uint64_t nowUs)
+{
+  if (watchdogTimeoutMs != 0 && nowUs - watchdogLastKickUs > (uint64_t)watchdogTimeoutMs * 1000)
+  {
+    fprintf(stderr, "Simulator: watchdog expired after %lu ms without a kick.\n", (unsigned long)watchdogTimeoutMs);
+    exit(SIM_EXIT_WATCHDOG);
+  }
+}
@@ -0,0 +1,61 @@
+#include "sim.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <linux/if.h>
+#include <linux/if_tun.h>
+
+// Host side of the simulated radio. Kept free of lwIP headers because lwIP's
+// socket and errno macros collide with the host's.
+
+static int tapFd = -1;
+
+// The interface must already exist and belong to the user running the simulator,
+// see sim/README.md
+bool simTapOpen(const char *name)
+{
+  int fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+  if (fd < 0)
+  {
+    printf("Simulator: cannot open /dev/net/tun: %s\n", strerror(errno));
+    return false;
+  }
+  struct ifreq request;
+  memset(&request, 0, sizeof(request));
+  request.ifr_flags = IFF_TAP | IFF_NO_PI;
+  strncpy(request.ifr_name, name, IFNAMSIZ - 1);
+  if (ioctl(fd, TUNSETIFF, &request) < 0)
+  {
+    printf("Simulator: cannot attach to %s: %s\n", name, strerror(errno));
+    close(fd);
+    return false;
+  }
+  tapFd = fd;
+  printf("Simulator: network attached to %s\n", name);
+  return true;
+}
+
+// Returns the frame length, or 0 when nothing is waiting
+int simTapRead(uint8_t *frame, size_t capacity)
+{
+  if (tapFd < 0)
+  {
+    return 0;
+  }
+  ssize_t len = read(tapFd, frame, capacity);
+  return len > 0 ? (int)len : 0;
+}
+
+bool simTapWrite(const uint8_t *frame, size_t len)
+{
+  if (tapFd < 0)
+  {
+    return false;
+  }
+  return write(tapFd, frame, len) == (ssize_t)len;
+}
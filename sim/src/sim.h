@@ -0,0 +1,92 @@
+#ifndef SIM_H
+#define SIM_H
+
+// Interfaces between the simulated peripherals (the pico-sdk stand-ins in
+// sim/include) and the device models that sit on the other side of them.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "pico.h"
+
+#define SIM_DEVICE_TICK_MS 1 // Device models and simulated interrupts run at this rate
+#define SIM_EXIT_WATCHDOG 3  // Process exit code when the firmware stops kicking the watchdog
+
+// Scripted waveforms (sim-script.cpp)
+// CSV of `time_s,channel,value` points, loaded from SIM_SCRIPT. Analog channels are
+// interpolated linearly between points, `gpio<N>` channels hold their last value.
+bool simScriptLoad(const char *path);
+bool simScriptHas(const char *channel);
+float simScriptValue(const char *channel, float fallback);
+void simScriptApplyGpio();
+
+// GPIO (sim-gpio.cpp)
+// Devices drive input pins (open drain when `driven` is false) and read outputs back.
+// Edge interrupts are dispatched to the firmware's callback on the calling task.
+void simGpioDrive(uint gpio, bool level);
+void simGpioRelease(uint gpio);
+bool simGpioOutputLevel(uint gpio);
+
+// PWM (sim-pwm.cpp)
+float simPwmDuty(uint gpio); // 0.0 - 1.0 of the slice's wrap
+void simPwmServiceWrapIrq();  // Once per device tick while the wrap interrupt is enabled
+
+// PIO (sim-pio.cpp)
+// Pushes into the receive FIFO of every running state machine whose jmp pin is
+// `gpio`, dropping the word when the FIFO is full like `push noblock`
+void simPioPushByJmpPin(uint gpio, uint32_t value);
+void simPioPushByInPin(uint gpio, uint32_t value); // Same, by the first IN pin
+float simPioClockDivByJmpPin(uint gpio);
+
+// Rotary encoder (sim-encoder.cpp)
+void simEncoderStep();
+
+// IRQs (sim-system.cpp)
+bool simIrqDispatch(uint num); // Runs the handler if the interrupt is enabled
+void simWatchdogCheck(uint64_t nowUs);
+
+// I2C bus (sim-i2c.cpp)
+class SimI2cDevice
+{
+public:
+  virtual ~SimI2cDevice() {}
+  // Return the number of bytes accepted, or a negative value to NACK
+  virtual int write(const uint8_t *src, size_t len, bool nostop) = 0;
+  virtual int read(uint8_t *dst, size_t len, bool nostop) = 0;
+  virtual void step(uint32_t nowMs) = 0;
+};
+
+void simI2cAttach(uint8_t address, SimI2cDevice *device);
+void simI2cStep(uint32_t nowMs);
+void initSimSensors();
+
+// Fan and light bar plants (sim-plant.cpp)
+void initSimPlant();
+void simPlantStep(uint32_t elapsedMs);
+float simLightBarTemperature(uint dataGpio); // -1000 when no bar is wired to the pin
+
+// SSD1331 OLED (sim-ssd1331.cpp)
+void simSsd1331Write(bool data, const uint8_t *src, size_t len);
+void simSsd1331Step(uint32_t nowMs);
+uint32_t simSsd1331FrameCount();
+
+// Flash (sim-flash.cpp)
+bool simFlashLoad(const char *path);
+uint8_t *simFlashMemory();
+void simFlashSeedWifi(const char *ssid, const char *password);
+
+// Network (sim-netif.cpp, sim-tap.cpp)
+// Both cyw43 interfaces share the TAP device; addresses are dotted quad strings.
+bool simTapOpen(const char *name);
+int simTapRead(uint8_t *frame, size_t capacity);
+bool simTapWrite(const uint8_t *frame, size_t len);
+void simNetifUp(int itf, const char *ip, const char *netmask, const char *gateway);
+void simNetifDown(int itf);
+bool simNetifIsUp(int itf);
+void simNetifPoll();
+
+// Devices task (sim-devices.cpp)
+void startSimDevices();
+
+#endif // SIM_H
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""Stand-in for the compressor Pico when running the bench controller simulator.
+
+Connects to the controller's socket server (port 3000), answers its commands the
+way the compressor firmware does and streams STATUS_UPDATE messages from a small
+model of the tank. Messages to the controller are newline terminated JSON; the
+controller's own messages arrive back to back without a separator.
+
+    sim/tools/compressor-standin.py 192.168.10.2
+"""
+
+import argparse
+import json
+import socket
+import time
+
+PRESSURE_MAX = 40.0  # psi at which the motor stops
+PRESSURE_MIN = 25.0  # psi at which the motor restarts
+PUMP_RATE = 2.5      # psi per second while the motor runs
+LEAK_RATE = 0.05     # psi per second through the fittings
+USE_RATE = 1.5       # psi per second while the airbrush is in use
+RELEASE_RATE = 8.0   # psi per second through the release valve
+
+
+class Compressor:
+    def __init__(self):
+        self.pressure = 0.0
+        self.temperature = 24.0
+        self.on = False
+        self.motor = False
+        self.releasing = False
+        self.airbrush = False
+        self.compression = {"duration": 10, "left": 0}
+        self.motor_timer = {"duration": 5, "left": 0}
+        self.release = {"duration": 8, "left": 0}
+        self.events = []
+
+    def command(self, message):
+        kind = message.get("commandType")
+        if kind == "ON" and not self.on:
+            self.on = True
+            self.releasing = False
+            self.compression["left"] = self.compression["duration"] * 60
+            self.events.append({"infoType": "TURNED_ON"})
+        elif kind in ("OFF", "OFF_RELEASE") and self.on:
+            self.on = False
+            self.set_motor(False)
+            self.events.append({"infoType": "TURNED_OFF"})
+            if kind == "OFF_RELEASE":
+                self.releasing = True
+                self.release["left"] = self.release["duration"]
+                self.events.append({"infoType": "RELEASING"})
+        elif kind == "SET_COMPRESSION_TIMEOUT":
+            self.compression["duration"] = int(message.get("timeout", self.compression["duration"]))
+        elif kind == "SET_MOTOR_TIMEOUT":
+            self.motor_timer["duration"] = int(message.get("timeout", self.motor_timer["duration"]))
+        elif kind == "SET_RELEASE_TIMEOUT":
+            self.release["duration"] = int(message.get("timeout", self.release["duration"]))
+        self.events.append(self.status())
+
+    def set_motor(self, running):
+        if running != self.motor:
+            self.motor = running
+            self.motor_timer["left"] = self.motor_timer["duration"] * 60 if running else 0
+            self.events.append({"infoType": "MOTOR_START" if running else "MOTOR_STOP"})
+
+    def step(self, dt, airbrush):
+        if airbrush != self.airbrush:
+            self.airbrush = airbrush
+            self.events.append({"infoType": "SUPPLY_START" if airbrush else "SUPPLY_STOP"})
+        if self.on:
+            if self.pressure <= PRESSURE_MIN:
+                self.set_motor(True)
+            elif self.pressure >= PRESSURE_MAX:
+                self.set_motor(False)
+            self.compression["left"] = max(0.0, self.compression["left"] - dt)
+            if self.compression["left"] == 0:
+                self.command({"commandType": "OFF"})
+        if self.motor:
+            self.pressure += PUMP_RATE * dt
+            self.temperature += 0.2 * dt
+        self.temperature += (24.0 - self.temperature) * 0.01 * dt
+        self.pressure -= (LEAK_RATE + (USE_RATE if airbrush else 0.0)) * dt
+        if self.releasing:
+            self.pressure -= RELEASE_RATE * dt
+            self.release["left"] = max(0.0, self.release["left"] - dt)
+            if self.release["left"] == 0:
+                self.releasing = False
+                self.events.append({"infoType": "RELEASED"})
+        self.pressure = max(0.0, self.pressure)
+
+    def status(self):
+        return {
+            "infoType": "STATUS_UPDATE",
+            "pressure": round(self.pressure, 1),
+            "temperature": round(self.temperature, 1),
+            "compressorOn": self.on,
+            "motorRunning": self.motor,
+            "airbrushInUse": self.airbrush,
+            "compressionTimerDuration": self.compression["duration"],
+            "compressionTimeLeft": int(self.compression["left"]),
+            "motorTimerDuration": self.motor_timer["duration"],
+            "motorTimeLeft": int(self.motor_timer["left"]),
+            "releaseTimerDuration": self.release["duration"],
+            "releaseTimeLeft": int(self.release["left"]),
+        }
+
+
+def split_messages(buffer):
+    """Returns the complete JSON objects at the start of buffer and the remainder."""
+    decoder = json.JSONDecoder()
+    messages = []
+    while True:
+        buffer = buffer.lstrip()
+        if not buffer:
+            return messages, buffer
+        try:
+            message, end = decoder.raw_decode(buffer)
+        except json.JSONDecodeError:
+            return messages, buffer
+        messages.append(message)
+        buffer = buffer[end:]
+
+
+def airbrush_in_use(now, pattern):
+    """Airbrush triggers for `on` seconds out of every `period` when pattern is given."""
+    if pattern is None:
+        return False
+    on, period = pattern
+    return (now % period) < on
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host", help="address of the simulated controller")
+    parser.add_argument("--port", type=int, default=3000)
+    parser.add_argument("--interval", type=float, default=1.0, help="seconds between status updates")
+    parser.add_argument("--airbrush", type=float, nargs=2, metavar=("ON", "PERIOD"),
+                        help="use the airbrush for ON seconds out of every PERIOD")
+    args = parser.parse_args()
+
+    compressor = Compressor()
+    while True:
+        try:
+            connection = socket.create_connection((args.host, args.port), timeout=5)
+        except OSError as error:
+            print(f"connect to {args.host}:{args.port} failed: {error}, retrying")
+            time.sleep(2)
+            continue
+        print(f"connected to {args.host}:{args.port}")
+        connection.settimeout(0.1)
+        buffer = ""
+        last = time.monotonic()
+        last_status = 0.0
+        try:
+            while True:
+                try:
+                    data = connection.recv(1024)
+                    if not data:
+                        raise ConnectionError("controller closed the connection")
+                    messages, buffer = split_messages(buffer + data.decode("utf-8", "replace"))
+                    for message in messages:
+                        print(f"<- {json.dumps(message)}")
+                        if message.get("messageType") == "COMMAND":
+                            compressor.command(message)
+                except socket.timeout:
+                    pass
+
+                now = time.monotonic()
+                compressor.step(now - last, airbrush_in_use(now, args.airbrush))
+                last = now
+                if now - last_status >= args.interval:
+                    last_status = now
+                    compressor.events.append(compressor.status())
+                while compressor.events:
+                    message = {"messageType": "INFO", **compressor.events.pop(0)}
+                    connection.sendall((json.dumps(message) + "\n").encode())
+        except (ConnectionError, OSError) as error:
+            print(f"disconnected: {error}")
+            connection.close()
+            time.sleep(1)
+
+
+if __name__ == "__main__":
+    main()
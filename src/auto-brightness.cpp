@@ -0,0 +1,76 @@
+#include "auto-brightness.h"
+#include "gamma.h"
+
+#include <math.h>
+
+// Output light is proportional to duty, not to the perceptual brightness percentage
+static float brightnessToDuty(int brightness)
+{
+  return gammaLightnessToDuty(((uint32_t)brightness * GAMMA_LIGHTNESS_MAX) / 100) / (float)GAMMA_DUTY_MAX;
+}
+
+static int dutyToBrightness(float duty)
+{
+  uint32_t lightness = gammaDutyToLightness((uint32_t)(duty * GAMMA_DUTY_MAX));
+  return (int)((lightness * 100 + GAMMA_LIGHTNESS_MAX / 2) / GAMMA_LIGHTNESS_MAX);
+}
+
+void autoBrightnessInit(AutoBrightness *controller)
+{
+  controller->selfGain = AUTO_BRIGHTNESS_DEFAULT_GAIN;
+  controller->lastLux = 0.0f;
+  controller->lastDuty = 0.0f;
+  controller->haveLast = false;
+}
+
+float autoBrightnessAmbient(const AutoBrightness *controller, float measuredLux, int brightness)
+{
+  float ambient = measuredLux - controller->selfGain * brightnessToDuty(brightness);
+  return ambient > 0.0f ? ambient : 0.0f;
+}
+
+int autoBrightnessUpdate(AutoBrightness *controller, float measuredLux, int brightness, float setpointLux)
+{
+  float duty = brightnessToDuty(brightness);
+
+  // Learn the bars' contribution from our own steps: between two settled readings
+  // the ambient is assumed unchanged, so the lux delta is all ours
+  if (controller->haveLast && fabsf(duty - controller->lastDuty) >= AUTO_BRIGHTNESS_MIN_LEARN_DUTY)
+  {
+    float gain = (measuredLux - controller->lastLux) / (duty - controller->lastDuty);
+    if (gain >= AUTO_BRIGHTNESS_MIN_GAIN && gain <= AUTO_BRIGHTNESS_MAX_GAIN)
+    {
+      controller->selfGain += (gain - controller->selfGain) * AUTO_BRIGHTNESS_LEARN_RATE;
+    }
+  }
+  controller->lastLux = measuredLux;
+  controller->lastDuty = duty;
+  controller->haveLast = true;
+
+  if (fabsf(measuredLux - setpointLux) <= setpointLux * AUTO_BRIGHTNESS_HYSTERESIS)
+  {
+    return brightness;
+  }
+
+  float ambient = autoBrightnessAmbient(controller, measuredLux, brightness);
+  float required = (setpointLux - ambient) / controller->selfGain;
+  if (required < 0.0f)
+  {
+    required = 0.0f;
+  }
+  else if (required > 1.0f)
+  {
+    required = 1.0f;
+  }
+
+  int target = dutyToBrightness(required);
+  if (target > brightness + AUTO_BRIGHTNESS_MAX_STEP)
+  {
+    target = brightness + AUTO_BRIGHTNESS_MAX_STEP;
+  }
+  else if (target < brightness - AUTO_BRIGHTNESS_MAX_STEP)
+  {
+    target = brightness - AUTO_BRIGHTNESS_MAX_STEP;
+  }
+  return target;
+}
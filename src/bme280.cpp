@@ -6,69 +6,160 @@
 
 #include "pico/stdlib.h"
 
-BME280::BME280(i2c_inst_t *i2cPort, uint8_t addr) : i2cPort(i2cPort), address(addr) {}
+#define BME280_REG_CALIB_00 0x88
+#define BME280_REG_CHIP_ID 0xD0
+#define BME280_REG_CALIB_26 0xE1
+#define BME280_REG_CTRL_HUM 0xF2
+#define BME280_REG_CTRL_MEAS 0xF4
+#define BME280_REG_CONFIG 0xF5
+#define BME280_REG_DATA 0xF7 // press_msb through hum_lsb, 8 bytes
+#define BME280_MODE_FORCED 0x01
+
+// Worst case conversion time from the datasheet (section 9.1), in µs
+#define BME280_OSRS_SAMPLES(osrs) ((osrs) == 0 ? 0 : 1 << ((osrs) - 1))
+#define BME280_MEASURE_MAX_US (1250 + 2300 * BME280_OSRS_SAMPLES(BME280_OSRS_T) +     \
+                               2300 * BME280_OSRS_SAMPLES(BME280_OSRS_P) + 575 +       \
+                               2300 * BME280_OSRS_SAMPLES(BME280_OSRS_H) + 575)
 
-void BME280::init()
+void bme280Unpack(const uint8_t data[8], Bme280Raw *raw)
 {
-  this->loadCalibrationData();
-  // Increasing oversampling for temperature to x2
-  this->writeByte(0xF2, 0x01); // Humidity oversampling x1
-  this->writeByte(0xF4, 0x2D); // Temp oversampling x2, Pressure oversampling x1, Normal mode
-  this->writeByte(0xF5, 0xA0); // Standby time 1000 ms
+  raw->pressure = (int32_t)(((uint32_t)data[0] << 12) | ((uint32_t)data[1] << 4) | ((uint32_t)data[2] >> 4));
+  raw->temperature = (int32_t)(((uint32_t)data[3] << 12) | ((uint32_t)data[4] << 4) | ((uint32_t)data[5] >> 4));
+  raw->humidity = (int32_t)(((uint32_t)data[6] << 8) | (uint32_t)data[7]);
 }
 
-bool BME280::readAll(float *temperature, float *humidity, float *pressure)
+void bme280Compensate(const Bme280Calibration *calibration, const Bme280Raw *raw, Bme280Reading *reading)
 {
-  uint8_t data[8];
-  if (this->readBytes(0xF7, data, 8) != 8)
+  const Bme280Calibration &c = *calibration;
+
+  // Temperature, and t_fine which the other two are corrected with
+  int32_t adcT = raw->temperature;
+  int32_t var1 = ((((adcT >> 3) - ((int32_t)c.digT1 << 1))) * ((int32_t)c.digT2)) >> 11;
+  int32_t var2 = (((((adcT >> 4) - ((int32_t)c.digT1)) * ((adcT >> 4) - ((int32_t)c.digT1))) >> 12) * ((int32_t)c.digT3)) >> 14;
+  int32_t tFine = var1 + var2;
+  reading->temperature = (tFine * 5 + 128) >> 8;
+
+  // Pressure in whole Pa without 64-bit arithmetic
+  var1 = (tFine >> 1) - (int32_t)64000;
+  var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)c.digP6);
+  var2 = var2 + ((var1 * ((int32_t)c.digP5)) << 1);
+  var2 = (var2 >> 2) + (((int32_t)c.digP4) << 16);
+  var1 = (((c.digP3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((((int32_t)c.digP2) * var1) >> 1)) >> 18;
+  var1 = (((32768 + var1)) * ((int32_t)c.digP1)) >> 15;
+  if (var1 == 0)
   {
-    printf("Failed to read data\n");
+    reading->pressure = 0; // Avoid division by zero
+  }
+  else
+  {
+    uint32_t p = (((uint32_t)(((int32_t)1048576) - raw->pressure) - (var2 >> 12))) * 3125;
+    if (p < 0x80000000)
+    {
+      p = (p << 1) / ((uint32_t)var1);
+    }
+    else
+    {
+      p = (p / (uint32_t)var1) * 2;
+    }
+    var1 = (((int32_t)c.digP9) * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+    var2 = (((int32_t)(p >> 2)) * ((int32_t)c.digP8)) >> 13;
+    reading->pressure = (uint32_t)((int32_t)p + ((var1 + var2 + c.digP7) >> 4));
+  }
+
+  // Humidity in Q22.10
+  int32_t adcH = raw->humidity;
+  int32_t h = tFine - 76800;
+  h = (((((adcH << 14) - (((int32_t)c.digH4) << 20) - (((int32_t)c.digH5) * h)) + 16384) >> 15) *
+       (((((((h * ((int32_t)c.digH6)) >> 10) * (((h * ((int32_t)c.digH3)) >> 11) + 32768)) >> 10) + 2097152) *
+             ((int32_t)c.digH2) +
+         8192) >>
+        14));
+  h -= (((((h >> 15) * (h >> 15)) >> 7) * ((int32_t)c.digH1)) >> 4);
+  h = (h < 0 ? 0 : h);
+  h = (h > 419430400 ? 419430400 : h);
+  reading->humidity = (uint32_t)(h >> 12);
+}
+
+void bme280CompensateFloat(const Bme280Calibration *calibration, const Bme280Raw *raw,
+                           float *temperature, float *pressure, float *humidity)
+{
+  const Bme280Calibration &c = *calibration;
+
+  float adcT = (float)raw->temperature;
+  float var1 = (adcT / 16384.0f - (float)c.digT1 / 1024.0f) * (float)c.digT2;
+  float var2 = (adcT / 131072.0f - (float)c.digT1 / 8192.0f) * (adcT / 131072.0f - (float)c.digT1 / 8192.0f) * (float)c.digT3;
+  float tFine = var1 + var2;
+  *temperature = tFine / 5120.0f;
+
+  var1 = tFine / 2.0f - 64000.0f;
+  var2 = var1 * var1 * (float)c.digP6 / 32768.0f;
+  var2 = var2 + var1 * (float)c.digP5 * 2.0f;
+  var2 = var2 / 4.0f + (float)c.digP4 * 65536.0f;
+  var1 = ((float)c.digP3 * var1 * var1 / 524288.0f + (float)c.digP2 * var1) / 524288.0f;
+  var1 = (1.0f + var1 / 32768.0f) * (float)c.digP1;
+  if (var1 == 0.0f)
+  {
+    *pressure = 0.0f;
+  }
+  else
+  {
+    float p = 1048576.0f - (float)raw->pressure;
+    p = (p - var2 / 4096.0f) * 6250.0f / var1;
+    var1 = (float)c.digP9 * p * p / 2147483648.0f;
+    var2 = p * (float)c.digP8 / 32768.0f;
+    *pressure = p + (var1 + var2 + (float)c.digP7) / 16.0f;
+  }
+
+  float h = tFine - 76800.0f;
+  h = ((float)raw->humidity - ((float)c.digH4 * 64.0f + (float)c.digH5 / 16384.0f * h)) *
+      ((float)c.digH2 / 65536.0f * (1.0f + (float)c.digH6 / 67108864.0f * h * (1.0f + (float)c.digH3 / 67108864.0f * h)));
+  h = h * (1.0f - (float)c.digH1 * h / 524288.0f);
+  *humidity = h > 100.0f ? 100.0f : h < 0.0f ? 0.0f : h;
+}
+
+BME280::BME280(i2c_inst_t *i2cPort, uint8_t addr) : i2cPort(i2cPort), address(addr) {}
+
+bool BME280::init()
+{
+  uint8_t chipId = 0;
+  if (this->readBytes(BME280_REG_CHIP_ID, &chipId, 1) != 1 || chipId != BME280_CHIP_ID)
+  {
+    printf("BME280 not found.\n");
+    return false;
+  }
+  if (!this->loadCalibrationData())
+  {
+    printf("Failed to read BME280 calibration.\n");
     return false;
   }
+  // The filter only takes in sleep mode, which the sensor is in after reset.
+  // ctrl_hum takes effect with the next write to ctrl_meas.
+  this->writeByte(BME280_REG_CONFIG, BME280_FILTER << 2);
+  this->writeByte(BME280_REG_CTRL_HUM, BME280_OSRS_H);
+  return true;
+}
 
-  // Combining data bytes for pressure, temperature, and humidity
-  int32_t adc_P = ((uint32_t)data[0] << 12) | ((uint32_t)data[1] << 4) | ((uint32_t)data[2] >> 4);
-  int32_t adc_T = ((uint32_t)data[3] << 12) | ((uint32_t)data[4] << 4) | ((uint32_t)data[5] >> 4);
-  int32_t adc_H = ((uint32_t)data[6] << 8) | (uint32_t)data[7];
-
-  // Temperature compensation
-  int32_t var1, var2, t_fine;
-  var1 = ((((adc_T >> 3) - ((int32_t)calibData.digT1 << 1))) * ((int32_t)calibData.digT2)) >> 11;
-  var2 = (((((adc_T >> 4) - ((int32_t)calibData.digT1)) * ((adc_T >> 4) - ((int32_t)calibData.digT1))) >> 12) * ((int32_t)calibData.digT3)) >> 14;
-  t_fine = var1 + var2;
-  *temperature = ((t_fine * 5 + 128) >> 8) / 100.0f;
-
-  // Pressure compensation
-  int64_t p;
-  var1 = ((int64_t)t_fine) - 128000;
-  var2 = var1 * var1 * (int64_t)calibData.digP6;
-  var2 += (var1 * (int64_t)calibData.digP5) << 17;
-  var2 += ((int64_t)calibData.digP4) << 35;
-  var1 = ((var1 * var1 * (int64_t)calibData.digP3) >> 8) + ((var1 * (int64_t)calibData.digP2) << 12);
-  var1 = (((((int64_t)1) << 47) + var1) * (int64_t)calibData.digP1) >> 33;
-  if (var1 == 0)
+int BME280::startMeasurement()
+{
+  uint8_t ctrlMeas = (BME280_OSRS_T << 5) | (BME280_OSRS_P << 2) | BME280_MODE_FORCED;
+  if (this->writeByte(BME280_REG_CTRL_MEAS, ctrlMeas) != 2)
   {
-    return false; // Avoid division by zero
+    return -1;
   }
-  p = 1048576 - adc_P;
-  p = (((p << 31) - var2) * 3125) / var1;
-  var1 = (((int64_t)calibData.digP9) * (p >> 13) * (p >> 13)) >> 25;
-  var2 = (((int64_t)calibData.digP8) * p) >> 19;
-  p = ((p + var1 + var2) >> 8) + (((int64_t)calibData.digP7) << 4);
-  *pressure = ((float)p / 25600.0f) - 251.0f; // Convert from Pa to hPa
-
-  // Humidity compensation
-  int32_t v_x1_u32r = t_fine - 76800;
-  v_x1_u32r = (((((adc_H << 14) - (((int32_t)calibData.digH4) << 20) - (((int32_t)calibData.digH5) * v_x1_u32r)) + 16384) >> 15) *
-               (((((((v_x1_u32r * ((int32_t)calibData.digH6)) >> 10) * (((v_x1_u32r * ((int32_t)calibData.digH3)) >> 11) + 32768)) >> 10) + 2097152) *
-                     ((int32_t)calibData.digH2) +
-                 8192) >>
-                14));
-  v_x1_u32r -= (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) * ((int32_t)calibData.digH1)) >> 4);
-  v_x1_u32r = (v_x1_u32r < 0 ? 0 : v_x1_u32r);
-  v_x1_u32r = (v_x1_u32r > 419430400 ? 419430400 : v_x1_u32r);
-  *humidity = (float)(v_x1_u32r >> 12) / 1024.0f;
+  return (BME280_MEASURE_MAX_US + 999) / 1000;
+}
 
+bool BME280::readMeasurement(Bme280Reading *reading)
+{
+  uint8_t data[8];
+  if (this->readBytes(BME280_REG_DATA, data, sizeof(data)) != sizeof(data))
+  {
+    printf("Failed to read data\n");
+    return false;
+  }
+  Bme280Raw raw;
+  bme280Unpack(data, &raw);
+  bme280Compensate(&this->calibData, &raw, reading);
   return true;
 }
 
@@ -89,10 +180,14 @@ int BME280::writeByte(uint8_t regAddr, uint8_t value)
   return i2c_write_blocking(this->i2cPort, this->address, buffer, 2, false);
 }
 
-void BME280::loadCalibrationData()
+bool BME280::loadCalibrationData()
 {
+  // 0x88-0xA1: temperature and pressure, then dig_H1 after a reserved byte
   uint8_t calib[26];
-  this->readBytes(0x88, calib, 24);
+  if (this->readBytes(BME280_REG_CALIB_00, calib, 26) != 26)
+  {
+    return false;
+  }
   calibData.digT1 = (uint16_t)(calib[1] << 8) | calib[0];
   calibData.digT2 = (int16_t)(calib[3] << 8) | calib[2];
   calibData.digT3 = (int16_t)(calib[5] << 8) | calib[4];
@@ -105,14 +200,16 @@ void BME280::loadCalibrationData()
   calibData.digP7 = (int16_t)(calib[19] << 8) | calib[18];
   calibData.digP8 = (int16_t)(calib[21] << 8) | calib[20];
   calibData.digP9 = (int16_t)(calib[23] << 8) | calib[22];
-  calibData.digH1 = calib[24];
-  this->readBytes(0xE1, calib, 7);
+  calibData.digH1 = calib[25];
+  if (this->readBytes(BME280_REG_CALIB_26, calib, 7) != 7)
+  {
+    return false;
+  }
   calibData.digH2 = (int16_t)(calib[1] << 8) | calib[0];
   calibData.digH3 = calib[2];
-  int16_t e4 = calib[3];
-  int16_t e5 = calib[4];
-  calibData.digH4 = (e4 << 4) | (e5 & 0x0F);
-  calibData.digH5 = (e5 >> 4) | (calib[5] << 4);
+  // dig_H4 and dig_H5 are signed 12-bit values sharing 0xE5
+  calibData.digH4 = (int16_t)((int8_t)calib[3] * 16) | (calib[4] & 0x0F);
+  calibData.digH5 = (int16_t)((int8_t)calib[5] * 16) | (calib[4] >> 4);
   calibData.digH6 = (int8_t)calib[6];
 
   // Debug output for calibration data
@@ -135,4 +232,5 @@ void BME280::loadCalibrationData()
   printf("H4: %d\n", calibData.digH4);
   printf("H5: %d\n", calibData.digH5);
   printf("H6: %d\n", (int)calibData.digH6);
+  return true;
 }
@@ -0,0 +1,136 @@
+#include "boot-timeline.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+// Microseconds since reset fit 32 bits for the first 71 minutes, well past any
+// boot, and 32 bit stores are atomic on the M0+ so readers never see half a time
+typedef struct
+{
+  const char *name; // Stored last, entries without one are still being filled in
+  uint32_t startUs;
+  uint32_t endUs; // 0 while the step runs
+  uint8_t core;
+  bool milestone;
+} BootEntry;
+
+static BootEntry entries[BOOT_TIMELINE_MAX_ENTRIES];
+static uint32_t entryCount = 0;
+
+static uint32_t bootNowUs()
+{
+  uint64_t now = time_us_64();
+  return now > UINT32_MAX ? UINT32_MAX : (uint32_t)now;
+}
+
+static int reserveEntry(const char *name, bool milestone)
+{
+  uint32_t index = __atomic_fetch_add(&entryCount, 1, __ATOMIC_RELAXED);
+  if (index >= BOOT_TIMELINE_MAX_ENTRIES)
+  {
+    return -1;
+  }
+  BootEntry &entry = entries[index];
+  entry.startUs = bootNowUs();
+  entry.endUs = milestone ? entry.startUs : 0;
+  entry.core = (uint8_t)get_core_num();
+  entry.milestone = milestone;
+  __atomic_store_n(&entry.name, name, __ATOMIC_RELEASE);
+  return (int)index;
+}
+
+static int publishedCount()
+{
+  uint32_t count = __atomic_load_n(&entryCount, __ATOMIC_RELAXED);
+  return count > BOOT_TIMELINE_MAX_ENTRIES ? BOOT_TIMELINE_MAX_ENTRIES : (int)count;
+}
+
+int bootStepBegin(const char *name)
+{
+  return reserveEntry(name, false);
+}
+
+void bootStepEnd(int step)
+{
+  if (step < 0)
+  {
+    return;
+  }
+  BootEntry &entry = entries[step];
+  uint32_t endUs = bootNowUs();
+  __atomic_store_n(&entry.endUs, endUs, __ATOMIC_RELEASE);
+  printf("Boot: %s took %lu us on core %u.\n", entry.name, (unsigned long)(endUs - entry.startUs), entry.core);
+}
+
+void bootMilestone(const char *name)
+{
+  int count = publishedCount();
+  for (int i = 0; i < count; i++)
+  {
+    const char *existing = __atomic_load_n(&entries[i].name, __ATOMIC_ACQUIRE);
+    if (existing != NULL && entries[i].milestone && strcmp(existing, name) == 0)
+    {
+      return;
+    }
+  }
+  int index = reserveEntry(name, true);
+  if (index >= 0)
+  {
+    printf("Boot: %s at %lu us.\n", name, (unsigned long)entries[index].startUs);
+  }
+}
+
+size_t bootTimelineToJson(char *buffer, size_t length)
+{
+  size_t offset = 0;
+  int written = snprintf(buffer, length, "{\"timeline\":[");
+  if (written < 0 || (size_t)written >= length)
+  {
+    return 0;
+  }
+  offset += written;
+
+  bool first = true;
+  int count = publishedCount();
+  for (int i = 0; i < count; i++)
+  {
+    const BootEntry &entry = entries[i];
+    const char *name = __atomic_load_n(&entry.name, __ATOMIC_ACQUIRE);
+    if (name == NULL)
+    {
+      continue;
+    }
+    uint32_t endUs = __atomic_load_n(&entry.endUs, __ATOMIC_ACQUIRE);
+    if (entry.milestone)
+    {
+      written = snprintf(buffer + offset, length - offset, "%s{\"name\":\"%s\",\"core\":%u,\"atUs\":%lu}",
+                         first ? "" : ",", name, entry.core, (unsigned long)entry.startUs);
+    }
+    else if (endUs == 0)
+    {
+      written = snprintf(buffer + offset, length - offset, "%s{\"name\":\"%s\",\"core\":%u,\"startUs\":%lu}",
+                         first ? "" : ",", name, entry.core, (unsigned long)entry.startUs);
+    }
+    else
+    {
+      written = snprintf(buffer + offset, length - offset, "%s{\"name\":\"%s\",\"core\":%u,\"startUs\":%lu,\"endUs\":%lu}",
+                         first ? "" : ",", name, entry.core, (unsigned long)entry.startUs, (unsigned long)endUs);
+    }
+    // Ensure we don't overflow the buffer
+    if (written < 0 || offset + written >= length)
+    {
+      break;
+    }
+    offset += written;
+    first = false;
+  }
+
+  written = snprintf(buffer + offset, length - offset, "]}");
+  if (written > 0 && offset + written < length)
+  {
+    offset += written;
+  }
+  return offset;
+}
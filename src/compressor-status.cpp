@@ -1,6 +1,6 @@
 #include "compressor-status.h"
 
-volatile CompressorStatus g_compressorStatus = {
+Snapshot<CompressorStatus> g_compressorStatus(CompressorStatus{
     0.0f,  // pressure
     0.0f,  // temperature
     false, // compressorOn
@@ -12,4 +12,4 @@ volatile CompressorStatus g_compressorStatus = {
     0,     // motorTimeLeft
     0,     // releaseTimerDuration
     0      // releaseTimeLeft
-};
+});
@@ -1,9 +1,9 @@
 #include "control.h"
 #include "compressor-status.h"
+#include "json-arena.h"
 #include "wifi.h"
 
 #include <cstdio>
-#include <string>
 #include <cstring>
 
 #include "cJSON.h"
@@ -16,19 +16,20 @@ QueueHandle_t incommingMessageQueue = NULL;
 
 void initControl()
 {
-  incommingMessageQueue = xQueueCreate(10, sizeof(Message));
-
+  // The incoming queue is created with the socket server's in initWifi()
   if (!incommingMessageQueue)
   {
-    printf("Failed to create incoming message queues.\n");
+    printf("Incoming message queue missing, call initWifi() first.\n");
   }
 }
 
 bool bufferToMessage(const char *buffer, Message &msg)
 {
+  jsonArenaBegin();
   cJSON *json = cJSON_Parse(buffer);
   if (!json)
   {
+    jsonArenaEnd();
     printf("Failed to parse JSON: %s\n", buffer);
     return false;
   }
@@ -200,11 +201,13 @@ bool bufferToMessage(const char *buffer, Message &msg)
     }
   }
   cJSON_Delete(json);
+  jsonArenaEnd();
   return true;
 }
 
-std::string messageToString(const Message &msg)
+size_t messageToJson(const Message &msg, char *buffer, size_t length)
 {
+  jsonArenaBegin();
   cJSON *json = cJSON_CreateObject();
   if (msg.messageType == COMMAND)
   {
@@ -258,11 +261,19 @@ std::string messageToString(const Message &msg)
       cJSON_AddNumberToObject(json, "releaseTimeLeft", msg.status.releaseTimeLeft);
     }
   }
-  char *jsonString = cJSON_PrintUnformatted(json);
-  std::string result(jsonString);
-  cJSON_free(jsonString);
+  // Printed straight into the caller's buffer, so only the tree touches the arena
+  bool printed = json != NULL && cJSON_PrintPreallocated(json, buffer, (int)length, false);
   cJSON_Delete(json);
-  return result;
+  jsonArenaEnd();
+  if (!printed)
+  {
+    if (length > 0)
+    {
+      buffer[0] = '\0';
+    }
+    return 0;
+  }
+  return strlen(buffer);
 }
 
 // {"messageType": "INFO", "infoType": "STATUS_UPDATE", "pressure": 101.3, "temperature": 25.6, "compressorOn": true, "motorRunning": false, "airbrushInUse": true, "compressionTimerDuration": 10, "compressionTimeLeft": 1, "motorTimerDuration": 5, "motorTimeLeft": 1, "releaseTimerDuration": 8, "releaseTimeLeft": 1}
@@ -378,17 +389,18 @@ void sendSetReleaseTimeoutCommand(int minutes)
 
 void logCompressor()
 {
-  float pressure = g_compressorStatus.pressure;
-  float temperature = g_compressorStatus.temperature;
-  bool compressorOn = g_compressorStatus.compressorOn;
-  bool motorRunning = g_compressorStatus.motorRunning;
-  bool airbrushInUse = g_compressorStatus.airbrushInUse;
-  int compDuration = g_compressorStatus.compressionTimerDuration;
-  int compTimeLeft = g_compressorStatus.compressionTimeLeft;
-  int motorDuration = g_compressorStatus.motorTimerDuration;
-  int motorTimeLeft = g_compressorStatus.motorTimeLeft;
-  int releaseDuration = g_compressorStatus.releaseTimerDuration;
-  int releaseTimeLeft = g_compressorStatus.releaseTimeLeft;
+  const CompressorStatus status = g_compressorStatus.read();
+  float pressure = status.pressure;
+  float temperature = status.temperature;
+  bool compressorOn = status.compressorOn;
+  bool motorRunning = status.motorRunning;
+  bool airbrushInUse = status.airbrushInUse;
+  int compDuration = status.compressionTimerDuration;
+  int compTimeLeft = status.compressionTimeLeft;
+  int motorDuration = status.motorTimerDuration;
+  int motorTimeLeft = status.motorTimeLeft;
+  int releaseDuration = status.releaseTimerDuration;
+  int releaseTimeLeft = status.releaseTimeLeft;
 
   // Render the information on your OLED display.
   // For now, we print to the console.
@@ -413,61 +425,64 @@ void controlTask(void *params)
     {
       if (msg.messageType == INFO)
       {
+        // This task is the only publisher, so its last copy is current
+        CompressorStatus status = g_compressorStatus.read();
         switch (msg.status.infoType)
         {
         case STATUS_UPDATE:
           // Update all fields from the comprehensive status update
-          g_compressorStatus.pressure = msg.status.pressure;
-          g_compressorStatus.temperature = msg.status.temperature;
-          g_compressorStatus.compressorOn = msg.status.compressorOn;
-          g_compressorStatus.motorRunning = msg.status.motorRunning;
-          g_compressorStatus.airbrushInUse = msg.status.airbrushInUse;
-          g_compressorStatus.compressionTimerDuration = msg.status.compressionTimerDuration;
-          g_compressorStatus.compressionTimeLeft = msg.status.compressionTimeLeft;
-          g_compressorStatus.motorTimerDuration = msg.status.motorTimerDuration;
-          g_compressorStatus.motorTimeLeft = msg.status.motorTimeLeft;
-          g_compressorStatus.releaseTimerDuration = msg.status.releaseTimerDuration;
-          g_compressorStatus.releaseTimeLeft = msg.status.releaseTimeLeft;
+          status.pressure = msg.status.pressure;
+          status.temperature = msg.status.temperature;
+          status.compressorOn = msg.status.compressorOn;
+          status.motorRunning = msg.status.motorRunning;
+          status.airbrushInUse = msg.status.airbrushInUse;
+          status.compressionTimerDuration = msg.status.compressionTimerDuration;
+          status.compressionTimeLeft = msg.status.compressionTimeLeft;
+          status.motorTimerDuration = msg.status.motorTimerDuration;
+          status.motorTimeLeft = msg.status.motorTimeLeft;
+          status.releaseTimerDuration = msg.status.releaseTimerDuration;
+          status.releaseTimeLeft = msg.status.releaseTimeLeft;
           break;
         case PRESSURE_CHANGE:
           // For incremental updates, update only the affected field(s)
-          g_compressorStatus.pressure = msg.status.pressure;
+          status.pressure = msg.status.pressure;
           break;
         case TEMPERATURE_CHANGE:
-          g_compressorStatus.temperature = msg.status.temperature;
+          status.temperature = msg.status.temperature;
           break;
         case PRESSURE_COUNTDOWN_UPDATED:
-          g_compressorStatus.compressionTimeLeft = msg.status.compressionTimeLeft;
+          status.compressionTimeLeft = msg.status.compressionTimeLeft;
           break;
         case RELEASE_COUNTDOWN_UPDATE:
-          g_compressorStatus.releaseTimeLeft = msg.status.releaseTimeLeft;
+          status.releaseTimeLeft = msg.status.releaseTimeLeft;
           break;
         case MOTOR_COUNTDOWN_UPDATE:
-          g_compressorStatus.motorTimeLeft = msg.status.motorTimeLeft;
+          status.motorTimeLeft = msg.status.motorTimeLeft;
           break;
         case TURNED_ON:
-          g_compressorStatus.compressorOn = true;
+          status.compressorOn = true;
           break;
         case TURNED_OFF:
-          g_compressorStatus.compressorOn = false;
+          status.compressorOn = false;
           break;
         case MOTOR_START:
-          g_compressorStatus.motorRunning = true;
+          status.motorRunning = true;
           break;
         case MOTOR_STOP:
-          g_compressorStatus.motorRunning = false;
+          status.motorRunning = false;
           break;
         case SUPPLY_START:
-          g_compressorStatus.airbrushInUse = true;
+          status.airbrushInUse = true;
           break;
         case SUPPLY_STOP:
-          g_compressorStatus.airbrushInUse = false;
+          status.airbrushInUse = false;
           break;
         // You can handle additional cases as needed.
         default:
           printf("Unknown info type received: %d\n", msg.status.infoType);
           break;
         }
+        g_compressorStatus.publish(status);
         logCompressor();
       }
       else
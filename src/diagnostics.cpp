@@ -0,0 +1,199 @@
+#include "diagnostics.h"
+#include "static-memory.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#if defined(configNUMBER_OF_CORES)
+#define DIAGNOSTICS_CORES configNUMBER_OF_CORES
+#else
+#define DIAGNOSTICS_CORES 1
+#endif
+
+static SemaphoreHandle_t diagnosticsMutex = NULL;
+static StaticSemaphore_t diagnosticsMutexMemory;
+static SystemDiagnostics latestDiagnostics;
+
+// Raw FreeRTOS state is large (one TaskStatus_t per task), keep it off the task stack
+static TaskStatus_t taskStatus[DIAGNOSTICS_MAX_TASKS];
+
+// Run time counters from the previous sample, matched up by task handle
+static TaskHandle_t previousHandles[DIAGNOSTICS_MAX_TASKS];
+static configRUN_TIME_COUNTER_TYPE previousCounters[DIAGNOSTICS_MAX_TASKS];
+static uint32_t previousStacks[DIAGNOSTICS_MAX_TASKS];
+static int previousCount = 0;
+static configRUN_TIME_COUNTER_TYPE previousTotal = 0;
+
+void initDiagnostics()
+{
+  diagnosticsMutex = xSemaphoreCreateMutexStatic(&diagnosticsMutexMemory);
+  staticMemoryAccount("diagnostics", sizeof(diagnosticsMutexMemory) + sizeof(latestDiagnostics) + sizeof(taskStatus) +
+                                         sizeof(previousHandles) + sizeof(previousCounters) + sizeof(previousStacks));
+  if (diagnosticsMutex == NULL)
+  {
+    printf("Failed to create diagnostics mutex.\n");
+  }
+  memset(&latestDiagnostics, 0, sizeof(latestDiagnostics));
+}
+
+// Index of `handle` in the previous sample, or -1 for a task new since then
+static int previousIndexOf(TaskHandle_t handle)
+{
+  for (int i = 0; i < previousCount; i++)
+  {
+    if (previousHandles[i] == handle)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Reports a task whose stack has run low, once per new low
+static void checkStack(const TaskDiagnostics &task, int previous)
+{
+  if (task.stackHighWaterMark >= DIAGNOSTICS_LOW_STACK_WORDS)
+  {
+    return;
+  }
+  if (previous >= 0 && previousStacks[previous] <= task.stackHighWaterMark)
+  {
+    return;
+  }
+  printf("Diagnostics: %s stack down to %lu free words.\n", task.name, (unsigned long)task.stackHighWaterMark);
+}
+
+static void sampleDiagnostics()
+{
+  configRUN_TIME_COUNTER_TYPE totalRunTime = 0;
+  UBaseType_t count = uxTaskGetSystemState(taskStatus, DIAGNOSTICS_MAX_TASKS, &totalRunTime);
+  if (count == 0)
+  {
+    printf("Diagnostics: more than %d tasks, increase DIAGNOSTICS_MAX_TASKS.\n", DIAGNOSTICS_MAX_TASKS);
+    return;
+  }
+
+  // Unsigned subtraction keeps the window correct when the 32-bit counter wraps
+  configRUN_TIME_COUNTER_TYPE window = (totalRunTime - previousTotal) * DIAGNOSTICS_CORES;
+
+  SystemDiagnostics sample;
+  memset(&sample, 0, sizeof(sample));
+  sample.taskCount = (int)count;
+  for (UBaseType_t i = 0; i < count; i++)
+  {
+    TaskDiagnostics &task = sample.tasks[i];
+    strncpy(task.name, taskStatus[i].pcTaskName, sizeof(task.name) - 1);
+    task.priority = taskStatus[i].uxCurrentPriority;
+    task.stackHighWaterMark = taskStatus[i].usStackHighWaterMark;
+    // A task new since the last sample only counts the time it has run so far
+    int previous = previousIndexOf(taskStatus[i].xHandle);
+    configRUN_TIME_COUNTER_TYPE ran = taskStatus[i].ulRunTimeCounter - (previous >= 0 ? previousCounters[previous] : 0);
+    task.cpuPermille = window > 0 ? (uint16_t)(((uint64_t)ran * 1000) / window) : 0;
+    checkStack(task, previous);
+  }
+  // Filled after the loop, which still looks up the previous sample by handle
+  for (UBaseType_t i = 0; i < count; i++)
+  {
+    previousHandles[i] = taskStatus[i].xHandle;
+    previousCounters[i] = taskStatus[i].ulRunTimeCounter;
+    previousStacks[i] = sample.tasks[i].stackHighWaterMark;
+  }
+  previousCount = (int)count;
+  previousTotal = totalRunTime;
+
+  sample.freeHeap = xPortGetFreeHeapSize();
+  sample.minEverFreeHeap = xPortGetMinimumEverFreeHeapSize();
+  if (sample.minEverFreeHeap < DIAGNOSTICS_LOW_HEAP_BYTES &&
+      (latestDiagnostics.sampleCount == 0 || sample.minEverFreeHeap < latestDiagnostics.minEverFreeHeap))
+  {
+    printf("Diagnostics: heap down to %u bytes free.\n", (unsigned)sample.minEverFreeHeap);
+  }
+  sample.uptimeSeconds = (uint32_t)(time_us_64() / 1000000);
+  getInputStats(&sample.input);
+#if STATIC_MEMORY
+  // Once booted nothing should allocate, so any growth here is worth a line on the console
+  sample.heapAllocations = heapAllocationCount;
+  if (latestDiagnostics.sampleCount > 0 && sample.heapAllocations != latestDiagnostics.heapAllocations)
+  {
+    printf("Diagnostics: %lu heap allocations since the last sample, the last of %lu bytes.\n",
+           (unsigned long)(sample.heapAllocations - latestDiagnostics.heapAllocations), (unsigned long)heapAllocationLastSize);
+  }
+#endif
+
+  if (xSemaphoreTake(diagnosticsMutex, portMAX_DELAY) == pdTRUE)
+  {
+    sample.sampleCount = latestDiagnostics.sampleCount + 1;
+    memcpy(&latestDiagnostics, &sample, sizeof(sample));
+    xSemaphoreGive(diagnosticsMutex);
+  }
+}
+
+bool getDiagnostics(SystemDiagnostics *out)
+{
+  if (diagnosticsMutex == NULL || xSemaphoreTake(diagnosticsMutex, pdMS_TO_TICKS(100)) != pdTRUE)
+  {
+    return false;
+  }
+  memcpy(out, &latestDiagnostics, sizeof(SystemDiagnostics));
+  xSemaphoreGive(diagnosticsMutex);
+  return out->sampleCount > 0;
+}
+
+size_t diagnosticsToJson(char *buffer, size_t length)
+{
+  static SystemDiagnostics snapshot;
+  if (!getDiagnostics(&snapshot))
+  {
+    return snprintf(buffer, length, "{}");
+  }
+
+  size_t offset = 0;
+  int written = snprintf(buffer, length,
+                         "{\"uptime\":%lu,\"freeHeap\":%u,\"minEverFreeHeap\":%u,\"heapAllocations\":%lu,"
+                         "\"input\":{\"events\":%lu,\"lastLatencyUs\":%lu,\"maxLatencyUs\":%lu,\"droppedEdges\":%lu},\"tasks\":[",
+                         (unsigned long)snapshot.uptimeSeconds, (unsigned)snapshot.freeHeap, (unsigned)snapshot.minEverFreeHeap,
+                         (unsigned long)snapshot.heapAllocations,
+                         (unsigned long)snapshot.input.events, (unsigned long)snapshot.input.lastLatencyUs,
+                         (unsigned long)snapshot.input.maxLatencyUs, (unsigned long)snapshot.input.droppedEdges);
+  if (written < 0 || (size_t)written >= length)
+  {
+    return 0;
+  }
+  offset += written;
+
+  for (int i = 0; i < snapshot.taskCount; i++)
+  {
+    const TaskDiagnostics &task = snapshot.tasks[i];
+    written = snprintf(buffer + offset, length - offset,
+                       "%s{\"name\":\"%s\",\"priority\":%u,\"cpu\":%u.%u,\"stackFree\":%lu}",
+                       i > 0 ? "," : "", task.name, (unsigned)task.priority,
+                       task.cpuPermille / 10, task.cpuPermille % 10, (unsigned long)task.stackHighWaterMark);
+    // Ensure we don't overflow the buffer
+    if (written < 0 || offset + written >= length)
+    {
+      break;
+    }
+    offset += written;
+  }
+
+  written = snprintf(buffer + offset, length - offset, "]}");
+  if (written > 0 && offset + written < length)
+  {
+    offset += written;
+  }
+  return offset;
+}
+
+void diagnosticsTask(void *params)
+{
+  while (true)
+  {
+    sampleDiagnostics();
+    vTaskDelay(pdMS_TO_TICKS(DIAGNOSTICS_SAMPLE_MS));
+  }
+}
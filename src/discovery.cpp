@@ -0,0 +1,505 @@
+#include "discovery.h"
+#include "constants.h"
+#include "wifi.h"
+#include "firmware-version.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "lwip/apps/mdns.h"
+#include "lwip/apps/mdns_priv.h"
+#include "lwip/prot/dns.h"
+#include "lwip/def.h"
+#include "lwip/ip4_addr.h"
+#include "lwip/netif.h"
+#include "lwip/timeouts.h"
+
+#include "pico/cyw43_arch.h"
+
+#define PEER_TTL_MAX_S 7200 // Longest a peer is kept without hearing from it again
+
+volatile bool mdnsAp = false;
+volatile bool mdnsSta = false;
+
+static s8_t mdnsServiceHandleSta = -1;
+static s8_t mdnsServiceHandleAp = -1;
+
+// Only touched with the lwIP lock held, or from lwIP's timeouts and callbacks
+static uint32_t lastAnnounceMs = 0;
+static bool announced = false;
+static bool announcePending = false;
+static u8_t browseRequest = 0;
+static bool browsing = false;
+static DiscoveredPeer peers[DISCOVERY_MAX_PEERS];
+
+// How lwIP hands over SRV and PTR results: the SRV priority, weight and port in
+// network byte order (not filled in for PTR), then the uncompressed target
+struct DomainResult
+{
+  u16_t values[3];
+  struct mdns_domain domain;
+};
+
+static void addTxtItem(struct mdns_service *service, const char *item)
+{
+  err_t err = mdns_resp_add_service_txtitem(service, item, (u8_t)strlen(item));
+  if (err != ERR_OK)
+  {
+    printf("mDNS: Failed to add TXT item %s (Error %d).\n", item, err);
+  }
+}
+
+// What a peer needs to know before it connects: the protocol spoken on the
+// advertised port, that it is JSON lines rather than binary frames, that only
+// one client is served at a time and whether that client is already there
+static void serviceTxt(struct mdns_service *service, void *txtUserdata)
+{
+  (void)txtUserdata;
+  char item[MDNS_LABEL_MAXLEN + 1];
+  snprintf(item, sizeof(item), "proto=%d", DISCOVERY_PROTOCOL_VERSION);
+  addTxtItem(service, item);
+  addTxtItem(service, "framing=json-lines");
+  addTxtItem(service, "clients=1");
+  snprintf(item, sizeof(item), "busy=%d", networkStatus == NetworkStatus::CLIENT_CONNECTED ? 1 : 0);
+  addTxtItem(service, item);
+  snprintf(item, sizeof(item), "fw=%s", FIRMWARE_VERSION);
+  addTxtItem(service, item);
+}
+
+// Writes the labels of `domain` from `offset` on, dotted, stopping after the
+// first label when `firstOnly` is set. Quotes and control characters become '_'
+// so the result can go into JSON as it is.
+static void domainToString(const struct mdns_domain *domain, u16_t offset, bool firstOnly, char *out, size_t length)
+{
+  size_t written = 0;
+  while (offset < domain->length && domain->name[offset] != 0)
+  {
+    u8_t labelLength = domain->name[offset++];
+    if (written > 0 && written + 1 < length)
+    {
+      out[written++] = '.';
+    }
+    for (u8_t i = 0; i < labelLength && offset < domain->length; i++, offset++)
+    {
+      char c = (char)domain->name[offset];
+      if (written + 1 < length)
+      {
+        out[written++] = (c == '"' || c == '\\' || (unsigned char)c < 0x20) ? '_' : c;
+      }
+    }
+    if (firstOnly)
+    {
+      break;
+    }
+  }
+  out[written] = '\0';
+}
+
+static bool peerExpired(const DiscoveredPeer &peer, uint32_t now)
+{
+  return peer.instance[0] == '\0' || now - peer.seenMs >= peer.ttlMs;
+}
+
+// Finds the entry for `instance`, taking over an expired or the stalest one
+// for a new peer when `create` is set
+static DiscoveredPeer *findPeer(const char *instance, bool create)
+{
+  uint32_t now = sys_now();
+  DiscoveredPeer *replace = NULL;
+  for (int i = 0; i < DISCOVERY_MAX_PEERS; i++)
+  {
+    DiscoveredPeer *peer = &peers[i];
+    if (strcmp(peer->instance, instance) == 0 && !peerExpired(*peer, now))
+    {
+      return peer;
+    }
+    if (replace == NULL || peerExpired(*peer, now) ||
+        (!peerExpired(*replace, now) && now - peer->seenMs > now - replace->seenMs))
+    {
+      replace = peer;
+    }
+  }
+  if (!create)
+  {
+    return NULL;
+  }
+  memset(replace, 0, sizeof(*replace));
+  strncpy(replace->instance, instance, sizeof(replace->instance) - 1);
+  return replace;
+}
+
+static void refreshPeer(DiscoveredPeer *peer, u32_t ttl)
+{
+  peer->seenMs = sys_now();
+  peer->ttlMs = (ttl < PEER_TTL_MAX_S ? ttl : PEER_TTL_MAX_S) * 1000;
+}
+
+static void parsePeerTxt(DiscoveredPeer *peer, const char *data, int length)
+{
+  // A run of length-prefixed strings
+  for (int offset = 0; offset < length;)
+  {
+    int itemLength = (u8_t)data[offset++];
+    if (offset + itemLength > length)
+    {
+      return;
+    }
+    if (itemLength > 6 && strncmp(data + offset, "proto=", 6) == 0)
+    {
+      int version = 0;
+      for (int i = 6; i < itemLength && data[offset + i] >= '0' && data[offset + i] <= '9'; i++)
+      {
+        version = version * 10 + (data[offset + i] - '0');
+      }
+      peer->protocolVersion = (uint8_t)(version < 255 ? version : 255);
+    }
+    offset += itemLength;
+  }
+}
+
+// Called on lwIP's thread for each record that answers the browse query
+static void browseResult(struct mdns_answer *answer, const char *varpart, int varlen, int flags, void *arg)
+{
+  (void)flags;
+  (void)arg;
+  char name[DISCOVERY_HOST_MAX];
+
+  switch (answer->info.type)
+  {
+  case DNS_RRTYPE_PTR:
+  {
+    // Points at an instance, its SRV and TXT records say the rest
+    if (varlen < (int)sizeof(DomainResult))
+    {
+      return;
+    }
+    const DomainResult *result = (const DomainResult *)varpart;
+    domainToString(&result->domain, 0, true, name, sizeof(name));
+    DiscoveredPeer *peer = findPeer(name, answer->ttl != 0);
+    if (peer != NULL && answer->ttl == 0)
+    {
+      // Goodbye, the compressor is going away
+      printf("mDNS: %s left.\n", peer->instance);
+      peer->instance[0] = '\0';
+    }
+    else if (peer != NULL)
+    {
+      refreshPeer(peer, answer->ttl);
+    }
+    break;
+  }
+  case DNS_RRTYPE_SRV:
+  {
+    if (varlen < (int)sizeof(DomainResult))
+    {
+      return;
+    }
+    const DomainResult *result = (const DomainResult *)varpart;
+    domainToString(&answer->info.domain, 0, true, name, sizeof(name));
+    DiscoveredPeer *peer = findPeer(name, answer->ttl != 0);
+    if (peer == NULL)
+    {
+      return;
+    }
+    if (answer->ttl == 0)
+    {
+      peer->instance[0] = '\0';
+      return;
+    }
+    uint16_t port = lwip_ntohs(result->values[2]);
+    domainToString(&result->domain, 0, false, name, sizeof(name));
+    if (peer->port != port || strcmp(peer->host, name) != 0)
+    {
+      printf("mDNS: Found %s at %s:%u.\n", peer->instance, name, port);
+      if (strcmp(peer->host, name) != 0)
+      {
+        peer->ipAddress = 0;
+      }
+      peer->port = port;
+      strncpy(peer->host, name, sizeof(peer->host) - 1);
+    }
+    refreshPeer(peer, answer->ttl);
+    break;
+  }
+  case DNS_RRTYPE_TXT:
+  {
+    domainToString(&answer->info.domain, 0, true, name, sizeof(name));
+    DiscoveredPeer *peer = findPeer(name, false);
+    if (peer != NULL)
+    {
+      parsePeerTxt(peer, varpart, varlen);
+    }
+    break;
+  }
+  case DNS_RRTYPE_A:
+  {
+    if (varlen != 4)
+    {
+      return;
+    }
+    domainToString(&answer->info.domain, 0, false, name, sizeof(name));
+    uint32_t now = sys_now();
+    for (int i = 0; i < DISCOVERY_MAX_PEERS; i++)
+    {
+      if (!peerExpired(peers[i], now) && strcmp(peers[i].host, name) == 0)
+      {
+        memcpy(&peers[i].ipAddress, varpart, sizeof(peers[i].ipAddress));
+      }
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+// Queries for compressors again every DISCOVERY_BROWSE_MS. The search stays
+// open in between, so announcements from units that start up are seen too.
+static void browse(void *arg)
+{
+  (void)arg;
+  if (browsing)
+  {
+    mdns_search_stop(browseRequest);
+  }
+  struct netif *staNetif = &cyw43_state.netif[CYW43_ITF_STA];
+  err_t err = mdns_search_service(NULL, DISCOVERY_PEER_SERVICE, DNSSD_PROTO_TCP, staNetif, browseResult, NULL, &browseRequest);
+  browsing = err == ERR_OK;
+  if (!browsing)
+  {
+    printf("mDNS: Browse for %s failed (Error %d).\n", DISCOVERY_PEER_SERVICE, err);
+  }
+  sys_timeout(DISCOVERY_BROWSE_MS, browse, NULL);
+}
+
+static void stopBrowsing()
+{
+  sys_untimeout(browse, NULL);
+  if (browsing)
+  {
+    mdns_search_stop(browseRequest);
+    browsing = false;
+  }
+}
+
+static void announce(void *arg)
+{
+  (void)arg;
+  announcePending = false;
+  if (mdnsSta)
+  {
+    mdns_resp_announce(&cyw43_state.netif[CYW43_ITF_STA]);
+  }
+  if (mdnsAp)
+  {
+    mdns_resp_announce(&cyw43_state.netif[CYW43_ITF_AP]);
+  }
+  lastAnnounceMs = sys_now();
+  announced = true;
+}
+
+void discoveryRequestAnnounce()
+{
+  cyw43_arch_lwip_begin();
+  if ((mdnsSta || mdnsAp) && !announcePending)
+  {
+    // A client coming and going in quick succession costs one announcement
+    uint32_t since = sys_now() - lastAnnounceMs;
+    uint32_t delay = announced && since < DISCOVERY_ANNOUNCE_MIN_MS ? DISCOVERY_ANNOUNCE_MIN_MS - since : 0;
+    announcePending = true;
+    sys_timeout(delay, announce, NULL);
+  }
+  cyw43_arch_lwip_end();
+}
+
+static void cancelAnnounce()
+{
+  if (!mdnsSta && !mdnsAp && announcePending)
+  {
+    sys_untimeout(announce, NULL);
+    announcePending = false;
+  }
+}
+
+void deinitMdnsSta()
+{
+  if (!mdnsSta)
+  {
+    return;
+  }
+  struct netif *sta_netif = &cyw43_state.netif[CYW43_ITF_STA];
+  cyw43_arch_lwip_begin();
+  stopBrowsing();
+  // If you have a valid service handle, explicitly delete the service:
+  if (mdnsServiceHandleSta >= 0)
+  {
+    mdns_resp_del_service(sta_netif, mdnsServiceHandleSta);
+    mdnsServiceHandleSta = -1;
+  }
+  // Now remove the netif from the mDNS responder.
+  mdns_resp_remove_netif(sta_netif);
+  printf("mDNS on STA netif removed.\n");
+  mdnsSta = false;
+  cancelAnnounce();
+  cyw43_arch_lwip_end();
+}
+
+void initMdnsSta()
+{
+  if (mdnsSta)
+  {
+    return;
+  }
+  // Get a pointer to the STA network interface.
+  struct netif *sta_netif = &cyw43_state.netif[CYW43_ITF_STA];
+  if (!sta_netif)
+  {
+    printf("STA netif is null.\n");
+    return;
+  }
+
+  // Set the hostname using the provided API.
+  netif_set_hostname(sta_netif, MDNS_DOMAIN);
+
+  // Begin lwIP critical section.
+  cyw43_arch_lwip_begin();
+
+  // Add the network interface with the hostname.
+  mdns_resp_add_netif(sta_netif, netif_get_hostname(sta_netif));
+
+  // Advertise the service on the port the compressor link is served on.
+  mdnsServiceHandleSta = mdns_resp_add_service(sta_netif, MDNS_NAME, MDNS_SERVICE, DNSSD_PROTO_TCP, SOCKET_SERVER_PORT, serviceTxt, NULL);
+  if (mdnsServiceHandleSta < 0)
+  {
+    printf("mDNS add service failed for STA: %d\n", mdnsServiceHandleSta);
+    mdns_resp_remove_netif(sta_netif);
+    cyw43_arch_lwip_end();
+    return;
+  }
+
+  // Announce the service.
+  mdns_resp_announce(sta_netif);
+  lastAnnounceMs = sys_now();
+  announced = true;
+  printf("mDNS for STA initialized and service advertised.\n");
+
+  mdnsSta = true;
+  browse(NULL);
+
+  // End lwIP critical section.
+  cyw43_arch_lwip_end();
+}
+
+void deinitMdnsAp()
+{
+  if (!mdnsAp)
+  {
+    return;
+  }
+  struct netif *ap_netif = &cyw43_state.netif[CYW43_ITF_AP];
+  cyw43_arch_lwip_begin();
+  // If you have a valid service handle, explicitly delete the service:
+  if (mdnsServiceHandleAp >= 0)
+  {
+    mdns_resp_del_service(ap_netif, mdnsServiceHandleAp);
+    mdnsServiceHandleAp = -1;
+  }
+  // Now remove the netif from the mDNS responder.
+  mdns_resp_remove_netif(ap_netif);
+  printf("mDNS on AP netif removed.\n");
+  mdnsAp = false;
+  cancelAnnounce();
+  cyw43_arch_lwip_end();
+}
+
+// Helper function to initialize and advertise mDNS for AP mode.
+void initMdnsAp()
+{
+  if (mdnsAp)
+  {
+    return;
+  }
+  // Get a pointer to the AP network interface.
+  struct netif *ap_netif = &cyw43_state.netif[CYW43_ITF_AP];
+  if (!ap_netif)
+  {
+    printf("AP netif is null.\n");
+    return;
+  }
+
+  // Set the hostname using the provided API.
+  netif_set_hostname(ap_netif, MDNS_DOMAIN);
+
+  // Begin lwIP critical section.
+  cyw43_arch_lwip_begin();
+
+  // Add the network interface with the hostname.
+  mdns_resp_add_netif(ap_netif, netif_get_hostname(ap_netif));
+
+  // Advertise the service on the port the compressor link is served on.
+  mdnsServiceHandleAp = mdns_resp_add_service(ap_netif, MDNS_NAME, MDNS_SERVICE, DNSSD_PROTO_TCP, SOCKET_SERVER_PORT, serviceTxt, NULL);
+  if (mdnsServiceHandleAp < 0)
+  {
+    printf("mDNS add service failed for AP: %d\n", mdnsServiceHandleAp);
+    mdns_resp_remove_netif(ap_netif);
+    cyw43_arch_lwip_end();
+    return;
+  }
+
+  // Announce the service.
+  mdns_resp_announce(ap_netif);
+  lastAnnounceMs = sys_now();
+  announced = true;
+  printf("mDNS for AP initialized and service advertised.\n");
+
+  // End lwIP critical section.
+  cyw43_arch_lwip_end();
+  mdnsAp = true;
+}
+
+size_t discoveredPeersToJson(char *buffer, size_t length)
+{
+  size_t offset = 0;
+  int written = snprintf(buffer, length, "{\"peers\":[");
+  if (written < 0 || (size_t)written >= length)
+  {
+    return 0;
+  }
+  offset += written;
+
+  bool first = true;
+  uint32_t now = sys_now();
+  for (int i = 0; i < DISCOVERY_MAX_PEERS; i++)
+  {
+    const DiscoveredPeer &peer = peers[i];
+    if (peerExpired(peer, now))
+    {
+      continue;
+    }
+    char address[IP4ADDR_STRLEN_MAX] = "";
+    if (peer.ipAddress != 0)
+    {
+      ip4_addr_t ip;
+      ip4_addr_set_u32(&ip, peer.ipAddress);
+      ip4addr_ntoa_r(&ip, address, sizeof(address));
+    }
+    written = snprintf(buffer + offset, length - offset,
+                       "%s{\"instance\":\"%s\",\"host\":\"%s\",\"ip\":\"%s\",\"port\":%u,\"proto\":%u,\"ageMs\":%lu,\"ttlMs\":%lu}",
+                       first ? "" : ",", peer.instance, peer.host, address, peer.port, peer.protocolVersion,
+                       (unsigned long)(now - peer.seenMs), (unsigned long)peer.ttlMs);
+    // Ensure we don't overflow the buffer
+    if (written < 0 || offset + written >= length)
+    {
+      break;
+    }
+    offset += written;
+    first = false;
+  }
+
+  written = snprintf(buffer + offset, length - offset, "]}");
+  if (written > 0 && offset + written < length)
+  {
+    offset += written;
+  }
+  return offset;
+}
@@ -0,0 +1,210 @@
+#include "display-panel.h"
+
+#include <string.h>
+
+static PanelInterface *panel = NULL;
+static uint8_t shadow[PANEL_HEIGHT][PANEL_WIDTH]; // What the panel's GDRAM holds, RGB_COLOR8
+static_assert(sizeof(shadow) == PANEL_SHADOW_BYTES, "display.cpp accounts the shadow as PANEL_SHADOW_BYTES");
+static bool shadowValid = false;
+
+void initDisplayPanel(PanelInterface *interface)
+{
+  panel = interface;
+  panelClear(0, 0, PANEL_WIDTH - 1, PANEL_HEIGHT - 1);
+}
+
+void panelInvalidate()
+{
+  shadowValid = false;
+}
+
+// Same expansion the controller applies to 256-colour pixels (high bits
+// repeated), so accelerated shapes match the pixels around them
+static uint16_t panelColor(uint8_t color)
+{
+  uint16_t r = color >> 5;
+  uint16_t g = (color >> 2) & 0x07;
+  uint16_t b = color & 0x03;
+  return ((r << 2) | (r >> 1)) << 11 | ((g << 3) | g) << 5 | ((b << 3) | (b << 1) | (b >> 1));
+}
+
+static bool clipRect(int &x1, int &y1, int &x2, int &y2)
+{
+  if (x1 > x2)
+  {
+    int swap = x1;
+    x1 = x2;
+    x2 = swap;
+  }
+  if (y1 > y2)
+  {
+    int swap = y1;
+    y1 = y2;
+    y2 = swap;
+  }
+  if (x2 < 0 || y2 < 0 || x1 >= PANEL_WIDTH || y1 >= PANEL_HEIGHT)
+  {
+    return false;
+  }
+  x1 = x1 < 0 ? 0 : x1;
+  y1 = y1 < 0 ? 0 : y1;
+  x2 = x2 >= PANEL_WIDTH ? PANEL_WIDTH - 1 : x2;
+  y2 = y2 >= PANEL_HEIGHT ? PANEL_HEIGHT - 1 : y2;
+  return true;
+}
+
+static bool shadowIs(int x1, int y1, int x2, int y2, uint8_t color)
+{
+  if (!shadowValid)
+  {
+    return false;
+  }
+  for (int y = y1; y <= y2; y++)
+  {
+    for (int x = x1; x <= x2; x++)
+    {
+      if (shadow[y][x] != color)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static void shadowFill(int x1, int y1, int x2, int y2, uint8_t color)
+{
+  for (int y = y1; y <= y2; y++)
+  {
+    memset(&shadow[y][x1], color, x2 - x1 + 1);
+  }
+}
+
+void panelFillRect(int x1, int y1, int x2, int y2, uint8_t color)
+{
+  if (!clipRect(x1, y1, x2, y2) || shadowIs(x1, y1, x2, y2, color))
+  {
+    return;
+  }
+  panel->fillRect(x1, y1, x2, y2, panelColor(color));
+  shadowFill(x1, y1, x2, y2, color);
+}
+
+void panelDrawRect(int x1, int y1, int x2, int y2, uint8_t color)
+{
+  if (!clipRect(x1, y1, x2, y2))
+  {
+    return;
+  }
+  if (shadowIs(x1, y1, x2, y1, color) && shadowIs(x1, y2, x2, y2, color) &&
+      shadowIs(x1, y1, x1, y2, color) && shadowIs(x2, y1, x2, y2, color))
+  {
+    return;
+  }
+  panel->drawRect(x1, y1, x2, y2, panelColor(color));
+  shadowFill(x1, y1, x2, y1, color);
+  shadowFill(x1, y2, x2, y2, color);
+  shadowFill(x1, y1, x1, y2, color);
+  shadowFill(x2, y1, x2, y2, color);
+}
+
+void panelClear(int x1, int y1, int x2, int y2)
+{
+  if (!clipRect(x1, y1, x2, y2) || shadowIs(x1, y1, x2, y2, 0))
+  {
+    return;
+  }
+  panel->clearWindow(x1, y1, x2, y2);
+  shadowFill(x1, y1, x2, y2, 0);
+  if (x1 == 0 && y1 == 0 && x2 == PANEL_WIDTH - 1 && y2 == PANEL_HEIGHT - 1)
+  {
+    shadowValid = true; // Every pixel is known again
+  }
+}
+
+void panelCopy(int x1, int y1, int x2, int y2, int newX, int newY)
+{
+  if (!clipRect(x1, y1, x2, y2) || newX < 0 || newY < 0 || newX >= PANEL_WIDTH || newY >= PANEL_HEIGHT)
+  {
+    return;
+  }
+  // The controller drops whatever would land off the panel
+  int width = x2 - x1 + 1;
+  int height = y2 - y1 + 1;
+  width = newX + width > PANEL_WIDTH ? PANEL_WIDTH - newX : width;
+  height = newY + height > PANEL_HEIGHT ? PANEL_HEIGHT - newY : height;
+  panel->copyBlock(x1, y1, x2, y2, newX, newY);
+
+  // Rows in the order that never reads one already overwritten
+  int step = newY > y1 ? -1 : 1;
+  for (int i = step > 0 ? 0 : height - 1; i >= 0 && i < height; i += step)
+  {
+    memmove(&shadow[newY + i][newX], &shadow[y1 + i][x1], width);
+  }
+}
+
+// Sends the rows top to bottom, columns left to right, as one window
+static void sendBand(const uint8_t *pixels, int top, int bottom, int left, int right)
+{
+  int width = right - left + 1;
+  panel->startBlock(left, top, width);
+  for (int y = top; y <= bottom; y++)
+  {
+    const uint8_t *row = pixels + y * PANEL_WIDTH + left;
+    panel->sendBuffer(row, width);
+    memcpy(&shadow[y][left], row, width);
+  }
+  panel->endBlock();
+}
+
+// Consecutive rows with changes are sent as one window spanning all of their
+// changed columns, so a frame costs a few window setups and the changed pixels
+void panelDrawCanvas(NanoCanvas8 &canvas)
+{
+  const uint8_t *pixels = canvas.getData();
+  int top = -1;
+  int left = PANEL_WIDTH;
+  int right = -1;
+  for (int y = 0; y <= PANEL_HEIGHT; y++)
+  {
+    int first = PANEL_WIDTH;
+    int last = -1;
+    if (y < PANEL_HEIGHT)
+    {
+      const uint8_t *row = pixels + y * PANEL_WIDTH;
+      if (!shadowValid)
+      {
+        first = 0;
+        last = PANEL_WIDTH - 1;
+      }
+      else if (memcmp(row, shadow[y], PANEL_WIDTH) != 0)
+      {
+        first = 0;
+        while (row[first] == shadow[y][first])
+        {
+          first++;
+        }
+        last = PANEL_WIDTH - 1;
+        while (row[last] == shadow[y][last])
+        {
+          last--;
+        }
+      }
+    }
+    if (last >= 0)
+    {
+      top = top < 0 ? y : top;
+      left = first < left ? first : left;
+      right = last > right ? last : right;
+      continue;
+    }
+    if (top >= 0)
+    {
+      sendBand(pixels, top, y - 1, left, right);
+      top = -1;
+      left = PANEL_WIDTH;
+      right = -1;
+    }
+  }
+  shadowValid = true;
+}
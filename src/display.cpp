@@ -1,4 +1,6 @@
 #include "display.h"
+#include "display-panel.h"
+#include "display-palette.h"
 #include "constants.h"
 #include "settings.h"
 #include "sensors.h"
@@ -7,6 +9,9 @@
 #include "lights.h"
 #include "control.h"
 #include "compressor-status.h"
+#include "diagnostics.h"
+#include "static-memory.h"
+#include "boot-timeline.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -17,14 +22,16 @@
 #include "FreeRTOS.h"
 #include "timers.h"
 
-#define MIN_FAN_SPEED 10;
-#define MAX_FAN_SPEED 100;
-#define MIN_COMPRESSION_TIMER_DURATION 5;
-#define MIN_MOTOR_TIMER_DURATION 1;
-#define MIN_RELEASE_TIMER_DURATION 1;
-#define MAX_COMPRESSION_TIMER_DURATION 60;
-#define MAX_MOTOR_TIMER_DURATION 10;
-#define MAX_RELEASE_TIMER_DURATION 10;
+#define MIN_FAN_SPEED 10
+#define MAX_FAN_SPEED 100
+#define MIN_COMPRESSION_TIMER_DURATION 5
+#define MIN_MOTOR_TIMER_DURATION 1
+#define MIN_RELEASE_TIMER_DURATION 1
+#define MAX_COMPRESSION_TIMER_DURATION 60
+#define MAX_MOTOR_TIMER_DURATION 10
+#define MAX_RELEASE_TIMER_DURATION 10
+#define AUTO_BRIGHTNESS_LUX_STEP 50
+#define MAX_AUTO_BRIGHTNESS_LUX 5000
 
 // Define the SPI configuration
 SPlatformSpiConfig spiConfig = {
@@ -35,12 +42,37 @@ SPlatformSpiConfig spiConfig = {
     .sda = DISPLAY_SPI_MOSI_GPIO // MOSI Pin
 };
 
-const int canvasWidth = 96;  // Width
-const int canvasHeight = 64; // Height
+const int canvasWidth = PANEL_WIDTH;
+const int canvasHeight = PANEL_HEIGHT;
+#ifdef DISPLAY_16BPP
+// An RGB565 frame takes twice the RAM of the 8-bit canvas, so it is drawn in
+// horizontal strips. Each screen is drawn once per strip with the canvas offset
+// to it, and one strip is drawn while the other goes out over DMA.
+#define DISPLAY_STRIP_HEIGHT 16
+#define DISPLAY_STRIPS (canvasHeight / DISPLAY_STRIP_HEIGHT)
+
+class StripCanvas : public NanoCanvas16
+{
+public:
+  using NanoCanvas16::NanoCanvas16;
+
+  // Swaps the strip being drawn without resetting colour, font or mode like begin() does
+  void setBuffer(uint8_t *bytes)
+  {
+    m_buf = bytes;
+  }
+};
+
+uint8_t canvasData[2][canvasWidth * DISPLAY_STRIP_HEIGHT * 2];
+
+DisplaySSD1331_96x64x16_SPI display(DISPLAY_SPI_RST_GPIO, spiConfig);
+StripCanvas canvas(canvasWidth, DISPLAY_STRIP_HEIGHT, canvasData[0]);
+#else
 uint8_t canvasData[canvasWidth * canvasHeight];
 
 DisplaySSD1331_96x64x8_SPI display(DISPLAY_SPI_RST_GPIO, spiConfig);
 NanoCanvas8 canvas(canvasWidth, canvasHeight, canvasData);
+#endif
 const char *compressorSettingsMenuItems[] = {
     "P-Timeout",
     "M-Timeout",
@@ -52,13 +84,16 @@ static LcdGfxMenu compressorSettingsMenu(compressorSettingsMenuItems, sizeof(com
 const char *extactorSettingsMenuItems[] = {
     "Speed",
     "Stats",
+    "Calibrate",
 };
 static LcdGfxMenu extractorSettingsMenu(extactorSettingsMenuItems, sizeof(extactorSettingsMenuItems) / sizeof(char *), (NanoRect){{0, 0}, {0, 0}});
 
 const char *lightsSettingsMenuItems[] = {
     "Max",
+    "Auto",
     "Cooling",
     "Stats",
+    "System",
 };
 static LcdGfxMenu lightsSettingsMenu(lightsSettingsMenuItems, sizeof(lightsSettingsMenuItems) / sizeof(char *), (NanoRect){{0, 0}, {0, 0}});
 
@@ -73,6 +108,26 @@ static int lightsAlertCount = 0;
 static int compressionTimerDuration = 0;
 static int motorTimerDuration = 0;
 static int releaseTimerDuration = 0;
+static int diagnosticsScroll = 0;
+static SystemDiagnostics shownDiagnostics;
+static bool diagnosticsSampled = false;
+static bool compressorBoxFilled = false;
+static bool extractorBoxFilled = false;
+static bool lightsBoxFilled = false;
+// Readings for the frame being drawn, so every strip of it shows the same values
+static SensorReadings shownReadings;
+static uint32_t shownReadingsVersion = 0;
+static float shownLux = 0.0f;
+#ifndef DISPLAY_16BPP
+static int panelScreen = -1; // Screen the panel last showed, a new one starts from a hardware clear
+#endif
+
+// Copies the sensor snapshot only when it has been republished
+static void sampleReadings()
+{
+  sensorReadings.readIfChanged(&shownReadings, &shownReadingsVersion);
+  shownLux = boothLux.read();
+}
 
 void alertCompressor(int flashes)
 {
@@ -94,15 +149,19 @@ void flashTimerCallback(TimerHandle_t xTimer)
 
 void initDisplay()
 {
-  display.begin();
   canvas.setMode(CANVAS_MODE_TRANSPARENT);
-  TimerHandle_t xFlashTimer = xTimerCreate(
+#ifdef DISPLAY_16BPP
+  staticMemoryAccount("display", sizeof(canvasData));
+#else
+  staticMemoryAccount("display", sizeof(canvasData) + canvas8GlyphCacheSize() + PANEL_SHADOW_BYTES);
+#endif
+  static StaticTimer flashTimerMemory;
+  TimerHandle_t xFlashTimer = flashTimerMemory.create(
       "FlashTimer",        // Timer name
       pdMS_TO_TICKS(1000), // Timer period in ticks (1000 ms)
-      pdTRUE,              // Auto-reload
-      (void *)0,           // Timer ID
-      flashTimerCallback   // Callback function
-  );
+      true,                // Auto-reload
+      flashTimerCallback,  // Callback function
+      "display");
 
   if (xFlashTimer == NULL)
   {
@@ -117,79 +176,107 @@ void initDisplay()
   }
 }
 
-void getRgb(uint8_t color, uint8_t &r, uint8_t &g, uint8_t &b)
+// Colour for a temperature against its target, blue below through green to red above
+DisplayColor calculateColor(float targetTemperature, float actualTemperature)
 {
-  r = (color & 0xE0);      // Extract red (bits 7-5, 3 bits)
-  g = (color & 0x1C) << 3; // Extract green (bits 4-2, shift left to fill 8 bits)
-  b = (color & 0x03) << 6; // Extract blue (bits 1-0, shift left to fill 8 bits)
+  return temperatureColor(actualTemperature - targetTemperature);
 }
 
-// Function to interpolate between two colors
-uint8_t interpolateColor(uint32_t colorA, uint32_t colorB, int progress)
+#ifdef DISPLAY_16BPP
+// Draws a screen strip by strip. A strip is sent with DMA while the next one is
+// drawn into the other buffer, and the bus is only handed to the next strip once
+// the previous one has left it.
+static void presentFrame(void (*draw)())
 {
-  // Normalize progress to a value between 0.0 and 1.0
-  float normalizedProgress = static_cast<float>(progress) / 100.0f;
-
-  // Extract RGB components from both colors
-  uint8_t rA, gA, bA;
-  uint8_t rB, gB, bB;
-  getRgb(colorA, rA, gA, bA);
-  getRgb(colorB, rB, gB, bB);
-
-  printf("RA: %d GA: %d BA: %d\n", rA, gA, bA);
-  printf("RB: %d GB: %d BB: %d\n", rB, gB, bB);
-
-  // Interpolate the RGB values
-  uint8_t r = static_cast<uint8_t>(rA * (1 - normalizedProgress) + rB * normalizedProgress);
-  uint8_t g = static_cast<uint8_t>(gA * (1 - normalizedProgress) + gB * normalizedProgress);
-  uint8_t b = static_cast<uint8_t>(bA * (1 - normalizedProgress) + bB * normalizedProgress);
-
-  printf("R: %d G: %d B: %d\n", r, g, b);
-
-  // Return the final interpolated color in RGB_COLOR8 format
-  return RGB_COLOR8(r, g, b);
+  PicoSpi &spi = display.getInterface();
+  for (int strip = 0; strip < DISPLAY_STRIPS; strip++)
+  {
+    canvas.setBuffer(canvasData[strip & 1]);
+    canvas.setOffset(0, strip * DISPLAY_STRIP_HEIGHT);
+    canvas.clear();
+    draw();
+    if (strip > 0)
+    {
+      spi.waitBuffer();
+      display.getInterface().endBlock();
+    }
+    display.getInterface().startBlock(0, strip * DISPLAY_STRIP_HEIGHT, canvasWidth);
+    spi.sendBufferAsync(canvasData[strip & 1], sizeof(canvasData[0]));
+  }
+  spi.waitBuffer();
+  display.getInterface().endBlock();
 }
-
-uint8_t calculateColor(float targetTemperature, float actualTemperature)
+#else
+// Draws a screen and sends it to the panel. A new screen starts from a hardware
+// clear, so only its lit pixels go over SPI.
+static void presentFrame(void (*draw)())
 {
-  const float range = 5.0; // Range for transition (degrees above/below target)
-  float difference = actualTemperature - targetTemperature;
-
-  uint8_t red = 0, green = 0, blue = 0;
+  canvas.clear();
+  draw();
+  if (panelScreen != currentDisplay)
+  {
+    panelClear(0, 0, canvasWidth - 1, canvasHeight - 1);
+    panelScreen = currentDisplay;
+  }
+  panelDrawCanvas(canvas);
+}
+#endif
 
-  if (difference <= -range)
+// Box outlines and alert fills go to the controller's rectangle command as well
+// as the canvas, so presentFrame() finds them already on the panel
+static void drawBox(int x1, int y1, int x2, int y2, DisplayColor color, bool filled)
+{
+  canvas.setColor(color);
+  if (filled)
   {
-    // Fully blue when 5 or more degrees below target
-    red = 0;
-    green = 0;
-    blue = 255;
+    canvas.fillRect(x1, y1, x2, y2);
+#ifndef DISPLAY_16BPP
+    panelFillRect(x1, y1, x2, y2, color);
+#endif
   }
-  else if (difference >= range)
+  else
   {
-    // Fully red when 5 or more degrees above target
-    red = 255;
-    green = 0;
-    blue = 0;
+    canvas.drawRect(x1, y1, x2, y2);
+#ifndef DISPLAY_16BPP
+    panelDrawRect(x1, y1, x2, y2, color);
+#endif
   }
-  else if (difference < 0)
+}
+
+// Alternates a box between filled and outlined each frame while it has flashes left
+static void stepAlert(int &alertCount, bool &filled)
+{
+  if (alertCount > 0 && !filled)
   {
-    // Transition from blue to green (below target)
-    float ratio = (range + difference) / range; // Ratio from 0 (blue) to 1 (green)
-    red = 0;
-    green = static_cast<uint8_t>(255 * ratio);
-    blue = static_cast<uint8_t>(255 * (1 - ratio));
+    filled = true;
+    alertCount--;
   }
-  else
+  else if (filled)
   {
-    // Transition from green to red (above target)
-    float ratio = difference / range; // Ratio from 0 (green) to 1 (red)
-    red = static_cast<uint8_t>(255 * ratio);
-    green = static_cast<uint8_t>(255 * (1 - ratio));
-    blue = 0;
+    filled = false;
   }
+}
 
-  // Convert to RGB_COLOR8 format (8 bits per color)
-  return RGB_COLOR8(red, green, blue);
+// Menus draw straight to the display, which leaves the panel's copy of GDRAM stale
+static void showMenu(LcdGfxMenu &menu)
+{
+  menu.show(display);
+#ifndef DISPLAY_16BPP
+  panelInvalidate();
+#endif
+}
+
+static void displayMenu(DisplayType screen, LcdGfxMenu &menu)
+{
+  currentDisplay = screen;
+  display.setFixedFont(ssd1306xled_font6x8);
+#ifdef DISPLAY_16BPP
+  display.clear();
+#else
+  panelClear(0, 0, canvasWidth - 1, canvasHeight - 1);
+  panelScreen = screen;
+#endif
+  showMenu(menu);
 }
 
 void renderSetCompressionTimeout()
@@ -248,29 +335,135 @@ void renderSetFanSpeed()
   // display.drawCanvas(0, 0, canvas);
 }
 
-void renderCompressor()
+// Lit while a changed setting waits for, or is in, its flash commit
+static void drawSavingIndicator(int x, int y)
 {
-  static bool localFlash = false;
-  static bool fillRect = false;
-  if (compressorAlertCount > 0 && !fillRect)
+  if (settingsDirty() != 0)
   {
-    fillRect = true;
-    compressorAlertCount--;
+    canvas.setColor(ORANGE);
+    canvas.fillRect(x, y, x + 3, y + 3);
   }
-  else if (fillRect)
+}
+
+static void drawLightCooling()
+{
+  char buffer[32];
+  canvas.setFixedFont(ssd1306xled_font6x8);
+  canvas.setColor(WHITE);
+  canvas.printFixed(0, 0, "COOLING", STYLE_NORMAL);
+  canvas.setColor(currentSettings.lightCooling ? GREEN : GREY);
+  canvas.printFixed(66, 0, currentSettings.lightCooling ? "ON" : "OFF", STYLE_NORMAL);
+  drawSavingIndicator(91, 1);
+
+  // One row per bar: measured, predicted and the duty limit it is held to
+  canvas.setFixedFont(ssd1306xled_font5x7);
+  for (int i = 0; i < LIGHTS_CHANNELS; i++)
   {
-    fillRect = false;
+    canvas.setColor(lightsChannelLimit[i] < 100 ? RED : WHITE);
+    snprintf(buffer, sizeof(buffer), "%c %4.1f>%4.1f %3d%%", 'A' + i, shownReadings.lightsTemp[i], lightsChannelPredicted[i], lightsChannelLimit[i]);
+    canvas.printFixed(0, 14 + i * 10, buffer, STYLE_NORMAL);
   }
+  canvas.setColor(GREY);
+  snprintf(buffer, sizeof(buffer), "DERATE %d-%dC", currentSettings.lightDerateStart, currentSettings.lightDerateEnd);
+  canvas.printFixed(0, 50, buffer, STYLE_NORMAL);
+}
+
+void renderLightCooling()
+{
+  sampleReadings();
+  presentFrame(drawLightCooling);
+}
+
+static void drawAutoBrightness()
+{
+  char buffer[32];
+  canvas.setFixedFont(ssd1306xled_font6x8);
+  canvas.setColor(WHITE);
+  canvas.printFixed(0, 0, "AUTO LIGHT", STYLE_NORMAL);
+  drawSavingIndicator(91, 1);
 
-  canvas.setColor(RED);
-  if (fillRect)
+  canvas.setFreeFont(free_koi12x24);
+  if (currentSettings.autoBrightness)
   {
-    canvas.fillRect(0, 0, 30, 32);
+    snprintf(buffer, sizeof(buffer), "%d", currentSettings.autoBrightnessLux);
+    canvas.setColor(GREEN);
   }
   else
   {
-    canvas.drawRect(0, 0, 30, 32);
+    snprintf(buffer, sizeof(buffer), "OFF");
+    canvas.setColor(GREY);
   }
+  canvas.printFixed(18, 24, buffer, STYLE_NORMAL);
+
+  canvas.setFixedFont(ssd1306xled_font5x7);
+  canvas.setColor(GREY);
+  snprintf(buffer, sizeof(buffer), "NOW %d LUX %d%%", (int)shownLux, lightBrightness);
+  canvas.printFixed(0, 54, buffer, STYLE_NORMAL);
+}
+
+void renderAutoBrightness()
+{
+  sampleReadings();
+  presentFrame(drawAutoBrightness);
+}
+
+// Six task rows fit under the header, scroll through the rest with up/down
+#define DIAGNOSTICS_ROWS 6
+
+static void drawDiagnostics()
+{
+  const SystemDiagnostics &diagnostics = shownDiagnostics;
+  char buffer[32];
+  canvas.setFixedFont(ssd1306xled_font5x7);
+  if (!diagnosticsSampled)
+  {
+    canvas.setColor(GREY);
+    canvas.printFixed(2, 28, "SAMPLING...", STYLE_NORMAL);
+    return;
+  }
+
+  canvas.setColor(WHITE);
+  snprintf(buffer, sizeof(buffer), "HEAP %uk MIN %uk", (unsigned)(diagnostics.freeHeap / 1024), (unsigned)(diagnostics.minEverFreeHeap / 1024));
+  canvas.printFixed(0, 0, buffer, STYLE_NORMAL);
+
+  const int rows = DIAGNOSTICS_ROWS;
+  for (int row = 0; row < rows && diagnosticsScroll + row < diagnostics.taskCount; row++)
+  {
+    const TaskDiagnostics &task = diagnostics.tasks[diagnosticsScroll + row];
+    // Stacks with less than 64 words of headroom are worth a look
+    canvas.setColor(task.stackHighWaterMark < 64 ? RED : GREEN);
+    snprintf(buffer, sizeof(buffer), "%-7.7s%3u%%%5lu", task.name, task.cpuPermille / 10, (unsigned long)task.stackHighWaterMark);
+    canvas.printFixed(0, 10 + row * 9, buffer, STYLE_NORMAL);
+  }
+}
+
+void renderDiagnostics()
+{
+  diagnosticsSampled = getDiagnostics(&shownDiagnostics);
+  if (diagnosticsSampled)
+  {
+    const int rows = DIAGNOSTICS_ROWS;
+    if (diagnosticsScroll > shownDiagnostics.taskCount - rows)
+    {
+      diagnosticsScroll = shownDiagnostics.taskCount > rows ? shownDiagnostics.taskCount - rows : 0;
+    }
+#ifndef DISPLAY_16BPP
+    // Scrolling down a row moves the rest up in one copy command, so only the new
+    // bottom row is sent. Copies run in raster order, so only upward moves are safe.
+    static int panelScroll = 0; // diagnosticsScroll of the rows on the panel
+    if (panelScreen == DIAGNOSTICS_DISPLAY && diagnosticsScroll == panelScroll + 1)
+    {
+      panelCopy(0, 19, canvasWidth - 1, canvasHeight - 1, 0, 10);
+    }
+    panelScroll = diagnosticsScroll;
+#endif
+  }
+  presentFrame(drawDiagnostics);
+}
+
+static void drawCompressor()
+{
+  drawBox(0, 0, 30, 32, RED, compressorBoxFilled);
 
   switch (networkStatus)
   {
@@ -332,42 +525,38 @@ void renderCompressor()
   }
 }
 
-void renderExtractor()
+static void drawExtractor()
 {
-  static bool localFlash = false;
-  static bool fillRect = false;
-  if (extractorAlertCount > 0 && !fillRect)
-  {
-    fillRect = true;
-    extractorAlertCount--;
-  }
-  else if (fillRect)
-  {
-    fillRect = false;
-  }
-  canvas.setColor(ORANGE);
-  if (fillRect)
-  {
-    canvas.fillRect(32, 0, 63, 32);
-  }
-  else
-  {
-    canvas.drawRect(32, 0, 63, 32);
-  }
+  drawBox(32, 0, 63, 32, ORANGE, extractorBoxFilled);
   canvas.setFixedFont(ssd1306xled_font6x8);
   if (extractorOn)
   {
     canvas.setColor(WHITE);
     canvas.printFixed(41, 8, "ON", STYLE_NORMAL);
   }
+  else if (extractorCoolingDemand > 0)
+  {
+    // Running for the light bars rather than the user
+    canvas.setColor(BLUE);
+    canvas.printFixed(36, 8, "COOL", STYLE_NORMAL);
+  }
   else
   {
     canvas.setColor(GREY);
     canvas.printFixed(38, 8, "OFF", STYLE_NORMAL);
   }
   char buffer[32];
-  snprintf(buffer, sizeof(buffer), "%d%%", currentFanSpeed);
   canvas.setFixedFont(ssd1306xled_font5x7);
+  if (extractorStalled)
+  {
+    if (flash)
+    {
+      canvas.setColor(RED);
+      canvas.printFixed(34, 19, "STALL", STYLE_NORMAL);
+    }
+    return;
+  }
+  snprintf(buffer, sizeof(buffer), "%d%%", currentFanSpeed);
   if (currentFanSpeed != targetFanSpeed)
   {
     canvas.setColor(GREY);
@@ -390,28 +579,9 @@ void renderExtractor()
   }
 }
 
-void renderLights()
+static void drawLights()
 {
-  static bool localFlash = false;
-  static bool fillRect = false;
-  if (lightsAlertCount > 0 && !fillRect)
-  {
-    fillRect = true;
-    lightsAlertCount--;
-  }
-  else if (fillRect)
-  {
-    fillRect = false;
-  }
-  canvas.setColor(GREEN);
-  if (fillRect)
-  {
-    canvas.fillRect(65, 0, 95, 32);
-  }
-  else
-  {
-    canvas.drawRect(65, 0, 95, 32);
-  }
+  drawBox(65, 0, 95, 32, GREEN, lightsBoxFilled);
 
   canvas.setFixedFont(ssd1306xled_font6x8);
   if (lightBrightness > 0)
@@ -449,51 +619,33 @@ void renderLights()
   }
 }
 
-void renderBottom()
+static void drawBottom()
 {
   char buffer[32];
   canvas.setFixedFont(ssd1306xled_font5x7);
   canvas.setColor(WHITE);
   canvas.printFixed(2, 36, "T:", STYLE_NORMAL);
-  if (boothTemp > TEMP_HIGH)
-  {
-    canvas.setColor(RED);
-  }
-  else if (boothTemp < TEMP_LOW)
-  {
-    canvas.setColor(ORANGE);
-  }
-  else
-  {
-    canvas.setColor(GREEN);
-  }
+  // Green inside the band, shading to red or blue by how far outside it the booth is
+  const float boothTemp = shownReadings.boothTemp;
+  const float boothHumidity = shownReadings.boothHumidity;
+  float outside = boothTemp > TEMP_HIGH ? boothTemp - TEMP_HIGH : boothTemp < TEMP_LOW ? boothTemp - TEMP_LOW : 0.0f;
+  canvas.setColor(temperatureColor(outside));
   snprintf(buffer, sizeof(buffer), "%d", (int)boothTemp);
   canvas.printFixed(12, 36, buffer, STYLE_BOLD);
 
   canvas.setColor(WHITE);
   canvas.printFixed(29, 36, "H:", STYLE_NORMAL);
-  if (boothHumidity > HUMIDITY_HIGH)
-  {
-    canvas.setColor(RED);
-  }
-  else if (boothHumidity < HUMIDITY_LOW)
-  {
-    canvas.setColor(ORANGE);
-  }
-  else
-  {
-    canvas.setColor(GREEN);
-  }
+  canvas.setColor(humidityColor(boothHumidity));
   snprintf(buffer, sizeof(buffer), "%d%%", (int)boothHumidity);
   canvas.printFixed(39, 36, buffer, STYLE_BOLD);
 
   canvas.setColor(WHITE);
   canvas.printFixed(60, 36, "L:", STYLE_NORMAL);
-  if (boothLux < LUX_LOW)
+  if (shownLux < LUX_LOW)
   {
     canvas.setColor(RED);
   }
-  else if (boothLux < LUX_MEDIUM)
+  else if (shownLux < LUX_MEDIUM)
   {
     canvas.setColor(ORANGE);
   }
@@ -501,17 +653,17 @@ void renderBottom()
   {
     canvas.setColor(GREEN);
   }
-  snprintf(buffer, sizeof(buffer), "%d", (int)boothLux);
+  snprintf(buffer, sizeof(buffer), "%d", (int)shownLux);
   canvas.printFixed(70, 36, buffer, STYLE_BOLD);
 }
 
-void renderHome()
+static void drawHome()
 {
-  canvas.clear();
-  renderCompressor();
-  renderExtractor();
-  renderLights();
-  renderBottom();
+  drawCompressor();
+  drawExtractor();
+  drawLights();
+  drawBottom();
+  drawSavingIndicator(91, 56);
   // Light
   // if (lightOn)
   // {
@@ -657,39 +809,54 @@ void renderHome()
   //         flashing = true;
   //     }
   // }
-
-  display.drawCanvas(0, 0, canvas);
 }
 
-void displayUp()
+void renderHome()
 {
+  sampleReadings();
+  stepAlert(compressorAlertCount, compressorBoxFilled);
+  stepAlert(extractorAlertCount, extractorBoxFilled);
+  stepAlert(lightsAlertCount, lightsBoxFilled);
+  presentFrame(drawHome);
+}
 
+// Menus move one item per detent, values move `steps`, which the encoder scales
+// up on fast turns
+void displayUp(int detents, int steps)
+{
   if (currentDisplay == HOME)
   {
-    lightTargetBrightness--;
-    if (lightTargetBrightness < 0)
-    {
-      lightTargetBrightness = 0;
-    }
+    // Turning the knob takes the lights back from the auto-brightness loop
+    settingsSetAutoBrightness(false, currentSettings.autoBrightnessLux);
+    setLightTargetBrightness(lightTargetBrightness - steps);
   }
   if (currentDisplay == COMPRESSOR_SETTINGS_MENU)
   {
-    compressorSettingsMenu.up();
-    compressorSettingsMenu.show(display);
+    for (int i = 0; i < detents; i++)
+    {
+      compressorSettingsMenu.up();
+    }
+    showMenu(compressorSettingsMenu);
   }
   if (currentDisplay == EXTRACTOR_SETTINGS_MENU)
   {
-    extractorSettingsMenu.up();
-    extractorSettingsMenu.show(display);
+    for (int i = 0; i < detents; i++)
+    {
+      extractorSettingsMenu.up();
+    }
+    showMenu(extractorSettingsMenu);
   }
   if (currentDisplay == LIGHTS_SETTINGS_MENU)
   {
-    lightsSettingsMenu.up();
-    lightsSettingsMenu.show(display);
+    for (int i = 0; i < detents; i++)
+    {
+      lightsSettingsMenu.up();
+    }
+    showMenu(lightsSettingsMenu);
   }
   else if (currentDisplay == SET_COMPRESSION_TIMEOUT_DISPLAY)
   {
-    compressionTimerDuration--;
+    compressionTimerDuration -= steps;
     if (compressionTimerDuration < MIN_COMPRESSION_TIMER_DURATION)
     {
       compressionTimerDuration = MIN_COMPRESSION_TIMER_DURATION;
@@ -697,7 +864,7 @@ void displayUp()
   }
   else if (currentDisplay == SET_MOTOR_TIMEOUT_DISPLAY)
   {
-    motorTimerDuration--;
+    motorTimerDuration -= steps;
     if (motorTimerDuration < MIN_MOTOR_TIMER_DURATION)
     {
       motorTimerDuration = MIN_MOTOR_TIMER_DURATION;
@@ -705,7 +872,7 @@ void displayUp()
   }
   else if (currentDisplay == SET_RELEASE_TIMEOUT_DISPLAY)
   {
-    releaseTimerDuration--;
+    releaseTimerDuration -= steps;
     if (releaseTimerDuration < MIN_RELEASE_TIMER_DURATION)
     {
       releaseTimerDuration = MIN_RELEASE_TIMER_DURATION;
@@ -713,23 +880,45 @@ void displayUp()
   }
   else if (currentDisplay == SET_FAN_SPEED_DISPLAY)
   {
-    currentSettings.fanSpeed--;
-    if (currentSettings.fanSpeed < MIN_FAN_SPEED)
+    int fanSpeed = currentSettings.fanSpeed - steps;
+    settingsSetFanSpeed(fanSpeed < MIN_FAN_SPEED ? MIN_FAN_SPEED : fanSpeed);
+  }
+  else if (currentDisplay == SET_LIGHT_COOLING)
+  {
+    settingsSetLightCooling(!currentSettings.lightCooling);
+  }
+  else if (currentDisplay == SET_AUTO_BRIGHTNESS)
+  {
+    // Below the lowest useful setpoint switches the loop off
+    if (currentSettings.autoBrightness)
     {
-      currentSettings.fanSpeed = MIN_FAN_SPEED;
+      int lux = currentSettings.autoBrightnessLux - AUTO_BRIGHTNESS_LUX_STEP * steps;
+      if (lux < LUX_LOW)
+      {
+        settingsSetAutoBrightness(false, (int)LUX_LOW);
+      }
+      else
+      {
+        settingsSetAutoBrightness(true, lux);
+      }
+    }
+  }
+  else if (currentDisplay == DIAGNOSTICS_DISPLAY)
+  {
+    diagnosticsScroll -= detents;
+    if (diagnosticsScroll < 0)
+    {
+      diagnosticsScroll = 0;
     }
   }
 }
 
-void displayDown()
+void displayDown(int detents, int steps)
 {
   if (currentDisplay == HOME)
   {
-    lightTargetBrightness++;
-    if (lightTargetBrightness > 100)
-    {
-      lightTargetBrightness = 100;
-    }
+    settingsSetAutoBrightness(false, currentSettings.autoBrightnessLux);
+    setLightTargetBrightness(lightTargetBrightness + steps);
     // lightIntensity += 2;
     // if (lightIntensity > 100)
     // {
@@ -738,22 +927,31 @@ void displayDown()
   }
   if (currentDisplay == COMPRESSOR_SETTINGS_MENU)
   {
-    compressorSettingsMenu.down();
-    compressorSettingsMenu.show(display);
+    for (int i = 0; i < detents; i++)
+    {
+      compressorSettingsMenu.down();
+    }
+    showMenu(compressorSettingsMenu);
   }
   if (currentDisplay == EXTRACTOR_SETTINGS_MENU)
   {
-    extractorSettingsMenu.down();
-    extractorSettingsMenu.show(display);
+    for (int i = 0; i < detents; i++)
+    {
+      extractorSettingsMenu.down();
+    }
+    showMenu(extractorSettingsMenu);
   }
   if (currentDisplay == LIGHTS_SETTINGS_MENU)
   {
-    lightsSettingsMenu.down();
-    lightsSettingsMenu.show(display);
+    for (int i = 0; i < detents; i++)
+    {
+      lightsSettingsMenu.down();
+    }
+    showMenu(lightsSettingsMenu);
   }
   else if (currentDisplay == SET_COMPRESSION_TIMEOUT_DISPLAY)
   {
-    compressionTimerDuration++;
+    compressionTimerDuration += steps;
     if (compressionTimerDuration > MAX_COMPRESSION_TIMER_DURATION)
     {
       compressionTimerDuration = MAX_COMPRESSION_TIMER_DURATION;
@@ -761,7 +959,7 @@ void displayDown()
   }
   else if (currentDisplay == SET_MOTOR_TIMEOUT_DISPLAY)
   {
-    motorTimerDuration++;
+    motorTimerDuration += steps;
     if (motorTimerDuration > MAX_MOTOR_TIMER_DURATION)
     {
       motorTimerDuration = MAX_MOTOR_TIMER_DURATION;
@@ -769,7 +967,7 @@ void displayDown()
   }
   else if (currentDisplay == SET_RELEASE_TIMEOUT_DISPLAY)
   {
-    releaseTimerDuration++;
+    releaseTimerDuration += steps;
     if (releaseTimerDuration > MAX_RELEASE_TIMER_DURATION)
     {
       releaseTimerDuration = MAX_RELEASE_TIMER_DURATION;
@@ -783,6 +981,27 @@ void displayDown()
     //     currentSettings.targetTemp = maxTargetTemp;
     // }
   }
+  else if (currentDisplay == SET_LIGHT_COOLING)
+  {
+    settingsSetLightCooling(!currentSettings.lightCooling);
+  }
+  else if (currentDisplay == SET_AUTO_BRIGHTNESS)
+  {
+    if (!currentSettings.autoBrightness)
+    {
+      settingsSetAutoBrightness(true, (int)LUX_LOW);
+    }
+    else
+    {
+      int lux = currentSettings.autoBrightnessLux + AUTO_BRIGHTNESS_LUX_STEP * steps;
+      settingsSetAutoBrightness(true, lux > MAX_AUTO_BRIGHTNESS_LUX ? MAX_AUTO_BRIGHTNESS_LUX : lux);
+    }
+  }
+  else if (currentDisplay == DIAGNOSTICS_DISPLAY)
+  {
+    // Clamped against the task count when rendering
+    diagnosticsScroll += detents;
+  }
 }
 
 void displayHome()
@@ -793,26 +1012,17 @@ void displayHome()
 
 void displayCompressorSettingsMenu()
 {
-  currentDisplay = COMPRESSOR_SETTINGS_MENU;
-  display.setFixedFont(ssd1306xled_font6x8);
-  display.clear();
-  compressorSettingsMenu.show(display);
+  displayMenu(COMPRESSOR_SETTINGS_MENU, compressorSettingsMenu);
 }
 
 void displayExtractorSettingsMenu()
 {
-  currentDisplay = EXTRACTOR_SETTINGS_MENU;
-  display.setFixedFont(ssd1306xled_font6x8);
-  display.clear();
-  extractorSettingsMenu.show(display);
+  displayMenu(EXTRACTOR_SETTINGS_MENU, extractorSettingsMenu);
 }
 
 void displayLightsSettingsMenu()
 {
-  currentDisplay = LIGHTS_SETTINGS_MENU;
-  display.setFixedFont(ssd1306xled_font6x8);
-  display.clear();
-  lightsSettingsMenu.show(display);
+  displayMenu(LIGHTS_SETTINGS_MENU, lightsSettingsMenu);
 }
 
 void displayEnter()
@@ -826,17 +1036,17 @@ void displayEnter()
     uint8_t selection = compressorSettingsMenu.selection();
     if (selection == 0)
     {
-      compressionTimerDuration = g_compressorStatus.compressionTimerDuration;
+      compressionTimerDuration = g_compressorStatus.read().compressionTimerDuration;
       currentDisplay = SET_COMPRESSION_TIMEOUT_DISPLAY;
     }
     else if (selection == 1)
     {
-      motorTimerDuration = g_compressorStatus.motorTimerDuration;
+      motorTimerDuration = g_compressorStatus.read().motorTimerDuration;
       currentDisplay = SET_MOTOR_TIMEOUT_DISPLAY;
     }
     else if (selection == 2)
     {
-      releaseTimerDuration = g_compressorStatus.releaseTimerDuration;
+      releaseTimerDuration = g_compressorStatus.read().releaseTimerDuration;
       currentDisplay = SET_RELEASE_TIMEOUT_DISPLAY;
     }
     else if (selection == 3)
@@ -855,6 +1065,12 @@ void displayEnter()
     {
       currentDisplay = EXTRACTOR_STATS;
     }
+    else if (selection == 2)
+    {
+      // The sweep is audible, the flashes only confirm it was asked for
+      requestExtractorCalibration();
+      alertExtractor(3);
+    }
   }
   else if (currentDisplay == LIGHTS_SETTINGS_MENU)
   {
@@ -865,12 +1081,21 @@ void displayEnter()
     }
     else if (selection == 1)
     {
-      currentDisplay = SET_LIGHT_COOLING;
+      currentDisplay = SET_AUTO_BRIGHTNESS;
     }
     else if (selection == 2)
+    {
+      currentDisplay = SET_LIGHT_COOLING;
+    }
+    else if (selection == 3)
     {
       currentDisplay = LIGHTS_STATS;
     }
+    else if (selection == 4)
+    {
+      diagnosticsScroll = 0;
+      currentDisplay = DIAGNOSTICS_DISPLAY;
+    }
   }
   else if (
       currentDisplay == SET_COMPRESSION_TIMEOUT_DISPLAY ||
@@ -878,7 +1103,9 @@ void displayEnter()
       currentDisplay == SET_RELEASE_TIMEOUT_DISPLAY ||
       currentDisplay == SET_FAN_SPEED_DISPLAY ||
       currentDisplay == SET_MAX_LIGHTS ||
-      currentDisplay == SET_LIGHT_COOLING)
+      currentDisplay == SET_LIGHT_COOLING ||
+      currentDisplay == SET_AUTO_BRIGHTNESS ||
+      currentDisplay == DIAGNOSTICS_DISPLAY)
   {
     displayBack();
     // checkForSettingsChange();
@@ -898,15 +1125,16 @@ void displayBack()
   }
   else if (currentDisplay == SET_COMPRESSION_TIMEOUT_DISPLAY || currentDisplay == SET_MOTOR_TIMEOUT_DISPLAY || currentDisplay == SET_RELEASE_TIMEOUT_DISPLAY)
   {
-    if (compressionTimerDuration != g_compressorStatus.compressionTimerDuration)
+    const CompressorStatus status = g_compressorStatus.read();
+    if (compressionTimerDuration != status.compressionTimerDuration)
     {
       sendSetCompressionTimeoutCommand(compressionTimerDuration);
     }
-    if (motorTimerDuration != g_compressorStatus.motorTimerDuration)
+    if (motorTimerDuration != status.motorTimerDuration)
     {
       sendSetMotorTimeoutCommand(motorTimerDuration);
     }
-    if (releaseTimerDuration != g_compressorStatus.releaseTimerDuration)
+    if (releaseTimerDuration != status.releaseTimerDuration)
     {
       sendSetReleaseTimeoutCommand(releaseTimerDuration);
     }
@@ -919,15 +1147,30 @@ void displayBack()
     displayExtractorSettingsMenu();
     // checkForSettingsChange();
   }
-  else if (currentDisplay == SET_MAX_LIGHTS || currentDisplay == SET_LIGHT_COOLING)
+  else if (currentDisplay == SET_MAX_LIGHTS || currentDisplay == SET_LIGHT_COOLING || currentDisplay == SET_AUTO_BRIGHTNESS || currentDisplay == DIAGNOSTICS_DISPLAY)
   {
     displayLightsSettingsMenu();
     // checkForSettingsChange();
   }
 }
 
+void startDisplay()
+{
+  display.begin();
+#ifndef DISPLAY_16BPP
+  initDisplayPanel(&display.getInterface());
+#endif
+}
+
 void displayTask(void *params)
 {
+  // The panel's reset and power-up delays run here, alongside the radio's
+  // firmware load, rather than holding up every other init in main()
+  int step = bootStepBegin("display");
+  startDisplay();
+  bootStepEnd(step);
+
+  bool firstFrame = true;
   while (true)
   {
     if (currentDisplay == HOME)
@@ -953,6 +1196,23 @@ void displayTask(void *params)
     {
       renderSetFanSpeed();
     }
+    else if (currentDisplay == SET_LIGHT_COOLING)
+    {
+      renderLightCooling();
+    }
+    else if (currentDisplay == SET_AUTO_BRIGHTNESS)
+    {
+      renderAutoBrightness();
+    }
+    else if (currentDisplay == DIAGNOSTICS_DISPLAY)
+    {
+      renderDiagnostics();
+    }
+    if (firstFrame)
+    {
+      bootMilestone("first-frame");
+      firstFrame = false;
+    }
     vTaskDelay(pdMS_TO_TICKS(200));
   }
 }
\ No newline at end of file
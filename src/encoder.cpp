@@ -0,0 +1,66 @@
+#include "encoder.h"
+#include "constants.h"
+#include "encoder.pio.h"
+
+#include <stdio.h>
+
+#include "hardware/clocks.h"
+#include "hardware/pio.h"
+
+#define ENCODER_MAX_STEP_RATE 100000 // Steps per second the decoder samples fast enough for
+#define ENCODER_LOOP_CYCLES 10       // Longest pass through encoder.pio
+
+static_assert(ENCODER_DC_GPIO == ENCODER_CLK_GPIO + 1, "encoder.pio reads both pins with one IN");
+
+static PIO encoderPio;
+static int encoderSm = -1;
+
+void initEncoder()
+{
+  // The jump table has to start at address 0, so this usually takes a PIO of its own
+  encoderPio = pio0;
+  if (!pio_can_add_program(encoderPio, &encoder_program))
+  {
+    encoderPio = pio1;
+    if (!pio_can_add_program(encoderPio, &encoder_program))
+    {
+      printf("No PIO space for the encoder\n");
+      return;
+    }
+  }
+  pio_add_program(encoderPio, &encoder_program);
+  encoderSm = pio_claim_unused_sm(encoderPio, true);
+
+  gpio_pull_up(ENCODER_CLK_GPIO);
+  gpio_pull_up(ENCODER_DC_GPIO);
+  pio_gpio_init(encoderPio, ENCODER_CLK_GPIO);
+  pio_gpio_init(encoderPio, ENCODER_DC_GPIO);
+  pio_sm_set_consecutive_pindirs(encoderPio, encoderSm, ENCODER_CLK_GPIO, 2, false);
+
+  pio_sm_config config = encoder_program_get_default_config(0);
+  sm_config_set_in_pins(&config, ENCODER_CLK_GPIO);
+  // IN shifts left so the current levels land below the previous ones
+  sm_config_set_in_shift(&config, false, false, 32);
+  sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_RX);
+  // Slower sampling is plenty for a hand turned knob and filters the fastest contact bounce
+  sm_config_set_clkdiv(&config, (float)clock_get_hz(clk_sys) / (ENCODER_LOOP_CYCLES * ENCODER_MAX_STEP_RATE));
+
+  pio_sm_init(encoderPio, encoderSm, 0, &config);
+  pio_sm_set_enabled(encoderPio, encoderSm, true);
+}
+
+int32_t readEncoderCount()
+{
+  if (encoderSm < 0)
+  {
+    return 0;
+  }
+  // The FIFO fills with stale counts between reads. Drain them and take the
+  // next one, which the state machine pushes within a few cycles.
+  uint stale = pio_sm_get_rx_fifo_level(encoderPio, encoderSm);
+  for (uint i = 0; i < stale; i++)
+  {
+    pio_sm_get(encoderPio, encoderSm);
+  }
+  return (int32_t)pio_sm_get_blocking(encoderPio, encoderSm);
+}
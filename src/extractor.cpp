@@ -2,47 +2,151 @@
 #include "constants.h"
 #include "isr-handlers.h"
 #include "settings.h"
+#include "sensors.h"
+#include "fan-controller.h"
+#include "ramp.h"
+#include "static-memory.h"
+#include "tach.pio.h"
 
 #include "pico/stdlib.h"
 #include "hardware/pwm.h"
-#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
 #include "FreeRTOS.h"
 #include "timers.h"
 #include "semphr.h"
 
+#include <limits.h>
+
 // Define constants
 #define PWM_FREQUENCY 25000    // 25 kHz suitable for PC fans
 #define SYSTEM_CLOCK 125000000 // 125 MHz system clock of the Raspberry Pi Pico
 #define CLOCK_DIV 1            // PWM clock divider (should be 1, 2, 4, 8, etc.)
+#define EXTRACTOR_RAMP_MS 3000 // S-curve spin up/down time for a full 0 -> 100% change
+#define CALIBRATION_SETTLE_MS 2000
+
+#define RPM_SAMPLE_MS 100     // Tachometer snapshot rate (10 Hz)
+#define TACH_MEDIAN_WINDOW 5  // Periods in the median filter
+#define TACH_TIMEOUT_MS 500   // No falling edge for this long means the fan has stopped
+#define TACH_MAX_RPM 10000    // Shorter periods than this are noise (or the PIO counter wrapping)
+#define TACH_LOOP_OVERHEAD 4  // Cycles per period spent in mov/push/mov, see tach.pio
+
+// Extractor task notification bits
+#define EXTRACTOR_NOTIFY_TACH (1 << 0) // Fresh tachometer sample
+#define EXTRACTOR_NOTIFY_RAMP (1 << 1) // Setpoint moved
+#define EXTRACTOR_NOTIFY_CALIBRATE (1 << 2) // Sweep the fan and store a new table
 
 volatile int currentFanSpeed = 0;
 volatile int targetFanSpeed = 0;
-volatile uint64_t extractorRPM = 0;
+volatile uint32_t extractorCentiRPM = 0;
 volatile bool extractorOn = false;
-volatile uint64_t pulseCount = 0;
+volatile bool extractorStalled = false;
+volatile int extractorCoolingDemand = 0;
 
 TimerHandle_t rpmTimer;
-// uint64_t lastTimerCall = 0;
-// SemaphoreHandle_t mutex;
+static StaticTimer rpmTimerMemory;
+static TaskHandle_t extractorTaskHandle = NULL;
+static FanController fanController;
+static Ramp fanRamp;
+static volatile bool extractorCalibrating = false;
+
+static PIO tachPio;
+static uint tachSm;
+static uint32_t tachPeriods[TACH_MEDIAN_WINDOW];
+static int tachPeriodCount = 0;
+static int tachPeriodIndex = 0;
+static TickType_t lastTachEdge = 0;
+
+// Median of the buffered periods, robust against the odd noise edge a PWM driven fan picks up
+static uint32_t medianTachPeriod()
+{
+  uint32_t sorted[TACH_MEDIAN_WINDOW];
+  for (int i = 0; i < tachPeriodCount; i++)
+  {
+    uint32_t value = tachPeriods[i];
+    int j = i;
+    while (j > 0 && sorted[j - 1] > value)
+    {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+  return sorted[tachPeriodCount / 2];
+}
 
-// Assuming deltaTime is in microseconds and we want RPM:
-// There are 60,000,000 microseconds in a minute.
-// If there are two pulses per revolution, the number of revolutions is pulseCount / 2.
+// The tach PIO program times every period between falling edges, so there is no
+// GPIO interrupt per pulse. This drains its FIFO at 10 Hz and publishes one sample.
 void rpmTimerCallback(TimerHandle_t xTimer)
 {
-  // static uint64_t lastTime = 0; // Ensure this is static or globally defined
+  const uint32_t systemClock = clock_get_hz(clk_sys);
+  const uint32_t minPeriod = (uint32_t)((30ULL * systemClock) / TACH_MAX_RPM);
+  TickType_t now = xTaskGetTickCount();
+
+  while (!pio_sm_is_rx_fifo_empty(tachPio, tachSm))
+  {
+    uint32_t period = 2 * pio_sm_get(tachPio, tachSm) + TACH_LOOP_OVERHEAD;
+    if (period < minPeriod)
+    {
+      continue;
+    }
+    tachPeriods[tachPeriodIndex] = period;
+    tachPeriodIndex = (tachPeriodIndex + 1) % TACH_MEDIAN_WINDOW;
+    if (tachPeriodCount < TACH_MEDIAN_WINDOW)
+    {
+      tachPeriodCount++;
+    }
+    lastTachEdge = now;
+  }
+
+  uint32_t centiRpm = 0;
+  if (tachPeriodCount > 0 && (now - lastTachEdge) < pdMS_TO_TICKS(TACH_TIMEOUT_MS))
+  {
+    // Two pulses per revolution: RPM = 60 * clock / (2 * period), kept in hundredths
+    centiRpm = (uint32_t)((3000ULL * systemClock) / medianTachPeriod());
+  }
+  else
+  {
+    tachPeriodCount = 0;
+    tachPeriodIndex = 0;
+  }
 
-  // uint64_t currentTime = to_us_since_boot(get_absolute_time());
-  // uint64_t deltaTime = currentTime - lastTime; // Calculate elapsed time in microseconds
+  // Single aligned 32-bit store, so readers on either core always see a whole sample
+  extractorCentiRPM = centiRpm;
 
-  uint64_t revolutions = pulseCount / 2; // Two pulses per revolution
-  uint64_t rpm = revolutions * 60;       // * 1000000 / deltaTime; // Convert to RPM
+  // Wake the speed loop, it runs once per fresh measurement. With the fan off
+  // there is nothing to regulate, so leave the task asleep.
+  if (extractorTaskHandle != NULL && (extractorCalibrating || rampCurrent(&fanRamp) > 0))
+  {
+    xTaskNotify(extractorTaskHandle, EXTRACTOR_NOTIFY_TACH, eSetBits);
+  }
+}
 
-  // printf("Pulse Count: %llu, deltaTime: %llu us\n", pulseCount, deltaTime);
-  printf("RPM: %llu pulseCount: %d\n", rpm, pulseCount);
+// Ramp step, runs in the timer service task while the setpoint is moving
+static void onFanRampStep(uint32_t level, void *context)
+{
+  const uint wrap = calculatePWMWrapValue(PWM_FREQUENCY);
+  currentFanSpeed = (int)((level * 100 + wrap / 2) / wrap);
+  if (extractorTaskHandle != NULL)
+  {
+    xTaskNotify(extractorTaskHandle, EXTRACTOR_NOTIFY_RAMP, eSetBits);
+  }
+}
+
+// The fan runs at whichever is higher, the user's setting or what the lights need for cooling
+static void rampToTargetSpeed()
+{
+  int speed = MAX(targetFanSpeed, extractorCoolingDemand);
+  rampSetTarget(&fanRamp, ((uint32_t)speed * calculatePWMWrapValue(PWM_FREQUENCY)) / 100);
+  if (rampIsActive(&fanRamp))
+  {
+    sensorsTransientStarted();
+  }
+}
 
-  // lastTime = currentTime; // Update last time
-  pulseCount = 0; // Reset pulse count
+bool extractorRamping()
+{
+  return rampIsActive(&fanRamp);
 }
 
 void initExtractor(void)
@@ -50,8 +154,10 @@ void initExtractor(void)
   // mutex = xSemaphoreCreateMutex();
   configurePWM(EXTRACTOR_PWM_GPIO);
   configureTachometer(EXTRACTOR_TACH_GPIO);
+  fanControllerInit(&fanController, calculatePWMWrapValue(PWM_FREQUENCY));
+  rampInit(&fanRamp, calculatePWMWrapValue(PWM_FREQUENCY), RAMP_S_CURVE, EXTRACTOR_RAMP_MS, onFanRampStep, NULL);
 
-  rpmTimer = xTimerCreate("RPM Timer", pdMS_TO_TICKS(1000), pdTRUE, (void *)0, rpmTimerCallback);
+  rpmTimer = rpmTimerMemory.create("RPM Timer", pdMS_TO_TICKS(RPM_SAMPLE_MS), true, rpmTimerCallback, "extractor");
   if (rpmTimer == NULL)
   {
     // Handle error
@@ -67,12 +173,15 @@ void startExtractor(void)
 {
   targetFanSpeed = 100; // currentSettings.fanSpeed
   extractorOn = true;
+  rampToTargetSpeed();
 }
 
 void stopExtractor(void)
 {
   targetFanSpeed = 0;
   extractorOn = false; // Ensure fan is actually stopping
+  extractorStalled = false;
+  rampToTargetSpeed();
 }
 
 void updateExtractorSpeed(void)
@@ -80,32 +189,141 @@ void updateExtractorSpeed(void)
   if (extractorOn)
   {
     targetFanSpeed = currentSettings.fanSpeed;
+    rampToTargetSpeed();
   }
 }
 
+void setExtractorCoolingDemand(int percent)
+{
+  extractorCoolingDemand = MIN(MAX(percent, 0), 100);
+  rampToTargetSpeed();
+}
+
+void requestExtractorCalibration()
+{
+  if (extractorTaskHandle != NULL)
+  {
+    xTaskNotify(extractorTaskHandle, EXTRACTOR_NOTIFY_CALIBRATE, eSetBits);
+  }
+}
+
+// Takes the duty -> RPM table from settings. False if there is none or it is
+// not one a sweep could have produced, in which case the fan has to be swept.
+static bool loadExtractorCalibration()
+{
+  if (currentSettings.fanCalibrationMagic != FAN_CALIBRATION_MAGIC || currentSettings.fanRpmAtDuty[0] != 0)
+  {
+    return false;
+  }
+  for (int i = 1; i < FAN_CALIBRATION_POINTS; i++)
+  {
+    if (currentSettings.fanRpmAtDuty[i] < currentSettings.fanRpmAtDuty[i - 1])
+    {
+      return false;
+    }
+    fanControllerSetCalibrationPoint(&fanController, i, currentSettings.fanRpmAtDuty[i]);
+  }
+  // A stored sweep that found no tachometer stays open-loop until swept again
+  if (fanControllerFinishCalibration(&fanController))
+  {
+    printf("Extractor calibration loaded, max %lu RPM\n", (unsigned long)fanControllerMaxRpm(&fanController));
+  }
+  else
+  {
+    printf("Stored extractor calibration has no tachometer, running open-loop\n");
+  }
+  return true;
+}
+
+// Sweeps the duty cycle to learn the duty -> RPM curve used as feed-forward,
+// on first boot and on request, and stores it in settings
+static void calibrateExtractor()
+{
+  const uint wrap = calculatePWMWrapValue(PWM_FREQUENCY);
+  printf("Calibrating extractor...\n");
+  extractorCalibrating = true;
+  for (int i = 1; i < FAN_CALIBRATION_POINTS; i++)
+  {
+    pwm_set_gpio_level(EXTRACTOR_PWM_GPIO, (i * wrap) / (FAN_CALIBRATION_POINTS - 1));
+    vTaskDelay(pdMS_TO_TICKS(CALIBRATION_SETTLE_MS));
+    // Discard the window that straddled the duty change and wait for a clean one
+    ulTaskNotifyTake(pdTRUE, 0);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CALIBRATION_SETTLE_MS));
+    uint32_t rpm = extractorCentiRPM / 100;
+    fanControllerSetCalibrationPoint(&fanController, i, rpm);
+    printf("Extractor calibration %d%%: %lu RPM\n", i * 10, (unsigned long)rpm);
+  }
+  pwm_set_gpio_level(EXTRACTOR_PWM_GPIO, 0);
+  extractorCalibrating = false;
+
+  if (fanControllerFinishCalibration(&fanController))
+  {
+    printf("Extractor calibrated, max %lu RPM\n", (unsigned long)fanControllerMaxRpm(&fanController));
+  }
+  else
+  {
+    printf("Extractor calibration failed (no tachometer?), running open-loop\n");
+  }
+  settingsSetFanCalibration(fanController.rpmAtDuty);
+}
+
 void extractorTask(void *params)
 {
-  const TickType_t xDelay = pdMS_TO_TICKS(100); // Increase delay for slower ramp
+  const uint wrap = calculatePWMWrapValue(PWM_FREQUENCY);
+  extractorTaskHandle = xTaskGetCurrentTaskHandle();
+
+  if (!loadExtractorCalibration())
+  {
+    calibrateExtractor();
+  }
+
+  TickType_t lastMeasurement = xTaskGetTickCount();
   while (1)
   {
-    if (currentFanSpeed != targetFanSpeed)
+    // Sleep until the setpoint ramp moves or a tachometer sample arrives; both stop while the fan is off
+    uint32_t events = 0;
+    xTaskNotifyWait(0, ULONG_MAX, &events, portMAX_DELAY);
+    if (events & EXTRACTOR_NOTIFY_CALIBRATE)
+    {
+      // Then carry on below, so a fan that was running picks up its setpoint again
+      calibrateExtractor();
+      lastMeasurement = xTaskGetTickCount();
+      events = 0;
+    }
+
+    uint32_t setpoint = rampCurrent(&fanRamp);
+    uint pwmLevel = 0;
+    if (setpoint == 0)
     {
-      if (currentFanSpeed < targetFanSpeed)
+      fanControllerReset(&fanController);
+    }
+    else if (!fanController.calibrated)
+    {
+      // Open-loop fallback, the ramp level is the duty
+      pwmLevel = setpoint;
+    }
+    else
+    {
+      uint32_t targetRpm = (uint32_t)(((uint64_t)setpoint * fanControllerMaxRpm(&fanController)) / wrap);
+      if (events & EXTRACTOR_NOTIFY_TACH)
       {
-        currentFanSpeed += 1;
+        TickType_t now = xTaskGetTickCount();
+        pwmLevel = fanControllerUpdate(&fanController, targetRpm, extractorCentiRPM / 100, pdTICKS_TO_MS(now - lastMeasurement));
+        lastMeasurement = now;
+        if (fanController.stalled && !extractorStalled)
+        {
+          printf("Extractor stalled at %d%% duty\n", (pwmLevel * 100) / wrap);
+        }
+        extractorStalled = fanController.stalled;
       }
       else
       {
-        currentFanSpeed -= 1;
+        pwmLevel = fanControllerOutput(&fanController, targetRpm);
       }
     }
-
-    // Set PWM level or drive it low if speed is zero
-    uint pwmLevel = (currentFanSpeed > 0) ? (currentFanSpeed * calculatePWMWrapValue(PWM_FREQUENCY)) / 100 : 0;
     pwm_set_gpio_level(EXTRACTOR_PWM_GPIO, pwmLevel);
 
-    // printf("FAN SPEED: %d RPM: %d\n", currentFanSpeed, extractorRPM);
-    vTaskDelay(xDelay);
+    // printf("FAN SPEED: %d RPM: %lu\n", currentFanSpeed, extractorCentiRPM / 100);
   }
 }
 
@@ -129,17 +347,26 @@ static uint calculatePWMWrapValue(uint frequency)
 
 static void configureTachometer(uint gpio)
 {
-  gpio_set_function(gpio, GPIO_FUNC_SIO);
-  gpio_set_dir(gpio, GPIO_IN);
-  // Explicitly specifying the ISR function removes the global IRS function which prevents buttons from working (don't do it)
-  // gpio_set_irq_enabled_with_callback(gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &tachometerISR);
-  gpio_set_irq_enabled(gpio, GPIO_IRQ_EDGE_FALL, true);
-}
+  // Fan tach outputs are open collector
+  gpio_pull_up(gpio);
 
-void tachometerISR(uint gpio, uint32_t events)
-{
-  if (gpio == EXTRACTOR_TACH_GPIO && events & GPIO_IRQ_EDGE_FALL)
+  tachPio = pio0;
+  if (!pio_can_add_program(tachPio, &tach_program))
   {
-    pulseCount++;
+    tachPio = pio1;
   }
+  uint offset = pio_add_program(tachPio, &tach_program);
+  tachSm = (uint)pio_claim_unused_sm(tachPio, true);
+
+  pio_gpio_init(tachPio, gpio);
+  pio_sm_set_consecutive_pindirs(tachPio, tachSm, gpio, 1, false);
+
+  pio_sm_config config = tach_program_get_default_config(offset);
+  sm_config_set_in_pins(&config, gpio);
+  sm_config_set_jmp_pin(&config, gpio);
+  // Only the CPU reads periods, give it the full 8 entry FIFO
+  sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_RX);
+
+  pio_sm_init(tachPio, tachSm, offset, &config);
+  pio_sm_set_enabled(tachPio, tachSm, true);
 }
@@ -0,0 +1,141 @@
+#include "fan-controller.h"
+
+#include <string.h>
+
+static int64_t clampLevel(int64_t level, int64_t maxLevel)
+{
+  if (level < 0)
+  {
+    return 0;
+  }
+  if (level > maxLevel)
+  {
+    return maxLevel;
+  }
+  return level;
+}
+
+void fanControllerInit(FanController *controller, uint32_t maxLevel)
+{
+  memset(controller, 0, sizeof(FanController));
+  controller->maxLevel = maxLevel;
+  controller->kp = FAN_KP_Q16;
+  controller->ki = FAN_KI_Q16;
+}
+
+void fanControllerSetCalibrationPoint(FanController *controller, int index, uint32_t rpm)
+{
+  if (index >= 0 && index < FAN_CALIBRATION_POINTS)
+  {
+    controller->rpmAtDuty[index] = rpm;
+  }
+}
+
+bool fanControllerFinishCalibration(FanController *controller)
+{
+  // No spin at 0% duty, and noise must never make the table go backwards or the
+  // inverse lookup in fanControllerFeedForward stops being well defined
+  controller->rpmAtDuty[0] = 0;
+  for (int i = 1; i < FAN_CALIBRATION_POINTS; i++)
+  {
+    if (controller->rpmAtDuty[i] < controller->rpmAtDuty[i - 1])
+    {
+      controller->rpmAtDuty[i] = controller->rpmAtDuty[i - 1];
+    }
+  }
+  controller->calibrated = controller->rpmAtDuty[FAN_CALIBRATION_POINTS - 1] >= FAN_MIN_CALIBRATED_RPM;
+  fanControllerReset(controller);
+  return controller->calibrated;
+}
+
+uint32_t fanControllerMaxRpm(const FanController *controller)
+{
+  return controller->rpmAtDuty[FAN_CALIBRATION_POINTS - 1];
+}
+
+uint32_t fanControllerFeedForward(const FanController *controller, uint32_t targetRpm)
+{
+  if (targetRpm == 0)
+  {
+    return 0;
+  }
+  const uint32_t levelsPerPoint = controller->maxLevel / (FAN_CALIBRATION_POINTS - 1);
+  for (int i = 1; i < FAN_CALIBRATION_POINTS; i++)
+  {
+    uint32_t low = controller->rpmAtDuty[i - 1];
+    uint32_t high = controller->rpmAtDuty[i];
+    if (targetRpm <= high && targetRpm > low)
+    {
+      // Linear interpolation between the two neighbouring calibration points
+      return (i - 1) * levelsPerPoint + ((targetRpm - low) * levelsPerPoint) / (high - low);
+    }
+  }
+  return controller->maxLevel;
+}
+
+uint32_t fanControllerOutput(const FanController *controller, uint32_t targetRpm)
+{
+  if (targetRpm == 0)
+  {
+    return 0;
+  }
+  int64_t level = (int64_t)fanControllerFeedForward(controller, targetRpm) + controller->proportional + (controller->integral >> 16);
+  return (uint32_t)clampLevel(level, controller->maxLevel);
+}
+
+uint32_t fanControllerUpdate(FanController *controller, uint32_t targetRpm, uint32_t measuredRpm, uint32_t elapsedMs)
+{
+  if (targetRpm == 0)
+  {
+    fanControllerReset(controller);
+    return 0;
+  }
+
+  // Stall detection: no pulses at all while we are clearly driving the fan
+  uint32_t currentLevel = fanControllerOutput(controller, targetRpm);
+  if (measuredRpm == 0 && currentLevel >= (controller->maxLevel * FAN_STALL_MIN_DUTY) / 100)
+  {
+    if (controller->stallSamples < FAN_STALL_SAMPLES)
+    {
+      controller->stallSamples++;
+    }
+    controller->stalled = controller->stallSamples >= FAN_STALL_SAMPLES;
+  }
+  else if (measuredRpm > 0)
+  {
+    controller->stallSamples = 0;
+    controller->stalled = false;
+  }
+
+  int32_t error = (int32_t)targetRpm - (int32_t)measuredRpm;
+  controller->proportional = (int32_t)(((int64_t)controller->kp * error) >> 16);
+
+  // Conditional integration anti-windup: stop integrating while the output is pinned
+  // in the direction the error is pushing, or while the fan is not turning at all
+  int64_t unsaturated = (int64_t)fanControllerFeedForward(controller, targetRpm) + controller->proportional + (controller->integral >> 16);
+  bool pinnedHigh = unsaturated >= (int64_t)controller->maxLevel && error > 0;
+  bool pinnedLow = unsaturated <= 0 && error < 0;
+  if (!controller->stalled && !pinnedHigh && !pinnedLow)
+  {
+    controller->integral += ((int64_t)controller->ki * error * elapsedMs) / 1000;
+    int64_t limit = (int64_t)controller->maxLevel << 16;
+    if (controller->integral > limit)
+    {
+      controller->integral = limit;
+    }
+    else if (controller->integral < -limit)
+    {
+      controller->integral = -limit;
+    }
+  }
+
+  return fanControllerOutput(controller, targetRpm);
+}
+
+void fanControllerReset(FanController *controller)
+{
+  controller->proportional = 0;
+  controller->integral = 0;
+  controller->stallSamples = 0;
+  controller->stalled = false;
+}
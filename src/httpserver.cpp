@@ -3,14 +3,38 @@
 #include "fsdata.h"
 #include <string.h>
 #include <stdio.h>
-#include <sstream>
 #include "wifi.h"
 #include "cJSON.h"
+#include "json-arena.h"
 #include "settings.h"
+#include "diagnostics.h"
+#include "boot-timeline.h"
+#include "discovery.h"
+#include "static-memory.h"
+
+#define HTTP_REQUEST_MAX 1024      // Headers and body of a POST /configure
+#define SCAN_RESULTS_JSON_MAX 2048 // Response bodies, built in place for each request
+#define DIAGNOSTICS_JSON_MAX 2048
 
 static struct tcp_pcb *http_pcb = NULL;
 
-static std::string fullRequest;
+// POST /configure as it arrives, possibly over several segments
+static char fullRequest[HTTP_REQUEST_MAX];
+static size_t fullRequestLength = 0;
+
+// The HTTP server stays up on the station interface for the diagnostics routes,
+// but credentials are only read or written on the setup access point
+static bool provisioningAllowed(struct tcp_pcb *pcb)
+{
+  if (isAppModeActive)
+  {
+    return true;
+  }
+  printf("Provisioning request refused outside AP mode.\n");
+  const char *response = "HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\n\r\n";
+  tcp_write(pcb, response, strlen(response), TCP_WRITE_FLAG_COPY);
+  return false;
+}
 
 static err_t handle_post_request(struct tcp_pcb *pcb, const char *request)
 {
@@ -18,7 +42,16 @@ static err_t handle_post_request(struct tcp_pcb *pcb, const char *request)
   if (body)
   {
     body += 4; // Move past the "\r\n\r\n" delimiter
-    printf("Received POST data: %s\n", body);
+    printf("Received POST data, %u bytes.\n", (unsigned)strlen(body));
+
+    // Runs on lwIP's thread, which must not wait for a task parsing a message
+    if (!jsonArenaTryBegin())
+    {
+      printf("JSON arena busy, configure request refused.\n");
+      const char *response = "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 1\r\nContent-Length: 0\r\n\r\n";
+      tcp_write(pcb, response, strlen(response), TCP_WRITE_FLAG_COPY);
+      return ERR_OK;
+    }
 
     // Parse JSON
     cJSON *json = cJSON_Parse(body);
@@ -31,20 +64,11 @@ static err_t handle_post_request(struct tcp_pcb *pcb, const char *request)
 
       if (cJSON_IsString(ssid) && cJSON_IsString(password) && cJSON_IsNumber(authMode))
       {
-        // Save to settings
-        strncpy((char *)currentSettings.ssid, ssid->valuestring, sizeof(currentSettings.ssid) - 1);
-        currentSettings.ssid[sizeof(currentSettings.ssid) - 1] = '\0';
-
-        strncpy((char *)currentSettings.password, password->valuestring, sizeof(currentSettings.password) - 1);
-        currentSettings.password[sizeof(currentSettings.password) - 1] = '\0';
+        // Save to settings, the settings task writes them to flash
+        settingsSetCredentials(ssid->valuestring, password->valuestring, authMode->valueint);
 
-        currentSettings.authMode = authMode->valueint;
-
-        // Trigger a settings validation to save the updated settings
-        requestSettingsUpdate();
-
-        printf("Saved credentials: SSID='%s', Password='%s', AuthMode=%d\n",
-               currentSettings.ssid, currentSettings.password, currentSettings.authMode);
+        printf("Saved credentials: SSID='%s', AuthMode=%d\n",
+               currentSettings.ssid, currentSettings.authMode);
       }
       else
       {
@@ -57,6 +81,7 @@ static err_t handle_post_request(struct tcp_pcb *pcb, const char *request)
     {
       printf("Failed to parse JSON.\n");
     }
+    jsonArenaEnd();
     const char *response = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
     tcp_write(pcb, response, strlen(response), TCP_WRITE_FLAG_COPY);
   }
@@ -67,9 +92,9 @@ static err_t handle_post_request(struct tcp_pcb *pcb, const char *request)
   return ERR_OK;
 }
 
-static const char *generateScanResultsJson()
+const char *generateScanResultsJson()
 {
-  static char jsonBuffer[2048]; // Ensure it's large enough for your scan results
+  static char jsonBuffer[SCAN_RESULTS_JSON_MAX];
   size_t offset = 0;
 
   offset += snprintf(jsonBuffer + offset, sizeof(jsonBuffer) - offset, "[");
@@ -123,6 +148,12 @@ static err_t http_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err
 
   if (strncmp(request, "GET /scan.json", 14) == 0)
   {
+    if (!provisioningAllowed(pcb))
+    {
+      tcp_recved(pcb, p->len);
+      pbuf_free(p);
+      return ERR_OK;
+    }
     printf("HIT SCAN!\n");
     const char *jsonResponse = generateScanResultsJson();
     char header[128];
@@ -130,6 +161,33 @@ static err_t http_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err
     tcp_write(pcb, header, strlen(header), TCP_WRITE_FLAG_COPY);
     tcp_write(pcb, jsonResponse, strlen(jsonResponse), TCP_WRITE_FLAG_COPY);
   }
+  else if (strncmp(request, "GET /diagnostics.json", 21) == 0)
+  {
+    static char jsonResponse[DIAGNOSTICS_JSON_MAX];
+    size_t length = diagnosticsToJson(jsonResponse, sizeof(jsonResponse));
+    char header[128];
+    snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n\r\n", length);
+    tcp_write(pcb, header, strlen(header), TCP_WRITE_FLAG_COPY);
+    tcp_write(pcb, jsonResponse, length, TCP_WRITE_FLAG_COPY);
+  }
+  else if (strncmp(request, "GET /diagnostics/boot.json", 26) == 0)
+  {
+    static char jsonResponse[BOOT_TIMELINE_JSON_MAX];
+    size_t length = bootTimelineToJson(jsonResponse, sizeof(jsonResponse));
+    char header[128];
+    snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n\r\n", length);
+    tcp_write(pcb, header, strlen(header), TCP_WRITE_FLAG_COPY);
+    tcp_write(pcb, jsonResponse, length, TCP_WRITE_FLAG_COPY);
+  }
+  else if (strncmp(request, "GET /diagnostics/peers.json", 27) == 0)
+  {
+    static char jsonResponse[DISCOVERY_PEERS_JSON_MAX];
+    size_t length = discoveredPeersToJson(jsonResponse, sizeof(jsonResponse));
+    char header[128];
+    snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n\r\n", length);
+    tcp_write(pcb, header, strlen(header), TCP_WRITE_FLAG_COPY);
+    tcp_write(pcb, jsonResponse, length, TCP_WRITE_FLAG_COPY);
+  }
   else if (strncmp(request, "GET /", 5) == 0)
   {
     char header[256];
@@ -151,19 +209,35 @@ static err_t http_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err
       tcp_close(pcb);
       return ERR_OK;
     }
+    if (!provisioningAllowed(pcb))
+    {
+      fullRequestLength = 0;
+      tcp_recved(pcb, p->len);
+      pbuf_free(p);
+      return ERR_OK;
+    }
 
-    // Append received data to the fullRequest buffer
-    fullRequest.append(static_cast<const char *>(p->payload), p->len);
+    // Append received data to the fullRequest buffer, a request too large for it is dropped
+    if (fullRequestLength + p->len >= sizeof(fullRequest))
+    {
+      printf("Configure request longer than %d bytes, dropped.\n", HTTP_REQUEST_MAX - 1);
+      fullRequestLength = 0;
+      tcp_recved(pcb, p->len);
+      pbuf_free(p);
+      return ERR_OK;
+    }
+    memcpy(fullRequest + fullRequestLength, p->payload, p->len);
+    fullRequestLength += p->len;
+    fullRequest[fullRequestLength] = '\0';
 
     // Check if the request is complete (headers and body separated by \r\n\r\n)
-    size_t headerEnd = fullRequest.find("\r\n\r\n");
-    if (headerEnd != std::string::npos)
+    if (strstr(fullRequest, "\r\n\r\n") != NULL)
     {
       // Process the complete request
-      handle_post_request(pcb, fullRequest.c_str());
+      handle_post_request(pcb, fullRequest);
 
       // Clear the buffer for the next request
-      fullRequest.clear();
+      fullRequestLength = 0;
     }
     else
     {
@@ -184,8 +258,17 @@ static err_t http_accept(void *arg, struct tcp_pcb *pcb, err_t err)
   return ERR_OK;
 }
 
+void initHttpServer()
+{
+  staticMemoryAccount("http", sizeof(fullRequest) + SCAN_RESULTS_JSON_MAX + DIAGNOSTICS_JSON_MAX + BOOT_TIMELINE_JSON_MAX + DISCOVERY_PEERS_JSON_MAX);
+}
+
 void startHttpServer()
 {
+  if (http_pcb)
+  {
+    return;
+  }
   http_pcb = tcp_new();
   if (!http_pcb)
   {
@@ -0,0 +1,273 @@
+#include "input.h"
+#include "constants.h"
+
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define DEBOUNCE_TIME_MS 50       // Edges after an accepted one are ignored for this long
+#define LONG_PRESS_TIME_MS 500
+#define DOUBLE_PRESS_WINDOW_MS 300 // From a short press's release to the next press
+
+#define INPUT_RING_SIZE 64 // Power of two; holds a burst of contact bounce
+
+static const uint INPUT_BUTTON_GPIOS[INPUT_BUTTON_COUNT] = {ENTER_SW_GPIO, COMPRESSOR_BUTTON_GPIO, EXTRACTOR_BUTTON_GPIO};
+
+// One edge as seen by the ISR. The pin is read rather than taken from the event
+// mask, which can hold both edges when they come close together.
+typedef struct
+{
+  uint32_t timeUs;
+  uint8_t button;
+  bool pressed;
+} InputEdge;
+
+// Single producer (the GPIO ISR) and single consumer (nextInputEvent), so the
+// indices only need ordering, not locks
+static InputEdge ring[INPUT_RING_SIZE];
+static uint32_t ringHead = 0; // Written by the ISR
+static uint32_t ringTail = 0; // Written by the consumer
+static volatile bool edgeLost[INPUT_BUTTON_COUNT];
+static volatile uint32_t droppedEdges = 0;
+static TaskHandle_t consumerTask = NULL;
+
+typedef struct
+{
+  bool level;        // Last level recorded for the pin
+  bool pressed;      // Debounced state
+  bool settling;     // Ignoring edges until settledUs
+  uint32_t settledUs;
+  uint32_t pressUs;  // Start of the current press
+  uint32_t releaseUs; // End of the last short press
+  bool doubleEnabled; // Short presses wait out the double press window
+  bool shortPending; // A short press waiting to see if a second one follows
+  bool doublePress;  // The current press started inside the double press window
+  bool longSent;
+} ButtonState;
+
+static ButtonState buttons[INPUT_BUTTON_COUNT];
+static InputStats stats;
+
+static bool reached(uint32_t nowUs, uint32_t deadlineUs)
+{
+  return (int32_t)(nowUs - deadlineUs) >= 0;
+}
+
+void initInput()
+{
+  for (int i = 0; i < INPUT_BUTTON_COUNT; i++)
+  {
+    gpio_init(INPUT_BUTTON_GPIOS[i]);
+    gpio_set_dir(INPUT_BUTTON_GPIOS[i], GPIO_IN);
+    gpio_pull_up(INPUT_BUTTON_GPIOS[i]); // Assuming active low buttons
+    buttons[i].level = gpio_get(INPUT_BUTTON_GPIOS[i]) == 0;
+    buttons[i].pressed = buttons[i].level;
+    gpio_set_irq_enabled(INPUT_BUTTON_GPIOS[i], GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+  }
+}
+
+void setInputConsumer(TaskHandle_t task)
+{
+  consumerTask = task;
+}
+
+void enableDoublePress(InputButton button)
+{
+  buttons[button].doubleEnabled = true;
+}
+
+void handleButtonISR(uint gpio, uint32_t events)
+{
+  int button = 0;
+  while (button < INPUT_BUTTON_COUNT - 1 && INPUT_BUTTON_GPIOS[button] != gpio)
+  {
+    button++;
+  }
+
+  uint32_t head = ringHead;
+  if (head - __atomic_load_n(&ringTail, __ATOMIC_ACQUIRE) >= INPUT_RING_SIZE)
+  {
+    // The consumer re-reads the pin once it has caught up
+    edgeLost[button] = true;
+    droppedEdges++;
+  }
+  else
+  {
+    ring[head % INPUT_RING_SIZE] = {time_us_32(), (uint8_t)button, gpio_get(gpio) == 0};
+    __atomic_store_n(&ringHead, head + 1, __ATOMIC_RELEASE);
+  }
+
+  if (consumerTask != NULL)
+  {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(consumerTask, &higherPriorityTaskWoken);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+  }
+}
+
+static bool emit(InputEvent *event, int button, InputGesture gesture, uint32_t timeUs)
+{
+  event->button = (InputButton)button;
+  event->gesture = gesture;
+  event->timeUs = timeUs;
+  return true;
+}
+
+// Debounced press or release at timeUs
+static bool changeState(int button, bool pressed, uint32_t timeUs, InputEvent *event)
+{
+  ButtonState &state = buttons[button];
+  state.pressed = pressed;
+  state.settling = true;
+  state.settledUs = timeUs + DEBOUNCE_TIME_MS * 1000;
+  if (pressed)
+  {
+    state.pressUs = timeUs;
+    state.longSent = false;
+    // A press inside the window takes over the pending short press, whatever it turns out to be
+    state.doublePress = state.shortPending && !reached(timeUs, state.releaseUs + DOUBLE_PRESS_WINDOW_MS * 1000);
+    state.shortPending = false;
+    return false;
+  }
+  if (state.longSent)
+  {
+    return false; // Reported when the hold time ran out
+  }
+  if (state.doublePress)
+  {
+    return emit(event, button, DOUBLE_PRESS, timeUs);
+  }
+  if (state.doubleEnabled)
+  {
+    state.shortPending = true;
+    state.releaseUs = timeUs;
+    return false;
+  }
+  return emit(event, button, SHORT_PRESS, timeUs);
+}
+
+// Deadlines up to nowUs: the end of a debounce, the long press and the end of
+// the double press window
+static bool advance(int button, uint32_t nowUs, InputEvent *event)
+{
+  ButtonState &state = buttons[button];
+  if (state.settling && reached(nowUs, state.settledUs))
+  {
+    state.settling = false;
+    // The pin moved again while edges were being ignored
+    if (state.level != state.pressed && changeState(button, state.level, state.settledUs, event))
+    {
+      return true;
+    }
+  }
+  if (state.pressed && !state.longSent)
+  {
+    uint32_t longUs = state.pressUs + LONG_PRESS_TIME_MS * 1000;
+    if (reached(nowUs, longUs))
+    {
+      state.longSent = true;
+      return emit(event, button, LONG_PRESS, longUs);
+    }
+  }
+  if (state.shortPending)
+  {
+    uint32_t windowUs = state.releaseUs + DOUBLE_PRESS_WINDOW_MS * 1000;
+    if (reached(nowUs, windowUs))
+    {
+      state.shortPending = false;
+      return emit(event, button, SHORT_PRESS, windowUs);
+    }
+  }
+  return false;
+}
+
+// Edges are applied in the order they happened, with each button's deadlines run
+// up to the edge's time first, so the outcome depends only on the timestamps
+bool nextInputEvent(InputEvent *event)
+{
+  uint32_t tail = ringTail;
+  while (tail != __atomic_load_n(&ringHead, __ATOMIC_ACQUIRE))
+  {
+    const InputEdge edge = ring[tail % INPUT_RING_SIZE];
+    ButtonState &state = buttons[edge.button];
+    if (advance(edge.button, edge.timeUs, event))
+    {
+      return true; // The edge is applied on the next call
+    }
+    tail++;
+    __atomic_store_n(&ringTail, tail, __ATOMIC_RELEASE);
+    state.level = edge.pressed;
+    if (!state.settling && state.level != state.pressed && changeState(edge.button, state.level, edge.timeUs, event))
+    {
+      return true;
+    }
+  }
+
+  uint32_t nowUs = time_us_32();
+  for (int button = 0; button < INPUT_BUTTON_COUNT; button++)
+  {
+    if (edgeLost[button])
+    {
+      edgeLost[button] = false;
+      buttons[button].level = gpio_get(INPUT_BUTTON_GPIOS[button]) == 0;
+    }
+    if (advance(button, nowUs, event))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t inputWaitMs(uint32_t limit)
+{
+  uint32_t nowUs = time_us_32();
+  uint32_t waitUs = limit * 1000;
+  for (const ButtonState &state : buttons)
+  {
+    bool pending = true;
+    uint32_t deadlineUs = 0;
+    if (state.settling)
+    {
+      deadlineUs = state.settledUs;
+    }
+    else if (state.pressed && !state.longSent)
+    {
+      deadlineUs = state.pressUs + LONG_PRESS_TIME_MS * 1000;
+    }
+    else if (state.shortPending)
+    {
+      deadlineUs = state.releaseUs + DOUBLE_PRESS_WINDOW_MS * 1000;
+    }
+    else
+    {
+      pending = false;
+    }
+    if (pending)
+    {
+      uint32_t untilUs = reached(nowUs, deadlineUs) ? 0 : deadlineUs - nowUs;
+      if (untilUs < waitUs)
+      {
+        waitUs = untilUs;
+      }
+    }
+  }
+  return (waitUs + 999) / 1000;
+}
+
+void inputEventHandled(const InputEvent *event)
+{
+  uint32_t latencyUs = time_us_32() - event->timeUs;
+  stats.lastLatencyUs = latencyUs;
+  if (latencyUs > stats.maxLatencyUs)
+  {
+    stats.maxLatencyUs = latencyUs;
+  }
+  stats.events++;
+}
+
+void getInputStats(InputStats *out)
+{
+  *out = stats;
+  out->droppedEdges = droppedEdges;
+}
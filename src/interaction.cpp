@@ -4,6 +4,8 @@
 #include "control.h"
 #include "isr-handlers.h"
 #include "extractor.h"
+#include "encoder.h"
+#include "input.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -11,137 +13,80 @@
 
 #include "pico/stdlib.h"
 #include "FreeRTOS.h"
-#include "timers.h"
-#include "queue.h"
+#include "task.h"
 
-#define DEBOUNCE_TIME_MS 50
-#define LONG_PRESS_TIME_MS 500
-#define QUEUE_WAIT_TIME_MS 100
+#define ENCODER_POLL_MS 10
 
-SemaphoreHandle_t interactionQueue = NULL;
-volatile int32_t encoderPosition = 0;
+// Turning faster than the threshold scales each detent up to the largest step,
+// so a quick flick sweeps a 0-100 setting
+#define ENCODER_ACCEL_THRESHOLD 8 // Detents per second before steps grow
+#define ENCODER_ACCEL_FULL 60     // Detents per second for the largest step
+#define ENCODER_ACCEL_MAX_STEP 10
 
-TimerHandle_t debounceTimers[3];
-TimerHandle_t longPressTimers[3];
-volatile bool buttonStates[3] = {0};         // 0 for up, 1 for down
-volatile bool longPressHandled[3] = {false}; // Track if long press has been handled
-
-void debounceTimerCallback(TimerHandle_t xTimer);
-void longPressTimerCallback(TimerHandle_t xTimer);
+// Action for each button gesture, indexed by InputButton then InputGesture. Only
+// buttons with a double press action wait out the window after a short press,
+// the compressor and extractor toggle at once on every press.
+static const Interaction gestureActions[INPUT_BUTTON_COUNT][INPUT_GESTURE_COUNT] = {
+    {ENTER, BACK, ENTER_DOUBLE_PRESS},
+    {COMPRESSOR, COMPRESSOR_LONG_PRESS, NONE},
+    {EXTRACTOR, EXTRACTOR_LONG_PRESS, NONE},
+};
 
 void initInteraction()
 {
-  interactionQueue = xQueueCreate(10, sizeof(Interaction));
-  gpio_init(ENCODER_CLK_GPIO);
-  gpio_init(ENCODER_DC_GPIO);
-  gpio_set_dir(ENCODER_CLK_GPIO, GPIO_IN);
-  gpio_set_dir(ENCODER_DC_GPIO, GPIO_IN);
-
-  gpio_set_irq_enabled(ENCODER_CLK_GPIO, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
-  gpio_set_irq_enabled(ENCODER_DC_GPIO, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
-
-  const uint gpio_buttons[3] = {ENTER_SW_GPIO, COMPRESSOR_BUTTON_GPIO, EXTRACTOR_BUTTON_GPIO};
-  for (int i = 0; i < 3; i++)
-  {
-    debounceTimers[i] = xTimerCreate("DebounceTimer", pdMS_TO_TICKS(DEBOUNCE_TIME_MS), pdFALSE, (void *)(uintptr_t)i, debounceTimerCallback);
-    longPressTimers[i] = xTimerCreate("LongPressTimer", pdMS_TO_TICKS(LONG_PRESS_TIME_MS), pdFALSE, (void *)(uintptr_t)i, longPressTimerCallback);
-    gpio_init(gpio_buttons[i]);
-    gpio_set_dir(gpio_buttons[i], GPIO_IN);
-    gpio_pull_up(gpio_buttons[i]); // Assuming active low buttons
-    gpio_set_irq_enabled(gpio_buttons[i], GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
-  }
-}
-
-void handleButtonISR(uint gpio, uint32_t events)
-{
-  int index = (gpio == ENTER_SW_GPIO ? 0 : (gpio == COMPRESSOR_BUTTON_GPIO ? 1 : 2));
-  BaseType_t higherPriorityTaskWoken = pdFALSE;
-
-  // Start or reset the debounce timer
-  xTimerResetFromISR(debounceTimers[index], &higherPriorityTaskWoken);
-}
-
-void debounceTimerCallback(TimerHandle_t xTimer)
-{
-  int index = (int)(uintptr_t)pvTimerGetTimerID(xTimer);
-  uint gpio = (index == 0 ? ENTER_SW_GPIO : (index == 1 ? COMPRESSOR_BUTTON_GPIO : EXTRACTOR_BUTTON_GPIO));
-
-  // Check the stable state of the button
-  bool currentLevel = gpio_get(gpio) == 0; // Assuming active low
-  if (currentLevel != buttonStates[index])
+  // Buttons are debounced from timestamped edges and the knob is decoded by PIO,
+  // both on interactionTask with no timers
+  initInput();
+  for (int button = 0; button < INPUT_BUTTON_COUNT; button++)
   {
-    buttonStates[index] = currentLevel;
-    if (currentLevel)
-    {
-      // Button press detected
-      xTimerStart(longPressTimers[index], 0); // Start long press timer
-      longPressHandled[index] = false;
-    }
-    else
+    if (gestureActions[button][DOUBLE_PRESS] != NONE)
     {
-      // Button release detected
-      xTimerStop(longPressTimers[index], 0);
-      if (!longPressHandled[index])
-      {
-        // Short press detected
-        Interaction action = (index == 0 ? ENTER : (index == 1 ? COMPRESSOR : EXTRACTOR));
-        xQueueSendFromISR(interactionQueue, &action, NULL);
-      }
+      enableDoublePress((InputButton)button);
     }
   }
+  initEncoder();
 }
 
-void longPressTimerCallback(TimerHandle_t xTimer)
+// Step size for a turn of `detents` clicks that came `intervalMs` after the last one
+static int encoderStep(int detents, uint32_t intervalMs)
 {
-  int index = (int)(uintptr_t)pvTimerGetTimerID(xTimer);
-  longPressHandled[index] = true;
-  Interaction action = (index == 0 ? BACK : (index == 1 ? COMPRESSOR_LONG_PRESS : EXTRACTOR_LONG_PRESS));
-  xQueueSendFromISR(interactionQueue, &action, NULL);
+  uint32_t rate = intervalMs > 0 ? (uint32_t)detents * 1000 / intervalMs : ENCODER_ACCEL_FULL;
+  if (rate <= ENCODER_ACCEL_THRESHOLD)
+  {
+    return 1;
+  }
+  if (rate >= ENCODER_ACCEL_FULL)
+  {
+    return ENCODER_ACCEL_MAX_STEP;
+  }
+  return 1 + (int)((ENCODER_ACCEL_MAX_STEP - 1) * (rate - ENCODER_ACCEL_THRESHOLD) / (ENCODER_ACCEL_FULL - ENCODER_ACCEL_THRESHOLD));
 }
 
-// Ensure the remaining part of your program initializes and uses these structures properly
-
-void handleEncoderISR(uint gpio, uint32_t events)
+// Turns whole detents since the last poll into one up or down adjustment. The
+// partial detent is left in lastCount for the next poll.
+static void pollEncoder()
 {
-  static int32_t last_level_a = -1;
-  static int32_t lastEncoderPosition = 0;
-  if (gpio == ENCODER_CLK_GPIO)
+  static int32_t lastCount = 0;
+  static TickType_t lastTurn = 0;
+  int32_t delta = (int32_t)((uint32_t)readEncoderCount() - (uint32_t)lastCount);
+  int detents = delta / ENCODER_COUNTS_PER_DETENT;
+  if (detents == 0)
   {
-    int level_a = gpio_get(ENCODER_CLK_GPIO);
-    int level_b = gpio_get(ENCODER_DC_GPIO);
-
-    if (level_a != last_level_a)
-    {
-      last_level_a = level_a;
-
-      // Rising edge of A determines the action using B's state
-      if (level_a == 1)
-      {
-        encoderPosition += (level_b == 1 ? 1 : -1);
-      }
-      // Falling edge of A can also determine the action if needed
-      else
-      {
-        encoderPosition += (level_b == 0 ? 1 : -1);
-      }
-      Interaction action = NONE;
-      if (encoderPosition > lastEncoderPosition)
-      {
-        action = UP;
-      }
-      else if (encoderPosition < lastEncoderPosition)
-      {
-        action = DOWN;
-      }
-      lastEncoderPosition = encoderPosition;
-      if (action != NONE)
-      {
-        xQueueSendFromISR(interactionQueue, &action, NULL);
-      }
-      printf("Encoder Position: %d\n", encoderPosition);
-    }
+    return;
+  }
+  lastCount += detents * ENCODER_COUNTS_PER_DETENT;
 
-    // Log the position for testing purposes
+  TickType_t now = xTaskGetTickCount();
+  int clicks = abs(detents);
+  int steps = clicks * encoderStep(clicks, pdTICKS_TO_MS(now - lastTurn));
+  lastTurn = now;
+  if (detents > 0)
+  {
+    displayUp(clicks, steps);
+  }
+  else
+  {
+    displayDown(clicks, steps);
   }
 }
 
@@ -157,17 +102,13 @@ void handleInteraction(Interaction interaction)
     printf("BACK COMMAND\n");
     displayBack();
     break;
-  case UP:
-    printf("UP COMMAND\n");
-    displayUp();
-    break;
-  case DOWN:
-    printf("DOWN COMMAND\n");
-    displayDown();
+  case ENTER_DOUBLE_PRESS:
+    printf("HOME COMMAND\n");
+    displayHome();
     break;
   case COMPRESSOR:
     printf("COMPRESSOR COMMAND\n");
-    if (g_compressorStatus.compressorOn)
+    if (g_compressorStatus.read().compressorOn)
     {
       sendOffCommand();
     }
@@ -204,17 +145,21 @@ void handleInteraction(Interaction interaction)
 
 void interactionTask(void *pvParameters)
 {
-  Interaction interaction = NONE;
+  setInputConsumer(xTaskGetCurrentTaskHandle());
+  InputEvent event;
   while (1)
   {
-    if (xQueueReceive(interactionQueue, &interaction, pdMS_TO_TICKS(QUEUE_WAIT_TIME_MS)) == pdPASS)
+    while (nextInputEvent(&event))
     {
-      // Process interaction commands
-      handleInteraction(interaction);
-    }
-    else
-    {
-      vPortYield();
+      Interaction interaction = gestureActions[event.button][event.gesture];
+      if (interaction != NONE)
+      {
+        handleInteraction(interaction);
+        inputEventHandled(&event);
+      }
     }
+    pollEncoder();
+    // Woken early by button edges, otherwise in time for the next hold deadline or encoder poll
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(inputWaitMs(ENCODER_POLL_MS)));
   }
 }
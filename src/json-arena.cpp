@@ -0,0 +1,83 @@
+#include "json-arena.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "cJSON.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "static-memory.h"
+
+#define JSON_ARENA_ALIGN 8 // cJSON nodes hold a double
+
+static uint8_t arena[JSON_ARENA_SIZE] __attribute__((aligned(JSON_ARENA_ALIGN)));
+static size_t arenaUsed = 0;
+static size_t arenaHighWater = 0;
+static bool arenaFullReported = false;
+
+static StaticSemaphore_t arenaMutexMemory;
+static SemaphoreHandle_t arenaMutex = NULL;
+
+static void *arenaAllocate(size_t size)
+{
+  size_t start = (arenaUsed + JSON_ARENA_ALIGN - 1) & ~(size_t)(JSON_ARENA_ALIGN - 1);
+  if (start + size > JSON_ARENA_SIZE)
+  {
+    // cJSON treats this like malloc failing, the parse or build is abandoned
+    if (!arenaFullReported)
+    {
+      printf("JSON arena full, %u bytes requested with %u used.\n", (unsigned)size, (unsigned)arenaUsed);
+      arenaFullReported = true;
+    }
+    return NULL;
+  }
+  arenaUsed = start + size;
+  if (arenaUsed > arenaHighWater)
+  {
+    arenaHighWater = arenaUsed;
+  }
+  return &arena[start];
+}
+
+static void arenaFree(void *pointer)
+{
+  // Reclaimed all at once by the next jsonArenaBegin()
+  (void)pointer;
+}
+
+void initJsonArena()
+{
+  arenaMutex = xSemaphoreCreateMutexStatic(&arenaMutexMemory);
+  staticMemoryAccount("json", sizeof(arena) + sizeof(arenaMutexMemory));
+
+  cJSON_Hooks hooks = {arenaAllocate, arenaFree};
+  cJSON_InitHooks(&hooks);
+}
+
+void jsonArenaBegin()
+{
+  xSemaphoreTake(arenaMutex, portMAX_DELAY);
+  arenaUsed = 0;
+  arenaFullReported = false;
+}
+
+bool jsonArenaTryBegin()
+{
+  if (xSemaphoreTake(arenaMutex, 0) != pdTRUE)
+  {
+    return false;
+  }
+  arenaUsed = 0;
+  arenaFullReported = false;
+  return true;
+}
+
+void jsonArenaEnd()
+{
+  xSemaphoreGive(arenaMutex);
+}
+
+size_t jsonArenaHighWater()
+{
+  return arenaHighWater;
+}
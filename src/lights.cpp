@@ -1,9 +1,15 @@
 #include "constants.h"
 #include "lights.h"
 #include "settings.h"
+#include "sensors.h"
+#include "extractor.h"
+#include "ramp.h"
+#include "thermal.h"
+#include "gamma.h"
 
 #include "pico/stdlib.h"
 #include "hardware/pwm.h"
+#include "hardware/irq.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
@@ -14,48 +20,255 @@ LEDPWMController lightsA, lightsB, lightsC;
 volatile int lightBrightness = 0;
 volatile int lightTargetBrightness = currentSettings.lightBrightness;
 
+volatile int lightsChannelBrightness[LIGHTS_CHANNELS] = {0, 0, 0};
+volatile int lightsChannelLimit[LIGHTS_CHANNELS] = {100, 100, 100};
+volatile float lightsChannelPredicted[LIGHTS_CHANNELS] = {0.0f, 0.0f, 0.0f};
+
+typedef struct
+{
+  uint gpio;
+
+  // Calibration: duty (in PWM levels) where the bar first visibly lights, and a Q16
+  // gain trim so bars with different LED bins can be matched at full output
+  uint16_t offset;
+  uint32_t trim;
+
+  Ramp ramp; // In perceptual lightness, 0-GAMMA_LIGHTNESS_MAX
+  ThermalChannel thermal;
+
+  // Output, duty with GAMMA_FRACTION_BITS below the PWM LSB
+  volatile uint32_t duty;
+  volatile bool dithering;
+  uint8_t ditherError;
+} LightChannel;
+
+static LightChannel channels[LIGHTS_CHANNELS] = {
+    {.gpio = LIGHTS_A_PWM_GPIO, .offset = LIGHTS_A_OFFSET, .trim = LIGHTS_A_TRIM},
+    {.gpio = LIGHTS_B_PWM_GPIO, .offset = LIGHTS_B_OFFSET, .trim = LIGHTS_B_TRIM},
+    {.gpio = LIGHTS_C_PWM_GPIO, .offset = LIGHTS_C_OFFSET, .trim = LIGHTS_C_TRIM},
+};
+static uint ditherSlice;
+static TaskHandle_t lightsTaskHandle = NULL;
+static int coolingDemand = 0;
+
 // Initialize a single LED PWM controller
 void ledPwmInit(uint gpio)
 {
   gpio_set_function(gpio, GPIO_FUNC_PWM);
   uint slice_num = pwm_gpio_to_slice_num(gpio);
   pwm_config config = pwm_get_default_config();
-  pwm_config_set_clkdiv(&config, 4.f); // Set the clock divider
-  pwm_config_set_wrap(&config, 65535); // Set the maximum PWM counter value
+  pwm_config_set_clkdiv(&config, 1.f);              // Full system clock, for the highest PWM rate at 16 bits
+  pwm_config_set_wrap(&config, LIGHTS_PWM_WRAP);    // Set the maximum PWM counter value
   pwm_init(slice_num, &config, true);
 }
 
-// Function to set the duty cycle for a given PWM GPIO
-void ledPwmSetDutyCycle(uint gpio, uint dutyCycle)
+// PWM wrap of the first bar's slice. The other slices run at the same rate and latch
+// their level at their own wrap, so one interrupt can feed all three. First-order
+// sigma-delta: the carried error makes the average over 2^GAMMA_FRACTION_BITS
+// periods land on the fractional duty.
+static void lightsPwmWrapISR()
 {
-  uint slice_num = pwm_gpio_to_slice_num(gpio);
-  uint duty = (uint32_t)dutyCycle * 65535 / 100; // Convert percentage to duty cycle value
-  pwm_set_chan_level(slice_num, pwm_gpio_to_channel(gpio), duty);
+  pwm_clear_irq(ditherSlice);
+  for (int i = 0; i < LIGHTS_CHANNELS; i++)
+  {
+    LightChannel &channel = channels[i];
+    if (!channel.dithering)
+    {
+      continue;
+    }
+    uint32_t duty = channel.duty;
+    uint32_t level = duty >> GAMMA_FRACTION_BITS;
+    channel.ditherError += duty & ((1 << GAMMA_FRACTION_BITS) - 1);
+    if (channel.ditherError >= (1 << GAMMA_FRACTION_BITS))
+    {
+      channel.ditherError -= (1 << GAMMA_FRACTION_BITS);
+      level++;
+    }
+    pwm_set_gpio_level(channel.gpio, level);
+  }
+}
+
+// Lightness -> calibrated duty -> PWM, integer only
+static void setChannelLightness(int index, uint32_t lightness)
+{
+  LightChannel &channel = channels[index];
+  uint32_t duty = 0;
+  if (lightness > 0)
+  {
+    const uint32_t offset = (uint32_t)channel.offset << GAMMA_FRACTION_BITS;
+    const uint32_t span = (uint32_t)(((uint64_t)(GAMMA_DUTY_MAX - offset) * channel.trim) >> 16);
+    duty = offset + (uint32_t)(((uint64_t)gammaLightnessToDuty(lightness) * span) / GAMMA_DUTY_MAX);
+  }
+
+  channel.duty = duty;
+  bool dither = (duty >> GAMMA_FRACTION_BITS) < LIGHTS_DITHER_LEVEL && (duty & ((1 << GAMMA_FRACTION_BITS) - 1)) != 0;
+  channel.dithering = dither;
+  if (!dither)
+  {
+    // High enough that one LSB is invisible, round and let the hardware hold it
+    pwm_set_gpio_level(channel.gpio, (duty + (1 << (GAMMA_FRACTION_BITS - 1))) >> GAMMA_FRACTION_BITS);
+  }
+
+  // Only take the wrap interrupt while some bar actually needs it
+  bool anyDithering = false;
+  for (int i = 0; i < LIGHTS_CHANNELS; i++)
+  {
+    anyDithering |= channels[i].dithering;
+  }
+  pwm_set_irq_enabled(ditherSlice, anyDithering);
+}
+
+// Ramp step, runs in the timer service task at the ramp tick rate while fading
+static void onLightsRampStep(uint32_t level, void *context)
+{
+  int index = (int)(intptr_t)context;
+  setChannelLightness(index, level);
+  lightsChannelBrightness[index] = (int)((level * 100 + GAMMA_LIGHTNESS_MAX / 2) / GAMMA_LIGHTNESS_MAX);
+
+  int brightest = 0;
+  for (int i = 0; i < LIGHTS_CHANNELS; i++)
+  {
+    if (lightsChannelBrightness[i] > brightest)
+    {
+      brightest = lightsChannelBrightness[i];
+    }
+  }
+  lightBrightness = brightest;
+}
+
+static ThermalCurve currentDerateCurve()
+{
+  ThermalCurve curve = {
+      .startC = currentSettings.lightDerateStart,
+      .endC = currentSettings.lightDerateEnd,
+      .minPercent = LIGHTS_DERATE_MIN,
+  };
+  if (curve.startC <= 0 || curve.endC <= curve.startC)
+  {
+    curve.startC = LIGHTS_DEFAULT_DERATE_START;
+    curve.endC = LIGHTS_DEFAULT_DERATE_END;
+  }
+  return curve;
+}
+
+// Steps every bar's thermal model and, if enabled, asks the extractor for help
+static void updateThermal(uint32_t elapsedMs)
+{
+  const ThermalCurve curve = currentDerateCurve();
+  const SensorReadings readings = sensorReadings.read();
+  // The booth sensor reads 0 until its first sample
+  float ambient = readings.boothTemp != 0.0f ? readings.boothTemp : THERMAL_DEFAULT_AMBIENT_C;
+  int demand = 0;
+
+  for (int i = 0; i < LIGHTS_CHANNELS; i++)
+  {
+    LightChannel &channel = channels[i];
+    channel.thermal.curve = curve;
+    // Readings that fail are never published, so 0 means no sample yet
+    float measured = readings.lightsTemp[i];
+    // The model wants electrical duty, not perceived brightness
+    uint8_t dutyPercent = (uint8_t)(((uint64_t)channel.duty * 100) / GAMMA_DUTY_MAX);
+    uint8_t limit = thermalUpdate(&channel.thermal, measured, measured != 0.0f, ambient, dutyPercent, elapsedMs);
+    if (limit < 100 && lightsChannelLimit[i] == 100)
+    {
+      printf("Lights %c derating to %u%% (predicted %.1fC)\n", 'A' + i, limit, channel.thermal.predictedC);
+    }
+    lightsChannelLimit[i] = limit;
+    lightsChannelPredicted[i] = channel.thermal.predictedC;
+
+    uint8_t channelDemand = thermalCoolingDemand(&channel.thermal);
+    if (channelDemand > demand)
+    {
+      demand = channelDemand;
+    }
+  }
+
+  if (!currentSettings.lightCooling)
+  {
+    demand = 0;
+  }
+  if (demand != coolingDemand)
+  {
+    coolingDemand = demand;
+    setExtractorCoolingDemand(demand);
+  }
 }
 
 void initLights()
 {
-  ledPwmInit(LIGHTS_A_PWM_GPIO);
-  ledPwmInit(LIGHTS_B_PWM_GPIO);
-  ledPwmInit(LIGHTS_C_PWM_GPIO);
+  const ThermalCurve curve = currentDerateCurve();
+  for (int i = 0; i < LIGHTS_CHANNELS; i++)
+  {
+    ledPwmInit(channels[i].gpio);
+    thermalInit(&channels[i].thermal, &curve);
+    // The gamma table already makes lightness perceptually even, so fade it linearly
+    rampInit(&channels[i].ramp, GAMMA_LIGHTNESS_MAX, RAMP_LINEAR, LIGHTS_RAMP_MS, onLightsRampStep, (void *)(intptr_t)i);
+  }
+
+  ditherSlice = pwm_gpio_to_slice_num(channels[0].gpio);
+  pwm_clear_irq(ditherSlice);
+  irq_set_exclusive_handler(PWM_IRQ_WRAP, lightsPwmWrapISR);
+  irq_set_enabled(PWM_IRQ_WRAP, true);
+}
+
+void setLightTargetBrightness(int brightness)
+{
+  if (brightness < 0)
+  {
+    brightness = 0;
+  }
+  else if (brightness > 100)
+  {
+    brightness = 100;
+  }
+  lightTargetBrightness = brightness;
+  if (lightsTaskHandle != NULL)
+  {
+    xTaskNotifyGive(lightsTaskHandle);
+  }
+}
+
+bool lightsRamping()
+{
+  for (int i = 0; i < LIGHTS_CHANNELS; i++)
+  {
+    if (rampIsActive(&channels[i].ramp))
+    {
+      return true;
+    }
+  }
+  return false;
 }
 
 void lightsTask(void *pvParameters)
 {
+  lightsTaskHandle = xTaskGetCurrentTaskHandle();
+  TickType_t lastUpdate = xTaskGetTickCount();
   while (1)
   {
-    // Set the same brightness for all lights
-    if (lightBrightness > lightTargetBrightness)
+    TickType_t now = xTaskGetTickCount();
+    uint32_t elapsedMs = pdTICKS_TO_MS(now - lastUpdate);
+    if (elapsedMs >= THERMAL_UPDATE_MS)
     {
-      lightBrightness--;
+      updateThermal(elapsedMs);
+      lastUpdate = now;
     }
-    else if (lightBrightness < lightTargetBrightness)
+
+    // Each bar follows the shared target, capped by its own thermal limit so one hot
+    // bar backs off without dimming the others. The ramp engine does the fading.
+    uint32_t target = ((uint32_t)lightTargetBrightness * GAMMA_LIGHTNESS_MAX) / 100;
+    for (int i = 0; i < LIGHTS_CHANNELS; i++)
     {
-      lightBrightness++;
+      // The limit is a duty, bring it into lightness before comparing
+      uint32_t limit = gammaDutyToLightness(((uint32_t)lightsChannelLimit[i] * GAMMA_DUTY_MAX) / 100);
+      rampSetTarget(&channels[i].ramp, target < limit ? target : limit);
     }
-    ledPwmSetDutyCycle(LIGHTS_A_PWM_GPIO, lightBrightness);
-    ledPwmSetDutyCycle(LIGHTS_B_PWM_GPIO, lightBrightness);
-    ledPwmSetDutyCycle(LIGHTS_C_PWM_GPIO, lightBrightness);
-    vTaskDelay(pdMS_TO_TICKS(100));
+    if (lightsRamping())
+    {
+      sensorsTransientStarted();
+    }
+
+    // Woken early by brightness changes, otherwise at the thermal model rate
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(THERMAL_UPDATE_MS));
   }
-}
\ No newline at end of file
+}
@@ -1,11 +1,28 @@
 #include "max44009.h"
 
+#define MAX44009_REG_INT_STATUS 0x00
+#define MAX44009_REG_INT_ENABLE 0x01
+#define MAX44009_REG_CONFIG 0x02
+#define MAX44009_REG_LUX_HIGH 0x03
+#define MAX44009_REG_THRESHOLD_UPPER 0x05
+#define MAX44009_REG_THRESHOLD_LOWER 0x06
+#define MAX44009_REG_THRESHOLD_TIMER 0x07
+
+#define MAX44009_CONFIG_CONTINUOUS 0x80
+#define MAX44009_LUX_PER_COUNT 0.045f
+
 MAX44009::MAX44009(i2c_inst_t *i2cPort, uint8_t addr) : i2cPort(i2cPort), address(addr) {}
 
 void MAX44009::init()
 {
-  // Optional: configure the sensor, if necessary
-  this->configureIntegrationTime(400);
+  // Let the sensor pick its own range, a fixed integration time clips in sunlight
+  this->configureAutoRange();
+}
+
+void MAX44009::configureAutoRange(bool continuous)
+{
+  // MANUAL bit clear: gain and integration time are chosen by the sensor
+  this->writeByte(MAX44009_REG_CONFIG, continuous ? MAX44009_CONFIG_CONTINUOUS : 0x00);
 }
 
 void MAX44009::configureIntegrationTime(uint16_t time_ms)
@@ -43,20 +60,104 @@ void MAX44009::configureIntegrationTime(uint16_t time_ms)
     break;
   }
 
-  // Write configuration value to register 0x02
-  this->writeByte(0x02, configValue);
+  // Write configuration value to the configuration register, with MANUAL set so the
+  // integration time actually applies
+  this->writeByte(MAX44009_REG_CONFIG, 0x40 | configValue);
 }
 
 float MAX44009::readLux()
 {
   uint8_t luxBytes[2];
-  if (this->readBytes(0x03, luxBytes, 2) != 2)
+  if (this->readBytes(MAX44009_REG_LUX_HIGH, luxBytes, 2) != 2)
   {
     return -1.0; // Error handling if data read fails
   }
   uint16_t exponent = (luxBytes[0] >> 4) & 0x0F;
   uint16_t mantissa = ((luxBytes[0] & 0x0F) << 4) | (luxBytes[1] & 0x0F);
-  return mantissa * (1 << exponent) * 0.045; // Correct calculation as per datasheet
+  return mantissa * (1 << exponent) * MAX44009_LUX_PER_COUNT; // Correct calculation as per datasheet
+}
+
+// Threshold registers hold an exponent and the top 4 mantissa bits. The upper
+// threshold compares against mantissa | 0x0F and the lower against mantissa & 0xF0.
+static uint32_t thresholdCounts(int reg, bool upper)
+{
+  uint32_t mantissa = (uint32_t)(reg & 0x0F) << 4;
+  if (upper)
+  {
+    mantissa |= 0x0F;
+  }
+  return mantissa << (reg >> 4);
+}
+
+// Of the register values that keep `readingCounts` inside the window, the one
+// nearest `targetCounts` without going past it, or failing that the one nearest
+// the reading. A window edge on the wrong side of the reading raises INT at once.
+uint8_t MAX44009::encodeThreshold(uint32_t targetCounts, uint32_t readingCounts, bool upper)
+{
+  int best = -1;
+  uint32_t bestCounts = 0;
+  bool bestWithin = false;
+  for (int reg = 0; reg < 0xF0; reg++)
+  {
+    uint32_t counts = thresholdCounts(reg, upper);
+    if (upper ? counts < readingCounts : counts > readingCounts)
+    {
+      continue;
+    }
+    bool within = upper ? counts <= targetCounts : counts >= targetCounts;
+    bool take;
+    if (within)
+    {
+      take = !bestWithin || (upper ? counts > bestCounts : counts < bestCounts);
+    }
+    else
+    {
+      take = !bestWithin && (best < 0 || (upper ? counts < bestCounts : counts > bestCounts));
+    }
+    if (take)
+    {
+      best = reg;
+      bestCounts = counts;
+      bestWithin = within;
+    }
+  }
+  return best < 0 ? 0xEF : (uint8_t)best; // Above the sensor's range
+}
+
+float MAX44009::setThresholdWindow(float lux, float window, uint16_t timerMs)
+{
+  uint32_t reading = (uint32_t)(lux / MAX44009_LUX_PER_COUNT + 0.5f);
+  uint32_t upperTarget = (uint32_t)(lux * (1.0f + window) / MAX44009_LUX_PER_COUNT);
+  uint32_t lowerTarget = (uint32_t)(lux * (1.0f - window) / MAX44009_LUX_PER_COUNT + 0.999f);
+  uint8_t upper = this->encodeThreshold(upperTarget, reading, true);
+  uint8_t lower = this->encodeThreshold(lowerTarget, reading, false);
+  this->writeByte(MAX44009_REG_THRESHOLD_UPPER, upper);
+  this->writeByte(MAX44009_REG_THRESHOLD_LOWER, lower);
+  uint16_t steps = timerMs / 100;
+  this->writeByte(MAX44009_REG_THRESHOLD_TIMER, steps > 0xFF ? 0xFF : (uint8_t)steps);
+
+  if (reading == 0)
+  {
+    return 0.0f;
+  }
+  float above = (float)thresholdCounts(upper, true) / reading - 1.0f;
+  float below = 1.0f - (float)thresholdCounts(lower, false) / reading;
+  return above > below ? above : below;
+}
+
+void MAX44009::enableInterrupt(bool enable)
+{
+  this->writeByte(MAX44009_REG_INT_ENABLE, enable ? 0x01 : 0x00);
+}
+
+bool MAX44009::interruptPending()
+{
+  uint8_t status = 0;
+  if (this->readBytes(MAX44009_REG_INT_STATUS, &status, 1) != 1)
+  {
+    return false;
+  }
+  return (status & 0x01) != 0;
 }
 
 int MAX44009::writeByte(uint8_t regAddr, uint8_t value)
@@ -0,0 +1,213 @@
+#include "ramp.h"
+#include "static-memory.h"
+
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+// (2^(8p) - 1) / 255 sampled at p = 0, 1/16 ... 1 in Q16. Rising moves follow this
+// curve and falling moves its mirror, which is a geometric fade over a 256:1 range.
+static const uint32_t exponentialCurve[17] = {
+    0, 106, 257, 470, 771, 1197, 1799, 2651, 3855,
+    5558, 7967, 11374, 16191, 23004, 32639, 46266, 65536};
+
+static Ramp *ramps[RAMP_MAX_CHANNELS];
+static int rampCount = 0;
+static TimerHandle_t rampTimer = NULL;
+static StaticTimer rampTimerMemory;
+static bool rampTimerArmed = false;
+
+static uint32_t exponentialShape(uint32_t progress)
+{
+  uint32_t index = progress >> 12; // 16 segments
+  if (index >= 16)
+  {
+    return 65536;
+  }
+  uint32_t fraction = progress & 0xFFF;
+  uint32_t low = exponentialCurve[index];
+  uint32_t high = exponentialCurve[index + 1];
+  return low + (((high - low) * fraction) >> 12);
+}
+
+// Maps linear progress (Q16, 0-65536) onto the profile's curve (Q16)
+static uint32_t shapeProgress(RampProfile profile, uint32_t progress, bool rising)
+{
+  switch (profile)
+  {
+  case RAMP_EXPONENTIAL:
+    return rising ? exponentialShape(progress) : 65536 - exponentialShape(65536 - progress);
+  case RAMP_S_CURVE:
+  {
+    // Smoothstep: p^2 * (3 - 2p)
+    uint64_t squared = ((uint64_t)progress * progress) >> 16;
+    return (uint32_t)((squared * (3 * 65536 - 2 * progress)) >> 16);
+  }
+  case RAMP_LINEAR:
+  default:
+    return progress;
+  }
+}
+
+// Advances one ramp to `elapsedMs` into its move. Returns true while it is still in flight.
+static bool stepRamp(Ramp *ramp, uint32_t elapsedMs)
+{
+  if (elapsedMs >= ramp->durationMs)
+  {
+    ramp->current = ramp->target;
+    ramp->active = false;
+    return false;
+  }
+  uint32_t progress = (uint32_t)(((uint64_t)elapsedMs << 16) / ramp->durationMs);
+  bool rising = ramp->target > ramp->start;
+  uint32_t shaped = shapeProgress(ramp->profile, progress, rising);
+  int64_t delta = (int64_t)ramp->target - (int64_t)ramp->start;
+  ramp->current = (uint32_t)((int64_t)ramp->start + ((delta * shaped) >> 16));
+  return true;
+}
+
+// A start lost to a full timer command queue must not leave the flag set, or no
+// later move would arm the timer again and every ramp would stall
+static void rampTimerStartFailed()
+{
+  taskENTER_CRITICAL();
+  rampTimerArmed = false;
+  taskEXIT_CRITICAL();
+  printf("Failed to start ramp timer\n");
+}
+
+static void rampTimerCallback(TimerHandle_t xTimer)
+{
+  uint32_t levels[RAMP_MAX_CHANNELS];
+  bool changed[RAMP_MAX_CHANNELS];
+  bool anyActive = false;
+  TickType_t now = xTaskGetTickCount();
+
+  taskENTER_CRITICAL();
+  for (int i = 0; i < rampCount; i++)
+  {
+    Ramp *ramp = ramps[i];
+    changed[i] = ramp->active;
+    if (ramp->active)
+    {
+      anyActive |= stepRamp(ramp, pdTICKS_TO_MS(now - (TickType_t)ramp->startTick));
+    }
+    levels[i] = ramp->current;
+  }
+  // One-shot timer: only re-armed while something is still moving, so an idle
+  // bench costs no wake-ups at all
+  rampTimerArmed = anyActive;
+  taskEXIT_CRITICAL();
+
+  for (int i = 0; i < rampCount; i++)
+  {
+    if (changed[i] && ramps[i]->onStep != NULL)
+    {
+      ramps[i]->onStep(levels[i], ramps[i]->context);
+    }
+  }
+
+  // The timer service task must not block on its own command queue
+  if (anyActive && xTimerStart(rampTimer, 0) != pdPASS)
+  {
+    rampTimerStartFailed();
+  }
+}
+
+void initRamps()
+{
+  rampTimer = rampTimerMemory.create("RampTimer", pdMS_TO_TICKS(RAMP_TICK_MS), false, rampTimerCallback, "ramps");
+  if (rampTimer == NULL)
+  {
+    printf("Failed to create ramp timer\n");
+  }
+}
+
+bool rampInit(Ramp *ramp, uint32_t fullScale, RampProfile profile, uint32_t fullScaleMs, RampStepCallback onStep, void *context)
+{
+  if (rampCount >= RAMP_MAX_CHANNELS)
+  {
+    printf("Too many ramps, increase RAMP_MAX_CHANNELS\n");
+    return false;
+  }
+  ramp->fullScale = fullScale;
+  ramp->fullScaleMs = fullScaleMs;
+  ramp->profile = profile;
+  ramp->onStep = onStep;
+  ramp->context = context;
+  ramp->start = 0;
+  ramp->target = 0;
+  ramp->current = 0;
+  ramp->startTick = 0;
+  ramp->durationMs = 0;
+  ramp->active = false;
+
+  taskENTER_CRITICAL();
+  ramps[rampCount++] = ramp;
+  taskEXIT_CRITICAL();
+  return true;
+}
+
+void rampSetProfile(Ramp *ramp, RampProfile profile, uint32_t fullScaleMs)
+{
+  taskENTER_CRITICAL();
+  ramp->profile = profile;
+  ramp->fullScaleMs = fullScaleMs;
+  taskEXIT_CRITICAL();
+}
+
+void rampSetTarget(Ramp *ramp, uint32_t target)
+{
+  if (target > ramp->fullScale)
+  {
+    target = ramp->fullScale;
+  }
+
+  bool startTimer = false;
+  taskENTER_CRITICAL();
+  if (target != ramp->target)
+  {
+    // Retarget from wherever the ramp is now; the duration scales with the distance
+    // so every move has the same maximum slew rate
+    uint32_t distance = target > ramp->current ? target - ramp->current : ramp->current - target;
+    ramp->start = ramp->current;
+    ramp->target = target;
+    ramp->durationMs = (uint32_t)(((uint64_t)ramp->fullScaleMs * distance) / ramp->fullScale);
+    if (ramp->durationMs < RAMP_TICK_MS)
+    {
+      ramp->durationMs = RAMP_TICK_MS;
+    }
+    ramp->startTick = (uint32_t)xTaskGetTickCount();
+    ramp->active = distance > 0;
+  }
+  // Checked on every call, not just on a new target, so a ramp left in flight by a
+  // failed start picks up again the next time its owner sets the target
+  if (ramp->active && !rampTimerArmed)
+  {
+    rampTimerArmed = true;
+    startTimer = true;
+  }
+  taskEXIT_CRITICAL();
+
+  if (startTimer && xTimerStart(rampTimer, pdMS_TO_TICKS(RAMP_TICK_MS)) != pdPASS)
+  {
+    rampTimerStartFailed();
+  }
+}
+
+uint32_t rampCurrent(const Ramp *ramp)
+{
+  return ramp->current;
+}
+
+uint32_t rampTarget(const Ramp *ramp)
+{
+  return ramp->target;
+}
+
+bool rampIsActive(const Ramp *ramp)
+{
+  return ramp->active;
+}
@@ -0,0 +1,320 @@
+#include "transport.h"
+#include "control.h"
+#include "static-memory.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+
+#include "pico/cyw43_arch.h"
+
+#define RAW_TRANSPORT_SEND_SLOTS 4 // Lines in flight before the client acknowledges any
+#define RAW_TRANSPORT_POLL_MS 20   // How long a queued message can wait to be sent
+#define RAW_TRANSPORT_RECEIVE_SLOTS 4 // Lines received ahead of the server socket task
+
+// Raised by the lwIP callbacks, handled on the server socket task
+#define RAW_EVENT_CONNECTED (1 << 0)
+#define RAW_EVENT_DISCONNECTED (1 << 1)
+#define RAW_EVENT_SENT (1 << 2)
+#define RAW_EVENT_RECEIVED (1 << 3)
+
+static TaskHandle_t serveTask = NULL;
+static LineAssembler assembler;
+
+// Only touched with the lwIP lock held, or from its callbacks
+static struct tcp_pcb *clientPcb = NULL;
+
+// tcp_write() without TCP_WRITE_FLAG_COPY only references the data, so each line
+// stays in its slot until the client has acknowledged all of it. Slots are freed
+// in order from `sendHead` by the sent callback; only the server socket task
+// fills the slot after the last one in use, with the lwIP lock held.
+static char sendSlots[RAW_TRANSPORT_SEND_SLOTS][SOCKET_LINE_MAX];
+static char sendLine[SOCKET_LINE_MAX]; // The next line, serialised before a slot is taken
+static uint16_t sendLengths[RAW_TRANSPORT_SEND_SLOTS];
+static int sendHead = 0;
+static int sendCount = 0;
+static uint32_t sendAcked = 0; // Acknowledged bytes of the slot at sendHead
+
+// Parsing takes the JSON arena's mutex, which lwIP's thread must never wait on,
+// so received lines are copied here and parsed on the server socket task. The
+// receive callback only advances receiveHead and the task only receiveTail.
+static char receiveSlots[RAW_TRANSPORT_RECEIVE_SLOTS][SOCKET_LINE_MAX];
+static uint16_t receiveLengths[RAW_TRANSPORT_RECEIVE_SLOTS];
+static uint32_t receiveHead = 0;
+static uint32_t receiveTail = 0;
+static uint32_t receiveDropped = 0; // Lines the task fell too far behind to keep
+
+static void notifyServeTask(uint32_t event)
+{
+  if (serveTask != NULL)
+  {
+    xTaskNotify(serveTask, event, eSetBits);
+  }
+}
+
+// The assembler's callback on lwIP's thread
+static void queueReceivedLine(char *line, size_t length)
+{
+  uint32_t head = receiveHead;
+  if (head - __atomic_load_n(&receiveTail, __ATOMIC_ACQUIRE) >= RAW_TRANSPORT_RECEIVE_SLOTS)
+  {
+    __atomic_fetch_add(&receiveDropped, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  uint32_t slot = head % RAW_TRANSPORT_RECEIVE_SLOTS;
+  memcpy(receiveSlots[slot], line, length + 1);
+  receiveLengths[slot] = (uint16_t)length;
+  __atomic_store_n(&receiveHead, head + 1, __ATOMIC_RELEASE);
+  notifyServeTask(RAW_EVENT_RECEIVED);
+}
+
+static void rawInit()
+{
+  staticMemoryAccount("wifi", sizeof(assembler) + sizeof(sendSlots) + sizeof(sendLine) + sizeof(sendLengths) +
+                                  sizeof(receiveSlots) + sizeof(receiveLengths));
+  assembler.onLine = queueReceivedLine;
+}
+
+// Parses the lines queued by the receive callback
+static void handleReceivedLines()
+{
+  uint32_t dropped = __atomic_exchange_n(&receiveDropped, 0, __ATOMIC_RELAXED);
+  if (dropped > 0)
+  {
+    printf("Server: Dropped %lu received messages, too many waiting.\n", (unsigned long)dropped);
+  }
+  uint32_t tail = receiveTail;
+  while (tail != __atomic_load_n(&receiveHead, __ATOMIC_ACQUIRE))
+  {
+    uint32_t slot = tail % RAW_TRANSPORT_RECEIVE_SLOTS;
+    transportReceivedLine(receiveSlots[slot], receiveLengths[slot]);
+    tail++;
+    __atomic_store_n(&receiveTail, tail, __ATOMIC_RELEASE);
+  }
+}
+
+void rawTransportReceive(LineAssembler *lines, struct pbuf *chain)
+{
+  for (struct pbuf *segment = chain; segment != NULL; segment = segment->next)
+  {
+    lineAssemblerFeed(lines, (char *)segment->payload, segment->len);
+  }
+}
+
+static void detachClient(struct tcp_pcb *pcb)
+{
+  tcp_arg(pcb, NULL);
+  tcp_recv(pcb, NULL);
+  tcp_sent(pcb, NULL);
+  tcp_err(pcb, NULL);
+  clientPcb = NULL;
+  sendHead = 0;
+  sendCount = 0;
+  sendAcked = 0;
+}
+
+static err_t rawSent(void *arg, struct tcp_pcb *pcb, u16_t length)
+{
+  sendAcked += length;
+  while (sendCount > 0 && sendAcked >= sendLengths[sendHead])
+  {
+    sendAcked -= sendLengths[sendHead];
+    sendHead = (sendHead + 1) % RAW_TRANSPORT_SEND_SLOTS;
+    sendCount--;
+  }
+  notifyServeTask(RAW_EVENT_SENT);
+  return ERR_OK;
+}
+
+static err_t rawRecv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+  if (p == NULL)
+  {
+    printf("Server: Client disconnected.\n");
+    detachClient(pcb);
+    if (tcp_close(pcb) != ERR_OK)
+    {
+      tcp_abort(pcb);
+      notifyServeTask(RAW_EVENT_DISCONNECTED);
+      return ERR_ABRT;
+    }
+    notifyServeTask(RAW_EVENT_DISCONNECTED);
+    return ERR_OK;
+  }
+
+  rawTransportReceive(&assembler, p);
+  tcp_recved(pcb, p->tot_len);
+  pbuf_free(p);
+  return ERR_OK;
+}
+
+static void rawError(void *arg, err_t err)
+{
+  // lwIP has already freed the pcb
+  printf("Server: Connection lost (Error %d).\n", err);
+  clientPcb = NULL;
+  sendHead = 0;
+  sendCount = 0;
+  sendAcked = 0;
+  notifyServeTask(RAW_EVENT_DISCONNECTED);
+}
+
+static err_t rawAccept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+  if (err != ERR_OK || pcb == NULL)
+  {
+    return ERR_VAL;
+  }
+  // The newest connection wins: a compressor that restarted leaves its old one half open
+  if (clientPcb != NULL)
+  {
+    printf("Server: Replacing the previous client.\n");
+    struct tcp_pcb *previous = clientPcb;
+    detachClient(previous);
+    tcp_abort(previous);
+  }
+  printf("Server: Client connected.\n");
+
+  clientPcb = pcb;
+  lineAssemblerReset(&assembler);
+  tcp_nagle_disable(pcb); // Each line is a whole message, send it now
+  tcp_recv(pcb, rawRecv);
+  tcp_sent(pcb, rawSent);
+  tcp_err(pcb, rawError);
+  notifyServeTask(RAW_EVENT_CONNECTED);
+  return ERR_OK;
+}
+
+// Sends queued messages until the queue is empty or every slot is in flight
+static void sendQueuedMessages()
+{
+  Message message;
+  while (xQueuePeek(outgoingMessageQueue, &message, 0) == pdPASS)
+  {
+    cyw43_arch_lwip_begin();
+    bool ready = clientPcb != NULL && sendCount < RAW_TRANSPORT_SEND_SLOTS;
+    cyw43_arch_lwip_end();
+    if (!ready)
+    {
+      // Held for the next client, or until the client acknowledges a line
+      return;
+    }
+
+    // Serialised outside the lwIP lock, into a buffer no callback can reset
+    size_t length = messageToJson(message, sendLine, sizeof(sendLine));
+    if (length == 0)
+    {
+      printf("Server: Message longer than %d bytes, not sent.\n", SOCKET_LINE_MAX - 1);
+      xQueueReceive(outgoingMessageQueue, &message, 0);
+      continue;
+    }
+
+    // The client may have gone, or been replaced, since the check above, so the
+    // slot is only chosen now
+    cyw43_arch_lwip_begin();
+    ready = clientPcb != NULL && sendCount < RAW_TRANSPORT_SEND_SLOTS;
+    err_t err = ERR_OK;
+    if (ready)
+    {
+      int slot = (sendHead + sendCount) % RAW_TRANSPORT_SEND_SLOTS;
+      memcpy(sendSlots[slot], sendLine, length + 1);
+      err = tcp_write(clientPcb, sendSlots[slot], length, 0);
+      if (err == ERR_OK)
+      {
+        sendLengths[slot] = (uint16_t)length;
+        sendCount++;
+        tcp_output(clientPcb);
+      }
+    }
+    cyw43_arch_lwip_end();
+
+    if (!ready || err == ERR_MEM)
+    {
+      // Held for the next client, or until lwIP's send buffer has room again
+      return;
+    }
+    xQueueReceive(outgoingMessageQueue, &message, 0);
+    if (err == ERR_OK)
+    {
+      printf("Server: Sent message: %s\n", sendLine);
+    }
+    else
+    {
+      printf("Server: Failed to send message (Error %d).\n", err);
+    }
+  }
+}
+
+static void rawServe(uint16_t port)
+{
+  serveTask = xTaskGetCurrentTaskHandle();
+
+  cyw43_arch_lwip_begin();
+  struct tcp_pcb *listenPcb = NULL;
+  struct tcp_pcb *pcb = tcp_new();
+  if (pcb == NULL)
+  {
+    printf("Server: Failed to create pcb.\n");
+  }
+  else if (tcp_bind(pcb, IP_ADDR_ANY, port) != ERR_OK)
+  {
+    printf("Server: Bind failed.\n");
+    tcp_close(pcb);
+  }
+  else
+  {
+    listenPcb = tcp_listen_with_backlog(pcb, 1);
+    if (listenPcb == NULL)
+    {
+      printf("Server: Listen failed.\n");
+      tcp_close(pcb);
+    }
+    else
+    {
+      tcp_accept(listenPcb, rawAccept);
+    }
+  }
+  cyw43_arch_lwip_end();
+  if (listenPcb == NULL)
+  {
+    return;
+  }
+  printf("Server: Bound to port %d\n", port);
+  transportListening();
+
+  while (true)
+  {
+    uint32_t events = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(RAW_TRANSPORT_POLL_MS));
+    if (events & (RAW_EVENT_CONNECTED | RAW_EVENT_DISCONNECTED))
+    {
+      // Both can arrive between two waits, what counts is whether a client is there now
+      cyw43_arch_lwip_begin();
+      bool connected = clientPcb != NULL;
+      cyw43_arch_lwip_end();
+      if (connected && (events & RAW_EVENT_CONNECTED))
+      {
+        transportClientConnected();
+      }
+      else if (!connected)
+      {
+        transportClientDisconnected();
+        printf("Server: Connection closed. Waiting for new connection...\n");
+      }
+    }
+    handleReceivedLines();
+    sendQueuedMessages();
+  }
+}
+
+const Transport rawTransport = {
+    .name = "raw",
+    .init = rawInit,
+    .serve = rawServe,
+};
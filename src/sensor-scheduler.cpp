@@ -0,0 +1,108 @@
+#include "sensor-scheduler.h"
+
+#include <math.h>
+#include <stddef.h>
+
+// Deadlines wrap with the millisecond clock, compare them by difference
+static bool isDue(const SensorSource *source, uint32_t nowMs)
+{
+  return (int32_t)(nowMs - source->dueMs) >= 0;
+}
+
+static bool inTransient(const SensorSource *source)
+{
+  return source->transient != NULL && source->transient();
+}
+
+void sensorSchedulerInit(SensorScheduler *scheduler)
+{
+  scheduler->count = 0;
+}
+
+bool sensorSchedulerAdd(SensorScheduler *scheduler, SensorSource *source, uint32_t nowMs)
+{
+  if (scheduler->count >= SENSOR_SCHEDULER_MAX_SOURCES)
+  {
+    return false;
+  }
+  source->periodMs = source->minPeriodMs;
+  source->dueMs = nowMs;
+  source->hasValue = false;
+  scheduler->sources[scheduler->count++] = source;
+  return true;
+}
+
+// Works out the next period from a fresh reading
+static void adapt(SensorSource *source, float value)
+{
+  bool moved = !source->hasValue || fabsf(value - source->lastValue) >= source->threshold;
+  source->lastValue = value;
+  source->hasValue = true;
+  if (moved || inTransient(source))
+  {
+    source->periodMs = source->minPeriodMs;
+  }
+  else
+  {
+    uint32_t doubled = source->periodMs * 2;
+    source->periodMs = doubled < source->maxPeriodMs ? doubled : source->maxPeriodMs;
+  }
+}
+
+uint32_t sensorSchedulerRun(SensorScheduler *scheduler, uint32_t nowMs)
+{
+  uint32_t waitMs = UINT32_MAX;
+  for (int i = 0; i < scheduler->count; i++)
+  {
+    SensorSource *source = scheduler->sources[i];
+    if (isDue(source, nowMs))
+    {
+      float value = 0.0f;
+      uint32_t retryMs = 0;
+      switch (source->sample(&value, &retryMs))
+      {
+      case SENSOR_SAMPLED:
+        adapt(source, value);
+        source->dueMs = nowMs + (retryMs > 0 && retryMs < source->periodMs ? retryMs : source->periodMs);
+        break;
+      case SENSOR_PENDING:
+        source->dueMs = nowMs + retryMs;
+        break;
+      case SENSOR_FAILED:
+      default:
+        source->dueMs = nowMs + source->periodMs;
+        break;
+      }
+    }
+
+    uint32_t untilDue = isDue(source, nowMs) ? 0 : source->dueMs - nowMs;
+    if (untilDue < waitMs)
+    {
+      waitMs = untilDue;
+    }
+  }
+  return waitMs;
+}
+
+void sensorSchedulerWake(SensorSource *source, uint32_t nowMs)
+{
+  source->dueMs = nowMs;
+}
+
+void sensorSchedulerCheckTransients(SensorScheduler *scheduler, uint32_t nowMs)
+{
+  for (int i = 0; i < scheduler->count; i++)
+  {
+    SensorSource *source = scheduler->sources[i];
+    if (!inTransient(source))
+    {
+      continue;
+    }
+    source->periodMs = source->minPeriodMs;
+    uint32_t soonest = nowMs + source->minPeriodMs;
+    if ((int32_t)(source->dueMs - soonest) > 0)
+    {
+      source->dueMs = soonest;
+    }
+  }
+}
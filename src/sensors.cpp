@@ -3,6 +3,13 @@
 #include "control.h"
 #include "max44009.h"
 #include "sht30.h"
+#include "bme280.h"
+#include "settings.h"
+#include "lights.h"
+#include "auto-brightness.h"
+#include "boot-timeline.h"
+#include "extractor.h"
+#include "sensor-scheduler.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -14,20 +21,40 @@
 #include "task.h"
 #include "one_wire.h"
 
-volatile float lightsATemp = 0.0f;
-volatile float lightsBTemp = 0.0f;
-volatile float lightsCTemp = 0.0f;
-
-volatile float boothTemp = 0.0f;
-volatile float boothHumidity = 0.0f;
-volatile float boothLux = 0.0f;
+Snapshot<SensorReadings> sensorReadings;
+Snapshot<float> boothLux;
 
 One_wire lightsATempSensor(LIGHTS_A_TEMP_GPIO); // Internal sensor 1
 One_wire lightsBTempSensor(LIGHTS_B_TEMP_GPIO); // Internal sensor 2
 One_wire lightsCTempSensor(LIGHTS_C_TEMP_GPIO); // Internal sensor 3
 
+#define LIGHT_SENSOR_SETTLE_POLL_MS 250 // Only while waiting for the bars to stop fading
+#define LIGHT_SENSOR_FALLBACK_MS 60000  // Re-read this often anyway, in case an edge is missed
+#define LIGHT_SENSOR_POLL_MS 2000       // When INT is not wired, or cannot catch a change the loop acts on
+#define LIGHT_SENSOR_THRESHOLD_LUX 50.0f // Moves this size keep the sensor read at the fast rate
+#define LIGHT_SENSOR_WINDOW 0.05f      // Re-arm the threshold window up to ±5% around each reading
+#define LIGHT_SENSOR_WINDOW_MS 200     // Reading must stay outside the window this long
+#define LIGHT_SENSOR_SETTLE_MS 1000    // A full measurement cycle after the bars stop fading
+
+#define LIGHTS_TEMP_MIN_MS 1000     // While a bar is heating, cooling or fading
+#define LIGHTS_TEMP_MAX_MS 10000    // Steady bars
+#define LIGHTS_TEMP_THRESHOLD_C 0.25f
+#define BOOTH_MIN_MS 2000           // While the extractor changes speed or the booth air moves
+#define BOOTH_MAX_MS 30000          // Settled booth
+#define BOOTH_THRESHOLD_C 0.2f
+#define PRESSURE_MIN_MS 1000        // While the extractor changes speed
+#define PRESSURE_MAX_MS 30000       // Settled booth
+#define PRESSURE_THRESHOLD_PA 3.0f  // Well above the filtered noise at x4 oversampling
+
+// Sensor task notification bits
+#define SENSOR_NOTIFY_LIGHT (1 << 0)     // The MAX44009 left its threshold window
+#define SENSOR_NOTIFY_TRANSIENT (1 << 1) // A light or fan ramp started
+
 MAX44009 max44009(SENSOR_I2C_PORT, MAX44009_I2C_ADDR);
+static AutoBrightness autoBrightness;
+static TaskHandle_t sensorTaskHandle = NULL;
 SHT30 sht30(SENSOR_I2C_PORT, SHT30_I2C_ADDR);
+BME280 bme280(SENSOR_I2C_PORT, BME280_I2C_ADDR);
 
 void initSensors(void)
 {
@@ -36,80 +63,306 @@ void initSensors(void)
   gpio_set_function(SENSORS_I2C_SCL_GPIO, GPIO_FUNC_I2C);
   gpio_pull_up(SENSORS_I2C_SDA_GPIO); // Uncomment if needed
   gpio_pull_up(SENSORS_I2C_SCL_GPIO); // Uncomment if needed
-}
 
-float readLightsATemperature()
-{
-  rom_address_t address{};
-  lightsATempSensor.single_device_read_rom(address);
-  lightsATempSensor.convert_temperature(address, true, false);
-  return lightsATempSensor.temperature(address);
+  if (MAX44009_INT_GPIO >= 0)
+  {
+    gpio_init(MAX44009_INT_GPIO);
+    gpio_set_dir(MAX44009_INT_GPIO, GPIO_IN);
+    gpio_pull_up(MAX44009_INT_GPIO);
+    // Enabled here on the core that installed sharedISR, edges before the task starts are ignored
+    gpio_set_irq_enabled(MAX44009_INT_GPIO, GPIO_IRQ_EDGE_FALL, true);
+  }
 }
 
-float readLightsBTemperature()
-{
-  rom_address_t address{};
-  lightsBTempSensor.single_device_read_rom(address);
-  lightsBTempSensor.convert_temperature(address, true, false);
-  return lightsBTempSensor.temperature(address);
-}
+static rom_address_t lightsTempAddresses[LIGHTS_CHANNELS];
+static One_wire *lightsTempSensors[LIGHTS_CHANNELS] = {&lightsATempSensor, &lightsBTempSensor, &lightsCTempSensor};
+static bool lightsTempConverting = false;
+static uint32_t lightsTempReadyMs = 0;
+
+static SensorScheduler scheduler;
 
-float readLightsCTemperature()
+static uint32_t nowMs()
 {
-  rom_address_t address{};
-  lightsCTempSensor.single_device_read_rom(address);
-  lightsCTempSensor.convert_temperature(address, true, false);
-  return lightsCTempSensor.temperature(address);
+  return to_ms_since_boot(get_absolute_time());
 }
 
-void tempSensorTask(void *params)
+// The three buses convert at once, the readings are collected once they are done.
+// Nothing waits through the 750 ms conversion.
+static SensorSampleResult sampleLightsTemperature(float *value, uint32_t *retryMs)
 {
-  sht30.init();
-  lightsATempSensor.init();
-  lightsBTempSensor.init();
-  lightsCTempSensor.init();
-
-  while (1)
+  if (!lightsTempConverting)
   {
-    float localLightsATemp = readLightsATemperature();
-    float localLightsBTemp = readLightsBTemperature();
-    float localLightsCTemp = readLightsCTemperature();
-    if (localLightsATemp != -1000)
+    int conversionMs = 0;
+    for (int i = 0; i < LIGHTS_CHANNELS; i++)
     {
-      lightsATemp = localLightsATemp;
+      lightsTempSensors[i]->single_device_read_rom(lightsTempAddresses[i]);
+      int ms = lightsTempSensors[i]->convert_temperature(lightsTempAddresses[i], false, false);
+      if (ms > conversionMs)
+      {
+        conversionMs = ms;
+      }
     }
-    if (localLightsBTemp != -1000)
+    lightsTempConverting = true;
+    lightsTempReadyMs = nowMs() + conversionMs;
+    *retryMs = conversionMs;
+    return SENSOR_PENDING;
+  }
+  int32_t remaining = (int32_t)(lightsTempReadyMs - nowMs());
+  if (remaining > 0)
+  {
+    *retryMs = remaining;
+    return SENSOR_PENDING;
+  }
+  lightsTempConverting = false;
+
+  // This task is the only publisher, so its last copy is current
+  SensorReadings readings = sensorReadings.read();
+  bool any = false;
+  float hottest = 0.0f;
+  for (int i = 0; i < LIGHTS_CHANNELS; i++)
+  {
+    float temperature = lightsTempSensors[i]->temperature(lightsTempAddresses[i]);
+    if (temperature != -1000)
     {
-      lightsBTemp = localLightsBTemp;
+      readings.lightsTemp[i] = temperature;
+      hottest = !any || temperature > hottest ? temperature : hottest;
+      any = true;
     }
-    if (localLightsCTemp != -1000)
+  }
+  sensorReadings.publish(readings);
+  printf("Temperatures A: %.2f B: %.2f C: %.2f\n", readings.lightsTemp[0], readings.lightsTemp[1], readings.lightsTemp[2]);
+  if (!any)
+  {
+    return SENSOR_FAILED;
+  }
+  *value = hottest;
+  return SENSOR_SAMPLED;
+}
+
+static SensorSampleResult sampleBooth(float *value, uint32_t *retryMs)
+{
+  float boothTemp = 0.0f;
+  float boothHumidity = 0.0f;
+  if (!sht30.readAll(&boothTemp, &boothHumidity))
+  {
+    return SENSOR_FAILED;
+  }
+  SensorReadings readings = sensorReadings.read();
+  readings.boothTemp = boothTemp;
+  readings.boothHumidity = boothHumidity;
+  // One publish, so readers never pair a new temperature with an old humidity
+  sensorReadings.publish(readings);
+  printf("Temp: %.2f, Humidity: %.2f\n", readings.boothTemp, readings.boothHumidity);
+  // Humidity moves with the booth air too, the temperature is what is watched
+  *value = boothTemp;
+  return SENSOR_SAMPLED;
+}
+
+// Forced mode: each sample starts one conversion and the sensor sleeps between
+// them, so it measures on the scheduler's timeline rather than its own. The
+// extractor's buffeting is smoothed by the sensor's IIR filter, not here.
+static bool pressureMeasuring = false;
+static uint32_t pressureReadyMs = 0;
+
+static SensorSampleResult samplePressure(float *value, uint32_t *retryMs)
+{
+  if (!pressureMeasuring)
+  {
+    int measureMs = bme280.startMeasurement();
+    if (measureMs < 0)
     {
-      lightsCTemp = localLightsCTemp;
+      return SENSOR_FAILED;
     }
+    pressureMeasuring = true;
+    pressureReadyMs = nowMs() + measureMs;
+    *retryMs = measureMs;
+    return SENSOR_PENDING;
+  }
+  int32_t remaining = (int32_t)(pressureReadyMs - nowMs());
+  if (remaining > 0)
+  {
+    *retryMs = remaining;
+    return SENSOR_PENDING;
+  }
+  pressureMeasuring = false;
+
+  Bme280Reading reading;
+  if (!bme280.readMeasurement(&reading))
+  {
+    return SENSOR_FAILED;
+  }
+  SensorReadings readings = sensorReadings.read();
+  readings.boothPressure = reading.pressure / 100.0f;
+  sensorReadings.publish(readings);
+  printf("Pressure: %.2f\n", readings.boothPressure);
+  *value = (float)reading.pressure;
+  return SENSOR_SAMPLED;
+}
+
+// Readings taken mid-fade say nothing about the settled output, so the light
+// sensor is held off until a full measurement cycle after the bars stop
+static TickType_t lightsSettledAt = 0;
+static bool lightsSettling = false;
+
+static SensorSampleResult sampleLight(float *value, uint32_t *retryMs)
+{
+  TickType_t now = xTaskGetTickCount();
+  if (lightsRamping())
+  {
+    lightsSettling = true;
+    lightsSettledAt = now + pdMS_TO_TICKS(LIGHT_SENSOR_SETTLE_MS);
+  }
+  if (lightsSettling && (int32_t)(now - lightsSettledAt) < 0)
+  {
+    *retryMs = LIGHT_SENSOR_SETTLE_POLL_MS;
+    return SENSOR_PENDING;
+  }
+  // Always take one reading of the new output, even if it stayed inside the window
+  lightsSettling = false;
 
-    float localBoothTemp = 0.0f;
-    float localBoothHumidity = 0.0f;
+  // Reading the status releases INT, so the next crossing gives a fresh edge
+  if (MAX44009_INT_GPIO >= 0)
+  {
+    max44009.interruptPending();
+  }
+  float lux = max44009.readLux();
+  if (lux < 0)
+  {
+    return SENSOR_FAILED;
+  }
+  boothLux.publish(lux);
+  if (MAX44009_INT_GPIO < 0)
+  {
+    *retryMs = LIGHT_SENSOR_POLL_MS;
+  }
+  else if (max44009.setThresholdWindow(lux, LIGHT_SENSOR_WINDOW, LIGHT_SENSOR_WINDOW_MS) > AUTO_BRIGHTNESS_HYSTERESIS)
+  {
+    // The register steps left an edge outside the auto-brightness band, so a
+    // change the loop should act on might never raise INT
+    *retryMs = LIGHT_SENSOR_POLL_MS;
+  }
 
-    if (sht30.readAll(&localBoothTemp, &localBoothHumidity))
+  if (currentSettings.autoBrightness)
+  {
+    int brightness = autoBrightnessUpdate(&autoBrightness, lux, lightBrightness, (float)currentSettings.autoBrightnessLux);
+    if (brightness != lightTargetBrightness)
     {
-      boothTemp = localBoothTemp;
-      boothHumidity = localBoothHumidity;
+      // The fade that follows is a transient, so the result is read back once it settles
+      setLightTargetBrightness(brightness);
     }
+  }
+  *value = lux;
+  return SENSOR_SAMPLED;
+}
+
+static bool extractorTransient()
+{
+  return extractorRamping();
+}
+
+static bool lightsTransient()
+{
+  return lightsRamping();
+}
 
-    printf("Temperatures A: %.2f B: %.2f C: %.2f, Temp: %.2f, Humidity: %.2f\n", lightsATemp, lightsBTemp, lightsCTemp, boothTemp, boothHumidity);
+static SensorSource lightsTempSource = {
+    .name = "lights-temp",
+    .minPeriodMs = LIGHTS_TEMP_MIN_MS,
+    .maxPeriodMs = LIGHTS_TEMP_MAX_MS,
+    .threshold = LIGHTS_TEMP_THRESHOLD_C,
+    .sample = sampleLightsTemperature,
+    .transient = lightsTransient,
+};
+static SensorSource boothSource = {
+    .name = "booth",
+    .minPeriodMs = BOOTH_MIN_MS,
+    .maxPeriodMs = BOOTH_MAX_MS,
+    .threshold = BOOTH_THRESHOLD_C,
+    .sample = sampleBooth,
+    .transient = extractorTransient,
+};
+static SensorSource pressureSource = {
+    .name = "pressure",
+    .minPeriodMs = PRESSURE_MIN_MS,
+    .maxPeriodMs = PRESSURE_MAX_MS,
+    .threshold = PRESSURE_THRESHOLD_PA,
+    .sample = samplePressure,
+    .transient = extractorTransient,
+};
+// The light sensor mostly sleeps on its threshold window and is woken by INT,
+// its slowest period is only the fallback in case an edge is missed. Without
+// INT, sampleLight() asks to be polled instead.
+static SensorSource lightSource = {
+    .name = "light",
+    .minPeriodMs = LIGHT_SENSOR_SETTLE_POLL_MS,
+    .maxPeriodMs = LIGHT_SENSOR_FALLBACK_MS,
+    .threshold = LIGHT_SENSOR_THRESHOLD_LUX,
+    .sample = sampleLight,
+    .transient = lightsTransient,
+};
 
-    vTaskDelay(5000); // Delay
+// The MAX44009 pulls INT low once the reading has left the threshold window
+void handleLightSensorISR(uint gpio, uint32_t events)
+{
+  if (sensorTaskHandle == NULL || !(events & GPIO_IRQ_EDGE_FALL))
+  {
+    return;
   }
+  BaseType_t higherPriorityTaskWoken = pdFALSE;
+  xTaskNotifyFromISR(sensorTaskHandle, SENSOR_NOTIFY_LIGHT, eSetBits, &higherPriorityTaskWoken);
+  portYIELD_FROM_ISR(higherPriorityTaskWoken);
 }
 
-void lightSensorTask(void *params)
+void sensorsTransientStarted()
 {
+  if (sensorTaskHandle != NULL)
+  {
+    xTaskNotify(sensorTaskHandle, SENSOR_NOTIFY_TRANSIENT, eSetBits);
+  }
+}
+
+// Every sensor on one timeline of deadlines. Each is sampled at its fastest
+// rate while its readings move or a ramp is about to move them, and backs off
+// while they hold still, so an idle bench costs little bus traffic.
+void sensorTask(void *params)
+{
+  sensorTaskHandle = xTaskGetCurrentTaskHandle();
+  int step = bootStepBegin("temp-sensors");
+  sht30.init();
+  bool hasPressure = bme280.init();
+  lightsATempSensor.init();
+  lightsBTempSensor.init();
+  lightsCTempSensor.init();
+  bootStepEnd(step);
+
+  step = bootStepBegin("light-sensor");
   max44009.init();
-  while (1)
+  max44009.enableInterrupt(MAX44009_INT_GPIO >= 0);
+  bootStepEnd(step);
+  autoBrightnessInit(&autoBrightness);
+
+  sensorSchedulerInit(&scheduler);
+  sensorSchedulerAdd(&scheduler, &lightSource, nowMs());
+  sensorSchedulerAdd(&scheduler, &boothSource, nowMs());
+  sensorSchedulerAdd(&scheduler, &lightsTempSource, nowMs());
+  if (hasPressure)
   {
-    boothLux = max44009.readLux();
+    // Optional, boards without one run as before
+    sensorSchedulerAdd(&scheduler, &pressureSource, nowMs());
+  }
 
-    // printf("Lux: %.2f\n", boothLux);
-    vTaskDelay(500); // Delay
+  while (1)
+  {
+    uint32_t waitMs = sensorSchedulerRun(&scheduler, nowMs());
+    uint32_t events = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(waitMs < LIGHT_SENSOR_FALLBACK_MS ? waitMs : LIGHT_SENSOR_FALLBACK_MS));
+    if (events & SENSOR_NOTIFY_LIGHT)
+    {
+      sensorSchedulerWake(&lightSource, nowMs());
+    }
+    if (events & SENSOR_NOTIFY_TRANSIENT)
+    {
+      sensorSchedulerCheckTransients(&scheduler, nowMs());
+    }
   }
-}
\ No newline at end of file
+}
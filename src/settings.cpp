@@ -1,4 +1,8 @@
 #include "settings.h"
+#include "constants.h"
+#include "static-memory.h"
+#include "extractor.h"
+#include "lights.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -8,9 +12,12 @@
 #include "hardware/flash.h"
 #include "hardware/structs/xip_ctrl.h"
 #include "FreeRTOS.h"
-#include "timers.h"
+#include "task.h"
 #include "queue.h"
 
+// flash_range_program() works in whole pages, the tail past the settings stays erased
+#define SETTINGS_FLASH_BYTES ((sizeof(Settings) + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE)
+
 // Global settings variable
 volatile Settings currentSettings = {
     .ssid = "",
@@ -19,10 +26,27 @@ volatile Settings currentSettings = {
     .fanSpeed = 50,
     .lightBrightness = 50,
     .magic = SETTINGS_MAGIC,
+    .lightDerateStart = 45,
+    .lightDerateEnd = 65,
+    .lightCooling = 1,
+    .lightCoolingMagic = LIGHT_COOLING_MAGIC,
+    .autoBrightness = 0,
+    .autoBrightnessLux = (int)LUX_MEDIUM,
+    .autoBrightnessMagic = AUTO_BRIGHTNESS_MAGIC,
 };
 
 // Queue handle
 QueueHandle_t settingsQueue = NULL;
+static StaticQueue<SettingsCommandType, 5> settingsQueueMemory;
+
+// What the settings sector holds, so a burst that ends where it started costs no write
+static Settings storedSettings;
+static uint8_t flashPage[SETTINGS_FLASH_BYTES];
+
+// SettingsField bits changed since the last commit, and those being committed
+static volatile uint32_t dirtyFields = 0;
+static volatile uint32_t savingFields = 0;
+static volatile TickType_t lastChangeTick = 0;
 
 // Utility: Invalidate XIP Cache
 static void invalidateXipCache()
@@ -38,7 +62,7 @@ static void invalidateXipCache()
 // Flash erase helper
 static void callFlashRangeErase(void *param)
 {
-  uint32_t offset = (uint32_t)param;
+  uint32_t offset = (uint32_t)(uintptr_t)param;
   flash_range_erase(offset, FLASH_SECTOR_SIZE);
 }
 
@@ -47,13 +71,18 @@ static void callFlashRangeProgram(void *param)
 {
   uint32_t offset = ((uintptr_t *)param)[0];
   const uint8_t *data = (const uint8_t *)((uintptr_t *)param)[1];
-  flash_range_program(offset, data, FLASH_SECTOR_SIZE);
+  flash_range_program(offset, data, SETTINGS_FLASH_BYTES);
 }
 
 // Load settings from flash
 bool loadSettingsFromFlash(Settings *settings)
 {
-  const uint8_t *flashMemory = (const uint8_t *)(XIP_BASE + FLASH_TARGET_OFFSET);
+  return loadSettingsFromSector(FLASH_TARGET_OFFSET, settings);
+}
+
+bool loadSettingsFromSector(uint32_t offset, Settings *settings)
+{
+  const uint8_t *flashMemory = (const uint8_t *)(XIP_BASE + offset);
   const Settings *flashSettings = (const Settings *)flashMemory;
 
   printf("Reading settings from flash...\n");
@@ -69,112 +98,257 @@ bool loadSettingsFromFlash(Settings *settings)
   return false;
 }
 
-// Save settings to flash
-void saveSettingsToFlash(const Settings *settings)
+// Save settings to flash. Only called from the settings task, or before the
+// scheduler starts, as it shares the page buffer. Returns true once the sector
+// reads back as written.
+bool saveSettingsToFlash(const Settings *settings)
+{
+  return saveSettingsToSector(FLASH_TARGET_OFFSET, settings);
+}
+
+bool saveSettingsToSector(uint32_t offset, const Settings *settings)
 {
   printf("Saving settings to flash: SSID='%s', Auth Mode=%d\n", settings->ssid, settings->authMode);
 
   // Prepare buffer for writing
-  uint8_t buffer[sizeof(Settings)];
+  uint8_t *buffer = flashPage;
+  memset(buffer, 0xFF, SETTINGS_FLASH_BYTES);
   memcpy(buffer, settings, sizeof(Settings));
 
   // Safely erase flash
-  int rc = flash_safe_execute(callFlashRangeErase, (void *)FLASH_TARGET_OFFSET, UINT32_MAX);
+  int rc = flash_safe_execute(callFlashRangeErase, (void *)(uintptr_t)offset, UINT32_MAX);
   if (rc != PICO_OK)
   {
     printf("Error erasing flash sector: %d\n", rc);
-    return;
+    return false;
   }
 
   printf("Flash sector erased successfully.\n");
 
   // Safely write to flash
-  uintptr_t params[] = {FLASH_TARGET_OFFSET, (uintptr_t)buffer};
+  uintptr_t params[] = {offset, (uintptr_t)buffer};
   rc = flash_safe_execute(callFlashRangeProgram, params, UINT32_MAX);
   if (rc != PICO_OK)
   {
     printf("Error programming flash: %d\n", rc);
-    return;
+    return false;
   }
 
   printf("Settings saved successfully. Verifying...\n");
 
   // Verify the written data
-  const uint8_t *flashMemory = (const uint8_t *)(XIP_BASE + FLASH_TARGET_OFFSET);
+  const uint8_t *flashMemory = (const uint8_t *)(XIP_BASE + offset);
   if (memcmp(buffer, flashMemory, sizeof(Settings)) == 0)
   {
     printf("Settings verification successful.\n");
+    return true;
   }
-  else
-  {
-    printf("Settings verification failed.\n");
-  }
+  printf("Settings verification failed.\n");
+  return false;
 }
 
-// Reset settings in flash
-void resetSettings()
+// Settings with the credentials and connection cache cleared, keeping the rest
+static Settings defaultSettings()
 {
-  printf("Resetting settings in flash...\n");
-
-  // Default settings
-  Settings defaultSettings = {
+  Settings settings = (Settings){
       .ssid = "",
       .password = "",
       .authMode = 0,
       .fanSpeed = currentSettings.fanSpeed, // DO NOT RESET
       .lightBrightness = currentSettings.lightBrightness,
       .magic = SETTINGS_MAGIC,
+      .lightDerateStart = currentSettings.lightDerateStart,
+      .lightDerateEnd = currentSettings.lightDerateEnd,
+      .lightCooling = currentSettings.lightCooling,
+      .lightCoolingMagic = LIGHT_COOLING_MAGIC,
+      .autoBrightness = currentSettings.autoBrightness,
+      .autoBrightnessLux = currentSettings.autoBrightnessLux,
+      .autoBrightnessMagic = AUTO_BRIGHTNESS_MAGIC,
   };
+  // The fan calibration describes the hardware, not the user, so it stays too
+  memcpy(settings.fanRpmAtDuty, (const void *)currentSettings.fanRpmAtDuty, sizeof(settings.fanRpmAtDuty));
+  settings.fanCalibrationMagic = currentSettings.fanCalibrationMagic;
+  return settings;
+}
+
+// Reset settings in flash
+static void resetSettings()
+{
+  printf("Resetting settings in flash...\n");
+
+  Settings settings = defaultSettings();
+  taskENTER_CRITICAL();
+  // Anything changed before the reset goes with it
+  dirtyFields = 0;
+  memcpy((Settings *)&currentSettings, &settings, sizeof(Settings));
+  taskEXIT_CRITICAL();
 
-  saveSettingsToFlash(&defaultSettings);
+  if (saveSettingsToFlash(&settings))
+  {
+    storedSettings = settings;
+  }
+}
+
+// Gives each group past the magic that `settings` was written without the value
+// currentSettings starts with. Only valid before those defaults are overwritten.
+// Returns the SettingsField bits of the groups filled in.
+static uint32_t defaultMissingGroups(Settings *settings)
+{
+  uint32_t fields = 0;
+  if (settings->lightCoolingMagic != LIGHT_COOLING_MAGIC)
+  {
+    settings->lightDerateStart = currentSettings.lightDerateStart;
+    settings->lightDerateEnd = currentSettings.lightDerateEnd;
+    settings->lightCooling = currentSettings.lightCooling;
+    settings->lightCoolingMagic = LIGHT_COOLING_MAGIC;
+    fields |= SETTING_LIGHT_COOLING;
+  }
+  if (settings->autoBrightnessMagic != AUTO_BRIGHTNESS_MAGIC)
+  {
+    settings->autoBrightness = currentSettings.autoBrightness;
+    settings->autoBrightnessLux = currentSettings.autoBrightnessLux;
+    settings->autoBrightnessMagic = AUTO_BRIGHTNESS_MAGIC;
+    fields |= SETTING_AUTO_BRIGHTNESS;
+  }
+  return fields;
+}
+
+// Marks `fields` as changed and restarts the debounce window. A full queue
+// already holds a wake-up, and the bits say what changed, so nothing is lost.
+static void markDirty(uint32_t fields)
+{
+  __atomic_fetch_or(&dirtyFields, fields, __ATOMIC_RELEASE);
+  lastChangeTick = xTaskGetTickCount();
+  SettingsCommandType command = SETTINGS_CHANGED;
+  xQueueSend(settingsQueue, &command, 0);
 }
 
 // Initialize settings
 void initSettings()
 {
-  settingsQueue = xQueueCreate(10, sizeof(Settings));
-  Settings localSettingsCopy;
-  bool didLoad = true;
+  // Created first, loading defaults below already marks them for a commit
+  settingsQueue = settingsQueueMemory.create("settings");
+  if (settingsQueue == NULL)
+  {
+    printf("Failed to create settings queue.\n");
+  }
+  staticMemoryAccount("settings", sizeof(storedSettings) + sizeof(flashPage));
+
   // Attempt to load settings from flash
-  if (!loadSettingsFromFlash(&localSettingsCopy))
+  if (loadSettingsFromFlash(&storedSettings))
   {
-    printf("No valid settings found in flash. Loading defaults.\n");
+    // Copy loaded settings to the global `currentSettings`, with defaults for
+    // groups older firmware did not write, which then go out in one commit
+    Settings settings = storedSettings;
+    uint32_t missing = defaultMissingGroups(&settings);
+    memcpy((Settings *)&currentSettings, &settings, sizeof(Settings));
+    if (missing != 0)
+    {
+      printf("Settings from older firmware, defaulting fields 0x%02lx.\n", (unsigned long)missing);
+      markDirty(missing);
+    }
+    return;
+  }
 
-    // Load defaults if flash is empty or corrupted
-    localSettingsCopy = (Settings){
-        .ssid = "",
-        .password = "",
-        .authMode = 0,
-        .fanSpeed = currentSettings.fanSpeed, // DO NOT RESET
-        .lightBrightness = currentSettings.lightBrightness,
-        .magic = SETTINGS_MAGIC,
-    };
-    didLoad = false;
+  // Load defaults if flash is empty or corrupted, and write them out once the
+  // scheduler runs. storedSettings stays zeroed so the commit is not skipped.
+  printf("No valid settings found in flash. Loading defaults.\n");
+  Settings settings = defaultSettings();
+  memcpy((Settings *)&currentSettings, &settings, sizeof(Settings));
+  markDirty(SETTING_CREDENTIALS | SETTING_FAN_SPEED | SETTING_LIGHT_COOLING | SETTING_AUTO_BRIGHTNESS | SETTING_WIFI_CACHE);
+}
+
+void settingsSetCredentials(const char *ssid, const char *password, int authMode)
+{
+  taskENTER_CRITICAL();
+  bool changed = strncmp((const char *)currentSettings.ssid, ssid, sizeof(currentSettings.ssid) - 1) != 0 ||
+                 strncmp((const char *)currentSettings.password, password, sizeof(currentSettings.password) - 1) != 0 ||
+                 currentSettings.authMode != authMode;
+  if (changed)
+  {
+    strncpy((char *)currentSettings.ssid, ssid, sizeof(currentSettings.ssid) - 1);
+    currentSettings.ssid[sizeof(currentSettings.ssid) - 1] = '\0';
+    strncpy((char *)currentSettings.password, password, sizeof(currentSettings.password) - 1);
+    currentSettings.password[sizeof(currentSettings.password) - 1] = '\0';
+    currentSettings.authMode = authMode;
+  }
+  taskEXIT_CRITICAL();
+  if (changed)
+  {
+    markDirty(SETTING_CREDENTIALS);
   }
+}
 
-  // Copy loaded settings to the global `currentSettings`
-  memcpy((Settings *)&currentSettings, &localSettingsCopy, sizeof(Settings));
-  if (!didLoad)
+void settingsSetFanSpeed(int fanSpeed)
+{
+  if (currentSettings.fanSpeed != fanSpeed)
   {
-    requestSettingsUpdate();
+    currentSettings.fanSpeed = fanSpeed;
+    markDirty(SETTING_FAN_SPEED);
   }
-  // Create the settings queue
-  settingsQueue = xQueueCreate(5, sizeof(SettingsCommandType));
-  if (settingsQueue == NULL)
+}
+
+void settingsSetLightCooling(bool lightCooling)
+{
+  if ((currentSettings.lightCooling != 0) != lightCooling)
   {
-    printf("Failed to create settings queue.\n");
+    currentSettings.lightCooling = lightCooling ? 1 : 0;
+    markDirty(SETTING_LIGHT_COOLING);
   }
 }
 
-// Request settings validation
-void requestSettingsUpdate()
+void settingsSetAutoBrightness(bool autoBrightness, int autoBrightnessLux)
 {
-  SettingsCommandType command = SETTINGS_UPDATE;
+  taskENTER_CRITICAL();
+  bool changed = (currentSettings.autoBrightness != 0) != autoBrightness ||
+                 currentSettings.autoBrightnessLux != autoBrightnessLux;
+  if (changed)
+  {
+    currentSettings.autoBrightness = autoBrightness ? 1 : 0;
+    currentSettings.autoBrightnessLux = autoBrightnessLux;
+  }
+  taskEXIT_CRITICAL();
+  if (changed)
+  {
+    markDirty(SETTING_AUTO_BRIGHTNESS);
+  }
+}
 
-  if (xQueueSend(settingsQueue, &command, portMAX_DELAY) != pdPASS)
+void settingsSetWifiCache(const WifiConnectCache *cache)
+{
+  taskENTER_CRITICAL();
+  bool changed = memcmp(cache, (const void *)&currentSettings.wifiCache, sizeof(*cache)) != 0;
+  if (changed)
+  {
+    memcpy((void *)&currentSettings.wifiCache, cache, sizeof(*cache));
+  }
+  taskEXIT_CRITICAL();
+  if (changed)
+  {
+    markDirty(SETTING_WIFI_CACHE);
+  }
+}
+
+void settingsSetFanCalibration(const uint32_t rpmAtDuty[FAN_CALIBRATION_POINTS])
+{
+  taskENTER_CRITICAL();
+  bool changed = currentSettings.fanCalibrationMagic != FAN_CALIBRATION_MAGIC ||
+                 memcmp(rpmAtDuty, (const void *)currentSettings.fanRpmAtDuty, sizeof(currentSettings.fanRpmAtDuty)) != 0;
+  if (changed)
   {
-    printf("Settings validation request failed (queue full).\n");
+    memcpy((void *)currentSettings.fanRpmAtDuty, rpmAtDuty, sizeof(currentSettings.fanRpmAtDuty));
+    currentSettings.fanCalibrationMagic = FAN_CALIBRATION_MAGIC;
   }
+  taskEXIT_CRITICAL();
+  if (changed)
+  {
+    markDirty(SETTING_FAN_CALIBRATION);
+  }
+}
+
+uint32_t settingsDirty()
+{
+  return dirtyFields | savingFields;
 }
 
 // Request settings reset
@@ -187,35 +361,99 @@ void requestSettingsReset()
   }
 }
 
+// Writes everything marked so far as one commit. Fields marked while the flash
+// is busy stay dirty and go in the next one.
+static void commitSettings()
+{
+  Settings settings;
+  taskENTER_CRITICAL();
+  uint32_t fields = dirtyFields;
+  dirtyFields = 0;
+  savingFields = fields;
+  memcpy(&settings, (const void *)&currentSettings, sizeof(Settings));
+  taskEXIT_CRITICAL();
+
+  if (memcmp(&settings, &storedSettings, sizeof(Settings)) == 0)
+  {
+    printf("No settings change.\n");
+  }
+  else
+  {
+    printf("Committing settings change (fields 0x%02lx).\n", (unsigned long)fields);
+    if (saveSettingsToFlash(&settings))
+    {
+      storedSettings = settings;
+    }
+    else
+    {
+      // Try again after another debounce window
+      __atomic_fetch_or(&dirtyFields, fields, __ATOMIC_RELEASE);
+      lastChangeTick = xTaskGetTickCount();
+    }
+  }
+  savingFields = 0;
+}
+
+// The flash stall would freeze a fade or spin-up half way, so commits wait for
+// the ramps to settle
+static bool rampsInFlight()
+{
+  return lightsRamping() || extractorRamping();
+}
+
 // Settings task
 void settingsTask(void *params)
 {
   SettingsCommandType command;
+  TickType_t holdStart = 0;
+  bool holding = false;
 
   while (1)
   {
-    if (xQueueReceive(settingsQueue, &command, portMAX_DELAY))
+    TickType_t wait = portMAX_DELAY;
+    if (dirtyFields != 0)
     {
-      if (command == SETTINGS_UPDATE)
-      {
-        if (memcmp((const void *)&currentSettings, (const void *)&localSettingsCopy, sizeof(Settings)) != 0)
-        {
-          printf("Processing settings change.\n");
-          saveSettingsToFlash((const Settings *)&currentSettings);
-          memcpy(&localSettingsCopy, (const void *)&currentSettings, sizeof(Settings));
-        }
-        else
-        {
-          printf("No settings change.\n");
-        }
-      }
-      else if (command == SETTINGS_RESET)
+      TickType_t quiet = xTaskGetTickCount() - lastChangeTick;
+      TickType_t debounce = pdMS_TO_TICKS(SETTINGS_DEBOUNCE_MS);
+      wait = holding ? pdMS_TO_TICKS(SETTINGS_RAMP_POLL_MS) : quiet < debounce ? debounce - quiet : 0;
+    }
+
+    if (xQueueReceive(settingsQueue, &command, wait))
+    {
+      if (command == SETTINGS_RESET)
       {
         printf("Processing settings reset.\n");
         resetSettings();
-        memset((Settings *)&currentSettings, 0, sizeof(Settings));
-        currentSettings.magic = SETTINGS_MAGIC;
+        holding = false;
+      }
+      // SETTINGS_CHANGED only needs the wait above worked out again
+      continue;
+    }
+    if (dirtyFields == 0)
+    {
+      continue;
+    }
+    if (xTaskGetTickCount() - lastChangeTick < pdMS_TO_TICKS(SETTINGS_DEBOUNCE_MS))
+    {
+      // Changed again while holding for a ramp
+      holding = false;
+      continue;
+    }
+
+    if (rampsInFlight())
+    {
+      if (!holding)
+      {
+        holding = true;
+        holdStart = xTaskGetTickCount();
+      }
+      if (xTaskGetTickCount() - holdStart < pdMS_TO_TICKS(SETTINGS_MAX_HOLD_MS))
+      {
+        continue;
       }
+      printf("Ramps still moving after %d ms, committing settings anyway.\n", SETTINGS_MAX_HOLD_MS);
     }
+    holding = false;
+    commitSettings();
   }
 }
@@ -0,0 +1,158 @@
+#include "transport.h"
+#include "control.h"
+#include "static-memory.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "lwip/sockets.h"
+
+// Line being assembled from the compressor, and the line going back to it
+static LineAssembler assembler;
+static char readBuffer[SOCKET_LINE_MAX];
+static char sendLine[SOCKET_LINE_MAX];
+
+static void socketInit()
+{
+  staticMemoryAccount("wifi", sizeof(assembler) + sizeof(readBuffer) + sizeof(sendLine));
+  assembler.onLine = transportReceivedLine;
+}
+
+static void socketServe(uint16_t port)
+{
+  // Create the server socket.
+  int serverSocket = lwip_socket(AF_INET, SOCK_STREAM, 0);
+  if (serverSocket < 0)
+  {
+    printf("Server: Failed to create socket.\n");
+    return;
+  }
+
+  // Set up the server address structure.
+  struct sockaddr_in serverAddr;
+  memset(&serverAddr, 0, sizeof(serverAddr));
+  serverAddr.sin_family = AF_INET;
+  serverAddr.sin_port = htons(port);
+  serverAddr.sin_addr.s_addr = INADDR_ANY; // Listen on all interfaces
+
+  // Bind the socket.
+  if (lwip_bind(serverSocket, (struct sockaddr *)&serverAddr, sizeof(serverAddr)) < 0)
+  {
+    printf("Server: Bind failed.\n");
+    lwip_close(serverSocket);
+    return;
+  }
+  printf("Server: Bound to port %d\n", port);
+
+  // Listen for incoming connections.
+  if (lwip_listen(serverSocket, 1) < 0)
+  {
+    printf("Server: Listen failed.\n");
+    lwip_close(serverSocket);
+    return;
+  }
+  transportListening();
+  while (true)
+  {
+    struct sockaddr_in clientAddr;
+    socklen_t clientAddrLen = sizeof(clientAddr);
+    int clientSocket = lwip_accept(serverSocket, (struct sockaddr *)&clientAddr, &clientAddrLen);
+    if (clientSocket < 0)
+    {
+      printf("Server: Accept failed.\n");
+      vTaskDelay(pdMS_TO_TICKS(1000));
+      continue;
+    }
+    printf("Server: Client connected.\n");
+
+    // Set the client socket to non-blocking mode.
+    int flags = lwip_fcntl(clientSocket, F_GETFL, 0);
+    if (flags < 0)
+    {
+      printf("Server: Failed to get socket flags.\n");
+      lwip_close(clientSocket);
+      continue;
+    }
+    if (lwip_fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+      printf("Server: Failed to set socket non-blocking.\n");
+      lwip_close(clientSocket);
+      continue;
+    }
+
+    bool clientConnected = true;
+
+    lineAssemblerReset(&assembler);
+    transportClientConnected();
+
+    while (clientConnected)
+    {
+      int bytesRead = lwip_recv(clientSocket, readBuffer, sizeof(readBuffer), 0);
+      if (bytesRead > 0)
+      {
+        // Process complete messages delimited by newline.
+        lineAssemblerFeed(&assembler, readBuffer, (size_t)bytesRead);
+      }
+      else if (bytesRead == 0)
+      {
+        // The connection has been gracefully closed by the client.
+        printf("Server: Client disconnected (zero bytes received).\n");
+        clientConnected = false;
+        break;
+      }
+      else // bytesRead < 0
+      {
+        int err_val = errno;
+        // If errno is EWOULDBLOCK, EAGAIN, or even 0 (as a workaround), consider it as "no data available" and continue.
+        if (err_val == EWOULDBLOCK || err_val == EAGAIN || err_val == 0)
+        {
+          // No data available; do nothing and continue.
+        }
+        else
+        {
+          printf("Server: lwip_recv error: %d. Closing connection.\n", err_val);
+          clientConnected = false;
+          break;
+        }
+      }
+
+      // Process outgoing messages regardless of incoming data.
+      Message outgoingMsg;
+      while (xQueueReceive(outgoingMessageQueue, &outgoingMsg, 0) == pdPASS)
+      {
+        size_t length = messageToJson(outgoingMsg, sendLine, sizeof(sendLine));
+        if (length == 0)
+        {
+          printf("Server: Message longer than %d bytes, not sent.\n", SOCKET_LINE_MAX - 1);
+        }
+        else if (lwip_send(clientSocket, sendLine, length, 0) < 0)
+        {
+          printf("Server: Failed to send message: %s\n", sendLine);
+          clientConnected = false;
+          break;
+        }
+        else
+        {
+          printf("Server: Sent message: %s\n", sendLine);
+        }
+      }
+
+      // Yield to allow other tasks to run.
+      vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+    lwip_close(clientSocket);
+    transportClientDisconnected();
+    printf("Server: Connection closed. Waiting for new connection...\n");
+  }
+}
+
+const Transport socketTransport = {
+    .name = "socket",
+    .init = socketInit,
+    .serve = socketServe,
+};
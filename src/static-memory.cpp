@@ -0,0 +1,59 @@
+#include "static-memory.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define STATIC_MEMORY_MAX_SUBSYSTEMS 16
+
+typedef struct
+{
+  const char *subsystem;
+  size_t bytes;
+} StaticMemoryEntry;
+
+static StaticMemoryEntry entries[STATIC_MEMORY_MAX_SUBSYSTEMS];
+static int entryCount = 0;
+
+#if STATIC_MEMORY
+extern "C"
+{
+  volatile uint32_t heapAllocationCount = 0;
+  volatile uint32_t heapAllocationLastSize = 0;
+}
+#endif
+
+void staticMemoryAccount(const char *subsystem, size_t bytes)
+{
+  for (int i = 0; i < entryCount; i++)
+  {
+    if (strcmp(entries[i].subsystem, subsystem) == 0)
+    {
+      entries[i].bytes += bytes;
+      return;
+    }
+  }
+  if (entryCount >= STATIC_MEMORY_MAX_SUBSYSTEMS)
+  {
+    printf("Static memory: more than %d subsystems, increase STATIC_MEMORY_MAX_SUBSYSTEMS.\n", STATIC_MEMORY_MAX_SUBSYSTEMS);
+    return;
+  }
+  entries[entryCount].subsystem = subsystem;
+  entries[entryCount].bytes = bytes;
+  entryCount++;
+}
+
+void printStaticMemoryReport()
+{
+  size_t total = 0;
+  printf("Static RAM by subsystem:\n");
+  for (int i = 0; i < entryCount; i++)
+  {
+    printf("  %-12s %6u bytes\n", entries[i].subsystem, (unsigned)entries[i].bytes);
+    total += entries[i].bytes;
+  }
+  printf("  %-12s %6u bytes\n", "total", (unsigned)total);
+  printf("Heap free after init: %u of %u bytes\n", (unsigned)xPortGetFreeHeapSize(), (unsigned)configTOTAL_HEAP_SIZE);
+#if STATIC_MEMORY
+  printf("Heap allocations during init: %lu\n", (unsigned long)heapAllocationCount);
+#endif
+}
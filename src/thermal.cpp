@@ -0,0 +1,96 @@
+#include "thermal.h"
+
+#include <math.h>
+
+void thermalInit(ThermalChannel *channel, const ThermalCurve *curve)
+{
+  channel->curve = *curve;
+  channel->estimatedC = THERMAL_DEFAULT_AMBIENT_C;
+  channel->predictedC = THERMAL_DEFAULT_AMBIENT_C;
+  channel->limitPercent = 100;
+  channel->tripped = false;
+  channel->initialised = false;
+}
+
+uint8_t thermalDerate(const ThermalCurve *curve, float temperatureC)
+{
+  if (temperatureC <= curve->startC)
+  {
+    return 100;
+  }
+  if (temperatureC >= curve->endC + THERMAL_CUTOFF_MARGIN_C)
+  {
+    return 0;
+  }
+  if (temperatureC >= curve->endC || curve->endC <= curve->startC)
+  {
+    return curve->minPercent;
+  }
+  float fraction = (temperatureC - curve->startC) / (float)(curve->endC - curve->startC);
+  return (uint8_t)(100.0f - fraction * (100 - curve->minPercent) + 0.5f);
+}
+
+uint8_t thermalUpdate(ThermalChannel *channel, float measuredC, bool measurementValid, float ambientC, uint8_t dutyPercent, uint32_t elapsedMs)
+{
+  if (!channel->initialised)
+  {
+    if (!measurementValid)
+    {
+      // Nothing to anchor the model to yet, leave the bar alone
+      return channel->limitPercent;
+    }
+    channel->estimatedC = measuredC;
+    channel->initialised = true;
+  }
+
+  // First-order model: the bar heads for ambient + rise * duty with time constant tau
+  float steadyC = ambientC + THERMAL_RISE_AT_FULL_C * dutyPercent / 100.0f;
+  float dt = elapsedMs / 1000.0f;
+  channel->estimatedC += (steadyC - channel->estimatedC) * (dt / THERMAL_TAU_S);
+  if (measurementValid)
+  {
+    channel->estimatedC += (measuredC - channel->estimatedC) * THERMAL_OBSERVER_GAIN;
+  }
+
+  // Where the bar will be after the horizon if nothing changes. The sensor lags the
+  // LEDs, so derating on the prediction backs off before the reading catches up.
+  float approach = 1.0f - expf(-THERMAL_HORIZON_S / THERMAL_TAU_S);
+  channel->predictedC = channel->estimatedC + (steadyC - channel->estimatedC) * approach;
+
+  float worstC = channel->predictedC > channel->estimatedC ? channel->predictedC : channel->estimatedC;
+  if (measurementValid && measuredC > worstC)
+  {
+    worstC = measuredC;
+  }
+
+  if (worstC >= channel->curve.endC + THERMAL_CUTOFF_MARGIN_C)
+  {
+    channel->tripped = true;
+  }
+  else if (channel->tripped && worstC < channel->curve.endC)
+  {
+    channel->tripped = false;
+  }
+
+  channel->limitPercent = channel->tripped ? 0 : thermalDerate(&channel->curve, worstC);
+  return channel->limitPercent;
+}
+
+uint8_t thermalCoolingDemand(const ThermalChannel *channel)
+{
+  if (!channel->initialised)
+  {
+    return 0;
+  }
+  float worstC = channel->predictedC > channel->estimatedC ? channel->predictedC : channel->estimatedC;
+  float assistStartC = (float)(channel->curve.startC - THERMAL_ASSIST_LEAD_C);
+  if (worstC <= assistStartC)
+  {
+    return 0;
+  }
+  if (worstC >= channel->curve.endC)
+  {
+    return 100;
+  }
+  return (uint8_t)(((worstC - assistStartC) * 100.0f) / (channel->curve.endC - assistStartC));
+}
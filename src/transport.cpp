@@ -0,0 +1,61 @@
+#include "transport.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void lineAssemblerReset(LineAssembler *assembler)
+{
+  assembler->length = 0;
+  assembler->overflowed = false;
+}
+
+void lineAssemblerFeed(LineAssembler *assembler, char *data, size_t length)
+{
+  while (length > 0)
+  {
+    char *newline = (char *)memchr(data, '\n', length);
+    size_t chunk = newline ? (size_t)(newline - data) : length;
+    if (newline && assembler->length == 0 && !assembler->overflowed)
+    {
+      // The whole line is in this read, parse it where it is
+      if (chunk < sizeof(assembler->line))
+      {
+        *newline = '\0';
+        assembler->onLine(data, chunk);
+      }
+      else
+      {
+        printf("Server: Dropped a message longer than %d bytes.\n", SOCKET_LINE_MAX - 1);
+      }
+    }
+    else
+    {
+      if (!assembler->overflowed && assembler->length + chunk < sizeof(assembler->line))
+      {
+        memcpy(assembler->line + assembler->length, data, chunk);
+        assembler->length += chunk;
+      }
+      else
+      {
+        assembler->overflowed = true;
+      }
+      if (!newline)
+      {
+        return;
+      }
+
+      if (assembler->overflowed)
+      {
+        printf("Server: Dropped a message longer than %d bytes.\n", SOCKET_LINE_MAX - 1);
+      }
+      else
+      {
+        assembler->line[assembler->length] = '\0';
+        assembler->onLine(assembler->line, assembler->length);
+      }
+      lineAssemblerReset(assembler);
+    }
+    data += chunk + 1;
+    length -= chunk + 1;
+  }
+}
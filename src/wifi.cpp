@@ -4,9 +4,12 @@
 #include "httpserver.h"
 #include "settings.h"
 #include "control.h"
+#include "static-memory.h"
+#include "boot-timeline.h"
+#include "transport.h"
+#include "discovery.h"
 
 #include <cstdio>
-#include <string>
 #include <cstring>
 
 #include "FreeRTOS.h"
@@ -16,6 +19,7 @@
 
 #include "lwip/apps/httpd.h"
 #include "lwip/apps/mdns.h"
+#include "lwip/dhcp.h"
 #include "lwip/netif.h"
 #include "lwip/err.h"
 #include "lwip/sockets.h"
@@ -30,6 +34,22 @@
 #define SOCKET_SERVER_FAILED_BIT (1 << 4)
 
 EventGroupHandle_t eventGroup;
+static StaticEventGroup_t eventGroupMemory;
+static StaticQueue<Message, 5> incomingQueueMemory;
+static StaticQueue<Message, 5> outgoingQueueMemory;
+
+// Both tasks run for the whole session and wait for a notification to start, so
+// their static stacks are never handed back and recreated
+static StaticTask<4096> serverSocketTaskMemory;
+static StaticTask<1024> credentialsTaskMemory;
+static TaskHandle_t serverSocketTaskHandle = NULL;
+static TaskHandle_t credentialsTaskHandle = NULL;
+
+#if RAW_TRANSPORT
+static const Transport &transport = rawTransport;
+#else
+static const Transport &transport = socketTransport;
+#endif
 
 WifiScanResult topScanResults[MAX_SCAN_RESULTS];
 int scanResultCount = 0;
@@ -44,16 +64,14 @@ volatile bool isSocketActive = false;
 volatile bool isConnectedToSocketServer = false;
 
 QueueHandle_t outgoingMessageQueue = NULL;
-static int serverSocket = -1;
 volatile static int socketRetryDelay = 5000;
 volatile static int wifiRetryDelay = 1000;
 volatile bool isFlashing = false;
 
-volatile bool mdnsAp = false;
-volatile bool mdnsSta = false;
-
-static s8_t mdnsServiceHandleSta = -1;
-static s8_t mdnsServiceHandleAp = -1;
+// When this boot last got a lease, so a cached one known to have run out is not
+// offered again. Across a power cycle the age is unknown and the server decides.
+static TickType_t leaseAcquiredTick = 0;
+static bool leaseAcquiredThisBoot = false;
 
 volatile NetworkStatus networkStatus = NetworkStatus::STARTUP;
 
@@ -66,141 +84,6 @@ void printSettings(const volatile Settings *settings)
          settings->magic);
 }
 
-// Minimal TXT callback that does nothing.
-void srv_txt(struct mdns_service *service, void *txt_userdata)
-{
-  (void)service;
-  (void)txt_userdata;
-  // No TXT records to add.
-}
-
-void deinitMdnsSta()
-{
-  if (!mdnsSta)
-  {
-    return;
-  }
-  struct netif *sta_netif = &cyw43_state.netif[CYW43_ITF_STA];
-  cyw43_arch_lwip_begin();
-  // If you have a valid service handle, explicitly delete the service:
-  if (mdnsServiceHandleSta >= 0)
-  {
-    mdns_resp_del_service(sta_netif, mdnsServiceHandleSta);
-    mdnsServiceHandleSta = -1;
-  }
-  // Now remove the netif from the mDNS responder.
-  mdns_resp_remove_netif(sta_netif);
-  printf("mDNS on STA netif removed.\n");
-  cyw43_arch_lwip_end();
-  mdnsSta = false;
-}
-
-void initMdnsSta()
-{
-  if (mdnsSta)
-  {
-    return;
-  }
-  // Get a pointer to the STA network interface.
-  struct netif *sta_netif = &cyw43_state.netif[CYW43_ITF_STA];
-  if (!sta_netif)
-  {
-    printf("STA netif is null.\n");
-    return;
-  }
-
-  // Set the hostname using the provided API.
-  netif_set_hostname(sta_netif, MDNS_DOMAIN);
-
-  // Begin lwIP critical section.
-  cyw43_arch_lwip_begin();
-
-  // Add the network interface with the hostname.
-  mdns_resp_add_netif(sta_netif, netif_get_hostname(sta_netif));
-
-  // Advertise a service.
-  // Here, we advertise a service instance "ControlPico" of type "_control" on TCP port 12345.
-  mdnsServiceHandleSta = mdns_resp_add_service(sta_netif, MDNS_NAME, MDNS_SERVICE, DNSSD_PROTO_TCP, 12345, srv_txt, NULL);
-  if (mdnsServiceHandleSta != 0)
-  {
-    printf("mDNS add service failed for STA: %d\n", mdnsServiceHandleSta);
-    cyw43_arch_lwip_end();
-    return;
-  }
-
-  // Announce the service.
-  mdns_resp_announce(sta_netif);
-  printf("mDNS for STA initialized and service advertised.\n");
-
-  // End lwIP critical section.
-  cyw43_arch_lwip_end();
-  mdnsSta = true;
-}
-
-void deinitMdnsAp()
-{
-  if (!mdnsAp)
-  {
-    return;
-  }
-  struct netif *sta_netif = &cyw43_state.netif[CYW43_ITF_AP];
-  cyw43_arch_lwip_begin();
-  // If you have a valid service handle, explicitly delete the service:
-  if (mdnsServiceHandleAp >= 0)
-  {
-    mdns_resp_del_service(sta_netif, mdnsServiceHandleAp);
-    mdnsServiceHandleAp = -1;
-  }
-  // Now remove the netif from the mDNS responder.
-  mdns_resp_remove_netif(sta_netif);
-  printf("mDNS on AP netif removed.\n");
-  cyw43_arch_lwip_end();
-  mdnsAp = false;
-}
-
-// Helper function to initialize and advertise mDNS for AP mode.
-void initMdnsAp()
-{
-  if (mdnsAp)
-  {
-    return;
-  }
-  // Get a pointer to the AP network interface.
-  struct netif *ap_netif = &cyw43_state.netif[CYW43_ITF_AP];
-  if (!ap_netif)
-  {
-    printf("AP netif is null.\n");
-    return;
-  }
-
-  // Set the hostname using the provided API.
-  netif_set_hostname(ap_netif, MDNS_DOMAIN);
-
-  // Begin lwIP critical section.
-  cyw43_arch_lwip_begin();
-
-  // Add the network interface with the hostname.
-  mdns_resp_add_netif(ap_netif, netif_get_hostname(ap_netif));
-
-  // Advertise a service.
-  // Here, we advertise a service instance "ControlPico" of type "_control" on TCP port 12345.
-  s8_t err = mdns_resp_add_service(ap_netif, MDNS_NAME, MDNS_SERVICE, DNSSD_PROTO_TCP, 12345, srv_txt, NULL);
-  if (err != 0)
-  {
-    printf("mDNS add service failed for AP: %d\n", err);
-    cyw43_arch_lwip_end();
-    return;
-  }
-
-  // Announce the service.
-  mdns_resp_announce(ap_netif);
-  printf("mDNS for AP initialized and service advertised.\n");
-
-  // End lwIP critical section.
-  cyw43_arch_lwip_end();
-  mdnsAp = true;
-}
-
 // Sort scan results by RSSI in descending order
 void sortScanResultsByRSSI()
 {
@@ -388,6 +271,123 @@ void initArch()
   }
 }
 
+static bool hasConnectionCache(const char *ssid)
+{
+  const volatile WifiConnectCache &cache = currentSettings.wifiCache;
+  return cache.magic == WIFI_CACHE_MAGIC && cache.channel != 0 &&
+         strncmp((const char *)cache.ssid, ssid, sizeof(cache.ssid)) == 0;
+}
+
+// Puts the station's DHCP client in INIT-REBOOT with the cached address, so when
+// the link comes up it asks for that address straight away instead of running
+// DISCOVER/OFFER. A NAK or no answer drops lwIP back to DISCOVER on its own.
+static void seedDhcpLease(uint32_t ipAddress, uint32_t leaseSeconds)
+{
+  if (ipAddress == 0)
+  {
+    return;
+  }
+  if (leaseAcquiredThisBoot && leaseSeconds > 0 &&
+      (xTaskGetTickCount() - leaseAcquiredTick) / configTICK_RATE_HZ >= leaseSeconds)
+  {
+    printf("Cached DHCP lease has expired, requesting a new one.\n");
+    return;
+  }
+  struct netif *staNetif = &cyw43_state.netif[CYW43_ITF_STA];
+  cyw43_arch_lwip_begin();
+  struct dhcp *dhcp = netif_dhcp_data(staNetif);
+  if (dhcp != NULL && !netif_is_link_up(staNetif))
+  {
+    ip4_addr_set_u32(&dhcp->offered_ip_addr, ipAddress);
+    dhcp->state = DHCP_STATE_REBOOTING;
+  }
+  cyw43_arch_lwip_end();
+}
+
+// Joins the cached access point on its cached channel, skipping the scan the
+// normal join starts with. Gives up after WIFI_FAST_CONNECT_TIMEOUT_MS.
+static bool fastConnectToWiFi(const char *ssid, const char *password, int auth_mode)
+{
+  WifiConnectCache cache;
+  memcpy(&cache, (const void *)&currentSettings.wifiCache, sizeof(cache));
+  printf("Joining %02x:%02x:%02x:%02x:%02x:%02x on channel %u directly.\n",
+         cache.bssid[0], cache.bssid[1], cache.bssid[2], cache.bssid[3], cache.bssid[4], cache.bssid[5], cache.channel);
+
+  seedDhcpLease(cache.ipAddress, cache.leaseSeconds);
+
+  uint32_t auth = mapAuthMode(auth_mode);
+  size_t passwordLength = auth == CYW43_AUTH_OPEN ? 0 : strlen(password);
+  int result = cyw43_wifi_join(&cyw43_state, strlen(ssid), (const uint8_t *)ssid, passwordLength,
+                               (const uint8_t *)password, auth, cache.bssid, cache.channel);
+  if (result != 0)
+  {
+    printf("Direct join failed to start (Error %d).\n", result);
+    return false;
+  }
+
+  TickType_t start = xTaskGetTickCount();
+  while (xTaskGetTickCount() - start < pdMS_TO_TICKS(WIFI_FAST_CONNECT_TIMEOUT_MS))
+  {
+    int status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+    if (status == CYW43_LINK_UP)
+    {
+      printf("Direct join took %lu ms.\n", (unsigned long)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS));
+      return true;
+    }
+    if (status < 0)
+    {
+      printf("Direct join failed (Status %d).\n", status);
+      break;
+    }
+    vTaskDelay(pdMS_TO_TICKS(20));
+  }
+  cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+  return false;
+}
+
+// Records where this join landed. Only queues a flash write when something moved,
+// which for a bench that stays put is the first join after new credentials.
+static void saveConnectionCache(const char *ssid)
+{
+  WifiConnectCache cache = {};
+  strncpy(cache.ssid, ssid, sizeof(cache.ssid) - 1);
+  if (cyw43_wifi_get_bssid(&cyw43_state, cache.bssid) != 0)
+  {
+    return;
+  }
+  uint32_t channelInfo[3] = {0}; // hw_channel, target_channel, scan_channel
+  if (cyw43_ioctl(&cyw43_state, CYW43_IOCTL_GET_CHANNEL, sizeof(channelInfo), (uint8_t *)channelInfo, CYW43_ITF_STA) != 0)
+  {
+    return;
+  }
+  cache.channel = (uint8_t)channelInfo[0];
+
+  struct netif *staNetif = &cyw43_state.netif[CYW43_ITF_STA];
+  cyw43_arch_lwip_begin();
+  cache.ipAddress = ip4_addr_get_u32(netif_ip4_addr(staNetif));
+  struct dhcp *dhcp = netif_dhcp_data(staNetif);
+  if (dhcp != NULL && dhcp_supplied_address(staNetif))
+  {
+    cache.leaseSeconds = dhcp->offered_t0_lease;
+  }
+  cyw43_arch_lwip_end();
+  cache.magic = WIFI_CACHE_MAGIC;
+
+  leaseAcquiredTick = xTaskGetTickCount();
+  leaseAcquiredThisBoot = true;
+
+  settingsSetWifiCache(&cache);
+}
+
+static void reportConnected()
+{
+  isConnectedToWifi = true;
+  isTestingConnection = false;
+  auto ip_addr = cyw43_state.netif[CYW43_ITF_STA].ip_addr.addr;
+  printf("Pico W IP Address: %lu.%lu.%lu.%lu\n", ip_addr & 0xFF, (ip_addr >> 8) & 0xFF, (ip_addr >> 16) & 0xFF, ip_addr >> 24);
+  initMdnsSta();
+}
+
 bool connectToWiFi(const char *ssid, const char *password, int auth_mode)
 {
   printf("Using credentials SSID: %s Password: %s Auth Mode: %d\n", ssid, password, auth_mode);
@@ -395,6 +395,19 @@ bool connectToWiFi(const char *ssid, const char *password, int auth_mode)
   if (!isTestingConnection && !isConnectedToWifi)
   {
     isTestingConnection = true;
+
+    if (hasConnectionCache(ssid))
+    {
+      if (fastConnectToWiFi(ssid, password, auth_mode))
+      {
+        printf("Successfully connected to Wi-Fi.\n");
+        reportConnected();
+        saveConnectionCache(ssid);
+        return true;
+      }
+      printf("Direct join did not connect, falling back to a full scan.\n");
+    }
+
     const int timeoutMs = 30000; // Increased timeout
     const int retryDelayMs = 2000;
 
@@ -407,11 +420,8 @@ bool connectToWiFi(const char *ssid, const char *password, int auth_mode)
       if (result == 0)
       {
         printf("Successfully connected to Wi-Fi.\n");
-        isConnectedToWifi = true;
-        isTestingConnection = false;
-        auto ip_addr = cyw43_state.netif[CYW43_ITF_STA].ip_addr.addr;
-        printf("Pico W IP Address: %lu.%lu.%lu.%lu\n", ip_addr & 0xFF, (ip_addr >> 8) & 0xFF, (ip_addr >> 16) & 0xFF, ip_addr >> 24);
-        initMdnsSta();
+        reportConnected();
+        saveConnectionCache(ssid);
         return true;
       }
       else
@@ -461,7 +471,7 @@ bool connectToWifiWithCredentials()
   return connectToWiFi((const char *)currentSettings.ssid, (const char *)currentSettings.password, currentSettings.authMode);
 }
 
-bool sendMessage(const std::string &message)
+bool sendMessage(const Message &message)
 {
   if (outgoingMessageQueue == NULL)
   {
@@ -471,12 +481,12 @@ bool sendMessage(const std::string &message)
 
   if (xQueueSend(outgoingMessageQueue, &message, pdMS_TO_TICKS(100)) == pdPASS)
   {
-    printf("Message queued: %s\n", message.c_str());
+    printf("Message queued.\n");
     return true;
   }
   else
   {
-    printf("Failed to queue message: %s\n", message.c_str());
+    printf("Failed to queue message.\n");
     return false;
   }
 }
@@ -491,7 +501,7 @@ void initSocket()
       ;
     while (xQueueReceive(outgoingMessageQueue, &msg, 0) == pdTRUE)
       ;
-    xTaskCreate(serverSocketTask, "ServerSocketTask", 4096, NULL, tskIDLE_PRIORITY + 1, NULL);
+    xTaskNotifyGive(serverSocketTaskHandle);
     isSocketActive = true;
   }
 }
@@ -566,189 +576,80 @@ void deInitSTAMode()
   }
 }
 
+// Woken each time the access point comes up, then waits for the HTTP server to
+// store credentials
 void credentialsTask(void *params)
 {
   while (true)
   {
-    if (hasCredentials())
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while (!hasCredentials())
     {
-      xEventGroupSetBits(eventGroup, CONFIGURED_BIT);
-      vTaskDelete(NULL);
+      vTaskDelay(pdMS_TO_TICKS(100));
     }
-    vTaskDelay(pdMS_TO_TICKS(100));
+    xEventGroupSetBits(eventGroup, CONFIGURED_BIT);
   }
 }
 
-void serverSocketTask(void *params)
+void transportListening()
 {
-  // Create the server socket.
-  serverSocket = lwip_socket(AF_INET, SOCK_STREAM, 0);
-  if (serverSocket < 0)
-  {
-    printf("Server: Failed to create socket.\n");
-    xEventGroupSetBits(eventGroup, SOCKET_SERVER_FAILED_BIT);
-    vTaskDelete(NULL);
-    return;
-  }
-
-  // Set up the server address structure.
-  struct sockaddr_in serverAddr;
-  memset(&serverAddr, 0, sizeof(serverAddr));
-  serverAddr.sin_family = AF_INET;
-  serverAddr.sin_port = htons(SOCKET_SERVER_PORT);
-  serverAddr.sin_addr.s_addr = INADDR_ANY; // Listen on all interfaces
-
-  // Bind the socket.
-  if (lwip_bind(serverSocket, (struct sockaddr *)&serverAddr, sizeof(serverAddr)) < 0)
-  {
-    printf("Server: Bind failed.\n");
-    lwip_close(serverSocket);
-    serverSocket = -1;
-    xEventGroupSetBits(eventGroup, SOCKET_SERVER_FAILED_BIT);
-    vTaskDelete(NULL);
-    return;
-  }
-  printf("Server: Bound to port %d\n", SOCKET_SERVER_PORT);
-
-  // Listen for incoming connections.
-  if (lwip_listen(serverSocket, 1) < 0)
-  {
-    printf("Server: Listen failed.\n");
-    lwip_close(serverSocket);
-    serverSocket = -1;
-    xEventGroupSetBits(eventGroup, SOCKET_SERVER_FAILED_BIT);
-    vTaskDelete(NULL);
-    return;
-  }
-  printf("Server: Listening for connections...\n");
+  printf("Server: Listening for connections over the %s transport...\n", transport.name);
   networkStatus = NetworkStatus::SOCKET_RUNNING;
-  while (true)
-  {
-    struct sockaddr_in clientAddr;
-    socklen_t clientAddrLen = sizeof(clientAddr);
-    int clientSocket = lwip_accept(serverSocket, (struct sockaddr *)&clientAddr, &clientAddrLen);
-    if (clientSocket < 0)
-    {
-      printf("Server: Accept failed.\n");
-      vTaskDelay(pdMS_TO_TICKS(1000));
-      continue;
-    }
-    printf("Server: Client connected.\n");
-
-    // Set the client socket to non-blocking mode.
-    int flags = lwip_fcntl(clientSocket, F_GETFL, 0);
-    if (flags < 0)
-    {
-      printf("Server: Failed to get socket flags.\n");
-      lwip_close(clientSocket);
-      continue;
-    }
-    if (lwip_fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK) < 0)
-    {
-      printf("Server: Failed to set socket non-blocking.\n");
-      lwip_close(clientSocket);
-      continue;
-    }
+}
 
-    bool clientConnected = true;
+void transportClientConnected()
+{
+  networkStatus = NetworkStatus::CLIENT_CONNECTED;
+  discoveryRequestAnnounce();
+  sendGetStatusCommand();
+}
 
-    networkStatus = NetworkStatus::CLIENT_CONNECTED;
-    sendGetStatusCommand();
+void transportClientDisconnected()
+{
+  networkStatus = NetworkStatus::SOCKET_RUNNING;
+  discoveryRequestAnnounce();
+}
 
-    std::string messageBuffer;
+void transportReceivedLine(char *line, size_t length)
+{
+  printf("Server received complete message: %s\n", line);
 
-    while (clientConnected)
+  Message msg;
+  if (bufferToMessage(line, msg))
+  {
+    if (xQueueSend(incommingMessageQueue, &msg, 0) != pdPASS)
     {
-      char tempBuffer[256]; // Temporary buffer for each read.
-      int bytesRead = lwip_recv(clientSocket, tempBuffer, sizeof(tempBuffer) - 1, 0);
-      if (bytesRead > 0)
-      {
-        tempBuffer[bytesRead] = '\0';
-        // Append the received chunk to the message buffer.
-        messageBuffer.append(tempBuffer);
-
-        // Process complete messages delimited by newline.
-        size_t pos = 0;
-        while ((pos = messageBuffer.find('\n')) != std::string::npos)
-        {
-          std::string jsonMessage = messageBuffer.substr(0, pos);
-          messageBuffer.erase(0, pos + 1);
-          printf("Server received complete message: %s\n", jsonMessage.c_str());
-
-          Message msg;
-          if (bufferToMessage(jsonMessage.c_str(), msg))
-          {
-            if (xQueueSend(incommingMessageQueue, &msg, pdMS_TO_TICKS(100)) != pdPASS)
-            {
-              printf("Server: Failed to enqueue incoming message.\n");
-            }
-          }
-          else
-          {
-            printf("Server: Failed to convert buffer to Message.\n");
-          }
-        }
-      }
-      else if (bytesRead == 0)
-      {
-        // The connection has been gracefully closed by the client.
-        printf("Server: Client disconnected (zero bytes received).\n");
-        clientConnected = false;
-        break;
-      }
-      else // bytesRead < 0
-      {
-        int err_val = errno;
-        // If errno is EWOULDBLOCK, EAGAIN, or even 0 (as a workaround), consider it as "no data available" and continue.
-        if (err_val == EWOULDBLOCK || err_val == EAGAIN || err_val == 0)
-        {
-          // No data available; do nothing and continue.
-        }
-        else
-        {
-          printf("Server: lwip_recv error: %d. Closing connection.\n", err_val);
-          clientConnected = false;
-          break;
-        }
-      }
-
-      // Process outgoing messages regardless of incoming data.
-      Message outgoingMsg;
-      while (xQueueReceive(outgoingMessageQueue, &outgoingMsg, 0) == pdPASS)
-      {
-        std::string jsonString = messageToString(outgoingMsg);
-        if (lwip_send(clientSocket, jsonString.c_str(), jsonString.length(), 0) < 0)
-        {
-          printf("Server: Failed to send message: %s\n", jsonString.c_str());
-          clientConnected = false;
-          break;
-        }
-        else
-        {
-          printf("Server: Sent message: %s\n", jsonString.c_str());
-        }
-      }
-
-      // Yield to allow other tasks to run.
-      vTaskDelay(pdMS_TO_TICKS(100));
+      printf("Server: Failed to enqueue incoming message.\n");
     }
-
-    lwip_close(clientSocket);
-    printf("Server: Connection closed. Waiting for new connection...\n");
   }
+  else
+  {
+    printf("Server: Failed to convert buffer to Message.\n");
+  }
+}
 
-  // Cleanup: (never reached)
-  lwip_close(serverSocket);
-  serverSocket = -1;
-  xEventGroupSetBits(eventGroup, SOCKET_SERVER_FAILED_BIT);
-  vTaskDelete(NULL);
+// Woken by initSocket() each time the station connects
+void serverSocketTask(void *params)
+{
+  while (true)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    transport.serve(SOCKET_SERVER_PORT);
+    xEventGroupSetBits(eventGroup, SOCKET_SERVER_FAILED_BIT);
+  }
 }
 
 void handleStartup()
 {
   networkStatus = NetworkStatus::STARTUP;
   initSTAMode();
-  if (hasCredentials() && connectToWifiWithCredentials())
+  // Only the join at boot belongs on the boot timeline, reconnects would fill it
+  static bool joinTimed = false;
+  int step = joinTimed ? -1 : bootStepBegin("wifi-join");
+  joinTimed = true;
+  bool connected = hasCredentials() && connectToWifiWithCredentials();
+  bootStepEnd(step);
+  if (connected)
   {
     printf("Connected to Wi-Fi!\n");
     xEventGroupSetBits(eventGroup, WIFI_CONNECTED_BIT);
@@ -768,7 +669,7 @@ void handleWifiFailed()
   networkStatus = NetworkStatus::AP_MODE;
   deInitSTAMode();
   initAPMode();
-  xTaskCreate(credentialsTask, "CredentialsTask", 1024, NULL, tskIDLE_PRIORITY + 1, NULL);
+  xTaskNotifyGive(credentialsTaskHandle);
 }
 
 void handleConfigured()
@@ -790,7 +691,13 @@ void handleConfigured()
 void handleWifiConnected()
 {
   networkStatus = NetworkStatus::WIFI_CONNECTED;
+  // Keep the HTTP server up on the station interface so /diagnostics.json is
+  // reachable; it refuses the provisioning routes outside AP mode
+  cyw43_arch_lwip_begin();
+  startHttpServer();
+  cyw43_arch_lwip_end();
   initSocket();
+  bootMilestone("network-ready");
 }
 
 void handleSocketServerFailed()
@@ -819,26 +726,33 @@ void handleSocketServerFailed()
 
 void initWifi()
 {
-  eventGroup = xEventGroupCreate();
-  incommingMessageQueue = xQueueCreate(5, sizeof(Message));
+  eventGroup = xEventGroupCreateStatic(&eventGroupMemory);
+  staticMemoryAccount("wifi", sizeof(eventGroupMemory));
+  transport.init();
+  incommingMessageQueue = incomingQueueMemory.create("wifi");
   if (incommingMessageQueue == NULL)
   {
     printf("Failed to create incoming message queue.\n");
   }
-  outgoingMessageQueue = xQueueCreate(5, sizeof(Message));
+  outgoingMessageQueue = outgoingQueueMemory.create("wifi");
   if (outgoingMessageQueue == NULL)
   {
     printf("Failed to create outgoing message queue.\n");
   }
+  serverSocketTaskHandle = serverSocketTaskMemory.create(serverSocketTask, "ServerSocketTask", tskIDLE_PRIORITY + 1, "wifi");
+  credentialsTaskHandle = credentialsTaskMemory.create(credentialsTask, "CredentialsTask", tskIDLE_PRIORITY + 1, "wifi");
+  initHttpServer();
 }
 
 void wifiTask(void *params)
 {
   printf("Wi-Fi Task started.\n");
+  int step = bootStepBegin("radio");
   initArch();
   cyw43_arch_lwip_begin();
   mdns_resp_init();
   cyw43_arch_lwip_end();
+  bootStepEnd(step);
   xEventGroupSetBits(eventGroup, STARTUP_BIT);
   while (true)
   {
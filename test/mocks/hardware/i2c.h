@@ -0,0 +1,12 @@
+#ifndef MOCK_HARDWARE_I2C_H
+#define MOCK_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+
+// No bus: writes succeed and reads return zeros, see pico_mocks.cpp
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+
+#endif // MOCK_HARDWARE_I2C_H
@@ -0,0 +1,9 @@
+#ifndef MOCK_PICO_STDLIB_H
+#define MOCK_PICO_STDLIB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+#endif // MOCK_PICO_STDLIB_H
@@ -0,0 +1,14 @@
+#include <cstring>
+
+#include "hardware/i2c.h"
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+  return (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+  memset(dst, 0, len);
+  return (int)len;
+}
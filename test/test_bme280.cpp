@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+
+#include "bme280.h"
+
+// The datasheet's worked example (BMP280 section 3.12, shared by the BME280),
+// with typical humidity trimming parameters
+static const Bme280Calibration calibration = {
+    .digT1 = 27504,
+    .digT2 = 26435,
+    .digT3 = -1000,
+    .digP1 = 36477,
+    .digP2 = -10685,
+    .digP3 = 3024,
+    .digP4 = 2855,
+    .digP5 = 140,
+    .digP6 = -7,
+    .digP7 = 15500,
+    .digP8 = -14600,
+    .digP9 = 6000,
+    .digH1 = 75,
+    .digH2 = 362,
+    .digH3 = 0,
+    .digH4 = 313,
+    .digH5 = 50,
+    .digH6 = 30,
+};
+
+// adc_P = 415148, adc_T = 519888, adc_H = 30000 as one burst read of 0xF7-0xFE
+static const uint8_t example[8] = {0x65, 0x5A, 0xC0, 0x7E, 0xED, 0x00, 0x75, 0x30};
+
+TEST_CASE("bme280Unpack splits a burst read into 20 and 16 bit ADC values")
+{
+  Bme280Raw raw;
+  bme280Unpack(example, &raw);
+  CHECK(raw.pressure == 415148);
+  CHECK(raw.temperature == 519888);
+  CHECK(raw.humidity == 30000);
+}
+
+TEST_CASE("bme280Compensate matches the datasheet's worked example")
+{
+  Bme280Raw raw;
+  bme280Unpack(example, &raw);
+  Bme280Reading reading;
+  bme280Compensate(&calibration, &raw, &reading);
+
+  // 25.08 °C, and 100656 Pa from the 32-bit integer formula
+  CHECK(reading.temperature == 2508);
+  CHECK(reading.pressure == 100656);
+}
+
+TEST_CASE("bme280Compensate agrees with the floating point reference")
+{
+  // The example and readings around it as the extractor moves the booth pressure
+  for (int32_t dp = -4000; dp <= 4000; dp += 500)
+  {
+    for (int32_t dt = -20000; dt <= 20000; dt += 5000)
+    {
+      Bme280Raw raw;
+      bme280Unpack(example, &raw);
+      raw.pressure += dp;
+      raw.temperature += dt;
+
+      Bme280Reading reading;
+      bme280Compensate(&calibration, &raw, &reading);
+      float temperature, pressure, humidity;
+      bme280CompensateFloat(&calibration, &raw, &temperature, &pressure, &humidity);
+
+      CHECK(std::fabs(reading.temperature / 100.0f - temperature) <= 0.01f);
+      // The 32-bit integer formula trades a few Pa of absolute accuracy, about 3 Pa
+      // at the example; a broken step in it is off by far more
+      CHECK(std::fabs((float)reading.pressure - pressure) <= 8.0f);
+      CHECK(std::fabs(reading.humidity / 1024.0f - humidity) <= 0.1f);
+    }
+  }
+}